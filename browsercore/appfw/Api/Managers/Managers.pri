@@ -19,6 +19,7 @@ HEADERS += $$PWD/HistoryManager.h \
     $$PWD/viewcontroller.h \
     $$PWD/webpagecontroller.h \
     $$PWD/webpagecontroller_p.h \
+    $$PWD/sessionjournal.h \
     $$PWD/downloadcontroller_p.h \
     $$PWD/downloadcontroller.h \
     $$PWD/downloadproxy_p.h \
@@ -32,6 +33,7 @@ SOURCES += $$PWD/HistoryManager.cpp \
     $$PWD/LoadController.cpp \
     $$PWD/viewcontroller.cpp \
     $$PWD/webpagecontroller.cpp \
+    $$PWD/sessionjournal.cpp \
     $$PWD/downloadcontroller.cpp \
     $$PWD/downloadproxy.cpp \
     $$PWD/downloadproxydata.cpp \
@@ -27,6 +27,9 @@
 #include<QSqlError>
 #include<QWidget>
 #include<QDateTime>
+#include<QThread>
+#include<QMutex>
+#include<QWaitCondition>
 #include<QtGui>
 
 #include "geolocationManager.h"
@@ -34,11 +37,153 @@
 /* Declare the user defined meta type for use with QVariant in geolocation. */
 Q_DECLARE_METATYPE(QWebPage::PermissionPolicy);
 
+/**===================================================================================
+ * Applies the changes made to the permission table to the database, in order,
+ * from its own thread and its own connection so that the GUI thread never
+ * waits for SQLite. The statements are prepared once; changes that queue up
+ * while a batch is written go in the next transaction.
+ ======================================================================================*/
+class GeolocationWriter : public QThread
+{
+public:
+    struct Write {
+        enum Operation { Insert, Delete, Clear };
+        Operation operation;
+        QString domain;
+        int creationTime;
+        QString permission;
+    };
+
+    GeolocationWriter(const QString& fileName) : m_fileName(fileName), m_abort(false) {}
+    ~GeolocationWriter();
+
+    void queue(const Write& write);
+
+protected:
+    void run();
+
+private:
+    void writeAll(QSqlDatabase& db, QSqlQuery& insert, QSqlQuery& remove, QSqlQuery& clear);
+    static bool exec(QSqlQuery& query);
+
+    QString m_fileName;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QList<Write> m_queue;
+    bool m_abort;
+};
+
+/* Important: runs in the GUI thread, the pending changes are written before it returns */
+GeolocationWriter::~GeolocationWriter()
+{
+    m_mutex.lock();
+    m_abort = true;
+    m_condition.wakeOne();
+    m_mutex.unlock();
+
+    wait();
+}
+
+/* Important: runs in the GUI thread */
+void GeolocationWriter::queue(const Write& write)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.append(write);
+    m_condition.wakeOne();
+}
+
+/* Important: runs in its own thread, the connection has to be used only here */
+void GeolocationWriter::run()
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", GEOLOCATION_WRITER_DB_NAME);
+        db.setDatabaseName(m_fileName);
+        if (db.open()) {
+            QSqlQuery insert(db);
+            QSqlQuery remove(db);
+            QSqlQuery clear(db);
+            insert.prepare("INSERT OR IGNORE INTO geolocationdata (domain, creationtime, permission) "
+                           "VALUES (:domain, :ctime, :permission)");
+            remove.prepare("DELETE FROM geolocationdata WHERE domain=:domain");
+            clear.prepare("DELETE FROM geolocationdata");
+
+            writeAll(db, insert, remove, clear);
+            db.close();
+        } else {
+            qDebug() << "GeolocationWriter: cannot open" << m_fileName << db.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(GEOLOCATION_WRITER_DB_NAME);
+}
+
+void GeolocationWriter::writeAll(QSqlDatabase& db, QSqlQuery& insert, QSqlQuery& remove, QSqlQuery& clear)
+{
+    forever {
+        QList<Write> writes;
+        m_mutex.lock();
+        while (m_queue.isEmpty() && !m_abort)
+            m_condition.wait(&m_mutex);
+        writes = m_queue;
+        m_queue.clear();
+        m_mutex.unlock();
+
+        if (writes.isEmpty())
+            return; // aborted, and nothing left to write
+
+        db.transaction();
+        foreach (const Write& write, writes) {
+            switch (write.operation) {
+            case Write::Insert:
+                insert.bindValue(":domain", write.domain);
+                insert.bindValue(":ctime", write.creationTime);
+                insert.bindValue(":permission", write.permission);
+                exec(insert);
+                break;
+            case Write::Delete:
+                remove.bindValue(":domain", write.domain);
+                exec(remove);
+                break;
+            case Write::Clear:
+                exec(clear);
+                break;
+            }
+        }
+        if (!db.commit()) {
+            qDebug() << "GeolocationWriter:" << db.lastError().text();
+            db.rollback();
+        }
+    }
+}
+
+bool GeolocationWriter::exec(QSqlQuery& query)
+{
+    bool ok = query.exec();
+    if (!ok) {
+        qDebug() << "GeolocationWriter" << QString("ERR: %1 %2").arg(
+                query.lastError().type()).arg(query.lastError().text())
+                << " Query: " << query.lastQuery();
+    }
+    query.finish();
+    return ok;
+}
+
+static GeolocationManager* s_instance = NULL;
+
+/* Runs when the application object goes away, the writer finishes the pending changes */
+static void deleteGeolocationManager()
+{
+    delete s_instance;
+}
+
 GeolocationManager* GeolocationManager::getSingleton() 
 {
-    static GeolocationManager* s_instance;
+    static bool s_postRoutineAdded = false;
     if(!s_instance) {
         s_instance = new GeolocationManager();
+        if (!s_postRoutineAdded) {
+            qAddPostRoutine(deleteGeolocationManager);
+            s_postRoutineAdded = true;
+        }
     }
     Q_ASSERT(s_instance);
     return s_instance;    
@@ -46,6 +191,7 @@ GeolocationManager* GeolocationManager::getSingleton()
 
 GeolocationManager::GeolocationManager(QWidget *parent) :
     QObject(parent)
+    , m_writer(NULL)
 {
     setObjectName("geolocationManager");
     
@@ -61,11 +207,18 @@ GeolocationManager::GeolocationManager(QWidget *parent) :
         if(!doesTableExist(GEOLOCATION_TABLE_NAME)) {
             createGeolocationSchema();
         }
+        loadGeodata();
+
+        m_writer = new GeolocationWriter(m_geo.databaseName());
+        m_writer->start(QThread::LowPriority);
     }
 }
 
 GeolocationManager::~GeolocationManager()
 {
+    if (s_instance == this)
+        s_instance = NULL;
+    delete m_writer;
     m_geo.close();
     QSqlDatabase::removeDatabase(GEOLOCATION_DB_NAME);
 }
@@ -104,6 +257,22 @@ void GeolocationManager::createGeolocationSchema()
     }
 }
 
+/**===================================================================================
+ * Description: Reads the whole permission table into m_permissions.
+ * Returns: Nothing.
+ ======================================================================================*/
+void GeolocationManager::loadGeodata()
+{
+    QSqlQuery query(m_geo);
+    if (!query.exec("SELECT domain, permission FROM geolocationdata")) {
+        lastErrMsg(query);
+        return;
+    }
+    while (query.next())
+        m_permissions.insert(query.value(0).toString(), convertStringIntoPermission(query.value(1).toString()));
+    query.finish();
+}
+
 // TODO refactor this - nothing except the schema creation can use it as is
 bool GeolocationManager::doQuery(QString query)
 {
@@ -166,26 +335,18 @@ QString GeolocationManager::convertPermissionIntoString(QWebPage::PermissionPoli
  ======================================================================================*/
 int GeolocationManager::deleteGeodomain(QString domain)
 {
-   int retVal = SUCCESS;
-       
     if (domain.isEmpty())
-        retVal = FAILURE;
-       
-    if (retVal == SUCCESS) {
-        if (m_geo.isOpen()) {
-        QSqlQuery query(m_geo);
-               
-        query.prepare("DELETE FROM geolocationdata WHERE domain=:geodomain");
-        query.bindValue(":geodomain", domain);
-        if (!query.exec()) {
-            lastErrMsg(query);
-            retVal = DATABASEERROR;
-        }
-        } else 
-               retVal = FAILURE;
-    }
-       
-    return retVal;
+        return FAILURE;
+    if (!m_writer)
+        return FAILURE;
+
+    m_permissions.remove(domain);
+
+    GeolocationWriter::Write write;
+    write.operation = GeolocationWriter::Write::Delete;
+    write.domain = domain;
+    m_writer->queue(write);
+    return SUCCESS;
 }
  
 /**===================================================================================
@@ -194,19 +355,15 @@ int GeolocationManager::deleteGeodomain(QString domain)
  ======================================================================================*/
 int GeolocationManager::clearAllGeodata()
 {
-    int retVal = SUCCESS;
-    
-    if (m_geo.isOpen()) {
-        QSqlQuery query(m_geo);
-        
-        if (!query.exec("DELETE FROM geolocationdata")) {
-            lastErrMsg(query);
-            retVal = DATABASEERROR;
-        }
-    } else
-        retVal = FAILURE;
-    
-    return retVal;
+    if (!m_writer)
+        return FAILURE;
+
+    m_permissions.clear();
+
+    GeolocationWriter::Write write;
+    write.operation = GeolocationWriter::Write::Clear;
+    m_writer->queue(write);
+    return SUCCESS;
 }
 
 
@@ -217,51 +374,23 @@ int GeolocationManager::clearAllGeodata()
  ==================================================================*/
 int GeolocationManager::addGeodomain(QString domainToAdd, QWebPage::PermissionPolicy permission)
 {
-    int retVal = SUCCESS;
-    
     if (domainToAdd.isEmpty() || permission == QWebPage::PermissionUnknown)
-        retVal = FAILURE;
-    
-    if (retVal == SUCCESS) {
-        QString permissionPolicy(convertPermissionIntoString(permission));
-        
-        QDateTime dt  = QDateTime::currentDateTime();
-        int timestamp = dt.toTime_t();
-    
-        if (m_geo.isOpen()) {
-            QSqlQuery query(m_geo);
-            m_geo.transaction();
-            query.prepare("SELECT domain FROM geolocationdata WHERE domain=:domain");
-            query.bindValue(":domain",domainToAdd);
-            if (!query.exec()) {
-                 lastErrMsg(query);
-                 m_geo.rollback();
-                return DATABASEERROR;
-            }
-            if(!query.next()) {
-                QSqlQuery query2(m_geo);
-                query2.prepare("INSERT INTO geolocationdata (domain, creationtime, permission) "
-                        "VALUES (:domain, :ctime, :ppermisson)");
-                query2.bindValue(":domain", QVariant(domainToAdd));
-                query2.bindValue(":ctime", QVariant(timestamp));
-                query2.bindValue(":ppermission", QVariant(permissionPolicy));
-                if (!query2.exec()) {
-                    lastErrMsg(query);
-                    m_geo.rollback();
-                    retVal = DATABASEERROR;
-                }
-            }
-            query.finish();
-            if (!m_geo.commit()) {
-                 qDebug() << m_geo.lastError().text();
-                 m_geo.rollback();
-                 return DATABASEERROR;
-            }
-        } else
-            retVal = FAILURE;
-    }
-    
-    return retVal;
+        return FAILURE;
+    if (!m_writer)
+        return FAILURE;
+
+    // a domain keeps the permission it was first given
+    if (m_permissions.contains(domainToAdd))
+        return SUCCESS;
+    m_permissions.insert(domainToAdd, permission);
+
+    GeolocationWriter::Write write;
+    write.operation = GeolocationWriter::Write::Insert;
+    write.domain = domainToAdd;
+    write.creationTime = QDateTime::currentDateTime().toTime_t();
+    write.permission = convertPermissionIntoString(permission);
+    m_writer->queue(write);
+    return SUCCESS;
 }
 
 /**==============================================================
@@ -271,25 +400,13 @@ int GeolocationManager::addGeodomain(QString domainToAdd, QWebPage::PermissionPo
 QList<QVariant> GeolocationManager::findGeodomain(QString domainToFind)
 { 
     QList<QVariant> retValue;
-    
-    if (m_geo.isOpen()) {
-        QSqlQuery query(m_geo);
-        query.prepare(
-                "SELECT permission FROM geolocationdata WHERE domain=:domain");
-        query.bindValue(":domain",domainToFind);
-        if (query.exec()) {
-            if (query.next()) {
-                QWebPage::PermissionPolicy permission = convertStringIntoPermission(query.value(0).toString());
-                QVariant v;
-                v.setValue(permission);
-                retValue << v;
-                return retValue;
-            }
-        } else {
-            lastErrMsg(query);
-        }
+
+    QHash<QString, QWebPage::PermissionPolicy>::const_iterator it = m_permissions.constFind(domainToFind);
+    if (it != m_permissions.constEnd()) {
+        QVariant v;
+        v.setValue(it.value());
+        retValue << v;
     }
-    
     return retValue;
 }
 
@@ -27,13 +27,16 @@
 #include <QSqlError>
 #include <QVariant>
 #include <QWebPage>
+#include <QHash>
 #include "BWFGlobal.h"
 
 class QWidget;
+class GeolocationWriter;
 
 #define GEOLOCATION_DB_NAME   "Geolocation"
 #define GEOLOCATION_DB_FILE   "geolocation.db"
 #define GEOLOCATION_TABLE_NAME   "geolocationdata"
+#define GEOLOCATION_WRITER_DB_NAME   "GeolocationWriter"
 
 
 
@@ -63,11 +66,15 @@ public slots:
     bool doQuery(QString query);
     bool doesTableExist(QString tableName);
     void createGeolocationSchema();
+    void loadGeodata();
     void lastErrMsg(QSqlQuery& query);
     QWebPage::PermissionPolicy convertStringIntoPermission(QString permission);
     QString convertPermissionIntoString(QWebPage::PermissionPolicy permission);
 
     QSqlDatabase  m_geo;
+    // the whole table, the database is only written to, from m_writer
+    QHash<QString, QWebPage::PermissionPolicy> m_permissions;
+    GeolocationWriter* m_writer;
 };
 
 #endif //GEOLOCATIONMANAGER_H
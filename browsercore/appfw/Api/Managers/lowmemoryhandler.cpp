@@ -48,3 +48,11 @@ void LowMemoryHandler::stop()
     Q_D(LowMemoryHandler);
     d->stop();
 }
+
+void LowMemoryHandler::setFileSystemRoot(const QString& root)
+{
+    Q_D(LowMemoryHandler);
+    d->setFileSystemRoot(root);
+}
+
+#include "moc_lowmemoryhandler.cpp"
@@ -31,20 +31,37 @@ class LowMemoryHandler : public QObject
     Q_OBJECT
 
 public:
+    // Graded memory pressure, each level above none has its own signal.
+    // A signal is emitted once per episode, the first time its level is
+    // reached; memoryRecovered() ends the episode.
+    enum MemoryPressure {
+        NoMemoryPressure = 0,
+        ModerateMemoryPressure,     // moderateMemory()
+        CriticalMemoryPressure,     // lowMemory()
+        OutOfMemoryPressure         // outOfMemory(), the OOM killer is imminent
+    };
+
     LowMemoryHandler(QObject* parent = 0);
     virtual ~LowMemoryHandler();
 
+    // Directory the /proc and /sys trees are read from, "/" by default.
+    // Lets the Linux backend run against a fake procfs.
+    void setFileSystemRoot(const QString& root);
+
 public slots:
     void start();
     void stop();
 
 signals:
+    void moderateMemory();
     void lowMemory();
     void outOfMemory();
+    void memoryRecovered();
 
 private:
     LowMemoryHandlerPrivate* const d_ptr;
     Q_DECLARE_PRIVATE(LowMemoryHandler)
+    Q_PRIVATE_SLOT(d_func(), void _q_checkMemory())
 };
 
 #endif
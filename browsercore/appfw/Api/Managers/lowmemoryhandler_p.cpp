@@ -23,6 +23,372 @@
 #include "lowmemoryhandler_p.h"
 #include "lowmemoryhandler.h"
 
+#ifdef Q_OS_LINUX
+
+#include <QTimer>
+#include <QSocketNotifier>
+#include <QFile>
+#include <QDir>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Polling intervals, the PSI trigger and memory.events wake us up in between
+static const int KPollInterval = 2000;
+static const int KPressurePollInterval = 500;
+
+// PSI, percentage of time stalled on memory over the last 10 seconds.
+// Read from the cgroup of the process when possible, the system wide
+// figures are only trusted together with the process's own usage.
+static const double KPsiModerateSome = 10.0;
+static const double KPsiCriticalFull = 5.0;
+static const double KPsiOutOfMemoryFull = 25.0;
+// PSI trigger, 200ms of partial stall within a 2s window
+static const char KPsiTrigger[] = "some 200000 2000000";
+
+// cgroup usage in percent of memory.high / memory.max
+static const int KCgroupModerate = 80;
+static const int KCgroupCritical = 90;
+static const int KCgroupOutOfMemory = 97;
+
+// Resident size in percent of physical memory, used when
+// neither PSI nor a cgroup limit is available
+static const int KResidentModerate = 50;
+static const int KResidentCritical = 65;
+static const int KResidentOutOfMemory = 80;
+
+static QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    // procfs and cgroupfs report a size of 0, read until the end
+    return file.readAll();
+}
+
+// Re-reading through the watched descriptor re-arms its notification
+static QByteArray readFd(int fd)
+{
+    QByteArray data;
+    char buffer[512];
+    if (lseek(fd, 0, SEEK_SET) != 0)
+        return data;
+    ssize_t count;
+    while ((count = ::read(fd, buffer, sizeof(buffer))) > 0)
+        data.append(buffer, count);
+    return data;
+}
+
+// Value of "key=value" in a PSI line such as "full avg10=1.50 avg60=..."
+static double psiValue(const QByteArray& line, const char* key)
+{
+    QList<QByteArray> fields = line.simplified().split(' ');
+    foreach (const QByteArray& field, fields) {
+        int eq = field.indexOf('=');
+        if (eq > 0 && field.left(eq) == key)
+            return field.mid(eq + 1).toDouble();
+    }
+    return 0;
+}
+
+static qint64 cgroupValue(const QByteArray& data)
+{
+    QByteArray value = data.trimmed();
+    if (value.isEmpty() || value == "max")
+        return 0;
+    return value.toLongLong();
+}
+
+static int usageLevel(qint64 used, qint64 limit, int moderate, int critical, int outOfMemory)
+{
+    if (used <= 0 || limit <= 0)
+        return LowMemoryHandler::NoMemoryPressure;
+    qint64 percent = used * 100 / limit;
+    if (percent >= outOfMemory)
+        return LowMemoryHandler::OutOfMemoryPressure;
+    if (percent >= critical)
+        return LowMemoryHandler::CriticalMemoryPressure;
+    if (percent >= moderate)
+        return LowMemoryHandler::ModerateMemoryPressure;
+    return LowMemoryHandler::NoMemoryPressure;
+}
+
+// Level of the avg10 figures of a PSI file
+static int stallLevel(const QByteArray& data)
+{
+    double some = 0;
+    double full = 0;
+    QList<QByteArray> lines = data.split('\n');
+    foreach (const QByteArray& line, lines) {
+        if (line.startsWith("some "))
+            some = psiValue(line, "avg10");
+        else if (line.startsWith("full "))
+            full = psiValue(line, "avg10");
+    }
+
+    if (full >= KPsiOutOfMemoryFull)
+        return LowMemoryHandler::OutOfMemoryPressure;
+    if (full >= KPsiCriticalFull)
+        return LowMemoryHandler::CriticalMemoryPressure;
+    if (some >= KPsiModerateSome)
+        return LowMemoryHandler::ModerateMemoryPressure;
+    return LowMemoryHandler::NoMemoryPressure;
+}
+
+LowMemoryHandlerPrivate::LowMemoryHandlerPrivate()
+    : m_root("/")
+    , m_timer(0)
+    , m_psiFd(-1)
+    , m_psiNotifier(0)
+    , m_eventsFd(-1)
+    , m_eventsNotifier(0)
+    , m_physicalMemory(0)
+    , m_level(LowMemoryHandler::NoMemoryPressure)
+    , m_peakLevel(LowMemoryHandler::NoMemoryPressure)
+{
+}
+
+LowMemoryHandlerPrivate::~LowMemoryHandlerPrivate()
+{
+    stop();
+}
+
+void LowMemoryHandlerPrivate::start()
+{
+    Q_Q(LowMemoryHandler);
+    if (m_timer)
+        return;
+
+    QDir root(m_root);
+
+    // physical memory, scale for the resident size fallback
+    QList<QByteArray> meminfo = readFile(root.filePath("proc/meminfo")).split('\n');
+    foreach (const QByteArray& line, meminfo) {
+        if (line.startsWith("MemTotal:")) {
+            m_physicalMemory = line.mid(9).trimmed().split(' ').first().toLongLong() * 1024;
+            break;
+        }
+    }
+
+    // cgroup v2 of the process, "0::/path"
+    QList<QByteArray> cgroups = readFile(root.filePath("proc/self/cgroup")).split('\n');
+    foreach (const QByteArray& line, cgroups) {
+        if (line.startsWith("0::")) {
+            QString dir = root.filePath("sys/fs/cgroup") + QString::fromLocal8Bit(line.mid(3).trimmed());
+            if (QFile::exists(dir + "/memory.current"))
+                m_cgroupDir = dir;
+            break;
+        }
+    }
+
+    watchPressure();
+
+    m_timer = new QTimer(q);
+    QObject::connect(m_timer, SIGNAL(timeout()), q, SLOT(_q_checkMemory()));
+    m_timer->start(KPollInterval);
+    _q_checkMemory();
+}
+
+void LowMemoryHandlerPrivate::stop()
+{
+    delete m_timer;
+    m_timer = 0;
+    delete m_psiNotifier;
+    m_psiNotifier = 0;
+    delete m_eventsNotifier;
+    m_eventsNotifier = 0;
+    if (m_psiFd != -1) {
+        ::close(m_psiFd);
+        m_psiFd = -1;
+    }
+    if (m_eventsFd != -1) {
+        ::close(m_eventsFd);
+        m_eventsFd = -1;
+    }
+    m_cgroupDir.clear();
+    m_events.clear();
+    m_level = LowMemoryHandler::NoMemoryPressure;
+    m_peakLevel = LowMemoryHandler::NoMemoryPressure;
+}
+
+void LowMemoryHandlerPrivate::setFileSystemRoot(const QString& root)
+{
+    bool running = (m_timer != 0);
+    stop();
+    m_root = root;
+    if (running)
+        start();
+}
+
+/*!
+ * Arm the kernel notifications. Both are delivered as POLLPRI, which
+ * QSocketNotifier reports as an exception.
+ */
+void LowMemoryHandlerPrivate::watchPressure()
+{
+    Q_Q(LowMemoryHandler);
+
+    // A trigger is registered by writing to the file, which is only
+    // meaningful on the real procfs
+    if (QDir(m_root) == QDir::root()) {
+        QByteArray path = QFile::encodeName(pressureFile());
+        m_psiFd = ::open(path.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (m_psiFd != -1 && ::write(m_psiFd, KPsiTrigger, sizeof(KPsiTrigger)) < 0) {
+            // kernel without PSI triggers, or not permitted
+            ::close(m_psiFd);
+            m_psiFd = -1;
+        }
+        if (m_psiFd != -1) {
+            m_psiNotifier = new QSocketNotifier(m_psiFd, QSocketNotifier::Exception, q);
+            QObject::connect(m_psiNotifier, SIGNAL(activated(int)), q, SLOT(_q_checkMemory()));
+        }
+    }
+
+    if (!m_cgroupDir.isEmpty()) {
+        QByteArray path = QFile::encodeName(m_cgroupDir + "/memory.events");
+        m_eventsFd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+        if (m_eventsFd != -1) {
+            m_eventsNotifier = new QSocketNotifier(m_eventsFd, QSocketNotifier::Exception, q);
+            QObject::connect(m_eventsNotifier, SIGNAL(activated(int)), q, SLOT(_q_checkMemory()));
+        }
+    }
+}
+
+/*!
+ * The PSI file to watch: memory.pressure of the process's cgroup, which
+ * only counts stalls of our own tasks, else the system wide one
+ */
+QString LowMemoryHandlerPrivate::pressureFile() const
+{
+    if (!m_cgroupDir.isEmpty() && QFile::exists(m_cgroupDir + "/memory.pressure"))
+        return m_cgroupDir + "/memory.pressure";
+    return QDir(m_root).filePath("proc/pressure/memory");
+}
+
+/*!
+ * Level from the memory pressure stall information, -1 if not available.
+ * System wide stalls may be caused by any other process, they raise the
+ * level above moderate only when our own resident size is significant.
+ */
+int LowMemoryHandlerPrivate::psiLevel()
+{
+    QString path = pressureFile();
+    QByteArray data = readFile(path);
+    if (data.isEmpty())
+        return -1;
+
+    int level = stallLevel(data);
+    bool systemWide = m_cgroupDir.isEmpty() || !path.startsWith(m_cgroupDir);
+    if (systemWide && residentLevel() == LowMemoryHandler::NoMemoryPressure)
+        level = qMin<int>(level, LowMemoryHandler::ModerateMemoryPressure);
+    return level;
+}
+
+/*!
+ * Level from the cgroup v2 limits and events, -1 if the process
+ * is not in a cgroup with a memory limit
+ */
+int LowMemoryHandlerPrivate::cgroupLevel()
+{
+    if (m_cgroupDir.isEmpty())
+        return -1;
+
+    int level = LowMemoryHandler::NoMemoryPressure;
+
+    // counters that went up since the last check: "high" means reclaim
+    // is throttling us, "max" that the hard limit was hit and "oom" that
+    // reclaim failed at the limit
+    QByteArray events = (m_eventsFd != -1) ? readFd(m_eventsFd)
+                                           : readFile(m_cgroupDir + "/memory.events");
+    QList<QByteArray> lines = events.split('\n');
+    foreach (const QByteArray& line, lines) {
+        QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.count() != 2)
+            continue;
+        qint64 count = fields.at(1).toLongLong();
+        bool raised = m_events.contains(fields.at(0)) && count > m_events.value(fields.at(0));
+        m_events.insert(fields.at(0), count);
+        if (!raised)
+            continue;
+        if (fields.at(0) == "oom" || fields.at(0) == "oom_kill")
+            level = qMax<int>(level, LowMemoryHandler::OutOfMemoryPressure);
+        else if (fields.at(0) == "max")
+            level = qMax<int>(level, LowMemoryHandler::CriticalMemoryPressure);
+        else if (fields.at(0) == "high")
+            level = qMax<int>(level, LowMemoryHandler::ModerateMemoryPressure);
+    }
+
+    // the tighter of the soft and hard limit
+    qint64 high = cgroupValue(readFile(m_cgroupDir + "/memory.high"));
+    qint64 max = cgroupValue(readFile(m_cgroupDir + "/memory.max"));
+    qint64 limit = (high > 0 && (max <= 0 || high < max)) ? high : max;
+    if (limit <= 0)
+        return (level > LowMemoryHandler::NoMemoryPressure) ? level : -1;
+
+    qint64 current = cgroupValue(readFile(m_cgroupDir + "/memory.current"));
+    return qMax(level, usageLevel(current, limit,
+                                  KCgroupModerate, KCgroupCritical, KCgroupOutOfMemory));
+}
+
+/*!
+ * Level from the resident size of the process in /proc/self/statm
+ */
+int LowMemoryHandlerPrivate::residentLevel()
+{
+    // size resident shared text lib data dt, in pages
+    QList<QByteArray> fields = readFile(QDir(m_root).filePath("proc/self/statm")).simplified().split(' ');
+    if (fields.count() < 2)
+        return LowMemoryHandler::NoMemoryPressure;
+    qint64 resident = fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+    return usageLevel(resident, m_physicalMemory,
+                      KResidentModerate, KResidentCritical, KResidentOutOfMemory);
+}
+
+void LowMemoryHandlerPrivate::_q_checkMemory()
+{
+    Q_Q(LowMemoryHandler);
+    if (!m_timer)
+        return;
+
+    int psi = psiLevel();
+    int cgroup = cgroupLevel();
+    int level = qMax(psi, cgroup);
+    if (level < 0)
+        level = residentLevel();
+
+    // signal each level once per episode, it ends when the pressure is gone
+    if (level > m_peakLevel) {
+        m_peakLevel = level;
+        emitPressure(level);
+    }
+    else if (level == LowMemoryHandler::NoMemoryPressure && m_peakLevel > level) {
+        m_peakLevel = level;
+        emit q->memoryRecovered();
+    }
+    m_level = level;
+
+    m_timer->setInterval(level > LowMemoryHandler::NoMemoryPressure ? KPressurePollInterval : KPollInterval);
+}
+
+void LowMemoryHandlerPrivate::emitPressure(int level)
+{
+    Q_Q(LowMemoryHandler);
+    switch (level) {
+    case LowMemoryHandler::ModerateMemoryPressure:
+        emit q->moderateMemory();
+        break;
+    case LowMemoryHandler::CriticalMemoryPressure:
+        emit q->lowMemory();
+        break;
+    case LowMemoryHandler::OutOfMemoryPressure:
+        emit q->outOfMemory();
+        break;
+    default:
+        break;
+    }
+}
+
+#else // Q_OS_LINUX
+
 LowMemoryHandlerPrivate::LowMemoryHandlerPrivate()
 {
 }
@@ -38,3 +404,13 @@ void LowMemoryHandlerPrivate::start()
 void LowMemoryHandlerPrivate::stop()
 {
 }
+
+void LowMemoryHandlerPrivate::setFileSystemRoot(const QString& /*root*/)
+{
+}
+
+void LowMemoryHandlerPrivate::_q_checkMemory()
+{
+}
+
+#endif // Q_OS_LINUX
@@ -27,9 +27,13 @@
 #ifdef Q_OS_SYMBIAN
 #include <e32base.h>
 #include <e32std.h>
+#elif defined(Q_OS_LINUX)
+#include <QHash>
 #endif
 
 class LowMemoryHandler;
+class QTimer;
+class QSocketNotifier;
 
 class LowMemoryHandlerPrivate
 #ifdef Q_OS_SYMBIAN
@@ -44,6 +48,8 @@ public:
     
     void start();
     void stop();
+    void setFileSystemRoot(const QString& root);
+    void _q_checkMemory();
 
     LowMemoryHandler* q_ptr;
 
@@ -55,6 +61,28 @@ private:
 
     RChangeNotifier iNotifier;
     TBool iInitialized;
+#elif defined(Q_OS_LINUX)
+    QString pressureFile() const;
+    int psiLevel();
+    int cgroupLevel();
+    int residentLevel();
+    void watchPressure();
+    void emitPressure(int level);
+
+    QString m_root;
+    QTimer* m_timer;
+    // PSI trigger on the cgroup's memory.pressure or /proc/pressure/memory,
+    // wakes us up between polls
+    int m_psiFd;
+    QSocketNotifier* m_psiNotifier;
+    // cgroup v2 directory of the process and its memory.events
+    QString m_cgroupDir;
+    int m_eventsFd;
+    QSocketNotifier* m_eventsNotifier;
+    QHash<QByteArray, qint64> m_events;
+    qint64 m_physicalMemory;
+    int m_level;
+    int m_peakLevel;    // highest level signalled in the current episode
 #endif
 };
 
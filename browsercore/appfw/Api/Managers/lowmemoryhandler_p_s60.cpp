@@ -53,6 +53,15 @@ void LowMemoryHandlerPrivate::stop()
     Cancel();
 }
 
+void LowMemoryHandlerPrivate::setFileSystemRoot(const QString& /*root*/)
+{
+}
+
+void LowMemoryHandlerPrivate::_q_checkMemory()
+{
+    // notifications come from RChangeNotifier
+}
+
 void LowMemoryHandlerPrivate::DoCancel()
 {
     iNotifier.LogonCancel();
@@ -0,0 +1,471 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#include "sessionjournal.h"
+#include <QDataStream>
+#include <QMap>
+#include <QThread>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace WRT {
+
+static const quint32 KJournalMagic = 0x424a524e;   // "BJRN"
+static const quint16 KJournalVersion = 1;
+static const int KRecordHeaderSize = 6;             // quint32 length, quint16 checksum
+static const int KMaxRecordSize = 4 * 1024 * 1024;
+static const int KCompactThreshold = 256;           // records appended before asking for compaction
+
+/*!
+ * Writes a journal snapshot to a new file and syncs it to storage, so that
+ * it is complete on disk before it replaces the journal.
+ * Important: runs in its own thread, it only uses the data given to it.
+ */
+class SessionJournalWriter : public QThread
+{
+public:
+    SessionJournalWriter(SessionJournal* journal, int generation, const QString& fileName,
+                         const QList<SessionJournal::Window>& windows, const QList<quint32>& ids, quint32 activeId)
+        : m_journal(journal), m_generation(generation), m_fileName(fileName)
+        , m_windows(windows), m_ids(ids), m_activeId(activeId), m_succeeded(false) {}
+
+    bool succeeded() const { return m_succeeded; }
+
+protected:
+    void run();
+
+private:
+    bool write();
+
+private:
+    SessionJournal* m_journal;
+    int m_generation;
+    QString m_fileName;
+    QList<SessionJournal::Window> m_windows;
+    QList<quint32> m_ids;
+    quint32 m_activeId;
+    bool m_succeeded;
+};
+
+void SessionJournalWriter::run()
+{
+    m_succeeded = write();
+
+    // the journal may have waited for this writer and started another one
+    // by the time this is delivered, the generation tells them apart
+    QMetaObject::invokeMethod(m_journal, "writerFinished", Qt::QueuedConnection, Q_ARG(int, m_generation));
+}
+
+bool SessionJournalWriter::write()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    {
+        QDataStream header(&file);
+        header.setVersion(QDataStream::Qt_4_6);
+        header << KJournalMagic << KJournalVersion;
+    }
+
+    for (int i = 0; i < m_windows.count(); i++) {
+        quint32 id = m_ids.at(i);
+        const SessionJournal::Window& window = m_windows.at(i);
+
+        {
+            QByteArray record;
+            QDataStream out(&record, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_4_6);
+            out << quint8(SessionJournal::ERecordOpen) << id << qint32(i);
+            SessionJournal::writeRecord(&file, record);
+        }
+        {
+            QByteArray record;
+            QDataStream out(&record, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_4_6);
+            out << quint8(SessionJournal::ERecordHistory) << id << window.m_history;
+            SessionJournal::writeRecord(&file, record);
+        }
+        {
+            QByteArray record;
+            QDataStream out(&record, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_4_6);
+            out << quint8(SessionJournal::ERecordNavigate) << id << window.m_url << window.m_title;
+            SessionJournal::writeRecord(&file, record);
+        }
+        if (!window.m_thumbnail.isEmpty()) {
+            QByteArray record;
+            QDataStream out(&record, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_4_6);
+            out << quint8(SessionJournal::ERecordThumbnail) << id << window.m_thumbnail;
+            SessionJournal::writeRecord(&file, record);
+        }
+    }
+    if (m_activeId) {
+        QByteArray record;
+        QDataStream out(&record, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_4_6);
+        out << quint8(SessionJournal::ERecordActivate) << m_activeId;
+        SessionJournal::writeRecord(&file, record);
+    }
+
+    // the rename must not reach the disk before the data does
+    bool synced = file.flush();
+#ifdef Q_OS_WIN
+    synced = synced && _commit(file.handle()) == 0;
+#else
+    synced = synced && fsync(file.handle()) == 0;
+#endif
+    file.close();
+    return synced && file.error() == QFile::NoError;
+}
+
+SessionJournal::SessionJournal(const QString& fileName, QObject* parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+    , m_nextId(1)
+    , m_records(0)
+    , m_enabled(true)
+    , m_writer(0)
+    , m_generation(0)
+{
+}
+
+SessionJournal::~SessionJournal()
+{
+    finishCompaction();
+    m_file.close();
+}
+
+void SessionJournal::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!m_enabled) {
+        // a snapshot being written is still put in place
+        finishCompaction();
+        m_file.close();
+    }
+}
+
+/*!
+ * Replays the journal into \a windows, in window order, and sets \a activeIndex
+ * to the index of the window that was active last.
+ * Returns false if there is no usable journal.
+ */
+bool SessionJournal::load(QList<Window>& windows, int& activeIndex)
+{
+    windows.clear();
+    activeIndex = 0;
+
+    // A crash during compact() may have left only the new file
+    QString fileName = m_fileName;
+    if (!QFile::exists(fileName) && QFile::exists(m_fileName + QLatin1String(".new")))
+        fileName = m_fileName + QLatin1String(".new");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != KJournalMagic || version != KJournalVersion)
+        return false;
+
+    QList<quint32> order;
+    QMap<quint32, Window> byId;
+    quint32 activeId = 0;
+
+    while (!in.atEnd()) {
+        quint32 length = 0;
+        quint16 checksum = 0;
+        in >> length >> checksum;
+        if (in.status() != QDataStream::Ok || length > quint32(KMaxRecordSize))
+            break;
+        QByteArray record = file.read(length);
+        if (record.size() != int(length) || qChecksum(record.constData(), length) != checksum)
+            break;  // torn write, keep what came before
+
+        QDataStream r(record);
+        r.setVersion(QDataStream::Qt_4_6);
+        quint8 type = 0;
+        quint32 id = 0;
+        r >> type >> id;
+        switch (type) {
+        case ERecordOpen: {
+            qint32 position = 0;
+            r >> position;
+            order.removeAll(id);
+            order.insert(qBound(0, int(position), order.count()), id);
+            byId.insert(id, Window());
+            break;
+        }
+        case ERecordClose:
+            order.removeAll(id);
+            byId.remove(id);
+            break;
+        case ERecordActivate:
+            activeId = id;
+            break;
+        case ERecordNavigate:
+            if (byId.contains(id))
+                r >> byId[id].m_url >> byId[id].m_title;
+            break;
+        case ERecordHistory:
+            if (byId.contains(id))
+                r >> byId[id].m_history;
+            break;
+        case ERecordThumbnail:
+            if (byId.contains(id))
+                r >> byId[id].m_thumbnail;
+            break;
+        default:
+            break;  // written by a newer version
+        }
+    }
+
+    foreach (quint32 id, order) {
+        if (id == activeId)
+            activeIndex = windows.count();
+        windows.append(byId.value(id));
+    }
+    return !windows.isEmpty();
+}
+
+/*!
+ * Replaces the journal by a snapshot of \a pages, whose state is given by
+ * \a windows, and keeps it open for the following records. A null page is
+ * a restored window whose page has not been created yet.
+ * The snapshot is written by a thread; waitForCompaction() blocks until it
+ * has replaced the journal.
+ */
+bool SessionJournal::compact(const QList<WrtBrowserContainer*>& pages, const QList<Window>& windows, int activeIndex)
+{
+    Q_ASSERT(pages.count() == windows.count());
+    if (!m_enabled)
+        return false;
+
+    // one snapshot at a time
+    finishCompaction();
+
+    QList<quint32> ids;
+    m_ids.clear();
+    m_restoredIds.clear();
+    m_nextId = 1;
+    quint32 activeId = 0;
+    for (int i = 0; i < pages.count(); i++) {
+        quint32 id = m_nextId++;
+        if (pages.at(i))
+            m_ids.insert(pages.at(i), id);
+        else
+            m_restoredIds.append(id);
+        if (i == activeIndex)
+            activeId = id;
+        ids.append(id);
+    }
+
+    m_records = 0;
+    m_pendingRecords.clear();
+    m_writer = new SessionJournalWriter(this, ++m_generation, m_fileName + QLatin1String(".new"),
+                                        windows, ids, activeId);
+    m_writer->start(QThread::LowPriority);
+    return true;
+}
+
+/*!
+ * Waits for the snapshot being written, puts it in place of the journal and
+ * adds the records appended in the meantime
+ */
+void SessionJournal::finishCompaction()
+{
+    if (!m_writer)
+        return;
+
+    m_writer->wait();
+    bool written = m_writer->succeeded();
+    delete m_writer;
+    m_writer = 0;
+
+    QByteArray pending = m_pendingRecords;
+    m_pendingRecords.clear();
+    QString newFileName = m_fileName + QLatin1String(".new");
+    if (!written) {
+        // the ids now belong to the failed snapshot, start over on the next record
+        QFile::remove(newFileName);
+        m_file.close();
+        return;
+    }
+
+    // QFile::rename() does not overwrite; load() falls back to the new file
+    // if we stop between these two calls
+    m_file.close();
+    QFile::remove(m_fileName);
+    if (!QFile::rename(newFileName, m_fileName))
+        return;
+
+    m_file.setFileName(m_fileName);
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Append) && !pending.isEmpty()) {
+        m_file.write(pending);
+        m_file.flush();
+    }
+}
+
+void SessionJournal::writerFinished(int generation)
+{
+    if (generation == m_generation)
+        finishCompaction();
+}
+
+bool SessionJournal::exists() const
+{
+    return QFile::exists(m_fileName) || QFile::exists(m_fileName + QLatin1String(".new"));
+}
+
+void SessionJournal::remove()
+{
+    if (m_writer) {
+        m_writer->wait();
+        delete m_writer;
+        m_writer = 0;
+        m_pendingRecords.clear();
+    }
+    m_file.close();
+    m_ids.clear();
+    m_restoredIds.clear();
+    m_records = 0;
+    QFile::remove(m_fileName);
+    QFile::remove(m_fileName + QLatin1String(".new"));
+}
+
+void SessionJournal::windowOpened(WrtBrowserContainer* page, int position)
+{
+    if (m_ids.contains(page))
+        return;     // already in the last snapshot
+
+    quint32 id = m_nextId++;
+    m_ids.insert(page, id);
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << quint8(ERecordOpen) << id << qint32(position);
+    append(record);
+}
+
+void SessionJournal::windowClosed(WrtBrowserContainer* page)
+{
+    if (!m_ids.contains(page))
+        return;
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << quint8(ERecordClose) << m_ids.take(page);
+    append(record);
+}
+
+void SessionJournal::windowActivated(WrtBrowserContainer* page)
+{
+    if (!m_ids.contains(page))
+        return;
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << quint8(ERecordActivate) << m_ids.value(page);
+    append(record);
+}
+
+void SessionJournal::windowNavigated(WrtBrowserContainer* page, int position, const QString& url, const QString& title)
+{
+    // blank windows are left out of snapshots, they join on their first load
+    windowOpened(page, position);
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << quint8(ERecordNavigate) << m_ids.value(page) << url << title;
+    append(record);
+}
+
+/*!
+ * The page of the \a restoredIndex th window without a page was created
+ */
+void SessionJournal::windowCreated(WrtBrowserContainer* page, int restoredIndex)
+{
+    if (restoredIndex >= 0 && restoredIndex < m_restoredIds.count())
+        m_ids.insert(page, m_restoredIds.takeAt(restoredIndex));
+}
+
+/*!
+ * The \a restoredIndex th window without a page was closed
+ */
+void SessionJournal::restoredWindowClosed(int restoredIndex)
+{
+    if (restoredIndex < 0 || restoredIndex >= m_restoredIds.count())
+        return;
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << quint8(ERecordClose) << m_restoredIds.takeAt(restoredIndex);
+    append(record);
+}
+
+void SessionJournal::append(const QByteArray& record)
+{
+    if (!m_enabled || !isOpen())
+        return;
+
+    QByteArray framed = frame(record);
+    if (m_writer) {
+        // the record uses the ids of the snapshot being written, it must not
+        // reach the old file where they may name other windows
+        m_pendingRecords += framed;
+    } else {
+        m_file.write(framed);
+        m_file.flush();
+    }
+    if (++m_records == KCompactThreshold)
+        emit compactionNeeded();
+}
+
+QByteArray SessionJournal::frame(const QByteArray& record)
+{
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << quint32(record.size()) << quint16(qChecksum(record.constData(), record.size()));
+    Q_ASSERT(header.size() == KRecordHeaderSize);
+    return header + record;
+}
+
+void SessionJournal::writeRecord(QIODevice* device, const QByteArray& record)
+{
+    device->write(frame(record));
+}
+
+}
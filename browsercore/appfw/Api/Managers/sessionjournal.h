@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef __SESSIONJOURNAL_H__
+#define __SESSIONJOURNAL_H__
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include "BWFGlobal.h"
+
+namespace WRT {
+
+    class WrtBrowserContainer;
+    class SessionJournalWriter;
+
+    /*!
+     * Append-only record of the browser session, kept in a single file.
+     *
+     * Opening, closing, activating a window and finishing a page load each
+     * append one short record (window id, and url and title for a load),
+     * flushed right away, so a crash loses at most the event being written.
+     * compact() rewrites the file as a snapshot of the current windows with
+     * their full history; it is done at startup, at exit and, when the
+     * journal gets long, from the owner's reaction to compactionNeeded().
+     * The snapshot is written and synced from a thread of its own. It numbers
+     * the windows afresh, so records appended meanwhile are kept in memory
+     * and written after it once it replaces the old file; a crash before
+     * that loses them but leaves the old file as it was.
+     *
+     * Every record carries its length and a checksum; load() replays the
+     * records up to the first damaged one, e.g. the torn tail of a write cut
+     * short by a crash.
+     *
+     * Restored windows that have no page yet are passed to compact() as null
+     * pages. They are then referred to by their rank among those windows,
+     * see windowCreated() and restoredWindowClosed().
+     */
+    class BWF_EXPORT SessionJournal : public QObject
+    {
+        Q_OBJECT
+    public:
+        struct Window {
+            QByteArray m_history;       // QWebHistory as serialised by QDataStream
+            QString m_url;              // last page loaded, may be newer than m_history
+            QString m_title;
+            QByteArray m_thumbnail;     // PNG data, may be empty
+        };
+
+        SessionJournal(const QString& fileName, QObject* parent = 0);
+        ~SessionJournal();
+
+        bool isEnabled() const { return m_enabled; }
+        void setEnabled(bool enabled);
+        bool isOpen() const { return m_file.isOpen() || m_writer; }
+        bool exists() const;
+
+        bool load(QList<Window>& windows, int& activeIndex);
+        bool compact(const QList<WrtBrowserContainer*>& pages, const QList<Window>& windows, int activeIndex);
+        void waitForCompaction() { finishCompaction(); }
+        void remove();
+
+        void windowOpened(WrtBrowserContainer* page, int position);
+        void windowClosed(WrtBrowserContainer* page);
+        void windowActivated(WrtBrowserContainer* page);
+        void windowNavigated(WrtBrowserContainer* page, int position, const QString& url, const QString& title);
+        void windowCreated(WrtBrowserContainer* page, int restoredIndex);
+        void restoredWindowClosed(int restoredIndex);
+
+    signals:
+        void compactionNeeded();
+
+    private slots:
+        void finishCompaction();
+        void writerFinished(int generation);
+
+    private:
+        enum RecordType {
+            ERecordOpen = 1,
+            ERecordClose,
+            ERecordActivate,
+            ERecordNavigate,
+            ERecordHistory,
+            ERecordThumbnail
+        };
+
+        void append(const QByteArray& record);
+        static QByteArray frame(const QByteArray& record);
+        static void writeRecord(QIODevice* device, const QByteArray& record);
+        friend class SessionJournalWriter;
+
+    private:
+        QString m_fileName;
+        QFile m_file;
+        QHash<WrtBrowserContainer*, quint32> m_ids;
+        QList<quint32> m_restoredIds;   // windows snapshotted without a page, in order
+        quint32 m_nextId;
+        int m_records;          // appended since the last compaction
+        bool m_enabled;
+        SessionJournalWriter* m_writer;     // compaction in progress
+        int m_generation;                   // of m_writer
+        QByteArray m_pendingRecords;        // appended while m_writer runs, not written yet
+    };
+}
+#endif // __SESSIONJOURNAL_H__
@@ -35,6 +35,7 @@
 #include "ContentAgent.h"
 #include "lowmemoryhandler.h"
 #include "webnetworkaccessmanager.h"
+#include "webnetworkrecorder.h"
 #include <QWebFrame>
 #include <QWebHistory>
 #include <QGraphicsWebView>
@@ -77,6 +78,7 @@ static const QString EMAIL_SEND_TO_KEY = "to";
 #define MAX_NUM_WINDOWS 5
 
 static const char KHISTORYEXTENSION[]       = ".history";
+static const char KSESSIONJOURNALFILE[]     = "/session.journal";
 static const char KCOOKIESEXTENSION[]       = ".ini";
 
 
@@ -86,7 +88,11 @@ WebPageControllerPrivate::WebPageControllerPrivate(WebPageController* qq) :
     m_currentPage(-1),
     m_secContext(0),
     m_actionsParent(0),
-    donotsaveFlag(false)
+    donotsaveFlag(false),
+    m_journal(0),
+    m_savedActiveWindow(0),
+    m_sessionLoaded(false),
+    m_pageCacheReleased(false)
 {
     m_widgetParent = static_cast<QObject*>(qq); //new QWidget();
 
@@ -109,26 +115,33 @@ WebPageControllerPrivate::WebPageControllerPrivate(WebPageController* qq) :
 
 WebPageControllerPrivate::~WebPageControllerPrivate()
 {
-    // save history in the persistent storage, delete history files first
+    // save history in the persistent storage, replacing what the journal holds
    
     bool enabled = (bool) BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("SaveSession");
     if (enabled)
     {
-      q->deleteHistory();
       if(donotsaveFlag == false)
       {	
         int windowsSaved = 0;
         int activeWindowId = 0;
     	  q->saveHistory(&windowsSaved, &activeWindowId);
-    	  q->saveNumberOfWindows(windowsSaved);    
-        q->saveActiveWindowId(activeWindowId);
   	  }
+  	  else
+  	    q->deleteHistory();
   	  donotsaveFlag = true;
     }
     else
     {
     	q->deleteDataFiles();
     }
+    // closing the pages below is not part of the session
+    m_journal->setEnabled(false);
+
+    // restored windows that were never shown have no page to close
+    WRT::WrtBrowserContainer* theCurrentPage = q->currentPage();
+    m_allPages.removeAll(0);
+    m_restoredWindows.clear();
+    m_currentPage = m_allPages.indexOf(theCurrentPage);
 
     // clean up all pages
     while ( !m_allPages.isEmpty() )
@@ -177,16 +190,24 @@ WebPageController::WebPageController ( QObject* parent ) :
 
     d->m_historyDir = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("DataBaseDirectory");
 
+    d->m_journal = new SessionJournal(d->m_historyDir + QLatin1String(KSESSIONJOURNALFILE), this);
+    d->m_journal->setEnabled((bool) BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("SaveSession"));
+    // compact from the event loop, not from within the navigation that filled the journal
+    connect(d->m_journal, SIGNAL(compactionNeeded()), this, SLOT(compactSession()), Qt::QueuedConnection);
+
     // auto-connect actions
     connect( d->m_actionReload, SIGNAL( triggered() ), this, SLOT( currentReload() ) );
     connect( d->m_actionStop, SIGNAL( triggered() ), this, SLOT( currentStop() ) );
     connect( d->m_actionBack, SIGNAL( triggered() ), this, SLOT( currentBack() ) );
     connect( d->m_actionForward, SIGNAL( triggered() ), this, SLOT( currentForward() ) );
 
+    connect( m_memoryHandler, SIGNAL( moderateMemory() ), this, SLOT( handleModerateMemory() ) );
     connect( m_memoryHandler, SIGNAL( lowMemory() ), this, SIGNAL( lowMemory() ) );
     connect( m_memoryHandler, SIGNAL( lowMemory() ), this, SLOT( handleLowMemory() ) );
     connect( m_memoryHandler, SIGNAL( outOfMemory() ), this, SIGNAL( outOfMemory() ) );
     connect( m_memoryHandler, SIGNAL( outOfMemory() ), this, SLOT( handleOutOfMemory() ) );
+    connect( m_memoryHandler, SIGNAL( memoryRecovered() ), this, SIGNAL( memoryRecovered() ) );
+    connect( m_memoryHandler, SIGNAL( memoryRecovered() ), this, SLOT( handleMemoryRecovered() ) );
     m_memoryHandler->start();
 
     updateJSActions();
@@ -216,30 +237,15 @@ WRT::WrtBrowserContainer* WebPageController::openPage(QObject* parent, WRT::WrtB
     WRT::WrtBrowserContainer* page =  currentPage();
     if (  d->m_allPages.count() < MAX_NUM_WINDOWS ) {
 
-
-        // create without parent
-        page = WRT::WrtBrowserContainer::createPageWithWidgetParent(parent, pg);
-
-        // emit signal for creating network connection.
-
-        Q_ASSERT( page );
-        page->settings()->setAttribute(QWebSettings::DeveloperExtrasEnabled, (bool) BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("DeveloperExtras"));
-        connect( page, SIGNAL( loadFinished(bool) ), SLOT( onLoadFinishedForBackgroundWindow(bool) ) );
-
-        // emit signal indicating that new page is being created
-        emit creatingPage( page );
-
         /* Add the new page after the current page */
         WRT::WrtBrowserContainer * theCurrentPage = currentPage();
         int index = d->m_allPages.indexOf(theCurrentPage);
-        d->m_allPages.insert (index+1, page );
+        page = createPage(parent, pg);
 
-  // set the max number of pages to hold in the memory page cache to pages
-  // The Page Cache allows for a nicer user experience when navigating forth or back to pages in 
-  // the forward/back history, by pausing and resuming up to pages per page group
+        // emit signal indicating that new page is being created
+        emit creatingPage( page );
 
-		int maxPagesInCache = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("MaxPagesInCache");
-        page->settings()->setMaximumPagesInCache(maxPagesInCache);
+        d->m_allPages.insert (index+1, page );
 
         // emit signal
         emit pageCreated( page );
@@ -248,16 +254,44 @@ WRT::WrtBrowserContainer* WebPageController::openPage(QObject* parent, WRT::WrtB
         if(d->m_allPages.size() == 1) {
             setCurrentPage(page);
         }
-        int count = historyWindowCount();
-        int activeWinId = activeWindowId();
 
-        if (m_bRestoreSession)
-        	startupRestoreHistory(NULL, index+1, page);
+        // The first page shows the window that was active, loadFromHistory()
+        // adds the other windows of the session without creating their pages
+        if (m_bRestoreSession) {
+            if (d->m_allPages.size() == 1)
+                startupRestoreHistory(NULL, activeWindowId(), page);
+        }
+        else if (ensureJournal())
+            d->m_journal->windowOpened(page, index+1);
     	  
     }
     return page;
 }
 
+/*!
+ * Creates a page with the browser settings, the caller adds it to the list
+ */
+WRT::WrtBrowserContainer* WebPageController::createPage(QObject* parent, WRT::WrtBrowserContainer* pg)
+{
+    // create without parent
+    WRT::WrtBrowserContainer* page = WRT::WrtBrowserContainer::createPageWithWidgetParent(parent, pg);
+
+    // emit signal for creating network connection.
+
+    Q_ASSERT( page );
+    page->settings()->setAttribute(QWebSettings::DeveloperExtrasEnabled, (bool) BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("DeveloperExtras"));
+    connect( page, SIGNAL( loadFinished(bool) ), SLOT( onLoadFinishedForBackgroundWindow(bool) ) );
+
+    // set the max number of pages to hold in the memory page cache to pages
+    // The Page Cache allows for a nicer user experience when navigating forth or back to pages in 
+    // the forward/back history, by pausing and resuming up to pages per page group
+    int maxPagesInCache = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("MaxPagesInCache");
+    // no page cache until an out of memory episode is over
+    page->settings()->setMaximumPagesInCache(d->m_pageCacheReleased ? 0 : maxPagesInCache);
+
+    return page;
+}
+
 
 WRT::WrtBrowserContainer* WebPageController::openPage()
 {
@@ -271,26 +305,10 @@ WRT::WrtBrowserContainer* WebPageController::openPage()
 
 WRT::WrtBrowserContainer* WebPageController::openPageFromHistory(int index)
 {
-    QDir dir(d->m_historyDir);
-    QFileInfoList fileList(dir.entryInfoList(QDir::Files));
-    QString indexStr;
-    indexStr.setNum(index);
-    
-    
-    QString historyFile = d->m_historyDir + QLatin1String("/history") + indexStr + QLatin1String(".history");
-    QFile file(historyFile);    
-    if(file.exists())
-    {
-    	  if(file.size() <= 12) // empty file
-    	  {	
-        	file.remove();
-        	return NULL;
-        }
-        else
-        	return openPage();
-    }    
-    else // can not open file
-    	return NULL;   
+    if(index < 0 || index >= historyWindowCount())
+        return NULL;
+
+    return openPage();
 }
 
 /*!
@@ -319,7 +337,7 @@ void WebPageController::closePage ( WRT::WrtBrowserContainer *page )
         
             // change the current page
             if(newCurrIndex >= 0) {
-                theCurrentPage = d->m_allPages.at(newCurrIndex);
+                theCurrentPage = pageAt(newCurrIndex);
                 setCurrentPage(theCurrentPage);
                 updateCurrentPageIndex = true;
             }
@@ -337,6 +355,8 @@ void WebPageController::closePage ( WRT::WrtBrowserContainer *page )
 
         // actually delete the page from the list
         d->m_allPages.removeAt(closeIndex);
+        if (ensureJournal())
+            d->m_journal->windowClosed(page);
 
         // update the current page index if necessary
         // (this will just update the index now that we've removed the page from the list)
@@ -376,6 +396,9 @@ void WebPageController::setCurrentPage(WRT::WrtBrowserContainer* page)
     if(page == oldPage)
        return;
 
+    if (ensureJournal())
+        d->m_journal->windowActivated(page);
+
     // disconnect any existing aggregate signalling for pgMgr
     if(oldPage) {
         disconnect(oldPage, 0, this, 0);
@@ -480,6 +503,8 @@ void WebPageController::onLoadFinishedForBackgroundWindow(bool ok)
     WRT::WrtBrowserContainer* page = qobject_cast<WRT::WrtBrowserContainer*> (sender());
     if (page){
         page->setUpdateThumbnail(true);
+        if (ensureJournal())
+            d->m_journal->windowNavigated(page, d->m_allPages.indexOf(page), page->mainFrame()->url().toString(), page->pageTitle());
         // Current page is handled in onLoadFinished() so skip this case here
         if(page != currentPage()){
 			HistoryManager::getSingleton()->addHistory(page->mainFrame()->url().toString(), page->pageTitle());	
@@ -557,6 +582,17 @@ void WebPageController::releaseMemory()
     QPixmapCache::clear();    
     }
 
+/*! 
+ * Handle moderate memory pressure signals from LowMemoryHandler.
+ * Only drops caches that are cheap to rebuild, loading carries on.
+ * @see LowMemoryHandler
+ */
+void WebPageController::handleModerateMemory()
+    {
+    QWebSettings::clearMemoryCaches();
+    QPixmapCache::clear();
+    }
+
 /*! 
  * Handle low memory signals from LowMemoryHandler
  * @see LowMemoryHandler
@@ -568,15 +604,43 @@ void WebPageController::handleLowMemory()
     }
 
 /*! 
- * Handle out of memory signals from LowMemoryHandler
+ * Handle out of memory signals from LowMemoryHandler.
+ * The OOM killer is imminent: stop loading in every window and give up
+ * the back/forward page cache, which keeps whole documents alive.
+ * The page cache stays off until handleMemoryRecovered().
  * @see LowMemoryHandler
  */
 void WebPageController::handleOutOfMemory()
     {
     currentStop();
+    foreach (WRT::WrtBrowserContainer* page, d->m_allPages) {
+        if (!page)
+            continue;
+        page->triggerAction(QWebPage::Stop);
+        if (!d->m_pageCacheReleased)
+            page->settings()->setMaximumPagesInCache(0);
+    }
+    d->m_pageCacheReleased = true;
     releaseMemory();
     }
 
+/*! 
+ * Handle the end of a memory pressure episode from LowMemoryHandler,
+ * give the pages their back/forward page cache back
+ * @see LowMemoryHandler
+ */
+void WebPageController::handleMemoryRecovered()
+    {
+    if (!d->m_pageCacheReleased)
+        return;
+    d->m_pageCacheReleased = false;
+    int maxPagesInCache = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsInt("MaxPagesInCache");
+    foreach (WRT::WrtBrowserContainer* page, d->m_allPages) {
+        if (page)
+            page->settings()->setMaximumPagesInCache(maxPagesInCache);
+    }
+    }
+
 /*!
  * Retrieve a pointer to the current WRT::WrtBrowserContainer
  * @return    Returns current page handle
@@ -592,6 +656,7 @@ WRT::WrtBrowserContainer* WebPageController::currentPage() const
 
 /*!
  * Retrieve a list of all of the pages managed by WebPageController
+ * A restored window is null until its page is created, see pageAt()
  * @return   List of all the pages opened by WebPageController
  * @see WRT::WrtBrowserContainer
  */
@@ -600,6 +665,83 @@ QList<WRT::WrtBrowserContainer*>* WebPageController::allPages()
     return &d->m_allPages;
 }
 
+/*!
+ * Retrieve the page at \a index, creating it if it is a restored window
+ * that has not been shown yet
+ */
+WRT::WrtBrowserContainer* WebPageController::pageAt(int index)
+{
+    if (index < 0 || index >= d->m_allPages.count())
+        return NULL;
+
+    WRT::WrtBrowserContainer* page = d->m_allPages.at(index);
+    if (page)
+        return page;
+
+    int restoredIndex = restoredWindowIndex(index);
+    SessionJournal::Window window = d->m_restoredWindows.takeAt(restoredIndex);
+    page = createPage(this, 0);
+    page->setPageFactory(this);
+    d->m_allPages[index] = page;
+    if (ensureJournal())
+        d->m_journal->windowCreated(page, restoredIndex);
+    // not creatingPage(): the window already has its slot in the views
+    emit pageCreated( page );
+    restoreHistory(page, window);
+    return page;
+}
+
+/*!
+ * Saved title and thumbnail of the restored window at \a index.
+ * Returns false if the window has a page, then it has the current ones.
+ */
+bool WebPageController::restoredWindow(int index, QString& title, QImage& thumbnail)
+{
+    if (index < 0 || index >= d->m_allPages.count() || d->m_allPages.at(index))
+        return false;
+
+    const SessionJournal::Window& window = d->m_restoredWindows.at(restoredWindowIndex(index));
+    title = window.m_title.isEmpty() ? partialUrl(QUrl(window.m_url)) : window.m_title;
+    thumbnail = QImage::fromData(window.m_thumbnail, "PNG");
+    return true;
+}
+
+/*!
+ * Index in m_restoredWindows of the restored window at \a index in m_allPages
+ */
+int WebPageController::restoredWindowIndex(int index) const
+{
+    int restoredIndex = 0;
+    for (int i = 0; i < index; i++) {
+        if (!d->m_allPages.at(i))
+            restoredIndex++;
+    }
+    return restoredIndex;
+}
+
+/*!
+ * Close the window at \a index, without creating its page if it was never shown
+ */
+void WebPageController::closePageAt(int index)
+{
+    if (index < 0 || index >= d->m_allPages.count())
+        return;
+
+    WRT::WrtBrowserContainer* page = d->m_allPages.at(index);
+    if (page) {
+        closePage(page);
+        return;
+    }
+
+    int restoredIndex = restoredWindowIndex(index);
+    d->m_restoredWindows.removeAt(restoredIndex);
+    d->m_allPages.removeAt(index);
+    if (index < d->m_currentPage)
+        d->m_currentPage--;
+    if (ensureJournal())
+        d->m_journal->restoredWindowClosed(restoredIndex);
+}
+
 /*! 
  * Retrieve the number of pages managed by WebPageController
  * @return  count of all the pages currently opend by WebPageController
@@ -897,7 +1039,8 @@ void WebPageController::currentSetFromHistory(int historyIndex)
 void WebPageController::gotoCurrentItem()
 {
     WRT::WrtBrowserContainer* activePage = currentPage();
-    if(activePage) {
+    // nothing to do if restore already started loading a newer page
+    if(activePage && activePage->mainFrame()->requestedUrl().isEmpty()) {
         QList<QWebHistoryItem> items = activePage->history()->items();
         QWebHistoryItem item = activePage->history()->currentItem();
         if (item.isValid()) {
@@ -1062,128 +1205,232 @@ void WebPageController::loadFromHistory()
    }
     else
     {	
-    	 int count2 = restoreNumberOfWindows();
-    	 
-    	 // "sanity check" count shall be always equal to count2. If not, something wrong. Open only one window - start page in this case.
-    	 	
-    	 if((count > 0) && (count == count2)) // load all browser windows from the last session
+    	 // The page of the window that was active was created and restored
+    	 // with the initial page; the other windows of the last session only
+    	 // get their saved record, their page is created when first shown
+    	 WRT::WrtBrowserContainer* page = currentPage();
+    	 int active = activeWindowId();
+    	 for(int i = 0; i < count; i++)
     	 {
-    	 	
-    	 	for(int i = 0; i < count2-1; i++) //all windows except current
-    	 	{
-    	 		openPageFromHistory(i);
-    	 	}		
-    	  m_bRestoreSession = false;
+    	 	if (i == active || d->m_allPages.count() >= MAX_NUM_WINDOWS)
+    	 	    continue;
+    	 	d->m_allPages.insert(i < active ? i : d->m_allPages.count(), 0);
+    	 	d->m_restoredWindows.append(d->m_savedWindows.at(i));
+    	 }		
+    	 m_bRestoreSession = false;
 
     	 // Go to current window
-    	 int pageIndex = activeWindowId();
-    	 WRT::WrtBrowserContainer* page = d->m_allPages.at(pageIndex);
+    	 d->m_currentPage = d->m_allPages.indexOf(page);
     	 setCurrentPage(page);
     	 gotoCurrentItem();
-    	 	
-    	 }
-    	 else // browser did not close correctly; exception handler: delete all files and load start page as in first startup
-    	 {
-    	 	deleteHistory();
-    	 	deleteDataFiles();
-    	 	loadLocalFile();
-    	 }			    	 
     }	 
     m_bRestoreSession = false;
-    return ;
 
+    // start a fresh journal from the restored windows, the list read from
+    // the journal is only needed while restoring
+    compactSession();
+    d->m_savedWindows.clear();
 }
 
+/*!
+ * Reads the saved session, once, from the journal
+ */
+void WebPageController::loadSession()
+{
+    if (d->m_sessionLoaded)
+        return;
+    d->m_sessionLoaded = true;
+    if (d->m_journal->isEnabled() && !d->m_journal->exists())
+        migrateLegacySession();
+    d->m_journal->load(d->m_savedWindows, d->m_savedActiveWindow);
+}
 
-WRT::WrtBrowserContainer* WebPageController::startupRestoreHistory(QWidget* parent, int index, WRT::WrtBrowserContainer* page)
+/*!
+ * Reads a number from one of the text files of the session format used
+ * before the session journal
+ */
+static int readLegacyNumber(const QString& fileName)
 {
-    Q_UNUSED(parent)
-    // restore the history state from the disk for the current page
-    QString indexStr;
-    indexStr.setNum(index);
-    QString historyFile = d->m_historyDir + QLatin1String("/history") + indexStr + QLatin1String(".history");
-   
-    QFile file(historyFile);
-    if(file.open(QIODevice::ReadOnly)) {
-        QDataStream restore(&file);
-        restore >> *(page->history());
+    QFile file(fileName);
+    QString number = "0";
+    if (file.open(QIODevice::ReadOnly)) {
+        QTextStream textStream(&file);
+        textStream >> number;
         file.close();
     }
-    
-    return page;
+    return number.toInt();
 }
 
-void WebPageController::setLastUrl(QString url)
+/*!
+ * Moves a session saved before the session journal into the journal, once:
+ * one history<N>.history file per window, numwindow.dat and activewindow.dat.
+ * The old files are deleted when the journal is in place.
+ */
+void WebPageController::migrateLegacySession()
 {
-	QString winFile = d->m_historyDir + QLatin1String("/lasturl") + QLatin1String(".dat");
-    
-  QFile file(winFile);
-  if(file.open(QIODevice::WriteOnly)) {
-        QTextStream textStream(&file);
-        textStream << url;
-        textStream.flush();
+    QString numWindowFile = d->m_historyDir + QLatin1String("/numwindow.dat");
+    if (!QFile::exists(numWindowFile))
+        return;
+
+    int count = readLegacyNumber(numWindowFile);
+    int activeWindow = readLegacyNumber(d->m_historyDir + QLatin1String("/activewindow.dat"));
+
+    // url and title of each window come from its history
+    QWebPage scratch;
+    QList<WRT::WrtBrowserContainer*> pages;
+    QList<SessionJournal::Window> windows;
+    int activeIndex = 0;
+    for (int i = 0; i < count; i++) {
+        QFile file(d->m_historyDir + QLatin1String("/history") + QString::number(i) + QLatin1String(KHISTORYEXTENSION));
+        if (file.size() <= 12 || !file.open(QIODevice::ReadOnly))
+            continue;   // empty window
+
+        SessionJournal::Window window;
+        window.m_history = file.readAll();
         file.close();
-   }
-	
+        QDataStream restore(window.m_history);
+        restore >> *(scratch.history());
+        window.m_url = scratch.history()->currentItem().url().toString();
+        window.m_title = scratch.history()->currentItem().title();
+
+        if (i == activeWindow)
+            activeIndex = windows.count();
+        pages.append(0);
+        windows.append(window);
+    }
+
+    if (!windows.isEmpty()) {
+        d->m_journal->compact(pages, windows, activeIndex);
+        d->m_journal->waitForCompaction();
+        if (!d->m_journal->exists())
+            return;     // keep the old files for the next try
+    }
+
+    for (int i = 0; i < count; i++)
+        QFile::remove(d->m_historyDir + QLatin1String("/history") + QString::number(i) + QLatin1String(KHISTORYEXTENSION));
+    QFile::remove(numWindowFile);
+    QFile::remove(d->m_historyDir + QLatin1String("/activewindow.dat"));
+    QFile::remove(d->m_historyDir + QLatin1String("/lasturl.dat"));
+    QFile::remove(d->m_historyDir + QLatin1String("/windows.dat"));
 }
 
-QString WebPageController::getLastUrl()
+/*!
+ * Returns true if session events can be recorded now: saving is enabled and
+ * restore is over. Starts the journal with a snapshot if it is not open yet.
+ */
+bool WebPageController::ensureJournal()
 {
-	  QString winFile = d->m_historyDir + QLatin1String("/lasturl") + QLatin1String(".dat");
-    QFile file(winFile);
-    QString winStr = "";
-    if(file.open(QIODevice::ReadOnly)) {
-        QTextStream textStream(&file);
-        textStream >> winStr;
-        file.close();
-     }
-    
-	  return winStr;
+    if (m_bRestoreSession || d->donotsaveFlag || !d->m_journal->isEnabled())
+        return false;
+    if (!d->m_journal->isOpen())
+        compactSession();
+    return d->m_journal->isOpen();
 }
 
-void WebPageController::saveHistory(int* windowsSaved, int* activeWindowId)
+/*!
+ * The state to save for \a page, serialised now
+ */
+SessionJournal::Window WebPageController::sessionWindow(WRT::WrtBrowserContainer* page, bool withThumbnail)
+{
+    SessionJournal::Window window;
+    QDataStream history(&window.m_history, QIODevice::WriteOnly);
+    history << *(page->history());
+    window.m_url = page->history()->currentItem().url().toString();
+    window.m_title = page->pageTitle();
+    if (withThumbnail && !page->cachedThumbnail().isNull()) {
+        QBuffer buffer(&window.m_thumbnail);
+        buffer.open(QIODevice::WriteOnly);
+        page->cachedThumbnail().save(&buffer, "PNG");
+    }
+    return window;
+}
+
+/*!
+ * Rewrites the session journal as a snapshot of the open windows.
+ * Blank windows are not saved.
+ */
+void WebPageController::compactSession()
 {
-    QString indexStr;
-    int index = 0;
-    
-    unsigned int pageCount =  d->m_allPages.count();
-    
-    // Get index of current page
-    WRT::WrtBrowserContainer* theCurrentPage = currentPage();
+    compactSession(false);
+}
 
-    int currentIndex = d->m_allPages.indexOf(theCurrentPage);
-         
-    for (int tIndex = 0; tIndex < pageCount; tIndex++)
-    {
-       	// Don't save blank windows
-       	WrtBrowserContainer* page = d->m_allPages.at(tIndex);
-       	QString pageUrl = page->history()->currentItem().url().toString();
-       	if (!pageUrl.isEmpty())
-        {    	  
-
-          // In case of blank windows, reset the active window id
-          if (currentIndex == tIndex) *activeWindowId = index;
-
-          // Serialize page to file
-          indexStr.setNum(index);
-          QString historyFile = d->m_historyDir + QLatin1String("/history") + indexStr + QLatin1String(".history");
-          QFile file(historyFile);
-          if(file.open(QIODevice::WriteOnly)) {
-             QDataStream save(&file);
-             save << *(d->m_allPages.at(tIndex)->history());
-             file.flush();
-             file.close();
-          }
-          index++;
+int WebPageController::compactSession(bool withThumbnails)
+{
+    if (m_bRestoreSession || d->donotsaveFlag || !d->m_journal->isEnabled())
+        return 0;
+
+    QList<WRT::WrtBrowserContainer*> pages;
+    QList<SessionJournal::Window> windows;
+    int activeIndex = 0;
+    int restoredIndex = 0;
+    WRT::WrtBrowserContainer* theCurrentPage = currentPage();
+    foreach (WRT::WrtBrowserContainer* page, d->m_allPages) {
+        // restored windows never shown give back what was restored
+        if (!page) {
+            pages.append(page);
+            windows.append(d->m_restoredWindows.at(restoredIndex++));
+            continue;
         }
+        if (page->history()->currentItem().url().isEmpty())
+            continue;
+        if (page == theCurrentPage)
+            activeIndex = pages.count();
+        pages.append(page);
+        windows.append(sessionWindow(page, withThumbnails));
     }
+    d->m_journal->compact(pages, windows, activeIndex);
+    return activeIndex;
+}
+
+/*!
+ * Restores \a window into \a page. If the journal recorded a later load than
+ * the saved history, e.g. after a crash, that page is loaded again.
+ */
+void WebPageController::restoreHistory(WRT::WrtBrowserContainer* page, const SessionJournal::Window& window)
+{
+    if (!window.m_history.isEmpty()) {
+        QDataStream restore(window.m_history);
+        restore >> *(page->history());
+    }
+    if (!window.m_url.isEmpty() && window.m_url != page->history()->currentItem().url().toString())
+        page->mainFrame()->load(QUrl(window.m_url));
+}
+
+WRT::WrtBrowserContainer* WebPageController::startupRestoreHistory(QWidget* parent, int index, WRT::WrtBrowserContainer* page)
+{
+    Q_UNUSED(parent)
+    // restore the history state saved in the session journal for the current page
+    loadSession();
+    if (index >= 0 && index < d->m_savedWindows.count())
+        restoreHistory(page, d->m_savedWindows.at(index));
+    
+    return page;
+}
+
+QString WebPageController::getLastUrl()
+{
+    WRT::WrtBrowserContainer* page = currentPage();
+    if (page && !page->history()->currentItem().url().isEmpty())
+        return page->history()->currentItem().url().toString();
+
+    loadSession();
+    if (d->m_savedActiveWindow >= 0 && d->m_savedActiveWindow < d->m_savedWindows.count())
+        return d->m_savedWindows.at(d->m_savedActiveWindow).m_url;
+    return QString();
+}
 
-    // Save last url
-    WRT::WrtBrowserContainer* currentPage = d->m_allPages.at(*activeWindowId);
-    QWebHistoryItem	item = theCurrentPage->history()->currentItem();
-    QString lastUrl = item.url().toString();
-  	setLastUrl(lastUrl);
-    *windowsSaved = index;
+/*!
+ * Saves the session as one snapshot in the journal, with the thumbnails
+ * shown for the restored windows next time
+ */
+void WebPageController::saveHistory(int* windowsSaved, int* activeWindowId)
+{
+    *activeWindowId = compactSession(true);
+    *windowsSaved = 0;
+    foreach (WRT::WrtBrowserContainer* page, d->m_allPages) {
+        if (!page || !page->history()->currentItem().url().isEmpty())
+            (*windowsSaved)++;
+    }
 }
 
 void WebPageController::deleteDataFiles()
@@ -1206,6 +1453,8 @@ void WebPageController::deleteDataFiles()
          file2.remove();
          file2.close();
     }
+
+    d->m_journal->remove();
     
     d->donotsaveFlag = true;
           
@@ -1255,7 +1504,8 @@ void WebPageController::savePopupSettings(int val)
     for (int tIndex = 0; tIndex <  d->m_allPages.count(); tIndex++)
     {
         WrtBrowserContainer* page = d->m_allPages.at(tIndex);
-        page->settings()->setAttribute(QWebSettings::JavascriptCanOpenWindows, !val);
+        if (page)
+            page->settings()->setAttribute(QWebSettings::JavascriptCanOpenWindows, !val);
 
     }
 
@@ -1278,6 +1528,10 @@ void WebPageController::saveSaverestoreSettings(int val)
 	  		d->donotsaveFlag = true; // do not save .dat file
 	  	else // val = 1
 	  		d->donotsaveFlag = false;
+
+	  	d->m_journal->setEnabled(val != 0);
+	  	if(val == 0)
+	  		d->m_journal->remove();
 	  		
 }
 
@@ -1288,72 +1542,16 @@ bool WebPageController::getSaverestoreSettings()
 		
 }
 
-void WebPageController::saveNumberOfWindows(int windowsSaved)
-{
-	QString winFile = d->m_historyDir + QLatin1String("/numwindow") + QLatin1String(".dat");
-    
-  QFile file(winFile);
-  if(file.open(QIODevice::WriteOnly)) {
-        QTextStream textStream(&file);
-        textStream << windowsSaved;
-        textStream.flush();
-        file.close();
-   }
-	
-}
-void WebPageController::saveActiveWindowId(int activeWindowId)
-{
-	QString winFile = d->m_historyDir + QLatin1String("/activewindow") + QLatin1String(".dat");
-  
-  QFile file(winFile);
-  if(file.open(QIODevice::WriteOnly)) {
-        QTextStream textStream(&file);
-        textStream << activeWindowId;
-        textStream.flush();
-        file.close();
-   }
-	
-}
-
-int WebPageController::restoreNumberOfWindows()
-{
-	QString winFile = d->m_historyDir + QLatin1String("/numwindow") + QLatin1String(".dat");
-    QFile file(winFile);
-    QString winStr = "0";
-    if(file.open(QIODevice::ReadOnly)) {
-        QTextStream textStream(&file);
-        textStream >> winStr;
-        file.close();
-    }
-    return winStr.toInt();
-}
-
 int WebPageController::activeWindowId()
 {
-	QString winFile = d->m_historyDir + QLatin1String("/activewindow") + QLatin1String(".dat");
-    QFile file(winFile);
-    QString winStr = "0";
-    if(file.open(QIODevice::ReadOnly)) {
-        QTextStream textStream(&file);
-        textStream >> winStr;
-        file.close();
-    }
-    return winStr.toInt();
+    loadSession();
+    return d->m_savedActiveWindow;
 }
 
 int WebPageController::historyWindowCount()
 {
-    QDir dir(d->m_historyDir);
-    QFileInfoList fileList(dir.entryInfoList(QDir::Files));
-    int windowCount = 0;
-    
-    foreach (const QFileInfo fileInfo, fileList) {
-        const QString filePath(fileInfo.absoluteFilePath());
-        if (filePath.endsWith(QString(KHISTORYEXTENSION), Qt::CaseInsensitive)) {        	  
-            windowCount++;            
-        }
-    }
-    return windowCount;
+    loadSession();
+    return d->m_savedWindows.count();
 }
 
 QString WebPageController::currentDocTitle()
@@ -1461,6 +1659,9 @@ void WebPageController::clearHistoryInMemory()
 
 void WebPageController::deleteHistory()
 {
+    d->m_journal->remove();
+
+    // history files of the format used before the session journal
     QDir dir(d->m_historyDir);
     QFileInfoList fileList(dir.entryInfoList(QDir::Files));
     QString indexStr;
@@ -1504,6 +1705,8 @@ void WebPageController::deleteCookies()
     unsigned int pageCount =  d->m_allPages.count();
     QNetworkAccessManager* accessManager = NULL;
     for (int tIndex = 0; tIndex < pageCount; tIndex++){
+        if (!d->m_allPages.at(tIndex))
+            continue;
         accessManager = d->m_allPages.at(tIndex)->networkAccessManager();
         static_cast<WebNetworkAccessManager*>(accessManager)->deleteCookiesFromMemory();
     }
@@ -1573,7 +1776,7 @@ QGraphicsWebView* WebPageController::webView()
 {
     for (int i = 0; i < allPages()->count(); i++) {
         WRT::WrtBrowserContainer* page = allPages()->at(i);
-        if (page->webWidget()) {
+        if (page && page->webWidget()) {
             return qobject_cast<QGraphicsWebView*> (page->webWidget());
         }
     }
@@ -1592,6 +1795,8 @@ void WebPageController::checkAndUpdatePageThumbnails(QSize &s)
 
     for (int i = 0; i < allPages()->count(); i++) {
         WRT::WrtBrowserContainer* page = allPages()->at(i);
+        if (!page)
+            continue;
         QWebHistoryItem item = page->history()->currentItem();
         WebPageData data = item.userData().value<WebPageData>();
 
@@ -1629,7 +1834,7 @@ void WebPageController::updatePageThumbnails()
     WRT::WrtBrowserContainer *page = currentPage();
        QWebHistoryItem item = page->history()->currentItem();
 //    page->savePageDataToHistoryItem(page->mainFrame(), &item);
-       page->setUpdateThumbnail(false);
+       page->setUpdateThumbnail(true);
 //    checkAndUpdatePageThumbnails();
 }
 
@@ -1696,6 +1901,26 @@ QString WebPageController::networkErrorUrl() {
     return m_networkErrorUrl; 
 }
 
+/*!
+ * Returns the requests of the current page's load as HAR style JSON
+ */
+QString WebPageController::networkHar()
+{
+    WRT::WebNetworkAccessManager* manager = currentPage() ?
+        qobject_cast<WRT::WebNetworkAccessManager*>(currentPage()->networkAccessManager()) : NULL;
+    return manager ? QString::fromUtf8(manager->recorder()->toHar()) : QString();
+}
+
+/*!
+ * Returns the critical path and blocking figures of the current page's load
+ */
+QString WebPageController::networkSummary()
+{
+    WRT::WebNetworkAccessManager* manager = currentPage() ?
+        qobject_cast<WRT::WebNetworkAccessManager*>(currentPage()->networkAccessManager()) : NULL;
+    return manager ? manager->recorder()->summary() : QString();
+}
+
 bool WebPageController::errorUrlMatches() {
   return m_bErrorUrlMatches;
 }
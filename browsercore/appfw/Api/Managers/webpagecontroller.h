@@ -29,10 +29,12 @@
 #include <QWebFrame>
 #include <QWebPage>
 #include <QIcon>
+#include <QImage>
 #include <QEvent>
 #include "browserpagefactory.h"
 #include "BWFGlobal.h"
 #include "messageboxproxy.h"
+#include "sessionjournal.h"
 #include <QDir>
 
 class QGraphicsWebView;
@@ -136,10 +138,13 @@ public:
     WRT::WrtBrowserContainer* openPage();
     WRT::WrtBrowserContainer* openPageFromHistory(int index);
     void closePage(WRT::WrtBrowserContainer*);
+    void closePageAt(int index);
 
     WRT::WrtBrowserContainer* currentPage() const;
 
     QList<WRT::WrtBrowserContainer*>* allPages();
+    WRT::WrtBrowserContainer* pageAt(int index);
+    bool restoredWindow(int index, QString& title, QImage& thumbnail);
 
     QList<QAction*> getContext();
 
@@ -148,13 +153,9 @@ public:
     void deleteHistory();    
     
     WRT::WrtBrowserContainer* startupRestoreHistory(QWidget* parent, int index, WRT::WrtBrowserContainer* page);
-    void saveNumberOfWindows(int windowsSaved);
-    void saveActiveWindowId(int activeWindowId);
-    int restoreNumberOfWindows();
     int historyWindowCount();
     int activeWindowId();
     
-    void setLastUrl(QString url);
 
     QIcon pageIcon();
     
@@ -171,7 +172,15 @@ public:
 private:
     void checkAndUpdatePageThumbnails(QSize &s);
     WRT::WrtBrowserContainer* openPage(QObject* parent, WRT::WrtBrowserContainer* page=0);
+    WRT::WrtBrowserContainer* createPage(QObject* parent, WRT::WrtBrowserContainer* page);
+    int restoredWindowIndex(int index) const;
     void releaseMemory();
+    void restoreHistory(WRT::WrtBrowserContainer* page, const WRT::SessionJournal::Window& window);
+    void loadSession();
+    void migrateLegacySession();
+    bool ensureJournal();
+    WRT::SessionJournal::Window sessionWindow(WRT::WrtBrowserContainer* page, bool withThumbnail);
+    int compactSession(bool withThumbnails);
 
 public: // public actions available for this view
     QAction * getActionReload();
@@ -226,12 +235,17 @@ public slots:
     void updateHistory();
     
     void share(const QString &url); 
+
+    // network waterfall of the current page load, see WebNetworkRecorder
+    QString networkHar();
+    QString networkSummary();
     void feedbackMail(const QString &mailAddress, const QString &mailBody);
 #ifdef QT_GEOLOCATION
     void setGeolocationPermission(QObject* frame, QObject* page, bool permissionGranted, bool saveSetting);
 #endif // QT_GEOLOCATION
 
 private slots:
+    void compactSession();
     void updateStatePageLoading();
     void updateStatePageLoadComplete(bool);
     void updateActions(bool pageIsLoading=false);
@@ -242,8 +256,10 @@ private slots:
     void secureStateChange(int);
     void processNetworkErrorHappened(const QString & msg); 
     void processNetworkErrorUrl(const QUrl & url);
+    void handleModerateMemory();
     void handleLowMemory();
     void handleOutOfMemory();
+    void handleMemoryRecovered();
 
     void onLoadFinished(bool);
     void onDatabaseQuotaExceeded (QWebFrame *,QString);  
@@ -294,9 +310,10 @@ signals:
 	  // Signal for network status 
     void networkErrorHappened(const QString & msg );
     
-    // Signals for low and out of memory
+    // Signals for low and out of memory, once per episode
     void lowMemory();
     void outOfMemory();
+    void memoryRecovered();
 
 #ifdef QT_GEOLOCATION   
     // Signal for geolocation permission
@@ -24,7 +24,9 @@
 
 #include <QWidget>
 #include <QAction>
+#include <QHash>
 #include "BWFGlobal.h"
+#include "sessionjournal.h"
 
 #define WEBPAGE_ZOOM_RANGE_MIN 25
 #define WEBPAGE_ZOOM_RANGE_MAX 300
@@ -58,5 +60,12 @@ public:
     QString m_historyDir;
     QObject* m_actionsParent;    
     bool donotsaveFlag;
+
+    WRT::SessionJournal* m_journal;
+    QList<WRT::SessionJournal::Window> m_savedWindows;     // session read at startup
+    int m_savedActiveWindow;
+    bool m_sessionLoaded;
+    QList<WRT::SessionJournal::Window> m_restoredWindows;  // one per null entry of m_allPages, in order
+    bool m_pageCacheReleased;   // page cache given up for an out of memory episode
 };
 #endif // __WEBPAGECONTROLLER_P_H__
@@ -29,6 +29,7 @@
 #include <QWebHistory>
 #include <QWebFrame>
 #include "wrtbrowsercontainer.h"
+#include "thumbnailservice.h"
 #include "webpagedata.h"
 
 #include <QDebug>
@@ -45,6 +46,7 @@ WindowViewPrivate::WindowViewPrivate(WebPageController * pageMgr,
     m_widgetParent(parent),
     m_graphicsWidgetParent(0),
     m_pageManager(pageMgr),
+    m_thumbnailService(0),
     m_mode(0),
     m_state(0)
 {
@@ -58,6 +60,7 @@ WindowViewPrivate::WindowViewPrivate(WebPageController * pageMgr,
     m_widgetParent(0),
     m_graphicsWidgetParent(parent),
     m_pageManager(pageMgr),
+    m_thumbnailService(0),
     m_mode(0),
     m_state(0)
 {
@@ -237,7 +240,12 @@ QString WindowView::title() const
         int centerIndex = d->m_flowInterface->centerIndex();
         if(centerIndex >= 0 && centerIndex < d->m_pageList->count())
         {
-            QString pagetitle(d->m_pageList->at(centerIndex)->mainFrame()->title());
+            QString pagetitle;
+            QImage thumbnail;
+            if (d->m_pageList->at(centerIndex))
+                pagetitle = d->m_pageList->at(centerIndex)->mainFrame()->title();
+            else
+                d->m_pageManager->restoredWindow(centerIndex, pagetitle, thumbnail);
             if(pagetitle.isEmpty())
                 title += qtTrId("txt_browser_windows_new_window");
             else
@@ -347,6 +355,7 @@ void WindowView::deactivate()
 
     // Hide and delete flowinterface later when told
     d->m_pageList = NULL;
+    d->m_thumbnailService->cancelAll();
 
     // Only needed when using QWidget based view
     //m_proxyWidget->setWidget(0);
@@ -366,6 +375,9 @@ void WindowView::deactivate()
 void WindowView::init()
 {
     d->m_transTimer = new QTimer(this);
+    d->m_thumbnailService = new ThumbnailService(this);
+    connect(d->m_thumbnailService, SIGNAL(thumbnailReady(WRT::WrtBrowserContainer*, const QImage&)),
+            this, SLOT(thumbnailReady(WRT::WrtBrowserContainer*, const QImage&)));
 
     // auto-link relevant actions to slots
     connect(d->m_actionForward, SIGNAL(triggered()), this, SLOT(forward()));
@@ -434,11 +446,27 @@ void WindowView::updateImages()
     if (d->m_flowInterface->slideCount() != 0)
         d->m_flowInterface->clear();
 
+    // Only the current page can have changed while the others were in the
+    // background; their cached thumbnails are shown without rendering them
     d->m_pageManager->currentPage()->requestPageDataUpdate();
+    d->m_pageManager->currentPage()->invalidateThumbnail();
     d->m_pageList = d->m_pageManager->allPages();
     for (int i = 0; i < d->m_pageList->count(); i++) {
         WrtBrowserContainer* window = d->m_pageList->at(i);
-        QString title = window->pageTitle();
+        QString title;
+        QImage thumbnail;
+        if (d->m_pageManager->restoredWindow(i, title, thumbnail)) {
+            // restored window never shown, its page is created when it is chosen
+            if (!thumbnail.isNull())
+                thumbnail = thumbnail.scaled(sz, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+#ifdef BROWSER_LAYOUT_TENONE
+            d->m_flowInterface->addSlide(thumbnail);
+#else
+            d->m_flowInterface->addSlide(thumbnail, title);
+#endif
+            continue;
+        }
+        title = window->pageTitle();
         if (title.isEmpty())
             title =  qtTrId("txt_browser_windows_new_window");
 
@@ -456,14 +484,27 @@ void WindowView::updateImages()
          }
 */
 #ifdef BROWSER_LAYOUT_TENONE
-         d->m_flowInterface->addSlide(window->thumbnail(sz));
+         d->m_flowInterface->addSlide(d->m_thumbnailService->request(window, sz));
 #else
-         d->m_flowInterface->addSlide(window->thumbnail(sz), title);
+         d->m_flowInterface->addSlide(d->m_thumbnailService->request(window, sz), title);
 #endif
      }
      setCenterIndex(d->m_pageManager->currentPage());
 }
 
+/*!
+  Replaces the placeholder or stale slide of \a page once its thumbnail is rendered
+*/
+void WindowView::thumbnailReady(WRT::WrtBrowserContainer* page, const QImage& image)
+{
+    if (!d->m_flowInterface || !d->m_pageList)
+        return;
+
+    int index = d->m_pageList->indexOf(page);
+    if (index >= 0 && index < d->m_flowInterface->slideCount())
+        d->m_flowInterface->setSlide(index, image);
+}
+
 void WindowView::updateWindows()
 {
     if (!d->m_flowInterface)
@@ -530,7 +571,7 @@ void WindowView::changedCenterIndex(int index)
 void WindowView::indexChangeInActiveState(int index)
 {
     if (d->m_mode ==  WindowViewModeNormal ) {
-        WrtBrowserContainer* page = d->m_pageList->at(index);
+        WrtBrowserContainer* page = d->m_pageManager->pageAt(index);
         d->m_pageManager->setCurrentPage(page);
 
         /* Set the new page as the center page */
@@ -579,14 +620,14 @@ void WindowView::okTriggeredCplt()
     {
         if(index >= 0 && index < d->m_pageList->count())
         {
-        	  WrtBrowserContainer* page = d->m_pageList->at(index);
+        	  WrtBrowserContainer* page = d->m_pageManager->pageAt(index);
         	  // If mainframe URL is empty, we are restoring page
-        	  // Page needs to be reloaded
-        	  if (page->mainFrame()->url().isEmpty()){
+        	  // Page needs to be reloaded, unless restore already started a load
+        	  if (page->mainFrame()->url().isEmpty() && page->mainFrame()->requestedUrl().isEmpty()){
         	  	QWebHistoryItem item = page->history()->currentItem();
         	  	if (item.isValid()) page->history()->goToItem(item);
         	  }
-            emit ok(d->m_pageList->at(index));
+            emit ok(page);
         }
     }
 }
@@ -702,8 +743,7 @@ void WindowView::delPage(int index)
         return;
 
     d->m_state = WindowViewDeletePage;
-    WrtBrowserContainer * p = d->m_pageList->at(index);
-    d->m_pageManager->closePage(p);
+    d->m_pageManager->closePageAt(index);
     updateActions();
 }
 
@@ -119,6 +119,7 @@ namespace WRT {
         void delPageCplt(int);
         void endAnimation();
         void addNextPage();
+        void thumbnailReady(WRT::WrtBrowserContainer*, const QImage&);
 
     private:
         void init();
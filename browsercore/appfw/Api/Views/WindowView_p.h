@@ -34,6 +34,7 @@ class WebPageController;
 namespace WRT {
     class WrtBrowserContainer;
     class GraphicsFlowInterface;
+    class ThumbnailService;
 
     class WindowViewPrivate
     {
@@ -57,6 +58,7 @@ namespace WRT {
 
         WebPageController * m_pageManager; // not owned
         QTimer* m_transTimer;
+        ThumbnailService* m_thumbnailService;
 
         QList<WrtBrowserContainer*>* m_pageList;
         QList<WrtBrowserContainer*> m_newPages;
@@ -28,9 +28,14 @@
 #include "HistoryManager.h"
 
 const QString KMostVistedStoreFile = "mostvisitedpages.dat";
-const uint KMostVistedStoreVersion = 1;
+const uint KMostVistedStoreVersion = 2;
+const uint KMostVistedStoreRawImageVersion = 1;   // thumbnails as QImage, converted on read
 const uint KMostVistedStoreLimit = 6;
 
+// Largest thumbnail shown by the most visited views, see MostVisitedViewItem::sizeHint()
+const int KMostVisitedThumbnailWidth = 238;
+const int KMostVisitedThumbnailQuality = 85;
+
 const QString KDefaultPage1 = "http://www.nytimes.com/";
 const QString KDefaultPage2 = "http://news.google.com/";
 const QString KDefaultPage3 = "http://www.nokia.com/";
@@ -39,17 +44,17 @@ const QString KDefaultPage5 = "http://www.cnn.com/";
 const QString KDefaultPage6 = "http://www.iltalehti.fi/etusivu/";
 
 MostVisitedPage::MostVisitedPage()
-    : m_pageThumbnail(0)
-    , m_pageRank(0)
+    : m_pageRank(0)
+    , m_pageThumbnail(0)
 {
 }
 
 MostVisitedPage::MostVisitedPage(QString url, QImage *pageThumbnail, uint pageRank)
     : m_url(url)
-    , m_pageThumbnail(pageThumbnail)
     , m_pageRank(pageRank)
+    , m_pageThumbnail(0)
 {
-
+    setPageThumbnail(pageThumbnail);
 }
 
 MostVisitedPage::~MostVisitedPage()
@@ -57,11 +62,49 @@ MostVisitedPage::~MostVisitedPage()
     delete m_pageThumbnail;
 }
 
+QImage *MostVisitedPage::pageThumbnail()
+{
+    if (!m_pageThumbnail && !m_thumbnailData.isEmpty()) {
+        QImage image = QImage::fromData(m_thumbnailData);
+        if (image.isNull())
+            m_thumbnailData.clear();    // unreadable, do not try again
+        else
+            m_pageThumbnail = new QImage(image);
+    }
+    return m_pageThumbnail;
+}
+
+void MostVisitedPage::setPageThumbnail(QImage *pageThumbnail)
+{
+    delete m_pageThumbnail;
+    m_pageThumbnail = 0;
+    m_thumbnailData.clear();
+
+    if (pageThumbnail) {
+        if (pageThumbnail->width() > KMostVisitedThumbnailWidth) {
+            QImage scaled = pageThumbnail->scaledToWidth(KMostVisitedThumbnailWidth, Qt::SmoothTransformation);
+            delete pageThumbnail;
+            pageThumbnail = new QImage(scaled);
+        }
+        m_pageThumbnail = pageThumbnail;
+
+        QBuffer buffer(&m_thumbnailData);
+        buffer.open(QIODevice::WriteOnly);
+        // PNG when the JPEG plugin is not available
+        if (!m_pageThumbnail->save(&buffer, "JPG", KMostVisitedThumbnailQuality)) {
+            buffer.seek(0);
+            m_thumbnailData.clear();
+            m_pageThumbnail->save(&buffer, "PNG");
+        }
+    }
+    emit thumbnailChanged();
+}
+
 QDataStream& operator<<(QDataStream &out, const MostVisitedPage &page)
 {
     //Writing pattern is as follows
     //URL
-    //false or (true & Image)
+    //false or (true & compressed image data)
     //pageRank
 
 
@@ -72,7 +115,7 @@ QDataStream& operator<<(QDataStream &out, const MostVisitedPage &page)
         out << false;
     else {
         //this is needed to get the correct offset while reading
-        out << true << *page.m_pageThumbnail;
+        out << true << page.m_thumbnailData;
     }
     out << page.m_pageRank;
     return out;
@@ -82,7 +125,7 @@ QDataStream& operator>>(QDataStream &in, MostVisitedPage &page)
 {
     //Reading pattern is as follows
     //URL
-    //false or (true & Image)
+    //false or (true & compressed image data)
     //pageRank
 
     //read page data from stream
@@ -91,10 +134,9 @@ QDataStream& operator>>(QDataStream &in, MostVisitedPage &page)
     bool hasThumbnail = false;
     in >> hasThumbnail;
 
-    if (hasThumbnail) {
-        page.m_pageThumbnail = new QImage();
-        in >> *page.m_pageThumbnail;
-    }
+    //the image is only decoded when a view shows it
+    if (hasThumbnail)
+        in >> page.m_thumbnailData;
 
     in >> page.m_pageRank;
 
@@ -193,13 +235,7 @@ void MostVisitedPageStore::pageAccessed(const QUrl& url, QImage* pageThumbnail,
     } else if (pageThumbnail) {
         // add thumbnail, delete if it has any old thumbnail
         
-        //This check is specifically added to take into account of
-        //future code changes if thumbnail gets assigned somewhere else
-        if (m_pageList[found]->m_pageThumbnail) {
-            delete m_pageList[found]->m_pageThumbnail;
-        }
-        
-        m_pageList[found]->m_pageThumbnail = pageThumbnail;
+        m_pageList[found]->setPageThumbnail(pageThumbnail);
     }
 		m_needPersistWrite = true;    
     writeStore();
@@ -273,6 +309,22 @@ void MostVisitedPageStore::readStore()
                 m_pageList.append(mvPage);
             }
         }
+        else if (version == KMostVistedStoreRawImageVersion) {
+            // convert once to compressed thumbnails
+            while (!in.atEnd()) {
+                MostVisitedPage *mvPage = new MostVisitedPage();
+                bool hasThumbnail = false;
+                in >> mvPage->m_url >> hasThumbnail;
+                if (hasThumbnail) {
+                    QImage *image = new QImage();
+                    in >> *image;
+                    mvPage->setPageThumbnail(image);
+                }
+                in >> mvPage->m_pageRank;
+                m_pageList.append(mvPage);
+            }
+            m_needPersistWrite = true;
+        }
         file.close();
     }   	
     
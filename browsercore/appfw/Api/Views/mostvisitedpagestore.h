@@ -24,6 +24,7 @@
 
 #include "BWFGlobal.h" 
 #include <QObject>
+#include <QByteArray>
 #include "singleton.h"
 #include "wrtbrowsercontainer.h"
 
@@ -46,16 +47,29 @@ public:
     QString pageUrl() {return m_url;}
     
     //Return whether or not page thumbnail present
-    bool thumbnailAvailable() const { return m_pageThumbnail != 0; }
+    bool thumbnailAvailable() const { return m_pageThumbnail != 0 || !m_thumbnailData.isEmpty(); }
+
+    //Return the page thumbnail, decoded on first use; 0 if there is none
+    QImage *pageThumbnail();
+
+    //Replace the page thumbnail, takes ownership. It is kept scaled down to
+    //display size, and compressed for the store file
+    void setPageThumbnail(QImage *pageThumbnail);
 
     //Serialization functions
     friend QDataStream& operator<<(QDataStream &out, const MostVisitedPage &source);
     friend QDataStream& operator>>(QDataStream &in, MostVisitedPage &destination);
 
+signals:
+    void thumbnailChanged();
+
 public:
     QString m_url;
-    QImage *m_pageThumbnail;
     uint m_pageRank;
+
+private:
+    QImage *m_pageThumbnail;    // decoded thumbnail, 0 until needed
+    QByteArray m_thumbnailData; // compressed thumbnail as stored in the file
 #ifdef ENABLE_TESTS
     	friend class MostVistedPageTest;
 #endif
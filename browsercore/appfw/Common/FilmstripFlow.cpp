@@ -156,7 +156,7 @@ private:
 class Filmstrip
 {
 public:
-    Filmstrip(const QImage& img, FilmstripFlowPrivate* filmstripFlowData): m_img(img), m_frozen(false), m_movieFrame(0), m_movie(NULL), m_filmstripFlowData(filmstripFlowData) {}
+    Filmstrip(const QImage& img, FilmstripFlowPrivate* filmstripFlowData): m_img(img), m_frozen(false), m_movieFrame(0), m_movie(NULL), m_filmstripFlowData(filmstripFlowData) {buildLevels();}
     ~Filmstrip() {}
 
     void paint(QPainter* painter);
@@ -167,12 +167,18 @@ public:
     void updateMovieFrame(int frame) { if(!m_frozen) m_movieFrame = frame;}
     void setName(const QString& name) {m_name = name;}
     QImage& image() {return m_img;}
+    void setImage(const QImage& img) {m_img = img; releaseLevels(); buildLevels();}
+    void buildLevels();
+    void releaseLevels() {m_halfImg = QImage(); m_quarterImg = QImage();}
     QString& name() {return m_name;}
 private:
     void createEmptyImage();
+    const QImage& imageForSize(const QSizeF& size);
 
 public:
     QImage m_img;
+    QImage m_halfImg;    // m_img scaled down to 1/2, built with the slide
+    QImage m_quarterImg; // m_img scaled down to 1/4, built with the slide
     bool m_frozen;
     int m_movieFrame;
     QString m_name;
@@ -200,6 +206,17 @@ public:
         m_films.clear();
     }
 
+    // keep the scaled images of the films up to reach slots away from the
+    // center one, drop the others
+    void updateLevels(int reach) {
+        for (int i = 0; i < m_films.size(); i++) {
+            if (qAbs(i - m_centerIndex) > reach)
+                m_films[i]->releaseLevels();
+            else
+                m_films[i]->buildLevels();
+        }
+    }
+
 public:
     QRgb m_bgColor;
     QImage* m_buffer;
@@ -230,6 +247,7 @@ void Filmstrip::createEmptyImage()
     if (m_name.isEmpty())
         m_name =  qtTrId("txt_browser_windows_new_window");
 #endif
+    releaseLevels();
     m_img = QImage(w, h, QImage::Format_RGB32);
 
     QPainter painter(&m_img);
@@ -248,6 +266,28 @@ void Filmstrip::createEmptyImage()
     painter.end();
 }
 
+// Scaled when the slide is set or comes back near the center, never while
+// a movie plays.
+void Filmstrip::buildLevels()
+{
+    if (m_img.isNull() || !m_halfImg.isNull())
+        return;
+    m_halfImg = m_img.scaled(m_img.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    m_quarterImg = m_halfImg.scaled(m_halfImg.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+// Scaling the full size thumbnail down by more than half on every animation
+// frame is what makes the movies slow; draw from the smallest level that is
+// still at least as wide as the target instead.
+const QImage& Filmstrip::imageForSize(const QSizeF& size)
+{
+    if (m_halfImg.isNull() || size.width() * 2 > m_img.width())
+        return m_img;
+    if (size.width() * 4 > m_img.width())
+        return m_halfImg;
+    return m_quarterImg;
+}
+
 void Filmstrip::paint(QPainter* painter)
 {
     Q_ASSERT(painter);
@@ -264,7 +304,7 @@ void Filmstrip::paint(QPainter* painter)
         target = m_movie->movieClip(m_movieFrame);
 
     //qDebug() << "m_movieFrame:" << m_movieFrame << " -- " << target;
-    if(target.right() > 0 || target.left() < m_filmstripFlowData->m_widgetSize.width()) {
+    if (target.right() > 0 && target.left() < m_filmstripFlowData->m_widgetSize.width()) {
         //painter->setPen(QPen(QColor(Qt::gray), 4));
         //painter->setBrush(QBrush());
         //painter->drawRect(target.x() - 2, target.y() - 2, target.width() + 5, target.height() + 5);
@@ -275,7 +315,7 @@ void Filmstrip::paint(QPainter* painter)
         if (m_img.isNull())
             createEmptyImage();
 
-        painter->drawImage(target, m_img);
+        painter->drawImage(target, imageForSize(target.size()));
 
         if (needFade)
             painter->setOpacity(1); // restore opacity
@@ -768,6 +808,7 @@ void FilmstripFlow::setCenterIndex(int i)
         return;
     Q_ASSERT(i >= 0 && i < d->m_films.size());
     d->m_centerIndex = i;
+    d->updateLevels(2);
     d->m_films[d->m_centerIndex]->updateMovie(d->m_movieFactory.createMovie(CenterToRight));
 
     CALL_ON_PREV_FILM_STRIP(updateMovie(d->m_movieFactory.createMovie(LeftToCenter)));
@@ -822,6 +863,20 @@ void FilmstripFlow::insert(int i, const QImage& image, const QString& title)
     }
 }
 
+/*!
+  Replaces the image of filmstrip at index position i, e.g. when a fresh
+  thumbnail arrives after a placeholder was shown.
+*/
+void FilmstripFlow::setSlide(int i, const QImage& image)
+{
+    Q_ASSERT(d);
+    if (i < 0 || i >= d->m_films.size())
+        return;
+
+    d->m_films[i]->setImage(image);
+    update();
+}
+
 /*!
   Removes filmstrip at index position i.
 */
@@ -1263,6 +1318,7 @@ void GraphicsFilmstripFlow::setCenterIndex(int i)
         return;
     Q_ASSERT(i >= 0 && i < d->m_films.size());
     d->m_centerIndex = i;
+    d->updateLevels(2);
     d->m_films[d->m_centerIndex]->updateMovie(d->m_movieFactory.createMovie(CenterToRight));
 
     CALL_ON_PREV_FILM_STRIP(updateMovie(d->m_movieFactory.createMovie(LeftToCenter)));
@@ -1317,6 +1373,20 @@ void GraphicsFilmstripFlow::insert(int i, const QImage& image, const QString& ti
     }
 }
 
+/*!
+  Replaces the image of filmstrip at index position i, e.g. when a fresh
+  thumbnail arrives after a placeholder was shown.
+*/
+void GraphicsFilmstripFlow::setSlide(int i, const QImage& image)
+{
+    Q_ASSERT(d);
+    if (i < 0 || i >= d->m_films.size())
+        return;
+
+    d->m_films[i]->setImage(image);
+    update();
+}
+
 /*!
   Removes filmstrip at index position i.
 */
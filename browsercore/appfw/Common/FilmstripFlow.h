@@ -103,6 +103,9 @@ public:
     //! removes filmstrip at index position i.
     void removeAt (int i);
 
+    //! replaces the image of filmstrip at index position i.
+    void setSlide(int i, const QImage& image);
+
     //! set background color
     void backgroundColor(const QRgb& c);
 
@@ -215,6 +218,9 @@ public:
     //! removes filmstrip at index position i.
     void removeAt (int i);
 
+    //! replaces the image of filmstrip at index position i.
+    void setSlide(int i, const QImage& image);
+
     //! set background color
     void backgroundColor(const QRgb& c);
 
@@ -87,6 +87,9 @@ namespace WRT {
         //! Remove a slide at index position
         virtual void removeAt(int) {}
 
+        //! Replace the image of the slide at index position
+        virtual void setSlide(int, const QImage&) {}
+
         //! handle the display mode change
         virtual void displayModeChanged(QString&) {}
 
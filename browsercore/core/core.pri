@@ -22,6 +22,8 @@ HEADERS += \
     $$PWD/network/networkerrorreply.h \
     $$PWD/network/webcookiejar.h \
     $$PWD/network/webnetworkaccessmanager.h \
+    $$PWD/network/webnetworkrecorder.h \
+    $$PWD/network/webnetworktransport.h \
     $$PWD/network/SchemeHandlerBr.h \
     $$PWD/network/SchemeHandlerBr_p.h \
     $$PWD/network/cacheworkerthread.h \
@@ -31,6 +33,7 @@ HEADERS += \
     $$PWD/browserpagefactory.h \
     $$PWD/brtglobal.h \
     $$PWD/scriptobjects.h \
+    $$PWD/thumbnailservice.h \
     $$PWD/webpagedata.h \
     $$PWD/wrtbrowsercontainer_p.h \
     $$PWD/wrtbrowsercontainer.h
@@ -39,9 +42,12 @@ SOURCES += \
     $$PWD/network/networkerrorreply.cpp \
     $$PWD/network/webcookiejar.cpp \
     $$PWD/network/webnetworkaccessmanager.cpp \
+    $$PWD/network/webnetworkrecorder.cpp \
+    $$PWD/network/webnetworktransport.cpp \
     $$PWD/network/SchemeHandlerBr.cpp \
     $$PWD/network/featherweightcache.cpp \
     $$PWD/actionjsobject.cpp \
+    $$PWD/thumbnailservice.cpp \
     $$PWD/wrtbrowsercontainer.cpp
     
 contains(br_mobility_bearer, yes) {
@@ -33,6 +33,9 @@
 #if defined(Q_OS_SYMBIAN)
 #include <e32std.h>
 #endif
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
 
 //#define FEATHERWEIGHTCACHE_DEBUG
 
@@ -441,6 +444,9 @@ bool FeatherWeightCachePrivate::removeFile(const QString &file)
 void FeatherWeightCachePrivate::updateCacheSize(qint64 newSize)
 {
     currentCacheSize = newSize;
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_COUNTER(Cache, "disk cache size", newSize);
+#endif
 #if defined(FEATHERWEIGHTCACHE_DEBUG)
     qDebug() << "FeatherWeightCachePrivate::updateCacheSize " << " new size " << currentCacheSize;
 #endif
@@ -485,6 +491,9 @@ QNetworkCacheMetaData FeatherWeightCache::fileMetaData(const QString &fileName)
 */
 QIODevice *FeatherWeightCache::data(const QUrl &url)
 {
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Cache, "FeatherWeightCache::data");
+#endif
 #if defined(FEATHERWEIGHTCACHE_DEBUG)
     //qDebug() << "FeatherWeightCache::data()" << url;
 #endif
@@ -730,6 +739,9 @@ void WorkerThread::run()
 
 qint64 WorkerThread::expireImpl()
 {
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Cache, "FeatherWeightCache::expire");
+#endif
     QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
     QDirIterator it(this->cacheDir, filters, QDirIterator::Subdirectories);
 
@@ -23,15 +23,12 @@
 #include <QNetworkReply>
 #include <QAuthenticator>
 #include <QNetworkInterface>
-#if QT_VERSION >= 0x040500
-#include <QNetworkDiskCache>
 
-#endif
-
-#include "bedrockprovisioning.h"
 #include "wrtbrowsercontainer.h"
 #include "webcookiejar.h"
 #include "webnetworkaccessmanager.h"
+#include "webnetworktransport.h"
+#include "webnetworkrecorder.h"
 
 #include "WebDialogProvider.h"
 
@@ -43,14 +40,19 @@ namespace WRT {
 
 WebNetworkAccessManager::WebNetworkAccessManager(WrtBrowserContainer* container, QObject* /*parent*/) : QNetworkAccessManager(container), m_browserContainer(container)
 {
-    m_cookieJar = new CookieJar();
+    m_transport = WebNetworkTransport::attach();
+    m_recorder = new WebNetworkRecorder(this);
     m_reply = NULL;
-    this->setCookieJar(m_cookieJar);
+    // QtWebKit reads document.cookie through the page's manager, share the
+    // transport's jar; setCookieJar() takes it over, give it back
+    setCookieJar(m_transport->sharedCookieJar());
+    m_transport->sharedCookieJar()->setParent(m_transport);
     connect(this, SIGNAL(authenticationRequired(QNetworkReply *, QAuthenticator *)), m_browserContainer, SLOT(slotAuthenticationRequired(QNetworkReply *, QAuthenticator *)));
     connect(this, SIGNAL(proxyAuthenticationRequired(const QNetworkProxy & , QAuthenticator * )), m_browserContainer, SLOT(slotProxyAuthenticationRequired(const QNetworkProxy &, QAuthenticator *)));
     connect(this, SIGNAL(finished(QNetworkReply *)), this, SLOT(onfinished(QNetworkReply *)));
-    setupCache();
-    setupNetworkProxy();
+    connect(m_browserContainer, SIGNAL(loadStarted()), m_recorder, SLOT(startLoad()));
+    // requests go out through the transport, the proxy is read by the download manager
+    setProxy(m_transport->proxy());
 }
 
 int WebNetworkAccessManager::activeNetworkInterfaces()
@@ -66,6 +68,8 @@ int WebNetworkAccessManager::activeNetworkInterfaces()
 
 void WebNetworkAccessManager::onfinished(QNetworkReply* reply)
 {
+    m_recorder->requestFinished(reply);
+
     QNetworkReply::NetworkError networkError = reply->error();
     QString requestUrl = reply->request().url().toString(); 
 
@@ -99,8 +103,7 @@ void WebNetworkAccessManager::onfinished(QNetworkReply* reply)
 
 WebNetworkAccessManager::~WebNetworkAccessManager()
 {
-    delete m_cookieJar;
-    setCache(NULL);
+    WebNetworkTransport::detach();
 }
 
 QNetworkReply* WebNetworkAccessManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData)
@@ -150,6 +153,7 @@ QNetworkReply* WebNetworkAccessManager::createRequest(Operation op, const QNetwo
     if (reply == NULL) {
 		reply = createRequestHelper(op, req, outgoingData);
     }
+    m_recorder->requestQueued(op, reply);
 
     return reply;
 }
@@ -198,61 +202,12 @@ QNetworkReply* WebNetworkAccessManager::createRequestHelper(Operation op, const
     langCountryCode.replace(QString("_"), QString("-"));
     req.setRawHeader("Accept-Language", langCountryCode.toUtf8());
 
-    return QNetworkAccessManager::createRequest(op, req, outgoingData);
-}
-
-void WebNetworkAccessManager::setupNetworkProxy()
-{
-   QNetworkProxy proxy;
-	 
-   QString proxyString = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("NetworkProxy");
-   QString portString = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("NetworkPort");
-   
-   if (proxyString.isEmpty())
-   	{
-      proxy.setType(QNetworkProxy::NoProxy);
-      proxy.setHostName("");
-      proxy.setPort(0);
-   	}
-   	else
-		{
-      proxy.setType(QNetworkProxy::HttpProxy);
-      proxy.setHostName(proxyString);
-      proxy.setPort(portString.toInt());
- 		}
-
-   	setProxy(proxy);
+    return m_transport->send(this, op, req, outgoingData);
 }
-// Setup cache
-// Need to use WrtSettingsUI to setup Disk Cache Directory Path
-void WebNetworkAccessManager::setupCache()
-{
-
-#if QT_VERSION >= 0x040500
-    #ifndef QTHTTPCACHE         
-        qDiskCache = new FeatherWeightCache(this);
-    #else
-        qDiskCache = new QNetworkDiskCache(this);
-    #endif
-    if ( !BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->value("DiskCacheEnabled").toBool() ) 
-		return;
-
-    QString diskCacheDir = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->value("DiskCacheDirectoryPath").toString();
-    if(diskCacheDir.isEmpty()) return;
-    // setup cache
-    qDiskCache->setCacheDirectory(diskCacheDir);
 
-    int cacheMaxSize = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->value("DiskCacheMaxSize").toInt();
-    qDiskCache->setMaximumCacheSize(cacheMaxSize);
-
-    setCache(qDiskCache);
-
-#endif
-}
 void WebNetworkAccessManager::deleteCookiesFromMemory()
 {
-    if (m_cookieJar)
-        m_cookieJar->deleteCookiesFromMemory();
+    m_transport->sharedCookieJar()->deleteCookiesFromMemory();
 }
 
 }
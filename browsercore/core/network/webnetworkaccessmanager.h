@@ -27,27 +27,24 @@
 #include "messageboxproxy.h"
 #include "SchemeHandlerBr.h"
 
-#if QT_VERSION >= 0x040500
-#include <QNetworkDiskCache>
-
-#endif
-
-//#define QTHTTPCACHE
-
-#ifndef QTHTTPCACHE
-#include "featherweightcache.h"
-#endif
-
 namespace WRT {
 
 class WrtBrowserContainer;
-class CookieJar;
+class WebNetworkTransport;
+class WebNetworkRecorder;
 
+/*!
+ * Per window front end of the shared WebNetworkTransport. It keeps the state
+ * that belongs to the window (secure page POST warning, scheme handler errors,
+ * blocking the network while the session is restored) and hands the requests
+ * it lets through to the transport.
+ */
 
 class WebNetworkAccessManager : public QNetworkAccessManager,
                                 public MessageBoxProxy
 {
     Q_OBJECT
+    friend class WebNetworkTransport;
 
 public:
     WebNetworkAccessManager(WrtBrowserContainer* page, QObject* parent = 0);
@@ -56,6 +53,7 @@ public:
     void onMessageBoxResponse(int retValue);
     int activeNetworkInterfaces();
     void deleteCookiesFromMemory();
+    WebNetworkRecorder* recorder() const { return m_recorder; }
 
 public slots:
 
@@ -63,8 +61,6 @@ protected:
     virtual QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
                                          QIODevice *outgoingData = 0);
 private:
-    void setupCache();
-    void setupNetworkProxy();
     //Handle connection request.
     QNetworkReply* createRequestHelper(Operation op, const QNetworkRequest &request, QIODevice *outgoingData = 0);
 
@@ -73,19 +69,12 @@ private slots:
 
 private:
     WrtBrowserContainer* m_browserContainer;
-    CookieJar* m_cookieJar;
+    WebNetworkTransport* m_transport;
+    WebNetworkRecorder* m_recorder;
     QNetworkReply* m_reply;
     QNetworkRequest* m_req;
     SchemeHandler::SchemeHandlerError m_schemeError;
 
-#if QT_VERSION >= 0x040500
-#ifndef QTHTTPCACHE
-    FeatherWeightCache *qDiskCache;
-#else
-    QNetworkDiskCache *qDiskCache;
-#endif
-#endif
-
 signals:
     void showMessageBox(WRT::MessageBoxProxy* data);
     void networkErrorHappened(const QString & msg);
@@ -0,0 +1,264 @@
+/*
+* Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#include <QStringList>
+
+#include "webnetworkrecorder.h"
+
+namespace WRT {
+
+static const char* operationName(QNetworkAccessManager::Operation op)
+{
+    switch (op) {
+    case QNetworkAccessManager::HeadOperation:
+        return "HEAD";
+    case QNetworkAccessManager::GetOperation:
+        return "GET";
+    case QNetworkAccessManager::PutOperation:
+        return "PUT";
+    case QNetworkAccessManager::PostOperation:
+        return "POST";
+    case QNetworkAccessManager::DeleteOperation:
+        return "DELETE";
+    default:
+        return "CUSTOM";
+    }
+}
+
+static QString jsonString(const QString& str)
+{
+    QString result("\"");
+    for (int i = 0; i < str.length(); i++) {
+        QChar c = str.at(i);
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (c.unicode() < 0x20)
+            result += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        else
+            result += c;
+    }
+    return result + '"';
+}
+
+WebNetworkRecorder::WebNetworkRecorder(QObject* parent)
+    : QObject(parent)
+    , m_ring(KCapacity)
+    , m_next(0)
+    , m_count(0)
+    , m_load(0)
+    , m_loadStart(0)
+{
+    m_clock.start();
+    m_loadStartDate = QDateTime::currentDateTime();
+}
+
+void WebNetworkRecorder::startLoad()
+{
+    m_load++;
+    m_loadStart = m_clock.elapsed();
+    m_loadStartDate = QDateTime::currentDateTime();
+}
+
+void WebNetworkRecorder::requestQueued(QNetworkAccessManager::Operation op, QNetworkReply* reply)
+{
+    if (!reply)
+        return;
+
+    // an entry still in flight after a full turn of the ring, or whose reply
+    // was deleted without finishing, is dropped here
+    Entry& entry = m_ring[m_next];
+    entry.m_reply = reply;
+    entry.m_load = m_load;
+    entry.m_url = reply->request().url();
+    entry.m_operation = op;
+    entry.m_queued = now();
+    entry.m_firstByte = -1;
+    entry.m_finished = -1;
+    entry.m_bytes = 0;
+    entry.m_status = 0;
+    entry.m_error = QNetworkReply::NoError;
+    entry.m_fromCache = false;
+    m_next = (m_next + 1) % KCapacity;
+    if (m_count < KCapacity)
+        m_count++;
+
+    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onDownloadProgress(qint64, qint64)));
+}
+
+void WebNetworkRecorder::requestFinished(QNetworkReply* reply)
+{
+    int index = inFlight(reply);
+    if (index < 0)
+        return;
+    Entry* entry = &m_ring[index];
+
+    entry->m_finished = now();
+    if (entry->m_firstByte < 0)
+        entry->m_firstByte = entry->m_finished;
+    entry->m_status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    entry->m_error = reply->error();
+    entry->m_fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    entry->m_reply = NULL;
+    disconnect(reply, 0, this, 0);
+}
+
+void WebNetworkRecorder::onDownloadProgress(qint64 bytesReceived, qint64 /*bytesTotal*/)
+{
+    int index = inFlight(sender());
+    if (index < 0)
+        return;
+    Entry& entry = m_ring[index];
+    if (entry.m_firstByte < 0)
+        entry.m_firstByte = now();
+    entry.m_bytes = bytesReceived;
+}
+
+/*!
+ * Returns the index in the ring of the request of \a reply, -1 if it is not
+ * in flight. Newest first: a reply deleted without finishing may have left
+ * its address in an older entry.
+ */
+int WebNetworkRecorder::inFlight(const QObject* reply) const
+{
+    for (int i = 1; i <= m_count; i++) {
+        int index = (m_next - i + KCapacity) % KCapacity;
+        if (m_ring[index].m_reply == reply)
+            return index;
+    }
+    return -1;
+}
+
+QList<WebNetworkRecorder::Entry> WebNetworkRecorder::entries() const
+{
+    QList<Entry> result;
+    for (int i = m_count; i > 0; i--) {
+        const Entry& entry = m_ring[(m_next - i + KCapacity) % KCapacity];
+        if (entry.m_load == m_load)
+            result.append(entry);
+    }
+    return result;
+}
+
+QByteArray WebNetworkRecorder::toHar() const
+{
+    QStringList items;
+    foreach (const Entry& entry, entries()) {
+        qint64 finished = entry.m_finished < 0 ? now() : entry.m_finished;
+        qint64 firstByte = entry.m_firstByte < 0 ? finished : entry.m_firstByte;
+        QString started = m_loadStartDate.addMSecs(entry.m_queued).toUTC().toString(Qt::ISODate) + 'Z';
+
+        // in one pass, a url may hold %1 and the like
+        items << QString("{\"startedDateTime\":%1,\"time\":%2,"
+                         "\"request\":{\"method\":\"%3\",\"url\":%4},"
+                         "\"response\":{\"status\":%5,\"bodySize\":%6},"
+                         "\"cache\":{\"source\":\"%7\"},"
+                         "\"timings\":{\"blocked\":-1,\"dns\":-1,\"connect\":-1,\"send\":0,\"wait\":%8,\"receive\":%9}}")
+                 .arg(jsonString(started),
+                      QString::number(finished - entry.m_queued),
+                      QLatin1String(operationName(entry.m_operation)),
+                      jsonString(entry.m_url.toString()),
+                      QString::number(entry.m_status),
+                      QString::number(entry.m_bytes),
+                      QLatin1String(entry.m_fromCache ? "cache" : "network"),
+                      QString::number(firstByte - entry.m_queued),
+                      QString::number(finished - firstByte));
+    }
+    QString har = QString("{\"log\":{\"version\":\"1.2\",\"creator\":{\"name\":\"WebNetworkRecorder\",\"version\":\"1\"},\"entries\":[%1]}}")
+                  .arg(items.join(","));
+    return har.toUtf8();
+}
+
+QString WebNetworkRecorder::summary() const
+{
+    QList<Entry> done;
+    int inFlight = 0;
+    int fromCache = 0;
+    qint64 bytes = 0;
+    foreach (const Entry& entry, entries()) {
+        if (entry.m_finished < 0) {
+            inFlight++;
+            continue;
+        }
+        done.append(entry);
+        bytes += entry.m_bytes;
+        if (entry.m_fromCache)
+            fromCache++;
+    }
+    if (done.isEmpty())
+        return QString("requests 0, in flight %1").arg(inFlight);
+
+    // span of the load and the time at least one request was in flight;
+    // the rest is spent waiting on the parser and scripts
+    qint64 start = done.first().m_queued;
+    qint64 end = 0;
+    qint64 busy = 0;
+    qint64 busyUntil = start;
+    foreach (const Entry& entry, done) {   // ordered by m_queued
+        end = qMax(end, entry.m_finished);
+        if (entry.m_finished > busyUntil) {
+            busy += entry.m_finished - qMax(entry.m_queued, busyUntil);
+            busyUntil = entry.m_finished;
+        }
+    }
+
+    // requests that had the network to themselves block everything behind them
+    qint64 blocking = 0;
+    int blockingCount = 0;
+    for (int i = 0; i < done.count(); i++) {
+        bool alone = true;
+        for (int j = 0; j < done.count() && alone; j++)
+            alone = (i == j || done[j].m_finished <= done[i].m_queued || done[j].m_queued >= done[i].m_finished);
+        if (alone) {
+            blocking += done[i].m_finished - done[i].m_queued;
+            blockingCount++;
+        }
+    }
+
+    // walk back from the last request to finish, through the request that
+    // finished last before each one was queued
+    int current = 0;
+    for (int i = 1; i < done.count(); i++) {
+        if (done[i].m_finished > done[current].m_finished)
+            current = i;
+    }
+    qint64 critical = 0;
+    int criticalCount = 0;
+    while (current >= 0) {
+        critical += done[current].m_finished - done[current].m_queued;
+        criticalCount++;
+        int previous = -1;
+        for (int i = 0; i < done.count(); i++) {
+            if (done[i].m_finished <= done[current].m_queued
+                && (previous < 0 || done[i].m_finished > done[previous].m_finished))
+                previous = i;
+        }
+        current = previous;
+    }
+
+    return QString("requests %1 (%2 from cache, %3 in flight), %4 bytes, load %5 ms, network busy %6 ms; "
+                   "critical path %7 requests %8 ms; blocking %9 requests %10 ms")
+           .arg(done.count()).arg(fromCache).arg(inFlight).arg(bytes)
+           .arg(end - start).arg(busy)
+           .arg(criticalCount).arg(critical)
+           .arg(blockingCount).arg(blocking);
+}
+
+}
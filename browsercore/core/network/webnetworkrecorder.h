@@ -0,0 +1,104 @@
+/*
+* Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef __WEBNETWORKRECORDER_H__
+#define __WEBNETWORKRECORDER_H__
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QVector>
+#include <QUrl>
+
+namespace WRT {
+
+/*!
+ * Waterfall of the requests made by one window, always on.
+ *
+ * The requests are kept in a ring of KCapacity entries allocated up front;
+ * recording a request stores a few integers and a shared copy of its url,
+ * and the requests in flight are found by a scan of the ring, so nothing
+ * is allocated per request but the connection to its progress signal.
+ * Times are in ms from the start of the page load the request belongs to;
+ * the first byte is when the first progress of the response arrived. Qt
+ * does not report connection setup separately, it is part of the wait for
+ * the first byte.
+ *
+ * toHar() exports the requests of the current page load as HAR style JSON,
+ * summary() gives the critical path and blocking figures of that load.
+ */
+class WebNetworkRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int KCapacity = 256;
+
+    struct Entry
+    {
+        Entry() : m_reply(NULL) {}
+
+        const QNetworkReply* m_reply;   // while in flight
+        int m_load;
+        QUrl m_url;
+        QNetworkAccessManager::Operation m_operation;
+        qint64 m_queued;
+        qint64 m_firstByte;             // -1 until the response starts
+        qint64 m_finished;              // -1 while in flight
+        qint64 m_bytes;
+        int m_status;
+        int m_error;
+        bool m_fromCache;
+    };
+
+    WebNetworkRecorder(QObject* parent = 0);
+
+    void requestQueued(QNetworkAccessManager::Operation op, QNetworkReply* reply);
+    void requestFinished(QNetworkReply* reply);
+
+    // entries of the current page load, oldest first
+    QList<Entry> entries() const;
+    QByteArray toHar() const;
+    QString summary() const;
+
+public slots:
+    void startLoad();
+
+private slots:
+    void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+
+private:
+    qint64 now() const { return m_clock.elapsed() - m_loadStart; }
+    int inFlight(const QObject* reply) const;
+
+private:
+    QVector<Entry> m_ring;
+    int m_next;
+    int m_count;
+    int m_load;
+    QElapsedTimer m_clock;
+    qint64 m_loadStart;
+    QDateTime m_loadStartDate;
+};
+}
+#endif
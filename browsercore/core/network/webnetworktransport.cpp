@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#include <QNetworkProxy>
+#include <QAuthenticator>
+
+#include "bedrockprovisioning.h"
+#include "webcookiejar.h"
+#include "webnetworkaccessmanager.h"
+#include "webnetworktransport.h"
+
+namespace WRT {
+
+WebNetworkTransport* WebNetworkTransport::s_instance = NULL;
+int WebNetworkTransport::s_refCount = 0;
+
+WebNetworkTransport* WebNetworkTransport::attach()
+{
+    if (!s_instance)
+        s_instance = new WebNetworkTransport();
+    s_refCount++;
+    return s_instance;
+}
+
+void WebNetworkTransport::detach()
+{
+    Q_ASSERT(s_refCount > 0);
+    if (--s_refCount == 0) {
+        delete s_instance;
+        s_instance = NULL;
+    }
+}
+
+WebNetworkTransport::WebNetworkTransport() : QNetworkAccessManager()
+{
+    m_cookieJar = new CookieJar();
+    setCookieJar(m_cookieJar);
+    connect(this, SIGNAL(authenticationRequired(QNetworkReply *, QAuthenticator *)), this, SLOT(onAuthenticationRequired(QNetworkReply *, QAuthenticator *)));
+    connect(this, SIGNAL(proxyAuthenticationRequired(const QNetworkProxy & , QAuthenticator * )), this, SLOT(onProxyAuthenticationRequired(const QNetworkProxy &, QAuthenticator *)));
+    setupCache();
+    setupNetworkProxy();
+}
+
+WebNetworkTransport::~WebNetworkTransport()
+{
+    // the cookie jar is a child, it saves the cookies when deleted
+    setCache(NULL);
+}
+
+QNetworkReply* WebNetworkTransport::send(WebNetworkAccessManager* frontEnd, Operation op,
+                                         const QNetworkRequest& request, QIODevice* outgoingData)
+{
+    // The front end's get()/post()/... wraps the reply, so its finished() and
+    // sslErrors() signals are still emitted per window. Authentication is
+    // asked through this manager, remember who to forward it to.
+    QNetworkReply* reply = QNetworkAccessManager::createRequest(op, request, outgoingData);
+    m_frontEnds.insert(reply, frontEnd);
+    m_lastFrontEnd = frontEnd;
+    connect(reply, SIGNAL(destroyed(QObject*)), this, SLOT(onReplyDestroyed(QObject*)));
+    return reply;
+}
+
+void WebNetworkTransport::onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator)
+{
+    WebNetworkAccessManager* frontEnd = m_frontEnds.value(reply);
+    if (frontEnd)
+        emit frontEnd->authenticationRequired(reply, authenticator);
+}
+
+void WebNetworkTransport::onProxyAuthenticationRequired(const QNetworkProxy& proxy, QAuthenticator* authenticator)
+{
+    // no reply to tell the window by, ask the one that made the last request
+    if (m_lastFrontEnd)
+        emit m_lastFrontEnd->proxyAuthenticationRequired(proxy, authenticator);
+}
+
+void WebNetworkTransport::onReplyDestroyed(QObject* reply)
+{
+    m_frontEnds.remove(reply);
+}
+
+void WebNetworkTransport::setupNetworkProxy()
+{
+    QNetworkProxy proxy;
+
+    QString proxyString = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("NetworkProxy");
+    QString portString = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("NetworkPort");
+
+    if (proxyString.isEmpty()) {
+        proxy.setType(QNetworkProxy::NoProxy);
+        proxy.setHostName("");
+        proxy.setPort(0);
+    }
+    else {
+        proxy.setType(QNetworkProxy::HttpProxy);
+        proxy.setHostName(proxyString);
+        proxy.setPort(portString.toInt());
+    }
+
+    setProxy(proxy);
+}
+
+// Setup cache
+// Need to use WrtSettingsUI to setup Disk Cache Directory Path
+void WebNetworkTransport::setupCache()
+{
+#if QT_VERSION >= 0x040500
+    #ifndef QTHTTPCACHE
+        m_diskCache = new FeatherWeightCache(this);
+    #else
+        m_diskCache = new QNetworkDiskCache(this);
+    #endif
+    if (!BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->value("DiskCacheEnabled").toBool())
+        return;
+
+    QString diskCacheDir = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->value("DiskCacheDirectoryPath").toString();
+    if (diskCacheDir.isEmpty())
+        return;
+    // setup cache
+    m_diskCache->setCacheDirectory(diskCacheDir);
+
+    int cacheMaxSize = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->value("DiskCacheMaxSize").toInt();
+    m_diskCache->setMaximumCacheSize(cacheMaxSize);
+
+    setCache(m_diskCache);
+#endif
+}
+
+}
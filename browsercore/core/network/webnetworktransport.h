@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef __WEBNETWORKTRANSPORT_H__
+#define __WEBNETWORKTRANSPORT_H__
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QHash>
+
+//#define QTHTTPCACHE
+
+#ifndef QTHTTPCACHE
+#include "featherweightcache.h"
+#else
+#include <QNetworkDiskCache>
+#endif
+
+namespace WRT {
+
+class CookieJar;
+class WebNetworkAccessManager;
+
+/*!
+ * The network access manager that actually talks to the network, shared by
+ * the WebNetworkAccessManager of every window. All the windows go through
+ * its cookie jar, disk cache and HTTP connection pool, so keep-alive
+ * connections opened by one window are reused by the others.
+ *
+ * The per window managers take a reference with attach() and give it back
+ * with detach(); the transport goes away, saving the cookies, with the last
+ * window.
+ */
+class WebNetworkTransport : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    static WebNetworkTransport* attach();
+    static void detach();
+
+    CookieJar* sharedCookieJar() const { return m_cookieJar; }
+
+    // Creates the reply for a request made through \a frontEnd
+    QNetworkReply* send(WebNetworkAccessManager* frontEnd, Operation op,
+                        const QNetworkRequest& request, QIODevice* outgoingData);
+
+private:
+    WebNetworkTransport();
+    ~WebNetworkTransport();
+
+    void setupCache();
+    void setupNetworkProxy();
+
+private slots:
+    void onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator);
+    void onProxyAuthenticationRequired(const QNetworkProxy& proxy, QAuthenticator* authenticator);
+    void onReplyDestroyed(QObject* reply);
+
+private:
+    static WebNetworkTransport* s_instance;
+    static int s_refCount;
+
+    CookieJar* m_cookieJar;
+#ifndef QTHTTPCACHE
+    FeatherWeightCache* m_diskCache;
+#else
+    QNetworkDiskCache* m_diskCache;
+#endif
+    QHash<QObject*, QPointer<WebNetworkAccessManager> > m_frontEnds;
+    QPointer<WebNetworkAccessManager> m_lastFrontEnd;
+};
+}
+#endif
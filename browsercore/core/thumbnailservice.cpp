@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+
+#include "thumbnailservice.h"
+#include "wrtbrowsercontainer.h"
+
+namespace WRT {
+
+ThumbnailService::ThumbnailService(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(renderNext()));
+}
+
+ThumbnailService::~ThumbnailService()
+{
+}
+
+/*!
+ * Returns a thumbnail of \a size for \a page right away and, if the page
+ * changed since its last capture, queues a refresh reported by thumbnailReady()
+ */
+QImage ThumbnailService::request(WrtBrowserContainer* page, const QSize& size)
+{
+    if (!page)
+        return QImage();
+    if (page->thumbnailUpToDate(size))
+        return page->cachedThumbnail();
+
+    bool queued = false;
+    for (int i = 0; i < m_queue.count(); i++) {
+        if (m_queue[i].m_page == page) {
+            m_queue[i].m_size = size;
+            queued = true;
+            break;
+        }
+    }
+    if (!queued) {
+        Request r;
+        r.m_page = page;
+        r.m_size = size;
+        m_queue.append(r);
+    }
+    if (!m_timer.isActive())
+        m_timer.start(0);
+
+    QImage stale = page->cachedThumbnail();
+    if (!stale.isNull())
+        return stale.size() == size ? stale : stale.scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+
+    QImage placeholder(size, QImage::Format_RGB32);
+    placeholder.fill(0xffffffff);
+    return placeholder;
+}
+
+/*!
+ * Drops the pending refresh of \a page, e.g. when it is being closed
+ */
+void ThumbnailService::cancel(WrtBrowserContainer* page)
+{
+    for (int i = m_queue.count() - 1; i >= 0; i--) {
+        if (m_queue[i].m_page == page)
+            m_queue.removeAt(i);
+    }
+}
+
+void ThumbnailService::cancelAll()
+{
+    m_queue.clear();
+    m_timer.stop();
+}
+
+/*!
+ * Renders the first queued page; QWebFrame::render() has to run on the GUI
+ * thread so the work is spread over event loop iterations instead
+ */
+void ThumbnailService::renderNext()
+{
+    while (!m_queue.isEmpty()) {
+        Request r = m_queue.takeFirst();
+        WrtBrowserContainer* page = r.m_page;
+        if (!page)
+            continue;   // closed meanwhile
+        QImage image = page->thumbnail(r.m_size);
+        emit thumbnailReady(page, image);
+        break;
+    }
+    if (!m_queue.isEmpty())
+        m_timer.start(0);
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+* Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+
+#ifndef __THUMBNAILSERVICE_H__
+#define __THUMBNAILSERVICE_H__
+
+#include "brtglobal.h"
+
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+
+namespace WRT {
+
+class WrtBrowserContainer;
+
+/*!
+ * Hands out page thumbnails without blocking the caller on rendering.
+ *
+ * request() always returns at once: the page's cached thumbnail if its content
+ * has not changed, otherwise the last (stale) capture or a blank placeholder.
+ * Stale pages are queued and rendered one per event loop iteration, each
+ * result is delivered with thumbnailReady().
+ */
+class WRT_BROWSER_EXPORT ThumbnailService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailService(QObject* parent = 0);
+    ~ThumbnailService();
+
+    QImage request(WrtBrowserContainer* page, const QSize& size);
+    void cancel(WrtBrowserContainer* page);
+    void cancelAll();
+
+signals:
+    void thumbnailReady(WRT::WrtBrowserContainer* page, const QImage& image);
+
+private slots:
+    void renderNext();
+
+private:
+    struct Request {
+        QPointer<WrtBrowserContainer> m_page;
+        QSize m_size;
+    };
+
+    QList<Request> m_queue;
+    QTimer m_timer;
+};
+
+}
+#endif // __THUMBNAILSERVICE_H__
@@ -89,6 +89,8 @@ WrtBrowserContainerPrivate::WrtBrowserContainerPrivate(QObject* parent,
 ,   m_widget(0)
 ,   m_fileChooser(0)
 ,   m_needUpdateThumbnail(false)
+,   m_contentGeneration(0)
+,   m_thumbnailGeneration(-1)
 {
     m_page = page;
 
@@ -187,6 +189,13 @@ WrtBrowserContainer::WrtBrowserContainer(QObject* parent) :
     connect(this, SIGNAL(loadFinished(bool)), d->m_loadController, SLOT(loadFinished(bool)));
     connect(mainFrame(), SIGNAL(urlChanged(QUrl)), d->m_loadController, SLOT(urlChanged(QUrl)));
     connect(mainFrame(), SIGNAL(initialLayoutCompleted()), d->m_loadController, SLOT(initialLayoutCompleted()));
+
+    /* A finished load, an edit, a scroll, or a new contents size or zoom makes the cached
+       thumbnail stale; repaints are not counted, an animated page would never hit the cache */
+    connect(this, SIGNAL(loadFinished(bool)), this, SLOT(invalidateThumbnail()));
+    connect(this, SIGNAL(contentsChanged()), this, SLOT(invalidateThumbnail()));
+    connect(this, SIGNAL(scrollRequested(int, int, const QRect&)), this, SLOT(invalidateThumbnail()));
+    connect(mainFrame(), SIGNAL(contentsSizeChanged(const QSize&)), this, SLOT(invalidateThumbnail()));
 	  
 #ifdef QT_GEOLOCATION 
     d->m_geolocationManager = GeolocationManager::getSingleton();
@@ -261,24 +270,46 @@ SchemeHandler* WrtBrowserContainer::schemeHandler() const
 }
 
 /*!
- *  This function returns a thumbnail image for this page as specified by X & Y co-ordinate scale factors
- * @param  scaleX :  X Co-ordinate scale factor for the page thumbnail
- * @param  scaleY :  y Co-ordinate scale factor for the page thumbnail
+ * Marks the cached thumbnail stale, the next thumbnail() call renders the page again
+ */
+void WrtBrowserContainer::invalidateThumbnail()
+{
+    d->m_contentGeneration++;
+}
+
+/*!
+ * Returns true if thumbnail() would return the cached image for size \a s without rendering
+ */
+bool WrtBrowserContainer::thumbnailUpToDate(QSize s) const
+{
+    return !d->m_needUpdateThumbnail
+        && d->m_thumbnailGeneration == d->m_contentGeneration
+        && d->m_thumbnail.size() == s;
+}
+
+/*!
+ *  This function returns a thumbnail image of size \a s for this page.
+ *  The page is rendered at thumbnail resolution, and only if it changed since the
+ *  last call; otherwise the cached image is returned.
+ * @param  s :  size of the thumbnail
  */
 QImage WrtBrowserContainer::thumbnail(QSize s)
 {
+    if (thumbnailUpToDate(s))
+        return d->m_thumbnail;
+
     QImage image(s, QImage::Format_RGB32);
     qreal fitWidth = s.width();
     QPoint renderPos(0, 0);
-    WebPageData* d = pageZoomMetaData();
+    WebPageData* zoomData = pageZoomMetaData();
     qreal scale = 1.0;
-    if(d->isValid())
+    if(zoomData->isValid())
     {
-        fitWidth = d->rect.width();
-        if(fitWidth > d->webViewRect.width() * d->scale)
-            fitWidth = d->webViewRect.width() * d->scale;
-        renderPos = d->webViewRect.topLeft().toPoint();
-        scale = s.width() / (fitWidth / d->scale);
+        fitWidth = zoomData->rect.width();
+        if(fitWidth > zoomData->webViewRect.width() * zoomData->scale)
+            fitWidth = zoomData->webViewRect.width() * zoomData->scale;
+        renderPos = zoomData->webViewRect.topLeft().toPoint();
+        scale = s.width() / (fitWidth / zoomData->scale);
     }
 
     if (image.isNull()) {
@@ -297,6 +328,11 @@ QImage WrtBrowserContainer::thumbnail(QSize s)
     painter.setTransform(transform);
 
     mainFrame()->render(&painter);
+    painter.end();
+
+    d->m_thumbnail = image;
+    d->m_thumbnailGeneration = d->m_contentGeneration;
+    d->m_needUpdateThumbnail = false;
     return image;
 }
 QImage WrtBrowserContainer::pageThumbnail(qreal scaleX, qreal scaleY)
@@ -306,21 +342,24 @@ QImage WrtBrowserContainer::pageThumbnail(qreal scaleX, qreal scaleY)
     #else
     QSize size(640,360);
     #endif
-    QImage image(size, QImage::Format_RGB32);
+    // Render straight at the thumbnail size instead of scaling a full size image down
+    QSize thumbSize = size;
+    thumbSize.scale(scaleX * size.width(), scaleY * size.height(), Qt::KeepAspectRatio);
+    if (thumbSize.isEmpty())
+        return QImage();
+    QImage image(thumbSize, QImage::Format_RGB32);
 
     QPainter painter(&image);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.fillRect(image.rect(), Qt::white);
+    painter.scale(qreal(thumbSize.width()) / size.width(), qreal(thumbSize.height()) / size.height());
     QRect r(0, 0, size.width(), size.height());
     QRegion clip(r);
-    painter.save();
-    painter.setBrush(Qt::white);
-    painter.drawRect(r);
-    painter.restore();
     qreal saveZoomFactor = mainFrame()->zoomFactor();
     mainFrame()->setZoomFactor(1.0);
     mainFrame()->render(&painter, clip);
     mainFrame()->setZoomFactor(saveZoomFactor);
-    QImage thumbnail = image.scaled(scaleX * size.width(), scaleY * size.height(),Qt::KeepAspectRatio,Qt::SmoothTransformation);
-    return thumbnail;
+    return image;
 }
 
 /*!
@@ -521,6 +560,7 @@ WebPageData* WrtBrowserContainer::pageZoomMetaData()
 
 void WrtBrowserContainer::setPageZoomMetaData(const WebPageData &zoomData ){
     history()->currentItem().setUserData(qVariantFromValue(zoomData));
+    invalidateThumbnail();
 }
 
 
@@ -72,6 +72,8 @@ public:
 
     QImage thumbnail(QSize s);
     QImage pageThumbnail(qreal scaleX, qreal scaleY);
+    bool thumbnailUpToDate(QSize s) const;
+    QImage cachedThumbnail() const { return d->m_thumbnail; }
 
     void setPageFactory(BrowserPageFactory* f);
 
@@ -113,6 +115,7 @@ public slots:
     void savePageDataToHistoryItem(QWebFrame*, QWebHistoryItem* item);
     void slotAuthenticationRequired(QNetworkReply *, QAuthenticator *);
     void slotProxyAuthenticationRequired(const QNetworkProxy &, QAuthenticator *);
+    void invalidateThumbnail();
 
 #ifdef QT_GEOLOCATION
     void handleRequestPermissionFromUser(QWebFrame* frame, QWebPage::PermissionDomain domain);
@@ -23,6 +23,7 @@
 #define __WRTBROWSERCONTAINER_P_H__
 
 #include "webpagedata.h"
+#include <QImage>
 
 class QGraphicsWidget;
 class QObject;
@@ -52,6 +53,9 @@ namespace WRT {
         WRT::LoadController * m_loadController; //Owned
         WrtBrowserFileChooser * m_fileChooser; // Owned
         bool m_needUpdateThumbnail;
+        QImage m_thumbnail;             // last capture, see thumbnail()
+        int m_contentGeneration;        // bumped when the page content changes, see invalidateThumbnail()
+        int m_thumbnailGeneration;      // m_contentGeneration when m_thumbnail was taken
 #ifdef QT_GEOLOCATION
         GeolocationManager *m_geolocationManager;
 #endif // QT_GEOLOCATION
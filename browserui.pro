@@ -24,6 +24,7 @@ symbian : {
 contains( what, tests ) {
     DEFINES += ENABLE_TESTS
     exists($$PWD/internal/tests/perfTracing/perfTracing.pro): SUBDIRS += internal/tests/perfTracing/perfTracing.pro
+    exists($$PWD/internal/tests/tests.pro): SUBDIRS += internal/tests/tests.pro
     exists($$PWD/internal/tests/mw/mw.pro): SUBDIRS += internal/tests/mw/mw.pro
     exists($$PWD/internal/tests/Bookmarks_Test/Bookmarks_Test.pro): SUBDIRS += internal/tests/mw/Bookmarks_Test/Bookmarks_Test.pro
 }
@@ -111,8 +111,11 @@ namespace GVA {
 
   QList<CachedHandler> ChromeDOM::getCachedHandlers(const QString &elementId, const QRectF & ownerArea)
   {
-    QWebElement snippet = getElementById(elementId);
-    QList <QWebElement> controls =  snippet.findAll(".GinebraCached").toList();
+    QList <QWebElement> controls;
+    if (m_scan.contains(elementId))
+      controls = m_scan.snippet(elementId).cached;
+    else
+      controls = getElementById(elementId).findAll(".GinebraCached").toList();
     QList <CachedHandler> handlers;
     for (int i = 0; i < controls.size(); i++){
       QWebElement elem = controls.at(i);
@@ -129,59 +132,56 @@ namespace GVA {
   
 
 //TODO: Get rid of rectangle argument to snippets. This is redundant with the element argument!!
-//TODO: Rewrite using function table
-  
-  ChromeSnippet * ChromeDOM::nativeSnippetForClassName(const QString & className, const QString elementId,  QWebElement element)
+
+  template <class T>
+  static ChromeSnippet * createSnippet(const QString &elementId, ChromeWidget * chrome, const QWebElement &element)
   {
-      QRectF rect = element.geometry();
-      
-      if (className == "ContentToolbar") {
-          return ContentToolbarSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "WindowToolbar") {
-          return WindowToolbarSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "RecentUrlToolbar") {
-          return RecentUrlToolbarSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "BookmarksToolbar") {
-          return BookmarksToolbarSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "SettingsToolbar") {
-          return SettingsToolbarSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "MostVisitedPagesWidget") {
-          return MostVisitedSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "ActionButton") {
-          return ActionButtonSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "PageSnippet") {
-          return PageSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "UrlSearchSnippet") {
-          return GUrlSearchSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "TextEditSnippet") {
-          return EditorSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "TitleUrlContainerSnippet") {
-          return TitleUrlContainerSnippet::instance(elementId, m_chrome, element);
-      }
-      else if (className == "CopyCutPasteSnippet") {
-          return CopyCutPasteSnippet::instance(elementId, m_chrome, element);
-      }
-      else {
-          ChromeSnippet* result = new ChromeSnippet(elementId, m_chrome, 0, element);
-          result->setChromeWidget(new QGraphicsWidget());
-          return result;
+      return T::instance(elementId, chrome, element);
+  }
+
+  QHash<QString, SnippetFactory> & ChromeDOM::snippetFactories()
+  {
+      static QHash<QString, SnippetFactory> factories;
+      if (factories.isEmpty()) {
+          factories.insert("ContentToolbar", createSnippet<ContentToolbarSnippet>);
+          factories.insert("WindowToolbar", createSnippet<WindowToolbarSnippet>);
+          factories.insert("RecentUrlToolbar", createSnippet<RecentUrlToolbarSnippet>);
+          factories.insert("BookmarksToolbar", createSnippet<BookmarksToolbarSnippet>);
+          factories.insert("SettingsToolbar", createSnippet<SettingsToolbarSnippet>);
+          factories.insert("MostVisitedPagesWidget", createSnippet<MostVisitedSnippet>);
+          factories.insert("ActionButton", createSnippet<ActionButtonSnippet>);
+          factories.insert("PageSnippet", createSnippet<PageSnippet>);
+          factories.insert("UrlSearchSnippet", createSnippet<GUrlSearchSnippet>);
+          factories.insert("TextEditSnippet", createSnippet<EditorSnippet>);
+          factories.insert("TitleUrlContainerSnippet", createSnippet<TitleUrlContainerSnippet>);
+          factories.insert("CopyCutPasteSnippet", createSnippet<CopyCutPasteSnippet>);
       }
+      return factories;
+  }
+
+  void ChromeDOM::registerSnippetClass(const QString &className, SnippetFactory factory)
+  {
+      snippetFactories().insert(className, factory);
+  }
+
+  ChromeSnippet * ChromeDOM::nativeSnippetForClassName(const QString & className, const QString elementId,  QWebElement element)
+  {
+      SnippetFactory factory = snippetFactories().value(className);
+      if (factory)
+          return factory(elementId, m_chrome, element);
+
+      ChromeSnippet* result = new ChromeSnippet(elementId, m_chrome, 0, element);
+      result->setChromeWidget(new QGraphicsWidget());
+      return result;
   }
   
   ChromeSnippet *ChromeDOM::getSnippet(const QString &docElementId) {
     ChromeSnippet * snippet = 0;
-    QWebElement doc = m_page->mainFrame()->documentElement();
-    QWebElement element = doc.findFirst("#" + docElementId);
+    //Snippets not seen by the initial scan are looked up on their own
+    ChromeDOMScan::SnippetElement info = m_scan.contains(docElementId)
+        ? m_scan.snippet(docElementId)
+        : ChromeDOMScan::readSnippetElement(getElementById(docElementId));
+    QWebElement element = info.element;
     QRect rect = element.geometry();
     //TODO: This may not be accurate since final heights may not have been computed at this point!!
     m_height += rect.height();
@@ -189,9 +189,9 @@ namespace GVA {
     //    qDebug() << "Snippet: ID: " << docElementId << " Owner Area: " << rect << " Element Rect: " << element.geometry();
   
     if (!rect.isNull()) {
-        QString className = element.attribute("data-GinebraNativeClass", "__NO_CLASS__");
+        QString className = info.className;
         if (className == "__NO_CLASS__") {
-            if (element.attribute("data-GinebraContainer", "false") == "true") {
+            if (info.container) {
                 snippet = new WebChromeContainerSnippet(docElementId, m_chrome, element);
                 snippet->setChromeWidget(new ChromeItem(snippet));
             }
@@ -214,42 +214,25 @@ namespace GVA {
             
         }
 
-        QWebElement parentElem;
-
-        if (!(parentElem = findChromeParent(element)).isNull()) {
-            snippet->setParentId(parentElem.attribute("id"));
+        if (!info.parentId.isNull()) {
+            snippet->setParentId(info.parentId);
         }
         //Set auto-layout attributes
-        snippet->setAnchor(element.attribute("data-GinebraAnchor", "AnchorNone"), false);
-        snippet->setAnchorOffset(element.attribute("data-GinebraAnchorOffset", "0").toInt());
-        snippet->setInitiallyVisible(element.attribute("data-GinebraVisible", "false") == "true");
-        snippet->setHidesContent(element.attribute("data-GinebraHidesContent", "false") == "true");
+        snippet->setAnchor(info.anchor, false);
+        snippet->setAnchorOffset(info.anchorOffset);
+        snippet->setInitiallyVisible(info.visible);
+        snippet->setHidesContent(info.hidesContent);
     }
     return snippet;
   }
   
-  QWebElement ChromeDOM::findChromeParent(QWebElement element)
-  {
-    while(!(element = element.parent()).isNull()){
-      if (element.attribute("class") == "GinebraSnippet"){
-	return element;
-      }
-    }
-    return element;
-  }
-
   QList <QWebElement> ChromeDOM::getInitialElements()
   {
     m_renderer->clearRenderList();
-    QWebElement test = getElementById("TestTableCell9");
-    //qDebug() << "TEST ELEMENT:" << test.toPlainText();
     m_height = 0;
-    QWebElement doc = m_page->mainFrame()->documentElement();
-#if QT_VERSION < 0x040600 //TBD: Do we care, given that the dom api is not officially supported before 4.6?
-    return doc.findAll(".GinebraSnippet");
-#else
-    return doc.findAll(".GinebraSnippet").toList();
-#endif
+    //Collect the snippets, their attributes and their cached controls in one pass
+    m_scan.scan(m_page->mainFrame()->documentElement());
+    return m_scan.elements();
   }
 
 } // end of namespace GVA
@@ -28,6 +28,7 @@
 #include <QHash>
 #include <QWebElement>
 #include "CachedHandler.h"
+#include "ChromeDOMScan.h"
 
 class QWebPage;
 class QGraphicsItem;
@@ -38,6 +39,8 @@ class ChromeSnippet;
 class ChromeWidget;
 class ChromeRenderer;
 
+typedef ChromeSnippet * (*SnippetFactory)(const QString &elementId, ChromeWidget * chrome, const QWebElement &element);
+
 class ChromeDOM : public QObject //TBD: Need QObject here?
 {
   Q_OBJECT
@@ -55,14 +58,17 @@ public:
   //QString getCacheableScript();
   QList<CachedHandler> getCachedHandlers(const QString &elementId, const QRectF & ownerArea);
   int height() { return m_height; }
+  //Native snippet classes are looked up by their data-GinebraNativeClass name
+  static void registerSnippetClass(const QString &className, SnippetFactory factory);
 private:
-  QWebElement findChromeParent(QWebElement element);
   ChromeSnippet *nativeSnippetForClassName(const QString & className, const QString elementId, QWebElement element);
+  static QHash<QString, SnippetFactory> & snippetFactories();
   QWebPage * m_page;
   ChromeRenderer * m_renderer;
   ChromeWidget * m_chrome;
   int m_height;
   int m_bytes;
+  ChromeDOMScan m_scan;
 };
 
 } // end of namespace GVA
@@ -0,0 +1,85 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+* 
+*
+*/
+
+#include "ChromeDOMScan.h"
+
+namespace GVA {
+
+  QWebElement ChromeDOMScan::findChromeParent(QWebElement element)
+  {
+    while(!(element = element.parent()).isNull()){
+      if (element.attribute("class") == "GinebraSnippet"){
+	return element;
+      }
+    }
+    return element;
+  }
+
+  ChromeDOMScan::SnippetElement ChromeDOMScan::readSnippetElement(const QWebElement &element)
+  {
+    SnippetElement info;
+    info.element = element;
+    QWebElement parentElem = findChromeParent(element);
+    if (!parentElem.isNull())
+      info.parentId = parentElem.attribute("id");
+    info.className = element.attribute("data-GinebraNativeClass", "__NO_CLASS__");
+    info.container = element.attribute("data-GinebraContainer", "false") == "true";
+    info.anchor = element.attribute("data-GinebraAnchor", "AnchorNone");
+    info.anchorOffset = element.attribute("data-GinebraAnchorOffset", "0").toInt();
+    info.visible = element.attribute("data-GinebraVisible", "false") == "true";
+    info.hidesContent = element.attribute("data-GinebraHidesContent", "false") == "true";
+    return info;
+  }
+
+  //Elements come in document order, so a snippet is recorded before anything inside it.
+  void ChromeDOMScan::scan(const QWebElement &document)
+  {
+    clear();
+#if QT_VERSION < 0x040600
+    QList <QWebElement> elements = document.findAll(".GinebraSnippet, .GinebraCached");
+#else
+    QList <QWebElement> elements = document.findAll(".GinebraSnippet, .GinebraCached").toList();
+#endif
+    foreach (const QWebElement &element, elements) {
+      if (element.hasClass("GinebraSnippet")) {
+        QString id = element.attribute("id");
+        m_snippets.insert(id, readSnippetElement(element));
+        m_elements.append(element);
+      }
+      if (element.hasClass("GinebraCached")) {
+        //A cached control belongs to every snippet it is nested in
+        for (QWebElement ancestor = element.parent(); !ancestor.isNull(); ancestor = ancestor.parent()) {
+          QHash<QString, SnippetElement>::iterator it = m_snippets.find(ancestor.attribute("id"));
+          if (it != m_snippets.end() && it->element == ancestor)
+            it->cached.append(element);
+        }
+      }
+    }
+  }
+
+  void ChromeDOMScan::clear()
+  {
+    m_snippets.clear();
+    m_elements.clear();
+  }
+
+} // end of namespace GVA
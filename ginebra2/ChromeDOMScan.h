@@ -0,0 +1,62 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef _GINEBRA_CHROME_DOM_SCAN_H_
+#define _GINEBRA_CHROME_DOM_SCAN_H_
+
+#include <QList>
+#include <QHash>
+#include <QWebElement>
+
+namespace GVA {
+
+//The snippets of a chrome document and what the chrome needs from them,
+//collected in one pass over the document
+class ChromeDOMScan
+{
+public:
+  struct SnippetElement {
+    QWebElement element;
+    QString parentId;
+    QString className;
+    bool container;
+    QString anchor;
+    int anchorOffset;
+    bool visible;
+    bool hidesContent;
+    QList<QWebElement> cached;
+  };
+  void scan(const QWebElement &document);
+  void clear();
+  bool contains(const QString &id) const { return m_snippets.contains(id); }
+  SnippetElement snippet(const QString &id) const { return m_snippets.value(id); }
+  //Snippet elements in document order
+  QList<QWebElement> elements() const { return m_elements; }
+  static SnippetElement readSnippetElement(const QWebElement &element);
+private:
+  static QWebElement findChromeParent(QWebElement element);
+  QHash<QString, SnippetElement> m_snippets;
+  QList<QWebElement> m_elements;
+};
+
+} // end of namespace GVA
+
+#endif
@@ -32,6 +32,30 @@ void paintDisabledRect(QPainter *painter, const QRectF &rect) {
     painter->restore();
 }
 
+void AnimationLayer::begin(QGraphicsItem *item) {
+    if (!item || isActive())
+        return;
+    cache(item);
+}
+
+void AnimationLayer::cache(QGraphicsItem *item) {
+    QGraphicsObject *object = item->toGraphicsObject();
+    if (object && object->cacheMode() == QGraphicsItem::NoCache) {
+        object->setCacheMode(QGraphicsItem::ItemCoordinateCache);
+        m_items.append(object);
+    }
+    foreach (QGraphicsItem *child, item->childItems())
+        cache(child);
+}
+
+void AnimationLayer::end() {
+    foreach (const QPointer<QGraphicsObject> &object, m_items) {
+        if (object)
+            object->setCacheMode(QGraphicsItem::NoCache);
+    }
+    m_items.clear();
+}
+
 }  // end ChromeEffect namespace
 
 }  // end GVA namespace
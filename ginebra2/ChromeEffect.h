@@ -23,6 +23,9 @@
 
 #include <QColor>
 #include <QRectF>
+#include <QGraphicsItem>
+#include <QPointer>
+#include <QList>
 
 class QPainter;
 
@@ -42,6 +45,26 @@ namespace ChromeEffect {
 
     static qreal disabledOpacity = 0.65;
     static QColor disabledColor = Qt::white;
+
+    /*!
+     * Renders an item and its children into pixmaps (ItemCoordinateCache) for the
+     * length of an animation that only changes their opacity or transform, so that
+     * every frame is a blit instead of a repaint. An item that calls update()
+     * during the animation is rendered again, once. Items that already have a
+     * cache mode keep it; the others get NoCache back from end().
+     */
+    class AnimationLayer {
+    public:
+        ~AnimationLayer() { end(); }
+        void begin(QGraphicsItem *item);
+        void end();
+        bool isActive() const { return !m_items.isEmpty(); }
+
+    private:
+        void cache(QGraphicsItem *item);
+
+        QList<QPointer<QGraphicsObject> > m_items;
+    };
 }
 
 }  // end namespace GVA
@@ -25,9 +25,24 @@
 
 namespace GVA {
 
+static const int KIndexCellSize = 64;
+
+static inline int indexCell(int column, int row)
+{
+  return (row << 16) | (column & 0xffff);
+}
+
+// The part of the page the grid covers
+static inline QRect indexBounds()
+{
+  return QRect(0, 0, 0xffff * KIndexCellSize, 0xffff * KIndexCellSize);
+}
+
 ChromeRenderer::ChromeRenderer(QWebPage * chromePage, QObject * parent)
   : QObject(parent),
-    m_page(0)
+    m_page(0),
+    m_visitStamp(0),
+    m_indexDirty(true)
 
 {
   setPage(chromePage);
@@ -36,6 +51,7 @@ ChromeRenderer::ChromeRenderer(QWebPage * chromePage, QObject * parent)
   //viewPalette.setColor(QPalette::Window, Qt::transparent);
   page()->setPalette(viewPalette);
   connect(page(), SIGNAL(repaintRequested(const QRect &)), this, SLOT(repaintRequested(const QRect &)));
+  connect(page()->mainFrame(), SIGNAL(contentsSizeChanged(const QSize &)), this, SLOT(invalidateIndex()));
 }
 
 ChromeRenderer::~ChromeRenderer()
@@ -47,21 +63,94 @@ void ChromeRenderer::resize(QSizeF newSize)
 {
   page()->setPreferredContentsSize(newSize.toSize());
   page()->setViewportSize(page()->mainFrame()->contentsSize());
+  m_indexDirty = true;
   emit chromeResized();
 }
 
+// An item that moved since the last index may have had the repaint of its
+// new place walked on the old index and missed, it is rendered again whole.
+void ChromeRenderer::rebuildIndex()
+{
+  bool sameList = m_itemRects.count() == m_renderList.count();
+  m_itemRects.resize(m_renderList.count());
+  m_visited.fill(0, m_renderList.count());
+  m_visitStamp = 0;
+  m_index.clear();
+  m_unindexed.clear();
+  for (int i = 0; i < m_renderList.count(); i++) {
+    WebChromeItem * item = m_renderList.at(i);
+    QRect rect = item->elementRect().toAlignedRect();
+    if (sameList && rect != m_itemRects.at(i) && !rect.isEmpty() && !item->isPainting())
+      item->update();
+    m_itemRects[i] = rect;
+    rect = rect.intersected(indexBounds());
+    if (rect.isEmpty()) {
+      m_unindexed.append(i);
+      continue;
+    }
+    for (int row = rect.top() / KIndexCellSize; row <= rect.bottom() / KIndexCellSize; row++)
+      for (int column = rect.left() / KIndexCellSize; column <= rect.right() / KIndexCellSize; column++)
+        m_index[indexCell(column, row)].append(i);
+  }
+  m_indexDirty = false;
+}
+
 void ChromeRenderer::repaintRequested(const QRect& dirtyRect)
 {
   //qDebug() << "ChromeRenderer repaintRequested: " << dirtyRect;
-  WebChromeItem * item;    
   if(!m_renderList.isEmpty()){
-      foreach(item, m_renderList){
-          if (item->elementRect().intersects(dirtyRect) && !item->isPainting()){
-              item->update();
-          }
+      // A hidden snippet shown is in no cell, nothing would find it
+      for (int i = 0; i < m_unindexed.count() && !m_indexDirty; i++) {
+          QRect rect = m_renderList.at(m_unindexed.at(i))->elementRect().toAlignedRect();
+          if (!rect.intersected(indexBounds()).isEmpty())
+              m_indexDirty = true;
+      }
+      if (m_indexDirty)
+          rebuildIndex();
+      // A snippet can move without the contents size changing, the walk
+      // gives up on a stale rect and is run again on a fresh index
+      if (!updateItems(dirtyRect)) {
+          rebuildIndex();
+          updateItems(dirtyRect);
       }
       emit chromeRepainted(dirtyRect);
   }
 }
 
+// Only the cells under the dirty rect are looked at, and each item only has
+// the part of it that changed rendered again. Returns false, with the index
+// marked dirty, if a hit item is no longer where the index has it.
+bool ChromeRenderer::updateItems(const QRect& dirtyRect)
+{
+  QRect rect = dirtyRect.intersected(indexBounds());
+  if (rect.isEmpty())
+    return true;
+  if (++m_visitStamp == 0) {
+    m_visited.fill(0);
+    m_visitStamp = 1;
+  }
+  for (int row = rect.top() / KIndexCellSize; row <= rect.bottom() / KIndexCellSize; row++) {
+    for (int column = rect.left() / KIndexCellSize; column <= rect.right() / KIndexCellSize; column++) {
+      QHash<int, QList<int> >::const_iterator cell = m_index.constFind(indexCell(column, row));
+      if (cell == m_index.constEnd())
+        continue;
+      foreach (int i, cell.value()) {
+        if (m_visited[i] == m_visitStamp)
+          continue;
+        m_visited[i] = m_visitStamp;
+        WebChromeItem * item = m_renderList.at(i);
+        QRect itemRect = item->elementRect().toAlignedRect();
+        if (itemRect != m_itemRects.at(i)) {
+          m_indexDirty = true;
+          return false;
+        }
+        QRect itemDirty = itemRect.intersected(dirtyRect);
+        if (!itemDirty.isEmpty() && !item->isPainting())
+          item->update(QRectF(itemDirty.translated(-itemRect.topLeft())));
+      }
+    }
+  }
+  return true;
+}
+
 } // end of namespace GVA
@@ -25,6 +25,8 @@
 #include <QObject>
 #include <QWebPage>
 #include <QWebFrame>
+#include <QVector>
+#include <QHash>
 
 namespace GVA {
 
@@ -40,17 +42,32 @@ namespace GVA {
     void setPage(QWebPage * page) {m_page = page;}
     QWebFrame * frame() { if (m_page) return m_page->mainFrame(); return 0;}
     void resize(QSizeF newSize);
-    void addRenderItem(WebChromeItem * item) {m_renderList.append(item);}
-    void clearRenderList() {if(!m_renderList.isEmpty()) m_renderList.clear();}
-    void updateChromeLayout() { emit chromeResized(); }
+    void addRenderItem(WebChromeItem * item) {m_renderList.append(item); m_indexDirty = true;}
+    void clearRenderList() {if(!m_renderList.isEmpty()) m_renderList.clear(); m_indexDirty = true;}
+    void updateChromeLayout() { m_indexDirty = true; emit chromeResized(); }
   public slots:
     void repaintRequested(const QRect& dirtyRect);
+  private slots:
+    void invalidateIndex() { m_indexDirty = true; }
   signals:
     void chromeRepainted(const QRectF& rect = QRectF());
     void chromeResized();
+  private:
+    void rebuildIndex();
+    bool updateItems(const QRect& dirtyRect);
   private:
     QWebPage * m_page;
     QList<WebChromeItem*> m_renderList;
+    // Element geometries of m_renderList, and a grid of KIndexCellSize square
+    // cells listing the items that overlap each cell. Rebuilt on the first
+    // repaint after the list or the chrome layout changes, after a walk hits
+    // an item that moved, or once an item left out of the grid has a place.
+    QVector<QRect> m_itemRects;
+    QHash<int, QList<int> > m_index;
+    QVector<int> m_unindexed;
+    QVector<uint> m_visited;
+    uint m_visitStamp;
+    bool m_indexDirty;
   };
 
 } // end of namespace GVA
@@ -0,0 +1,194 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+
+#include <QApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDesktopWidget>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QGraphicsWidget>
+#include <QPainter>
+#include <QSet>
+#include <QStringList>
+#include <QStyleOptionGraphicsItem>
+
+#include "bedrockprovisioning.h"
+#include "ChromeSnapshot.h"
+
+namespace GVA {
+
+  static const quint32 KMagic = 0x47435353; // "GCSS"
+  static const quint16 KVersion = 3;
+
+  ChromeSnapshot::ChromeSnapshot(const QString &chromeDirectory)
+    : m_chromeDirectory(chromeDirectory)
+  {
+  }
+
+  QString ChromeSnapshot::fileName() const
+  {
+    return BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("DataBaseDirectory") + "chromesnapshot.dat";
+  }
+
+  QSize ChromeSnapshot::screenSize()
+  {
+    return QApplication::desktop()->screenGeometry().size();
+  }
+
+  //Names, sizes and modification times of the chrome files, in a stable order.
+  //Files in a resource (":/...") directory have no modification time, they
+  //change with the application binary, so its own are added too.
+  QByteArray ChromeSnapshot::bundleStamp() const
+  {
+    QStringList files;
+    QDirIterator it(m_chromeDirectory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+      files << it.next();
+    files.sort();
+    files << QApplication::applicationFilePath();
+
+    QByteArray stamp;
+    QDataStream stream(&stamp, QIODevice::WriteOnly);
+    foreach (const QString &path, files) {
+      QFileInfo info(path);
+      stream << path << info.size() << info.lastModified();
+    }
+    return stamp;
+  }
+
+  bool ChromeSnapshot::load()
+  {
+    m_image = QImage();
+    m_snippetRects.clear();
+
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly))
+      return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic;
+    quint16 version;
+    QByteArray stamp;
+    QSize screen;
+    QImage image;
+    QMap<QString, QRectF> rects;
+    stream >> magic >> version;
+    if (magic == KMagic && version == KVersion)
+      stream >> stamp >> screen >> image >> rects;
+    bool valid = stream.status() == QDataStream::Ok
+                 && magic == KMagic && version == KVersion
+                 && screen == screenSize()
+                 && !image.isNull()
+                 && stamp == bundleStamp();
+    file.close();
+    // Only a clean shutdown writes a new one
+    file.remove();
+    if (!valid)
+      return false;
+
+    m_image = image;
+    m_snippetRects = rects;
+    return true;
+  }
+
+  static bool zLessThan(QGraphicsItem *a, QGraphicsItem *b)
+  {
+    return a->zValue() < b->zValue();
+  }
+
+  static bool stacksBehindParent(QGraphicsItem *item)
+  {
+    return item->zValue() < 0 || (item->flags() & QGraphicsItem::ItemStacksBehindParent);
+  }
+
+  //Paints an item and its children, but nothing else the scene has under them
+  static void renderItem(QPainter *painter, QGraphicsItem *item, const QTransform &sceneToImage)
+  {
+    if (!item->isVisible() || item->effectiveOpacity() <= 0)
+      return;
+    painter->save();
+    painter->setTransform(item->sceneTransform() * sceneToImage);
+    painter->setOpacity(item->effectiveOpacity());
+    if (item->flags() & QGraphicsItem::ItemClipsChildrenToShape)
+      painter->setClipPath(item->shape(), Qt::IntersectClip);
+
+    QList<QGraphicsItem *> children = item->childItems();
+    qStableSort(children.begin(), children.end(), zLessThan);
+    foreach (QGraphicsItem *child, children) {
+      if (stacksBehindParent(child))
+        renderItem(painter, child, sceneToImage);
+    }
+    if (!(item->flags() & QGraphicsItem::ItemHasNoContents)) {
+      QStyleOptionGraphicsItem option;
+      option.exposedRect = item->boundingRect();
+      option.rect = option.exposedRect.toAlignedRect();
+      item->paint(painter, &option, 0);
+    }
+    foreach (QGraphicsItem *child, children) {
+      if (!stacksBehindParent(child))
+        renderItem(painter, child, sceneToImage);
+    }
+    painter->restore();
+  }
+
+  //snippetIds holds the element id of each of the snippets, in the same order
+  bool ChromeSnapshot::save(QGraphicsWidget *layout, const QList<QGraphicsWidget *> &snippets,
+                            const QStringList &snippetIds)
+  {
+    QSize size = layout->size().toSize();
+    if (size.isEmpty() || snippets.count() != snippetIds.count())
+      return false;
+
+    //Only the snippets are drawn, the content view under them is left blank.
+    //A snippet nested in another one is drawn with it.
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(Qt::white).rgba());
+    QSet<QGraphicsItem *> snippetItems;
+    foreach (QGraphicsWidget *widget, snippets)
+      snippetItems.insert(widget);
+    QTransform sceneToImage = layout->sceneTransform().inverted();
+    QMap<QString, QRectF> rects;
+    QPainter painter(&image);
+    for (int i = 0; i < snippets.count(); i++) {
+      QGraphicsWidget *widget = snippets.at(i);
+      rects.insert(snippetIds.at(i), layout->mapRectFromScene(widget->sceneBoundingRect()));
+      bool nested = false;
+      for (QGraphicsItem *parent = widget->parentItem(); parent && !nested; parent = parent->parentItem())
+        nested = snippetItems.contains(parent);
+      if (!nested)
+        renderItem(&painter, widget, sceneToImage);
+    }
+    painter.end();
+
+    QFile file(fileName());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+      return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << KMagic << KVersion << bundleStamp() << screenSize() << image << rects;
+    return stream.status() == QDataStream::Ok;
+  }
+
+} // end of namespace GVA
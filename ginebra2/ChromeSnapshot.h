@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+
+#ifndef _GINEBRA_CHROME_SNAPSHOT_H_
+#define _GINEBRA_CHROME_SNAPSHOT_H_
+
+#include <QImage>
+#include <QList>
+#include <QMap>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+
+class QGraphicsWidget;
+
+namespace GVA {
+
+  /*!
+   * \brief The chrome as it looked at the last clean shutdown.
+   *
+   * save() renders the visible snippet widgets, each on its own, into a
+   * bitmap and records their geometry by element id. At the next launch
+   * load() gives back that bitmap and table so they can be shown while the
+   * chrome page is parsed and laid out. The live chrome replaces them once
+   * complete.
+   *
+   * The snapshot only counts if it was taken with the same chrome bundle
+   * (names, sizes and modification times of the files under the chrome
+   * directory, and of the application binary for resource bundles) and the
+   * same screen size. load() removes the file, so a crash never leaves one
+   * behind.
+   */
+  class ChromeSnapshot
+  {
+  public:
+    ChromeSnapshot(const QString &chromeDirectory);
+
+    bool load();
+    bool save(QGraphicsWidget *layout, const QList<QGraphicsWidget *> &snippets,
+              const QStringList &snippetIds);
+
+    const QImage &image() const { return m_image; }
+    const QMap<QString, QRectF> &snippetRects() const { return m_snippetRects; }
+
+  private:
+    QString fileName() const;
+    QByteArray bundleStamp() const;
+    static QSize screenSize();
+
+  private:
+    QString m_chromeDirectory;
+    QImage m_image;
+    QMap<QString, QRectF> m_snippetRects;
+  };
+
+} // end of namespace GVA
+
+#endif
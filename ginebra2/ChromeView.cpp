@@ -170,6 +170,9 @@ bool ChromeView::event(QEvent* event)
     {
         case QEvent::Gesture:
         {
+#ifdef ENABLE_PERF_TRACE
+            PERF_TRACE_SCOPE(Gesture, "ChromeView::gestureEvent");
+#endif
             ret = qstmDeliverGestureEventToGraphicsItem(this, event);
             break;
               }
@@ -75,6 +75,10 @@
 
 #include "GAlternateFileChooser.h"
 
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
+
 namespace GVA {
 
 // -----------------------------
@@ -312,6 +316,9 @@ namespace GVA {
     if (!ok) {
       return;
     }
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Chrome, "ChromeWidget::loadFinished");
+#endif
     if (!m_renderer)
       m_renderer = new ChromeRenderer(m_page, this);
     m_renderer->resize(m_layout->size());
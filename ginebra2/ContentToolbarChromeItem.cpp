@@ -89,12 +89,35 @@ namespace GVA {
     emit  updateVisibility(step);
   }
 
+  /*!
+   * The background of the full toolbar. It is a cached child of the toolbar,
+   * so fading it in or out only changes its opacity and every step of the
+   * fade is a blit. It stays under the toolbar's snippets.
+   */
+  class ContentToolbarBackground : public QGraphicsItem
+  {
+    public:
+      ContentToolbarBackground(ContentToolbarChromeItem* toolbar)
+          : QGraphicsItem(toolbar), m_toolbar(toolbar) {
+          setCacheMode(QGraphicsItem::ItemCoordinateCache);
+          setAcceptedMouseButtons(Qt::NoButton);
+          setZValue(-1);
+      }
+
+      QRectF boundingRect() const { return m_toolbar->boundingRect(); }
+      void paint(QPainter* painter, const QStyleOptionGraphicsItem* opt, QWidget* widget) {
+          m_toolbar->paintFullBackground(painter, opt, widget);
+      }
+      void toolbarResized() { prepareGeometryChange(); }
+
+    private:
+      ContentToolbarChromeItem* m_toolbar;
+  };
+
   ContentToolbarChromeItem::ContentToolbarChromeItem(ChromeSnippet* snippet, QGraphicsItem* parent)
       : ToolbarChromeItem(snippet, parent),
 #if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
       m_backgroundPainter(0),
-      m_backgroundPixmap(0),
-      m_backgroundDirty(true),
 #else
       m_background(NULL),
 #endif
@@ -111,6 +134,8 @@ namespace GVA {
     connect(m_animator, SIGNAL(finished()), this, SLOT(onAnimFinished()));
     
     m_maxOpacity = m_bgopacity = opacity();   
+    m_fullBackground = new ContentToolbarBackground(this);
+    m_fullBackground->setOpacity(m_bgopacity);
     if (m_autoHideToolbar ) {
        connect(m_snippet->chrome(), SIGNAL(chromeComplete()), this, SLOT(onChromeComplete()));
     }
@@ -150,7 +175,6 @@ namespace GVA {
 
 #if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
     delete m_backgroundPainter;
-    delete m_backgroundPixmap;
 #else
     if (m_background )
         delete m_background;
@@ -166,9 +190,7 @@ namespace GVA {
     //qDebug() << __PRETTY_FUNCTION__ << boundingRect();
     ToolbarChromeItem::resizeEvent(ev);
     addFullBackground();
-#if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
-    m_backgroundDirty = true;
-#endif
+    m_fullBackground->toolbarResized();
   }
 
   void ContentToolbarChromeItem::mousePressEvent(QGraphicsSceneMouseEvent * ev)  {
@@ -199,52 +221,52 @@ namespace GVA {
     Q_UNUSED(widget)
 
 //    qDebug() << __PRETTY_FUNCTION__ << m_state;
-    painter->save();
-
-    painter->setRenderHint(QPainter::Antialiasing);
-
-    painter->setPen(pen());
-    painter->setOpacity(m_bgopacity);
-
+    // The full background is m_fullBackground's
     switch (m_state) {
         case CONTENT_TOOLBAR_STATE_PARTIAL:
-          ToolbarChromeItem::paint(painter, opt, widget);
-          break;
         case CONTENT_TOOLBAR_STATE_ANIM_TO_FULL:
-          // intentional fall through  
         case CONTENT_TOOLBAR_STATE_ANIM_TO_PARTIAL:
           ToolbarChromeItem::paint(painter, opt, widget);
-          // intentional fall through
+          break;
         case CONTENT_TOOLBAR_STATE_FULL:
-#if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
-          if(m_backgroundDirty) {
-              updateBackgroundPixmap(geometry().size().toSize(), widget);
-              m_backgroundPainter->unloadPixmaps();
-          }
-          painter->drawPixmap(opt->exposedRect, *m_backgroundPixmap, opt->exposedRect);
-#else
-          // fill path with color
-          painter->fillPath(*m_background,QBrush(grad()));
-          painter->drawPath(*m_background);
-#endif
-          if(m_state == CONTENT_TOOLBAR_STATE_FULL && !isEnabled()) {
-              // Disabled, apply whitewash.
-              ChromeEffect::paintDisabledRect(painter, opt->exposedRect);
-          }
           break;
         default:
           qDebug() << "ContentToolbarChromeItem::paint invalid state" ;
           break;
     }
+  }
+
+  void ContentToolbarChromeItem::paintFullBackground(QPainter* painter, const QStyleOptionGraphicsItem* opt, QWidget* widget) {
+
+    painter->save();
+
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    painter->setPen(pen());
+
+#if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
+    // composed once per size by the painter
+    painter->setClipRect(opt->exposedRect);
+    m_backgroundPainter->paint(painter, QRect(QPoint(0, 0), geometry().size().toSize()), widget);
+#else
+    Q_UNUSED(widget)
+    // fill path with color
+    painter->fillPath(*m_background,QBrush(grad()));
+    painter->drawPath(*m_background);
+#endif
+    if(m_state == CONTENT_TOOLBAR_STATE_FULL && !isEnabled()) {
+        // Disabled, apply whitewash.
+        ChromeEffect::paintDisabledRect(painter, opt->exposedRect);
+    }
     // restore painter
     painter->restore();
-
   }
 
 
   void ContentToolbarChromeItem::setSnippet(ChromeSnippet* snippet) {
     ToolbarChromeItem::setSnippet(snippet);
     m_maxOpacity = m_bgopacity = opacity();
+    m_fullBackground->setOpacity(m_bgopacity);
     
     if (m_autoHideToolbar ) {
         connect(snippet->chrome(), SIGNAL(chromeComplete()), this, SLOT(onChromeComplete()));
@@ -384,12 +406,12 @@ namespace GVA {
     qreal value = step - (1.0 - m_maxOpacity);
     value =  (value > 0)? value: 0.0;
 
+    // Both are cached, a step only blits them at the new opacity
     if (m_bgopacity != value ) {
       m_bgopacity = value;
-      setOpacity(m_maxOpacity - value);
+      m_fullBackground->setOpacity(value);
       ContentToolbarSnippet * s = static_cast<ContentToolbarSnippet*>(m_snippet);
       s->middleSnippet()->widget()->setOpacity(value);
-      update();
     }
   }
 
@@ -432,17 +454,6 @@ namespace GVA {
 #endif
   }
 
-#if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
-	  void ContentToolbarChromeItem::updateBackgroundPixmap(const QSize &size, QWidget* widget) {
-      delete m_backgroundPixmap;
-      m_backgroundPixmap = new QPixmap(size);
-      m_backgroundPixmap->fill(QColor(0xff, 0xff, 0xff, 0));
-      QPainter painter(m_backgroundPixmap);
-      m_backgroundPainter->paint(&painter, QRect(0, 0, size.width(), size.height()), widget);
-      m_backgroundDirty = false;
-  }
-#endif
-
   void ContentToolbarChromeItem::stateEnterFull(bool animate) {
 
     //qDebug() <<__PRETTY_FUNCTION__ ;
@@ -458,11 +469,16 @@ namespace GVA {
       s->middleSnippet()->show();
     }
 
+    m_middleLayer.end();
     m_state = CONTENT_TOOLBAR_STATE_FULL;
     s->middleSnippet()->widget()->setOpacity(1.0);
     s->handleToolbarStateChange(m_state);
-    // TODO: specify the rect to be updated to avoid full repaint
+    // the toolbar no longer paints the partial background; the full one
+    // may need the whitewash now
     update();
+    m_fullBackground->setOpacity(m_bgopacity);
+    m_fullBackground->show();
+    m_fullBackground->update();
   }
 
   void ContentToolbarChromeItem::stateEnterPartial(bool animate) {
@@ -475,7 +491,9 @@ namespace GVA {
     // signals that it is expecting
     hideLinkedChildren();
 
+    m_middleLayer.end();
     s->middleSnippet()->hide();
+    m_fullBackground->hide();
     m_state = CONTENT_TOOLBAR_STATE_PARTIAL;
 #if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
     s->handleToolbarStateChange(m_state);
@@ -489,15 +507,23 @@ namespace GVA {
     ContentToolbarSnippet * s = static_cast<ContentToolbarSnippet*>(m_snippet);
 
     m_state = CONTENT_TOOLBAR_STATE_ANIM_TO_FULL;
+    update();
     s->middleSnippet()->show();
+    m_fullBackground->setOpacity(m_bgopacity);
+    m_fullBackground->show();
+    m_middleLayer.begin(s->middleSnippet()->widget());
     m_animator->start(false);
 
   }
 
   void ContentToolbarChromeItem::stateEnterAnimToPartial(bool animate) {
     m_state = CONTENT_TOOLBAR_STATE_ANIM_TO_PARTIAL;
+    update();
+    m_fullBackground->update();
 
     if (animate ) {
+      ContentToolbarSnippet * s = static_cast<ContentToolbarSnippet*>(m_snippet);
+      m_middleLayer.begin(s->middleSnippet()->widget());
       m_animator->start(true);
     }
     else {
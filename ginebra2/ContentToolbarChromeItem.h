@@ -25,12 +25,14 @@
 #include <QtGui>
 #include "Toolbar.h"
 #include "ToolbarChromeItem.h"
+#include "ChromeEffect.h"
 
 class QTimeLine;
 class QTimer;
 
 namespace GVA {
   class GWebContentView;
+  class ContentToolbarBackground;
 
   class ToolbarFadeAnimator: public QObject
   {
@@ -60,6 +62,7 @@ namespace GVA {
   class ContentToolbarChromeItem : public ToolbarChromeItem
   {
     Q_OBJECT
+    friend class ContentToolbarBackground;
 
     public:
       ContentToolbarChromeItem(ChromeSnippet* snippet, QGraphicsItem* parent = 0);
@@ -104,6 +107,7 @@ namespace GVA {
 
     private:
       void addFullBackground();
+      void paintFullBackground(QPainter* painter, const QStyleOptionGraphicsItem* opt, QWidget* widget);
 #if !defined(BROWSER_LAYOUT_TENONE) && !defined(Q_WS_MAEMO_5)
       void changeState( ContentToolbarState state, bool animate = false);
 #endif
@@ -117,15 +121,13 @@ namespace GVA {
       void  stateEnterAnimToPartial(bool animate =false);
       void  stateEnterAnimToFull(bool animate =false);
 
-#if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
-      void updateBackgroundPixmap(const QSize &size, QWidget* widget);
-#endif
-
       ToolbarFadeAnimator * m_animator;
+      // middle snippet, cached while it fades in or out
+      ChromeEffect::AnimationLayer m_middleLayer;
+      // full background, faded in and out at m_bgopacity
+      ContentToolbarBackground* m_fullBackground;
 #if defined(Q_WS_MAEMO_5) || defined(BROWSER_LAYOUT_TENONE)
       class ScaleNinePainter *m_backgroundPainter;
-      QPixmap *m_backgroundPixmap;
-      bool m_backgroundDirty;
 #else
       QPainterPath* m_background;
 #endif
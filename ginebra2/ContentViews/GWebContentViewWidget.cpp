@@ -426,17 +426,13 @@ void GWebContentViewWidget::paint(QPainter* painter, const QStyleOptionGraphicsI
         }
 #ifdef ENABLE_PERF_TRACE
     PERF_DEBUG() << "GWebContentViewWidget::paint: " << clipRect << "\n";
-    unsigned int st = WrtPerfTracer::tracer()->startTimer();
+    PERF_TRACE_SCOPE(Paint, "GWebContentViewWidget::paint");
 #endif
 
     //painter->fillRect(clipRect, QColor(255, 255, 255));
     if (!m_inLoading || !(m_loadingTime.elapsed() < 750)) {
         QGraphicsWebView::paint(painter, options, widget);
     }
-#ifdef ENABLE_PERF_TRACE
-    PERF_DEBUG() << "GWebContentViewWidget::paint__end: " <<
-        WrtPerfTracer::tracer()->elapsedTime(st) << "\n";
-#endif
 
 
 }
@@ -448,7 +444,7 @@ void GWebContentViewWidget::paint(QPainter* painter, const QStyleOptionGraphicsI
 
 #ifdef ENABLE_PERF_TRACE
     PERF_DEBUG() << "GWebContentViewWidget::paint: " << option->exposedRect << "\n";
-    unsigned int st = WrtPerfTracer::tracer()->startTimer();
+    PERF_TRACE_SCOPE(Paint, "GWebContentViewWidget::paint");
 #endif
     //qDebug() << "GWebContentViewWidget::paint";
     if (frozen() && m_frozenPixmap) {
@@ -528,10 +524,6 @@ void GWebContentViewWidget::paint(QPainter* painter, const QStyleOptionGraphicsI
         // Disabled, apply whitewash.
         ChromeEffect::paintDisabledRect(painter, option->exposedRect);
     }
-#ifdef ENABLE_PERF_TRACE
-    PERF_DEBUG() << "GWebContentViewWidget::paint__end: " <<
-        WrtPerfTracer::tracer()->elapsedTime(st) << "\n";
-#endif
 }
 #endif //NO_RESIZE_ON_LOAD
 
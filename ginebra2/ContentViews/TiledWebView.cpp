@@ -9,6 +9,10 @@
 #include <QGraphicsView>
 #include <QGraphicsSceneResizeEvent>
 
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
+
 
 
 const int cTileSize = 64;
@@ -303,6 +307,9 @@ QList<QPoint> TiledWebView::findTileLine4Update(bool dirty, bool inView, bool us
 
 QRectF TiledWebView::updateTile(const QPoint& t)
 {
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Tiling, "TiledWebView::updateTile");
+#endif
     m_inUpdate = true;
     Tile* tile = tileAt(t);
     if(!tile) tile = createTile(t);
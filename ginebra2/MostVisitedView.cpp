@@ -27,6 +27,17 @@ MostVisitedViewItem::MostVisitedViewItem(::MostVisitedPage *mostVisitedPage, QGr
 {
     grabGesture(QStm_Gesture::assignedType());
     installEventFilter(this);
+    safe_connect(m_mostVisitedPage, SIGNAL(thumbnailChanged()), this, SLOT(onThumbnailChanged()));
+}
+
+void MostVisitedViewItem::resizeEvent(QGraphicsSceneResizeEvent * event) {
+    QGraphicsWidget::resizeEvent(event);
+    m_pixmap = QPixmap();
+}
+
+void MostVisitedViewItem::onThumbnailChanged() {
+    m_pixmap = QPixmap();
+    update();
 }
 
 void MostVisitedViewItem::activate() {
@@ -40,9 +51,12 @@ void MostVisitedViewItem::activate() {
 }
 
 void MostVisitedViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
-    if(m_mostVisitedPage->m_pageThumbnail) {
-        QPixmap pixmap(QPixmap::fromImage(*m_mostVisitedPage->m_pageThumbnail).scaled(size().toSize()));
-        painter->drawPixmap(option->exposedRect, pixmap, option->exposedRect);
+    if(m_pixmap.isNull() && m_mostVisitedPage->pageThumbnail()) {
+        QImage image = m_mostVisitedPage->pageThumbnail()->scaled(size().toSize(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        m_pixmap = QPixmap::fromImage(image);
+    }
+    if(!m_pixmap.isNull()) {
+        painter->drawPixmap(option->exposedRect, m_pixmap, option->exposedRect);
         
         QPen pen;
         int x, y, w, h;
@@ -99,8 +113,6 @@ MostVisitedView::MostVisitedView(const QString &title, QGraphicsItem *parent)
       m_layout(new QGraphicsLinearLayout(Qt::Vertical, this)),
       m_title(0),
       m_gridView(new GridView(this)),
-      m_backgroundPixmap(0),
-      m_backgroundDirty(true),
       m_titleWrapper(new QGraphicsWidget(this))
       
 {
@@ -144,7 +156,6 @@ MostVisitedView::MostVisitedView(const QString &title, QGraphicsItem *parent)
 
 MostVisitedView::~MostVisitedView() {
     delete m_backgroundPainter;
-    delete m_backgroundPixmap;
 }
 
 void MostVisitedView::update(QString mode) {
@@ -165,8 +176,6 @@ void MostVisitedView::update(QString mode) {
 void MostVisitedView::resizeEvent(QGraphicsSceneResizeEvent * event) {
 	  
     m_gridView->resize(event->newSize());  
-    // Force background update on next paint().
-    m_backgroundDirty = true;
 }
 
 void MostVisitedView::closeEvent(QCloseEvent *event) {
@@ -197,27 +206,11 @@ void MostVisitedView::paint(QPainter *painter, const QStyleOptionGraphicsItem *o
     m_gridView->rebuildLayout();
     #endif
     
-    #ifndef Q_WS_MAEMO_5   
-    updateBackgroundPixmap(geometry().size().toSize(), widget);    	
-    m_backgroundPainter->unloadPixmaps();
-    #else
-    if(m_backgroundDirty) {    	
-     	updateBackgroundPixmap(geometry().size().toSize(), widget);    	
-      m_backgroundPainter->unloadPixmaps();
-    }
-    #endif
-
-    // Paint the background.
-    painter->drawPixmap(option->exposedRect, *m_backgroundPixmap, option->exposedRect);
-}
-
-void MostVisitedView::updateBackgroundPixmap(const QSize &size, QWidget* widget) {
-    delete m_backgroundPixmap;
-    m_backgroundPixmap = new QPixmap(size);
-    m_backgroundPixmap->fill(QColor(0xff, 0xff, 0xff, 0));
-    QPainter painter(m_backgroundPixmap);
-    m_backgroundPainter->paint(&painter, QRect(0, 0, size.width(), size.height()), widget);
-    m_backgroundDirty = false;
+    // Paint the background, the painter composes it once per size.
+    painter->save();
+    painter->setClipRect(option->exposedRect);
+    m_backgroundPainter->paint(painter, QRect(QPoint(0, 0), geometry().size().toSize()), widget);
+    painter->restore();
 }
 
 void MostVisitedView::onItemActivated() {
@@ -44,8 +44,14 @@ private:
         #endif
     }
     virtual void paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget = 0);   
+    virtual void resizeEvent(QGraphicsSceneResizeEvent * event);
+
+private slots:
+    void onThumbnailChanged();
+
 private:
     MostVisitedPage *m_mostVisitedPage;
+    QPixmap m_pixmap;   // thumbnail scaled to the item size, null when out of date
 };
 
 // --------------------------------------------
@@ -68,15 +74,11 @@ private:
     virtual void paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget = 0);
     virtual void closeEvent(QCloseEvent * event);
 
-    void updateBackgroundPixmap(const QSize &size, QWidget* widget);
-
 private:
     QGraphicsLinearLayout *m_layout;
     QGraphicsSimpleTextItem *m_title;
     GridView *m_gridView;
     ScaleThreePainter *m_backgroundPainter;
-    QPixmap *m_backgroundPixmap;
-    bool m_backgroundDirty;
     QString m_displayMode;
     QGraphicsWidget *m_titleWrapper;
 };
@@ -3,6 +3,19 @@
 
 namespace GVA {
 
+// The pieces of a skin are decoded once and shared by all the painters using it
+static QPixmap sharedPixmap(const QString &filename) {
+    QPixmap pixmap;
+    if(filename.isEmpty())
+        return pixmap;
+    QString key = QLatin1String("Skin:") + filename;
+    if(!QPixmapCache::find(key, &pixmap)) {
+        pixmap.load(filename);
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
+}
+
 ScaleNinePainter::ScaleNinePainter(
       const QString &topLeftFilename,
       const QString &topMiddleFilename,
@@ -22,17 +35,13 @@ ScaleNinePainter::ScaleNinePainter(
           m_bottomLeftFilename(bottomLeftFilename),
           m_bottomMiddleFilename(bottomMiddleFilename),
           m_bottomRightFilename(bottomRightFilename),
-          m_topLeftPixmap(0),
-          m_topMiddlePixmap(0),
-          m_topRightPixmap(0),
-          m_middleLeftPixmap(0),
-          m_middleMiddlePixmap(0),
-          m_middleRightPixmap(0),
-          m_bottomLeftPixmap(0),
-          m_bottomMiddlePixmap(0),
-          m_bottomRightPixmap(0),
           m_pixmapsLoaded(false)
 {
+    m_cacheKey = QLatin1String("ScaleNine:") + m_topLeftFilename
+            + QLatin1Char('|') + m_topMiddleFilename + QLatin1Char('|') + m_topRightFilename
+            + QLatin1Char('|') + m_middleLeftFilename + QLatin1Char('|') + m_middleMiddleFilename
+            + QLatin1Char('|') + m_middleRightFilename + QLatin1Char('|') + m_bottomLeftFilename
+            + QLatin1Char('|') + m_bottomMiddleFilename + QLatin1Char('|') + m_bottomRightFilename;
 }
 
 ScaleNinePainter::~ScaleNinePainter() {
@@ -41,103 +50,124 @@ ScaleNinePainter::~ScaleNinePainter() {
 
 void ScaleNinePainter::loadPixmaps() {
     Q_ASSERT(!m_pixmapsLoaded);
-    m_topLeftPixmap = new QPixmap(m_topLeftFilename);
-    m_topMiddlePixmap = new QPixmap(m_topMiddleFilename);
-    m_topRightPixmap = new QPixmap(m_topRightFilename);
-    m_middleLeftPixmap = new QPixmap(m_middleLeftFilename);
-    m_middleMiddlePixmap = new QPixmap(m_middleMiddleFilename);
-    m_middleRightPixmap = new QPixmap(m_middleRightFilename);
-    m_bottomLeftPixmap = new QPixmap(m_bottomLeftFilename);
-    m_bottomMiddlePixmap = new QPixmap(m_bottomMiddleFilename);
-    m_bottomRightPixmap = new QPixmap(m_bottomRightFilename);
+    m_topLeftPixmap = sharedPixmap(m_topLeftFilename);
+    m_topMiddlePixmap = sharedPixmap(m_topMiddleFilename);
+    m_topRightPixmap = sharedPixmap(m_topRightFilename);
+    m_middleLeftPixmap = sharedPixmap(m_middleLeftFilename);
+    m_middleMiddlePixmap = sharedPixmap(m_middleMiddleFilename);
+    m_middleRightPixmap = sharedPixmap(m_middleRightFilename);
+    m_bottomLeftPixmap = sharedPixmap(m_bottomLeftFilename);
+    m_bottomMiddlePixmap = sharedPixmap(m_bottomMiddleFilename);
+    m_bottomRightPixmap = sharedPixmap(m_bottomRightFilename);
     m_pixmapsLoaded = true;
 }
 
 void ScaleNinePainter::unloadPixmaps() {
-    delete m_topLeftPixmap; m_topLeftPixmap = 0;
-    delete m_topMiddlePixmap; m_topMiddlePixmap = 0;
-    delete m_topRightPixmap; m_topRightPixmap = 0;
-    delete m_middleLeftPixmap; m_middleLeftPixmap = 0;
-    delete m_middleMiddlePixmap; m_middleMiddlePixmap = 0;
-    delete m_middleRightPixmap; m_middleRightPixmap = 0;
-    delete m_bottomLeftPixmap; m_bottomLeftPixmap = 0;
-    delete m_bottomMiddlePixmap; m_bottomMiddlePixmap = 0;
-    delete m_bottomRightPixmap; m_bottomRightPixmap = 0;
+    m_topLeftPixmap = QPixmap();
+    m_topMiddlePixmap = QPixmap();
+    m_topRightPixmap = QPixmap();
+    m_middleLeftPixmap = QPixmap();
+    m_middleMiddlePixmap = QPixmap();
+    m_middleRightPixmap = QPixmap();
+    m_bottomLeftPixmap = QPixmap();
+    m_bottomMiddlePixmap = QPixmap();
+    m_bottomRightPixmap = QPixmap();
     m_pixmapsLoaded = false;
 }
 
 void ScaleNinePainter::paint(QPainter* painter, const QRect &rect, QWidget* widget) {
     Q_UNUSED(widget)
 
-    if(!m_pixmapsLoaded)
-        loadPixmaps();
+    if(rect.isEmpty())
+        return;
+
+    // Compose the pieces once per size, later paints are a single blit.  The
+    // result is shared with the other painters using the same skin and goes
+    // away with the rest of QPixmapCache when its budget runs out.
+    QPixmap composed;
+    QString key = m_cacheKey + QString("@%1x%2").arg(rect.width()).arg(rect.height());
+    if(!QPixmapCache::find(key, &composed)) {
+        if(!m_pixmapsLoaded)
+            loadPixmaps();
+        composed = QPixmap(rect.size());
+        composed.fill(Qt::transparent);
+        QPainter composer(&composed);
+        paintPieces(&composer, QRect(QPoint(0, 0), rect.size()));
+        composer.end();
+        QPixmapCache::insert(key, composed);
+        // the pieces stay in QPixmapCache for the next size
+        unloadPixmaps();
+    }
+    painter->drawPixmap(rect.topLeft(), composed);
+}
 
+void ScaleNinePainter::paintPieces(QPainter* painter, const QRect &rect) {
     painter->save();
 
     // Draw top left.
-    if(m_topLeftPixmap->height() > rect.height())
-        painter->drawPixmap(0, 0, m_topLeftPixmap->width(), rect.height(), *m_topLeftPixmap);
+    if(m_topLeftPixmap.height() > rect.height())
+        painter->drawPixmap(0, 0, m_topLeftPixmap.width(), rect.height(), m_topLeftPixmap);
     else
-        painter->drawPixmap(0, 0, *m_topLeftPixmap);
+        painter->drawPixmap(0, 0, m_topLeftPixmap);
 
     // Draw top middle.
-    if(!m_topMiddlePixmap->isNull()) {
-        painter->drawTiledPixmap(m_topLeftPixmap->width(),
+    if(!m_topMiddlePixmap.isNull()) {
+        painter->drawTiledPixmap(m_topLeftPixmap.width(),
                                  0,
-                                 rect.width() - (m_topLeftPixmap->width() + m_topRightPixmap->width()),
-                                 qMin(m_topMiddlePixmap->height(), rect.height()),
-                                 *m_topMiddlePixmap);
+                                 rect.width() - (m_topLeftPixmap.width() + m_topRightPixmap.width()),
+                                 qMin(m_topMiddlePixmap.height(), rect.height()),
+                                 m_topMiddlePixmap);
     }
 
     // Draw top right.
-    painter->drawPixmap(rect.right() - m_topRightPixmap->width() + 1, 0, *m_topRightPixmap);
+    painter->drawPixmap(rect.right() - m_topRightPixmap.width() + 1, 0, m_topRightPixmap);
 
     // Draw left border.
-    if(!m_middleLeftPixmap->isNull()) {
+    if(!m_middleLeftPixmap.isNull()) {
         painter->drawTiledPixmap(0,
-                                 m_topLeftPixmap->height(),
-                                 m_middleMiddlePixmap->width(),
-                                 rect.height() - (m_topLeftPixmap->height() + m_bottomLeftPixmap->height()),
-                                 *m_middleLeftPixmap);
+                                 m_topLeftPixmap.height(),
+                                 m_middleMiddlePixmap.width(),
+                                 rect.height() - (m_topLeftPixmap.height() + m_bottomLeftPixmap.height()),
+                                 m_middleLeftPixmap);
     }
 
     // Draw middle.
-    if(!m_middleMiddlePixmap->isNull()) {
+    if(!m_middleMiddlePixmap.isNull()) {
         QRect middleRect; 
-        middleRect.setLeft(m_middleLeftPixmap->isNull() ? m_topLeftPixmap->width() : m_topLeftPixmap->width());
-        middleRect.setRight(rect.width() - (m_middleRightPixmap->isNull() ? m_topRightPixmap->width() : m_topRightPixmap->width()) - 1);
-        middleRect.setTop(m_topMiddlePixmap->isNull() ? m_topLeftPixmap->height() : m_topMiddlePixmap->height());
-        middleRect.setBottom(rect.height() - (m_bottomMiddlePixmap->isNull() ? m_bottomLeftPixmap->height() : m_bottomMiddlePixmap->height()) - 1);
-        painter->drawTiledPixmap(middleRect, *m_middleMiddlePixmap);
+        middleRect.setLeft(m_middleLeftPixmap.isNull() ? m_topLeftPixmap.width() : m_topLeftPixmap.width());
+        middleRect.setRight(rect.width() - (m_middleRightPixmap.isNull() ? m_topRightPixmap.width() : m_topRightPixmap.width()) - 1);
+        middleRect.setTop(m_topMiddlePixmap.isNull() ? m_topLeftPixmap.height() : m_topMiddlePixmap.height());
+        middleRect.setBottom(rect.height() - (m_bottomMiddlePixmap.isNull() ? m_bottomLeftPixmap.height() : m_bottomMiddlePixmap.height()) - 1);
+        painter->drawTiledPixmap(middleRect, m_middleMiddlePixmap);
     }
 
     // Draw right border.
-    if(!m_middleRightPixmap->isNull()) {
-        painter->drawTiledPixmap(rect.width() - m_middleRightPixmap->width(),
-                                 m_topRightPixmap->height(),
-                                 m_middleRightPixmap->width(),
-                                 rect.height() - (m_topRightPixmap->height() + m_bottomRightPixmap->height()),
-                                 *m_middleRightPixmap);
+    if(!m_middleRightPixmap.isNull()) {
+        painter->drawTiledPixmap(rect.width() - m_middleRightPixmap.width(),
+                                 m_topRightPixmap.height(),
+                                 m_middleRightPixmap.width(),
+                                 rect.height() - (m_topRightPixmap.height() + m_bottomRightPixmap.height()),
+                                 m_middleRightPixmap);
     }
 
     // Draw bottom row.
-    if(!m_bottomLeftPixmap->isNull()) {
+    if(!m_bottomLeftPixmap.isNull()) {
         painter->drawPixmap(0,
-                            rect.bottom() - m_bottomLeftPixmap->height() + 1,
-                            *m_bottomLeftPixmap);
+                            rect.bottom() - m_bottomLeftPixmap.height() + 1,
+                            m_bottomLeftPixmap);
     }
-    if(!m_bottomMiddlePixmap->isNull()) {
+    if(!m_bottomMiddlePixmap.isNull()) {
         QRect bottomRect;
-        bottomRect.setLeft(m_bottomLeftPixmap->width());
-        bottomRect.setRight(rect.width() - m_bottomRightPixmap->width() - 1);
-        bottomRect.setTop(rect.bottom() - m_bottomMiddlePixmap->height() + 1);
+        bottomRect.setLeft(m_bottomLeftPixmap.width());
+        bottomRect.setRight(rect.width() - m_bottomRightPixmap.width() - 1);
+        bottomRect.setTop(rect.bottom() - m_bottomMiddlePixmap.height() + 1);
         bottomRect.setBottom(rect.bottom());
-        painter->drawTiledPixmap(bottomRect, *m_bottomMiddlePixmap);
+        painter->drawTiledPixmap(bottomRect, m_bottomMiddlePixmap);
     }
-    if(!m_bottomRightPixmap->isNull()) {
-        painter->drawPixmap(rect.right() - m_bottomLeftPixmap->width() + 1,
-                            rect.bottom() - m_bottomRightPixmap->height() + 1,
-                            *m_bottomRightPixmap);
+    if(!m_bottomRightPixmap.isNull()) {
+        painter->drawPixmap(rect.right() - m_bottomLeftPixmap.width() + 1,
+                            rect.bottom() - m_bottomRightPixmap.height() + 1,
+                            m_bottomRightPixmap);
     }
     painter->restore();
 }
@@ -33,6 +33,7 @@ public:
 
 private:
     void loadPixmaps();
+    void paintPieces(QPainter* painter, const QRect &rect);
 
 private:
     QString m_topLeftFilename;
@@ -44,16 +45,17 @@ private:
     QString m_bottomLeftFilename;
     QString m_bottomMiddleFilename;
     QString m_bottomRightFilename;
-    QPixmap *m_topLeftPixmap;
-    QPixmap *m_topMiddlePixmap;
-    QPixmap *m_topRightPixmap;
-    QPixmap *m_middleLeftPixmap;
-    QPixmap *m_middleMiddlePixmap;
-    QPixmap *m_middleRightPixmap;
-    QPixmap *m_bottomLeftPixmap;
-    QPixmap *m_bottomMiddlePixmap;
-    QPixmap *m_bottomRightPixmap;
+    QPixmap m_topLeftPixmap;
+    QPixmap m_topMiddlePixmap;
+    QPixmap m_topRightPixmap;
+    QPixmap m_middleLeftPixmap;
+    QPixmap m_middleMiddlePixmap;
+    QPixmap m_middleRightPixmap;
+    QPixmap m_bottomLeftPixmap;
+    QPixmap m_bottomMiddlePixmap;
+    QPixmap m_bottomRightPixmap;
     bool m_pixmapsLoaded;
+    QString m_cacheKey;
 };
 
 }  // GVA namespace
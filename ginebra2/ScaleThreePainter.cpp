@@ -3,6 +3,19 @@
 
 namespace GVA {
 
+// The pieces of a skin are decoded once and shared by all the painters using it
+static QPixmap sharedPixmap(const QString &filename) {
+    QPixmap pixmap;
+    if(filename.isEmpty())
+        return pixmap;
+    QString key = QLatin1String("Skin:") + filename;
+    if(!QPixmapCache::find(key, &pixmap)) {
+        pixmap.load(filename);
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
+}
+
 ScaleThreePainter::ScaleThreePainter(
       const QString &leftFilename,
       const QString &middleFilename,
@@ -10,11 +23,9 @@ ScaleThreePainter::ScaleThreePainter(
         : m_leftFilename(leftFilename),
           m_middleFilename(middleFilename),
           m_rightFilename(rightFilename),
-          m_leftPixmap(0),
-          m_middlePixmap(0),
-          m_rightPixmap(0),
           m_pixmapsLoaded(false)
 {
+    m_cacheKey = QLatin1String("ScaleThree:") + m_leftFilename + QLatin1Char('|') + m_middleFilename + QLatin1Char('|') + m_rightFilename;
 }
 
 ScaleThreePainter::~ScaleThreePainter() {
@@ -23,49 +34,70 @@ ScaleThreePainter::~ScaleThreePainter() {
 
 void ScaleThreePainter::loadPixmaps() {
     Q_ASSERT(!m_pixmapsLoaded);
-    m_leftPixmap = new QPixmap(m_leftFilename);
-    m_middlePixmap = new QPixmap(m_middleFilename);
-    m_rightPixmap = new QPixmap(m_rightFilename);
+    m_leftPixmap = sharedPixmap(m_leftFilename);
+    m_middlePixmap = sharedPixmap(m_middleFilename);
+    m_rightPixmap = sharedPixmap(m_rightFilename);
     m_pixmapsLoaded = true;
 }
 
 void ScaleThreePainter::unloadPixmaps() {
-    delete m_leftPixmap; m_leftPixmap = 0;
-    delete m_middlePixmap; m_middlePixmap = 0;
-    delete m_rightPixmap; m_rightPixmap = 0;
+    m_leftPixmap = QPixmap();
+    m_middlePixmap = QPixmap();
+    m_rightPixmap = QPixmap();
     m_pixmapsLoaded = false;
 }
 
 void ScaleThreePainter::paint(QPainter* painter, const QRect &rect, QWidget* widget) {
     Q_UNUSED(widget)
 
-    if(!m_pixmapsLoaded)
-        loadPixmaps();
+    if(rect.isEmpty())
+        return;
+
+    // Compose the pieces once per size, later paints are a single blit.  The
+    // result is shared with the other painters using the same skin and goes
+    // away with the rest of QPixmapCache when its budget runs out.
+    QPixmap composed;
+    QString key = m_cacheKey + QString("@%1x%2").arg(rect.width()).arg(rect.height());
+    if(!QPixmapCache::find(key, &composed)) {
+        if(!m_pixmapsLoaded)
+            loadPixmaps();
+        composed = QPixmap(rect.size());
+        composed.fill(Qt::transparent);
+        QPainter composer(&composed);
+        paintPieces(&composer, QRect(QPoint(0, 0), rect.size()));
+        composer.end();
+        QPixmapCache::insert(key, composed);
+        // the pieces stay in QPixmapCache for the next size
+        unloadPixmaps();
+    }
+    painter->drawPixmap(rect.topLeft(), composed);
+}
 
-    //    qDebug() << "ScaleThreePainter::paint: " << rect << qMin(m_middlePixmap->height(), rect.height());
+void ScaleThreePainter::paintPieces(QPainter* painter, const QRect &rect) {
+    //    qDebug() << "ScaleThreePainter::paint: " << rect << qMin(m_middlePixmap.height(), rect.height());
 
     painter->save();
 
     // Draw left.
-    if(m_leftPixmap->height() > rect.height())
-        painter->drawPixmap(0, 0, m_leftPixmap->width(), rect.height(), *m_leftPixmap);
+    if(m_leftPixmap.height() > rect.height())
+        painter->drawPixmap(0, 0, m_leftPixmap.width(), rect.height(), m_leftPixmap);
     else
-        painter->drawPixmap(0, 0, *m_leftPixmap);
+        painter->drawPixmap(0, 0, m_leftPixmap);
 
     // Draw top middle -- fills in the space is between the left and right pixmaps.
-    if(!m_middlePixmap->isNull()) {
-        painter->drawTiledPixmap(m_leftPixmap->width(),
+    if(!m_middlePixmap.isNull()) {
+        painter->drawTiledPixmap(m_leftPixmap.width(),
                                  0,
-                                 rect.width() - (m_leftPixmap->width() + m_rightPixmap->width()),
+                                 rect.width() - (m_leftPixmap.width() + m_rightPixmap.width()),
                                  rect.height(),
-                                 m_middlePixmap->scaledToHeight(rect.height()));
+                                 m_middlePixmap.scaledToHeight(rect.height()));
     }
 
     // Draw right.
-    if(m_rightPixmap->height() > rect.height())
-        painter->drawPixmap(rect.right() - m_rightPixmap->width() + 1, 0, m_rightPixmap->width(), rect.height(), *m_rightPixmap);
+    if(m_rightPixmap.height() > rect.height())
+        painter->drawPixmap(rect.right() - m_rightPixmap.width() + 1, 0, m_rightPixmap.width(), rect.height(), m_rightPixmap);
     else
-        painter->drawPixmap(rect.right() - m_rightPixmap->width() + 1, 0, *m_rightPixmap);
+        painter->drawPixmap(rect.right() - m_rightPixmap.width() + 1, 0, m_rightPixmap);
 
     painter->restore();
 }
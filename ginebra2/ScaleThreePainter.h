@@ -27,15 +27,17 @@ public:
 
 private:
     void loadPixmaps();
+    void paintPieces(QPainter* painter, const QRect &rect);
 
 private:
     QString m_leftFilename;
     QString m_middleFilename;
     QString m_rightFilename;
-    QPixmap *m_leftPixmap;
-    QPixmap *m_middlePixmap;
-    QPixmap *m_rightPixmap;
+    QPixmap m_leftPixmap;
+    QPixmap m_middlePixmap;
+    QPixmap m_rightPixmap;
     bool m_pixmapsLoaded;
+    QString m_cacheKey;
 };
 
 }  // GVA namespace
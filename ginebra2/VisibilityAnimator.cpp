@@ -20,7 +20,9 @@
 */
 
 #include "VisibilityAnimator.h"
+#include "ChromeSnippet.h"
 #include <QTimeLine>
+#include <QGraphicsWidget>
 
 // NB: These includes go away when plugins are implemented
 
@@ -48,6 +50,7 @@ VisibilityAnimator * VisibilityAnimator:: create(const QString & name, ChromeSni
 void VisibilityAnimator::setVisible(bool visible, bool animate){
   m_visible = visible;
   if (!animate) {
+    m_layer.end();
     updateVisibility((m_visible)?0.0:1.0);
     return;
   }
@@ -71,12 +74,16 @@ void VisibilityAnimator::setVisible(bool visible, bool animate){
     m_timeLine->setStartFrame(m_timeLine->endFrame());
   }
 
+  // The animators only change the opacity or transform of the widget
+  m_layer.begin(m_snippet->widget());
+
   emit started(m_visible);
   m_timeLine->start();
 }
 
 void VisibilityAnimator::onFinished()
 {
+  m_layer.end();
   emit finished(m_visible);
 }
 }
@@ -23,6 +23,7 @@
 #define __GINEBRA_VISIBILITYANIMATOR_H__
 
 #include <QObject>
+#include "ChromeEffect.h"
 
 class QTimeLine;
 
@@ -70,6 +71,7 @@ class VisibilityAnimator : public QObject
   QTimeLine *m_timeLine;
   bool m_visible;
   uint m_duration;
+  ChromeEffect::AnimationLayer m_layer;
 };
 
 }
@@ -38,10 +38,11 @@ WebChromeItem::WebChromeItem(ChromeWidget *chrome, const QWebElement & element,
     , m_element(element)
     , m_painting(false)
 {
-    setFlags(QGraphicsItem::ItemIsFocusable);
+    setFlags(QGraphicsItem::ItemIsFocusable | QGraphicsItem::ItemUsesExtendedStyleOption);
     //Adjust the element size to match the element rectangle
     updateSizes();
     //Use QGraphicsScene cached rendering NB: This might degrade rendering quality for some animation transforms
+    //The cache is the item's backing pixmap, ChromeRenderer invalidates only the dirty part of it
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
 }
 
@@ -102,11 +103,15 @@ void WebChromeItem::cachedHandlerEvent(QGraphicsSceneMouseEvent * ev)
 
 void WebChromeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* opt, QWidget* widget)
 {
-    Q_UNUSED(opt)
     Q_UNUSED(widget)
 
     m_painting = true;
+    // Clip to the exposed part, so only the invalidated region of the cache
+    // pixmap is rendered again
+    painter->save();
+    painter->setClipRect(opt->exposedRect);
     m_element.render(painter);
+    painter->restore();
     m_painting = false;
     ChromeItem::paint(painter, opt, widget);
 }
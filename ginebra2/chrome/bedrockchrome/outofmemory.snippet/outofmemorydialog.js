@@ -1,9 +1,13 @@
 //outofmemorydialog.js
 
+// Shown once per memory pressure episode, even if it goes from low to out of memory
+var outOfMemoryDialogShown = false;
+
 function outOfMemoryDialog() {
 
 	window.pageController.lowMemory.connect(showOutOfMemoryDialog);
 	window.pageController.outOfMemory.connect(showOutOfMemoryDialog);
+	window.pageController.memoryRecovered.connect(function() { outOfMemoryDialogShown = false; });
 	  
     this.write = writeOutOfMemoryDialog;
     // do setup
@@ -25,6 +29,9 @@ function writeOutOfMemoryDialog() {
 }
 
 function showOutOfMemoryDialog() {
+    if (outOfMemoryDialogShown)
+        return;
+    outOfMemoryDialogShown = true;
     window.snippets.OutOfMemoryDialogId.show(false);
 } 
 
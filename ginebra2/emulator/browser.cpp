@@ -24,6 +24,8 @@
 #include "../ChromeLayout.h"
 #include "../ChromeWidget.h"
 #include "../ChromeDOM.h"
+#include "../ChromeSnapshot.h"
+#include "../ChromeSnippet.h"
 #include "../Application.h"
 #include "WindowFlowView.h"
 #include "webpagecontroller.h"
@@ -163,6 +165,10 @@ m_app = new GVA::GinebraApplication();
 
 GinebraBrowser::~GinebraBrowser()
 {
+#ifndef __gva_no_chrome__
+  // Clean shutdown, the next launch can start from this chrome
+  saveChromeSnapshot();
+#endif
   delete m_chrome;
   delete WebPageController::getSingleton();
 #ifndef Q_WS_MAEMO_5
@@ -349,13 +355,41 @@ void GinebraBrowser::openUrl(QString url)
 //    }
 }
 
+#ifndef __gva_no_chrome__
+void GinebraBrowser::saveChromeSnapshot()
+{
+  if (!m_chrome->dom())
+    return;
+  QList<QGraphicsWidget *> widgets;
+  QStringList ids;
+  foreach (QObject *object, m_chrome->getSnippets()) {
+    GVA::ChromeSnippet *snippet = qobject_cast<GVA::ChromeSnippet *>(object);
+    if (snippet && snippet->isVisible() && snippet->widget()) {
+      widgets << snippet->widget();
+      ids << snippet->elementId();
+    }
+  }
+  GVA::ChromeSnapshot(m_install).save(m_chrome->layout(), widgets, ids);
+}
+#endif
+
 void GinebraBrowser::showSplashScreen() {
   QString splashImage = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("SplashImage");
   QString baseDir = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->valueAsString("ChromeBaseDirectory");
   QString imagePath =   baseDir + splashImage;
 
+  // Show the chrome from the last run, if still valid, until the real one is complete
+  QPixmap splashPixmap;
+#ifndef __gva_no_chrome__
+  GVA::ChromeSnapshot snapshot(m_install);
+  if (snapshot.load())
+    splashPixmap = QPixmap::fromImage(snapshot.image());
+#endif
+  if (splashPixmap.isNull())
+    splashPixmap = QPixmap(imagePath);
+
 #ifdef Q_WS_MAEMO_5
-  m_splashScreenM5 = new QSplashScreen(m_mainWindow, QPixmap(imagePath));
+  m_splashScreenM5 = new QSplashScreen(m_mainWindow, splashPixmap);
   m_splashScreenM5->show();
 #else
 
@@ -368,13 +402,13 @@ void GinebraBrowser::showSplashScreen() {
     if (m_view->orientation() == Qt::Horizontal) {
 		QMatrix mx;
 		mx.rotate(KLandscapeRoatation);
-    	m_splashScreen->setPixmap((QPixmap(imagePath)).transformed(mx));
+    	m_splashScreen->setPixmap(splashPixmap.transformed(mx));
     }
     else {
-        m_splashScreen->setPixmap((QPixmap(imagePath)));
+        m_splashScreen->setPixmap(splashPixmap);
     }
 #else
-     m_splashScreen->setPixmap((QPixmap(imagePath)));
+     m_splashScreen->setPixmap(splashPixmap);
 #endif    
    
 
@@ -68,6 +68,7 @@ class GinebraBrowser : public QObject
 
  private:
   void platformSpecificInit();
+  void saveChromeSnapshot();
 
  private:
   QString m_install;
@@ -102,8 +102,10 @@ HEADERS += \
     ActionButtonSnippet.h \
     CachedHandler.h \
     ChromeDOM.h \
+    ChromeDOMScan.h \
     ChromeRenderer.h \
     ChromeSnippet.h \
+    ChromeSnapshot.h \
     LocaleDelegate.h \
     ChromeEffect.h \
     ChromeLayout.h \
@@ -224,8 +226,10 @@ SOURCES += \
     Application.cpp \
     CachedHandler.cpp \
     ChromeDOM.cpp \
+    ChromeDOMScan.cpp \
     ChromeRenderer.cpp \
     ChromeSnippet.cpp \
+    ChromeSnapshot.cpp \
     LocaleDelegate.cpp \
     ChromeEffect.cpp \
     ChromeLayout.cpp \
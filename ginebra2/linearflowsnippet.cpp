@@ -182,7 +182,7 @@ private:
 class Filmstrip
 {
 public:
-    Filmstrip(const QImage& img, FilmstripFlowPrivate* filmstripFlowData): m_img(img), m_frozen(false), m_movieFrame(0), m_movie(NULL), m_filmstripFlowData(filmstripFlowData) {}
+    Filmstrip(const QImage& img, FilmstripFlowPrivate* filmstripFlowData): m_img(img), m_frozen(false), m_movieFrame(0), m_movie(NULL), m_filmstripFlowData(filmstripFlowData) {buildLevels();}
     ~Filmstrip() {}
 
     void paint(QPainter* painter);
@@ -193,12 +193,18 @@ public:
     void updateMovieFrame(int frame) { if (!m_frozen) m_movieFrame = frame;}
     void setName(const QString& name) {m_name = name;}
     QImage& image() {return m_img;}
+    void setImage(const QImage& img) {m_img = img; releaseLevels(); buildLevels();}
+    void buildLevels();
+    void releaseLevels() {m_halfImg = QImage(); m_quarterImg = QImage();}
     QString& name() {return m_name;}
 private:
     void createEmptyImage();
+    const QImage& imageForSize(const QSizeF& size);
 
 public:
     QImage m_img;
+    QImage m_halfImg;    // m_img scaled down to 1/2, built with the slide
+    QImage m_quarterImg; // m_img scaled down to 1/4, built with the slide
     bool m_frozen;
     int m_movieFrame;
     QString m_name;
@@ -226,6 +232,20 @@ public:
         m_films.clear();
     }
 
+    // keep the scaled images of the films up to reach slots away from the
+    // center one, drop the others; the strip wraps, so the distance is
+    // counted either way round
+    void updateLevels(int reach) {
+        int count = m_films.size();
+        for (int i = 0; i < count; i++) {
+            int distance = qAbs(i - m_centerIndex);
+            if (qMin(distance, count - distance) > reach)
+                m_films[i]->releaseLevels();
+            else
+                m_films[i]->buildLevels();
+        }
+    }
+
 public:
     QRgb m_bgColor;
     QImage* m_buffer;
@@ -254,6 +274,7 @@ void Filmstrip::createEmptyImage()
     int w = target.width();
     int h = target.height();
     m_name = NEW_FILM_TITLE;
+    releaseLevels();
     m_img = QImage(w, h, QImage::Format_RGB32);
 
     QPainter painter(&m_img);
@@ -261,6 +282,28 @@ void Filmstrip::createEmptyImage()
     painter.end();
 }
 
+// Scaled when the slide is set or comes back near the center, never while
+// a movie plays.
+void Filmstrip::buildLevels()
+{
+    if (m_img.isNull() || !m_halfImg.isNull())
+        return;
+    m_halfImg = m_img.scaled(m_img.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    m_quarterImg = m_halfImg.scaled(m_halfImg.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+// Scaling the full size thumbnail down by more than half on every animation
+// frame is what makes the movies slow; draw from the smallest level that is
+// still at least as wide as the target instead.
+const QImage& Filmstrip::imageForSize(const QSizeF& size)
+{
+    if (m_halfImg.isNull() || size.width() * 2 > m_img.width())
+        return m_img;
+    if (size.width() * 4 > m_img.width())
+        return m_halfImg;
+    return m_quarterImg;
+}
+
 void Filmstrip::paint(QPainter* painter)
 {
     Q_ASSERT(painter);
@@ -276,14 +319,14 @@ void Filmstrip::paint(QPainter* painter)
     else
         target = m_movie->movieClip(m_movieFrame);
 
-    if (target.right() > 0 || target.left() < m_filmstripFlowData->m_widgetSize.width()) {
+    if (target.right() > 0 && target.left() < m_filmstripFlowData->m_widgetSize.width()) {
         if (needFade)
             painter->setOpacity((ANIMATION_MAX_FRAME - m_movieFrame) / ANIMATION_MAX_FRAME);
 
         painter->fillRect(target.adjusted(-FRAME_WIDTH,-FRAME_WIDTH,FRAME_WIDTH,FRAME_WIDTH), QColor(Qt::gray));
 
         if (!m_img.isNull())
-            painter->drawImage(target, m_img);
+            painter->drawImage(target, imageForSize(target.size()));
 
         else {
             painter->save();
@@ -988,6 +1031,7 @@ void LinearFlowSnippet::setCenterIndex(int i)
         i = i % d->m_films.size();
 
     d->m_centerIndex = i;
+    d->updateLevels(3);
 
     CALL_ON_PREV_PREV_PREV_FILM_STRIP(updateMovie(NULL));
     CALL_ON_NEXT_NEXT_NEXT_FILM_STRIP(updateMovie(NULL));
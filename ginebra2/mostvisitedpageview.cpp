@@ -97,7 +97,7 @@ void MostVisitedPagesWidget::open()
     MostVisitedPageList mvPageList = m_mostVisitedPageStore->pageList();
 
     for (int i = 0; i < mvPageList.size(); i++) {
-        QImage *pageThumbnail = mvPageList[i]->m_pageThumbnail;
+        QImage *pageThumbnail = mvPageList[i]->pageThumbnail();
         bool removeTempThumbnail = false;
         if (!pageThumbnail) {
             removeTempThumbnail = true;
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <stdlib.h>
+
+namespace {
+    // Size distribution of the allocations made while loading a typical
+    // news page: weight per mille of requests up to each size
+    struct SizeClass
+    {
+        int limit;
+        int weight;
+    };
+
+    const SizeClass KSizeClasses[] = {
+        {16, 300}, {32, 250}, {64, 150}, {128, 100}, {256, 70}, {512, 50},
+        {1024, 30}, {4096, 30}, {16384, 15}, {65536, 4}, {262144, 1}
+    };
+    const int KSizeClassCount = sizeof(KSizeClasses) / sizeof(KSizeClasses[0]);
+
+    // Lifetimes: most cells die within a few allocations (temporary
+    // strings), a quarter live as long as a layout pass and a few stay
+    // until the page is left
+    const int KShortLived = 64;
+    const int KMediumLived = 4096;
+    const int KShortPercent = 70;
+    const int KMediumPercent = 25;
+
+    // Deterministic, the same sequence for every allocator
+    class Replay
+    {
+    public:
+        Replay() : m_seed(1) {}
+
+        int next()
+        {
+            m_seed = m_seed * 1103515245 + 12345;
+            return (m_seed >> 8) & 0xFFFFFF;
+        }
+
+        int size()
+        {
+            int r = next() % 1000;
+            int weight = 0;
+            int low = 1;
+            for (int i = 0; i < KSizeClassCount; ++i) {
+                weight += KSizeClasses[i].weight;
+                if (r < weight)
+                    return low + next() % (KSizeClasses[i].limit - low + 1);
+                low = KSizeClasses[i].limit + 1;
+            }
+            return KSizeClasses[0].limit;
+        }
+
+    private:
+        unsigned m_seed;
+    };
+}
+
+class tst_Allocator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pageLoad_data();
+    void pageLoad();
+    void reallocGrowth();
+};
+
+void tst_Allocator::pageLoad_data()
+{
+    QTest::addColumn<int>("allocations");
+
+    QTest::newRow("small page") << 20000;
+    QTest::newRow("large page") << 200000;
+}
+
+/*!
+ Allocate and free with the sizes and lifetimes of a page load, then
+ free everything as when navigating away. Run with and without the
+ preloaded allocator to compare.
+ */
+void tst_Allocator::pageLoad()
+{
+    QFETCH(int, allocations);
+
+    QVector<void*> shortLived(KShortLived);
+    QVector<void*> mediumLived(KMediumLived);
+    QVector<void*> longLived;
+    longLived.reserve(allocations);
+
+    QBENCHMARK {
+        Replay replay;
+        shortLived.fill(0);
+        mediumLived.fill(0);
+        for (int i = 0; i < allocations; ++i) {
+            int size = replay.size();
+            char* p = static_cast<char*>(malloc(size));
+            QVERIFY(p);
+            // Touch the cell as its user would write a header
+            memset(p, 1, qMin(size, 64));
+
+            int kind = replay.next() % 100;
+            if (kind < KShortPercent) {
+                int slot = i % KShortLived;
+                free(shortLived[slot]);
+                shortLived[slot] = p;
+            }
+            else if (kind < KShortPercent + KMediumPercent) {
+                int slot = replay.next() % KMediumLived;
+                free(mediumLived[slot]);
+                mediumLived[slot] = p;
+            }
+            else {
+                longLived.append(p);
+            }
+        }
+        for (int i = 0; i < KShortLived; ++i)
+            free(shortLived[i]);
+        for (int i = 0; i < KMediumLived; ++i)
+            free(mediumLived[i]);
+        for (int i = 0; i < longLived.count(); ++i)
+            free(longLived[i]);
+        longLived.resize(0);
+    }
+}
+
+/*!
+ Buffers grown a little at a time, as the network and parser buffers are
+ */
+void tst_Allocator::reallocGrowth()
+{
+    QBENCHMARK {
+        for (int buffer = 0; buffer < 100; ++buffer) {
+            char* p = 0;
+            for (int size = 256; size <= 256 * 1024; size += size / 4) {
+                p = static_cast<char*>(realloc(p, size));
+                QVERIFY(p);
+                p[size - 1] = 0;
+            }
+            free(p);
+        }
+    }
+}
+
+QTEST_MAIN(tst_Allocator)
+#include "tst_allocator.moc"
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QGraphicsScene>
+#include <QWebPage>
+#include <QWebFrame>
+#include <QWebElement>
+#include "ChromeDOMScan.h"
+#include "ChromeRenderer.h"
+#include "WebChromeItem.h"
+
+using namespace GVA;
+
+namespace GVA {
+// The items are built without snippets or cached handlers, these are never
+// reached; their sources would bring in the whole chrome
+bool ChromeSnippet::enabled() const { return true; }
+void CachedHandler::invoke() const {}
+}
+
+namespace {
+    // Each container snippet holds KGroupSize - 1 web snippets
+    const int KGroupSize = 5;
+    const int KCachedPerSnippet = 2;
+}
+
+class tst_ChromeConstruction : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void construction_data();
+    void construction();
+
+private:
+    QString chromeDocument(int snippetCount, QStringList& ids);
+};
+
+/*!
+ * A chrome document of \a snippetCount snippets, in containers, each web
+ * snippet with cached controls. The snippet ids go to \a ids.
+ */
+QString tst_ChromeConstruction::chromeDocument(int snippetCount, QStringList& ids)
+{
+    QString html("<html><body>");
+    for (int group = 0; group < snippetCount / KGroupSize; group++) {
+        QString container = QString("Container%1").arg(group);
+        ids << container;
+        html += QString("<div class=\"GinebraSnippet\" id=\"%1\" data-GinebraContainer=\"true\" "
+                        "data-GinebraAnchor=\"AnchorTop\" data-GinebraVisible=\"true\">").arg(container);
+        for (int i = 1; i < KGroupSize; i++) {
+            QString id = QString("Snippet%1_%2").arg(group).arg(i);
+            ids << id;
+            html += QString("<div class=\"GinebraSnippet\" id=\"%1\" data-GinebraVisible=\"true\" "
+                            "style=\"width: 100px; height: 20px\">").arg(id);
+            for (int j = 0; j < KCachedPerSnippet; j++)
+                html += QString("<span class=\"GinebraCached\" id=\"%1_%2\" "
+                                "data-GinebraOnClick=\"window.chrome.alert(%2)\">%2</span>").arg(id).arg(j);
+            html += "</div>";
+        }
+        html += "</div>";
+    }
+    html += "</body></html>";
+    return html;
+}
+
+void tst_ChromeConstruction::construction_data()
+{
+    QTest::addColumn<int>("snippetCount");
+    QTest::addColumn<bool>("scan");
+
+    QTest::newRow("10 snippets, one scan") << 10 << true;
+    QTest::newRow("10 snippets, lookup by id") << 10 << false;
+    QTest::newRow("50 snippets, one scan") << 50 << true;
+    QTest::newRow("50 snippets, lookup by id") << 50 << false;
+    QTest::newRow("250 snippets, one scan") << 250 << true;
+    QTest::newRow("250 snippets, lookup by id") << 250 << false;
+}
+
+/*!
+ * Collects the snippets as ChromeDOM does, by one scan or, as for snippets
+ * the scan did not see, by id, reads the cached controls' geometry as the
+ * cached handlers do, and builds the chrome items. The document is loaded
+ * once, outside of the timing.
+ */
+void tst_ChromeConstruction::construction()
+{
+    QFETCH(int, snippetCount);
+    QFETCH(bool, scan);
+
+    QStringList ids;
+    QWebPage page;
+    QSignalSpy loaded(&page, SIGNAL(loadFinished(bool)));
+    page.mainFrame()->setHtml(chromeDocument(snippetCount, ids));
+    for (int i = 0; i < 500 && loaded.isEmpty(); i++)
+        QTest::qWait(10);
+    QWebElement document = page.mainFrame()->documentElement();
+
+    int items = 0;
+    int controls = 0;
+    QBENCHMARK {
+        ChromeRenderer renderer(&page);
+        QGraphicsScene scene;
+        ChromeDOMScan domScan;
+        QList<ChromeDOMScan::SnippetElement> snippets;
+        if (scan) {
+            domScan.scan(document);
+            foreach (const QWebElement& element, domScan.elements())
+                snippets << domScan.snippet(element.attribute("id"));
+        } else {
+            foreach (const QString& id, ids) {
+                ChromeDOMScan::SnippetElement info = ChromeDOMScan::readSnippetElement(document.findFirst("#" + id));
+                info.cached = info.element.findAll(".GinebraCached").toList();
+                snippets << info;
+            }
+        }
+
+        items = 0;
+        QList<QRect> handlerRects;
+        foreach (const ChromeDOMScan::SnippetElement& info, snippets) {
+            QRect rect = info.element.geometry();
+            // Cached handlers keep their control's rect relative to the snippet
+            foreach (const QWebElement& control, info.cached)
+                handlerRects << control.geometry().translated(-rect.topLeft());
+            ChromeItem* item;
+            if (info.container) {
+                item = new ChromeItem();
+            } else {
+                WebChromeItem* webItem = new WebChromeItem(0, info.element);
+                renderer.addRenderItem(webItem);
+                item = webItem;
+            }
+            item->setPos(rect.topLeft());
+            scene.addItem(item);
+            items++;
+        }
+        controls = handlerRects.count();
+    }
+    QCOMPARE(items, snippetCount);
+    // A container sees the cached controls of the snippets inside it too
+    QCOMPARE(controls, snippetCount / KGroupSize * (KGroupSize - 1) * KCachedPerSnippet * 2);
+}
+
+QTEST_MAIN(tst_ChromeConstruction)
+#include "tst_chromeconstruction.moc"
@@ -0,0 +1,45 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#   Cost of a small, frequent chrome update, a progress bar growing in one
+#   snippet, against the number of snippets. The chrome renderer and the web
+#   chrome items are built from the ginebra2 sources; the snippets around
+#   them are not.
+#
+
+TARGET = ChromeRepaint_Benchmark
+QT += network webkit
+
+include(../tests.pri)
+
+include($$ROOT_DIR/browsercore/appfw/appfw-includepath.pri)
+INCLUDEPATH += $$ROOT_DIR/browsercore/core
+INCLUDEPATH += $$ROOT_DIR/bedrockProvisioning
+INCLUDEPATH += $$ROOT_DIR/ginebra2
+INCLUDEPATH += $$ROOT_DIR/qstmgesturelib
+INCLUDEPATH += $$ROOT_DIR/qstmgesturelib/qstmfilelogger
+LIBS += -lBrowserCore -lBedrockProvisioning -lqstmgesturelib
+
+HEADERS += $$ROOT_DIR/ginebra2/ChromeRenderer.h \
+           $$ROOT_DIR/ginebra2/ChromeItem.h \
+           $$ROOT_DIR/ginebra2/WebChromeItem.h
+
+SOURCES += $$ROOT_DIR/ginebra2/ChromeRenderer.cpp \
+           $$ROOT_DIR/ginebra2/ChromeItem.cpp \
+           $$ROOT_DIR/ginebra2/WebChromeItem.cpp \
+           tst_chromerepaint.cpp
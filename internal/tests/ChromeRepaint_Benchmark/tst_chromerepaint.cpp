@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QGraphicsView>
+#include <QWebPage>
+#include <QWebFrame>
+#include <QWebElement>
+#include "ChromeRenderer.h"
+#include "WebChromeItem.h"
+
+using namespace GVA;
+
+namespace GVA {
+// The items are built without snippets or cached handlers, these are never
+// reached; their sources would bring in the whole chrome
+bool ChromeSnippet::enabled() const { return true; }
+void CachedHandler::invoke() const {}
+}
+
+namespace {
+    const int KColumns = 20;
+    const int KSnippetSize = 32;
+    const int KUpdates = 20;
+}
+
+/*!
+ * A web chrome item that counts the renders of its cache pixmap
+ */
+class CountingItem : public WebChromeItem
+{
+public:
+    CountingItem(const QWebElement& element) : WebChromeItem(0, element), paints(0) {}
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* opt, QWidget* widget)
+    {
+        paints++;
+        WebChromeItem::paint(painter, opt, widget);
+    }
+    int paints;
+};
+
+/*!
+ * A chrome page of \a count snippets in a grid, each with a progress bar,
+ * and a web chrome item per snippet in an offscreen view
+ */
+class Chrome
+{
+public:
+    Chrome(int count);
+    void setProgress(int snippet, int width);
+    void moveSnippet(int snippet, int column, int row);
+    void setSnippetVisible(int snippet, bool visible);
+    void resetPaints();
+
+    QWebPage page;
+    ChromeRenderer renderer;
+    QGraphicsScene scene;
+    QGraphicsView view;
+    QList<CountingItem*> items;
+};
+
+Chrome::Chrome(int count)
+    : renderer(&page)
+{
+    QString html("<html><body style=\"margin: 0\">");
+    for (int i = 0; i < count; i++)
+        html += QString("<div class=\"snippet\" id=\"s%1\" style=\"position: absolute; overflow: hidden; "
+                        "left: %2px; top: %3px; width: %4px; height: %4px\">%1"
+                        "<div id=\"p%1\" style=\"width: 0px; height: 4px; background: blue\"></div></div>")
+                .arg(i).arg(i % KColumns * KSnippetSize).arg(i / KColumns * KSnippetSize).arg(KSnippetSize);
+    html += "</body></html>";
+
+    QSignalSpy loaded(&page, SIGNAL(loadFinished(bool)));
+    page.mainFrame()->setHtml(html);
+    for (int i = 0; i < 500 && loaded.isEmpty(); i++)
+        QTest::qWait(10);
+
+    QSize size(KColumns * KSnippetSize, (count + KColumns - 1) / KColumns * KSnippetSize);
+    renderer.resize(size);
+    foreach (QWebElement element, page.mainFrame()->findAllElements("div.snippet")) {
+        CountingItem* item = new CountingItem(element);
+        item->setPos(element.geometry().topLeft());
+        scene.addItem(item);
+        renderer.addRenderItem(item);
+        items.append(item);
+    }
+    view.setAttribute(Qt::WA_DontShowOnScreen);
+    view.setScene(&scene);
+    view.resize(size);
+    view.show();
+    QTest::qWaitForWindowShown(&view);
+    QApplication::processEvents();
+}
+
+/*!
+ * Grows the progress bar of \a snippet and lets the chrome repaint
+ */
+void Chrome::setProgress(int snippet, int width)
+{
+    QWebElement bar = page.mainFrame()->findFirstElement(QString("#p%1").arg(snippet));
+    bar.setStyleProperty("width", QString("%1px").arg(width));
+    // Lays the page out, which requests the repaint
+    bar.geometry();
+    QApplication::processEvents();
+}
+
+void Chrome::moveSnippet(int snippet, int column, int row)
+{
+    QWebElement element = page.mainFrame()->findFirstElement(QString("#s%1").arg(snippet));
+    element.setStyleProperty("left", QString("%1px").arg(column * KSnippetSize));
+    element.setStyleProperty("top", QString("%1px").arg(row * KSnippetSize));
+    element.geometry();
+    QApplication::processEvents();
+}
+
+void Chrome::setSnippetVisible(int snippet, bool visible)
+{
+    QWebElement element = page.mainFrame()->findFirstElement(QString("#s%1").arg(snippet));
+    element.setStyleProperty("display", visible ? "block" : "none");
+    element.geometry();
+    QApplication::processEvents();
+}
+
+void Chrome::resetPaints()
+{
+    foreach (CountingItem* item, items)
+        item->paints = 0;
+}
+
+class tst_ChromeRepaint : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void progress_data();
+    void progress();
+    void movedSnippet();
+    void movedIntoEmptyArea();
+    void shownSnippet();
+};
+
+void tst_ChromeRepaint::progress_data()
+{
+    QTest::addColumn<int>("snippetCount");
+
+    QTest::newRow("20 snippets") << 20;
+    QTest::newRow("100 snippets") << 100;
+    QTest::newRow("400 snippets") << 400;
+}
+
+/*!
+ * Time of KUpdates small updates of one snippet. Only that snippet's item
+ * renders again, whatever the number of snippets.
+ */
+void tst_ChromeRepaint::progress()
+{
+    QFETCH(int, snippetCount);
+
+    Chrome chrome(snippetCount);
+    QCOMPARE(chrome.items.count(), snippetCount);
+    chrome.resetPaints();
+
+    QBENCHMARK {
+        for (int step = 1; step <= KUpdates; step++)
+            chrome.setProgress(0, step);
+    }
+    QVERIFY(chrome.items.at(0)->paints > 0);
+    for (int i = 1; i < snippetCount; i++)
+        QCOMPARE(chrome.items.at(i)->paints, 0);
+}
+
+/*!
+ * Swaps two snippets without changing the size of the chrome, which leaves
+ * the renderer's index stale; an update of the moved snippet must still
+ * reach its item
+ */
+void tst_ChromeRepaint::movedSnippet()
+{
+    Chrome chrome(KColumns * 2);
+    chrome.setProgress(0, 1);
+    chrome.moveSnippet(1, 2, 0);
+    chrome.moveSnippet(2, 1, 0);
+    chrome.resetPaints();
+
+    chrome.setProgress(1, 10);
+    QVERIFY(chrome.items.at(1)->paints > 0);
+    QCOMPARE(chrome.items.at(2)->paints, 0);
+}
+
+/*!
+ * Moves the last snippet, alone on its row, to cells no item covered; its
+ * item renders at the new place
+ */
+void tst_ChromeRepaint::movedIntoEmptyArea()
+{
+    Chrome chrome(KColumns * 2 + 1);
+    chrome.setProgress(KColumns * 2, 1);
+    chrome.resetPaints();
+
+    chrome.moveSnippet(KColumns * 2, KColumns / 2, 2);
+    QVERIFY(chrome.items.at(KColumns * 2)->paints > 0);
+    chrome.resetPaints();
+    chrome.setProgress(KColumns * 2, 10);
+    QVERIFY(chrome.items.at(KColumns * 2)->paints > 0);
+}
+
+/*!
+ * A snippet hidden while the index is built is in no cell; showing it again
+ * must still render its item
+ */
+void tst_ChromeRepaint::shownSnippet()
+{
+    Chrome chrome(KColumns * 2 + 1);
+    chrome.setSnippetVisible(KColumns * 2, false);
+    chrome.setProgress(0, 1);
+    chrome.resetPaints();
+
+    chrome.setSnippetVisible(KColumns * 2, true);
+    QVERIFY(chrome.items.at(KColumns * 2)->paints > 0);
+}
+
+QTEST_MAIN(tst_ChromeRepaint)
+#include "tst_chromerepaint.moc"
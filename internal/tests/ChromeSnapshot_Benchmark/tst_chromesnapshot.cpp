@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QGraphicsScene>
+#include <QGraphicsWidget>
+#include <QPainter>
+#include <QWebPage>
+#include <QWebFrame>
+#include "bedrockprovisioning.h"
+#include "ChromeSnapshot.h"
+
+using namespace GVA;
+
+namespace {
+    const QSize KChromeSize(360, 640);
+    const int KSnippets = 16;
+    const int KSnippetHeight = 32;
+}
+
+/*!
+ * A snippet widget, or the content view under the snippets, filled with
+ * one colour
+ */
+class FilledWidget : public QGraphicsWidget
+{
+public:
+    FilledWidget(const QColor& color, QGraphicsItem* parent) : QGraphicsWidget(parent), m_color(color) {}
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*)
+    {
+        painter->fillRect(rect(), m_color);
+    }
+private:
+    QColor m_color;
+};
+
+class tst_ChromeSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void firstFrame_data();
+    void firstFrame();
+    void translucentSnippet();
+    void changedBundle();
+
+private:
+    bool saveChrome(const QColor& snippetColor, qreal snippetOpacity);
+
+private:
+    QString m_dir;
+    QString m_chromeDir;
+};
+
+void tst_ChromeSnapshot::initTestCase()
+{
+    m_dir = QDir::temp().filePath("tst_chromesnapshot");
+    m_chromeDir = m_dir + "/chrome";
+    QDir().mkpath(m_chromeDir);
+
+    // The settings of the test are kept apart from the browser's
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir);
+    BEDROCK_PROVISIONING::BedrockProvisioning* settings =
+        BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning();
+    settings->setValue("DataBaseDirectory", m_dir + "/");
+
+    // A chrome bundle of a page and its style sheet, KSnippets toolbars tall
+    QFile css(m_chromeDir + "/chrome.css");
+    QVERIFY(css.open(QIODevice::WriteOnly));
+    css.write(QString(".GinebraSnippet { height: %1px; border-bottom: 1px solid gray; "
+                      "background: -webkit-gradient(linear, left top, left bottom, from(#eee), to(#999)); }")
+              .arg(KSnippetHeight - 1).toLatin1());
+    css.close();
+    QFile html(m_chromeDir + "/chrome.html");
+    QVERIFY(html.open(QIODevice::WriteOnly));
+    html.write("<html><head><link rel=\"stylesheet\" type=\"text/css\" href=\"chrome.css\"/></head><body style=\"margin: 0\">");
+    for (int i = 0; i < KSnippets; i++)
+        html.write(QString("<div class=\"GinebraSnippet\" id=\"Snippet%1\">Toolbar %1</div>").arg(i).toLatin1());
+    html.write("</body></html>");
+    html.close();
+}
+
+void tst_ChromeSnapshot::cleanupTestCase()
+{
+    QFile::remove(m_dir + "/chromesnapshot.dat");
+    QFile::remove(m_chromeDir + "/chrome.css");
+    QFile::remove(m_chromeDir + "/chrome.html");
+    QDir().rmdir(m_chromeDir);
+
+    QString settingsFile = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->fileName();
+    QFile::remove(settingsFile);
+    QDir().rmdir(QFileInfo(settingsFile).path());
+    QDir().rmdir(m_dir);
+}
+
+/*!
+ * Saves a snapshot of a chrome of KSnippets snippets over a red content view
+ */
+bool tst_ChromeSnapshot::saveChrome(const QColor& snippetColor, qreal snippetOpacity)
+{
+    QGraphicsScene scene;
+    QGraphicsWidget* layout = new QGraphicsWidget();
+    scene.addItem(layout);
+    layout->resize(KChromeSize);
+    FilledWidget* content = new FilledWidget(Qt::red, layout);
+    content->resize(KChromeSize);
+
+    QList<QGraphicsWidget*> snippets;
+    QStringList ids;
+    for (int i = 0; i < KSnippets; i++) {
+        FilledWidget* snippet = new FilledWidget(snippetColor, layout);
+        snippet->setGeometry(0, i * KSnippetHeight, KChromeSize.width(), KSnippetHeight);
+        snippet->setOpacity(snippetOpacity);
+        snippets << snippet;
+        ids << QString("Snippet%1").arg(i);
+    }
+    return ChromeSnapshot(m_chromeDir).save(layout, snippets, ids);
+}
+
+void tst_ChromeSnapshot::firstFrame_data()
+{
+    QTest::addColumn<bool>("snapshot");
+
+    QTest::newRow("chrome snapshot") << true;
+    QTest::newRow("chrome page") << false;
+}
+
+/*!
+ * Time until the first frame of the chrome is ready to be shown: the saved
+ * snapshot read back, or the chrome page loaded, laid out and rendered
+ */
+void tst_ChromeSnapshot::firstFrame()
+{
+    QFETCH(bool, snapshot);
+
+    if (snapshot) {
+        QVERIFY(saveChrome(Qt::lightGray, 1));
+        QBENCHMARK_ONCE {
+            ChromeSnapshot chromeSnapshot(m_chromeDir);
+            QVERIFY(chromeSnapshot.load());
+            QPixmap frame = QPixmap::fromImage(chromeSnapshot.image());
+            QCOMPARE(frame.size(), KChromeSize);
+        }
+    } else {
+        QBENCHMARK_ONCE {
+            QWebPage page;
+            QSignalSpy loaded(&page, SIGNAL(loadFinished(bool)));
+            page.mainFrame()->load(QUrl::fromLocalFile(m_chromeDir + "/chrome.html"));
+            for (int i = 0; i < 500 && loaded.isEmpty(); i++)
+                QTest::qWait(10);
+            QCOMPARE(loaded.count(), 1);
+            page.setViewportSize(KChromeSize);
+            QPixmap frame(KChromeSize);
+            frame.fill(Qt::white);
+            QPainter painter(&frame);
+            page.mainFrame()->render(&painter);
+        }
+    }
+}
+
+/*!
+ * A translucent snippet is saved over a blank background, not over the
+ * content view under it
+ */
+void tst_ChromeSnapshot::translucentSnippet()
+{
+    QVERIFY(saveChrome(Qt::blue, 0.5));
+    ChromeSnapshot snapshot(m_chromeDir);
+    QVERIFY(snapshot.load());
+
+    QRgb inside = snapshot.image().pixel(KChromeSize.width() / 2, KSnippetHeight / 2);
+    QVERIFY(qBlue(inside) > 200);
+    QCOMPARE(qRed(inside), qGreen(inside));
+    QRgb outside = snapshot.image().pixel(KChromeSize.width() / 2, KSnippets * KSnippetHeight + 10);
+    QCOMPARE(outside, QColor(Qt::white).rgba());
+
+    // The geometry of every snippet comes back by id
+    QCOMPARE(snapshot.snippetRects().count(), KSnippets);
+    QCOMPARE(snapshot.snippetRects().value("Snippet1"),
+             QRectF(0, KSnippetHeight, KChromeSize.width(), KSnippetHeight));
+
+    // load() takes the snapshot away
+    QVERIFY(!ChromeSnapshot(m_chromeDir).load());
+}
+
+/*!
+ * A snapshot of another chrome bundle is not shown
+ */
+void tst_ChromeSnapshot::changedBundle()
+{
+    QVERIFY(saveChrome(Qt::lightGray, 1));
+    QFile css(m_chromeDir + "/chrome.css");
+    QVERIFY(css.open(QIODevice::Append));
+    css.write(".GinebraCached { color: blue; }");
+    css.close();
+
+    QVERIFY(!ChromeSnapshot(m_chromeDir).load());
+}
+
+QTEST_MAIN(tst_ChromeSnapshot)
+#include "tst_chromesnapshot.moc"
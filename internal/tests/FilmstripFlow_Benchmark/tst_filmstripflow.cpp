@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QPainter>
+#include "FilmstripFlow.h"
+
+using namespace WRT;
+
+namespace {
+    // ANIMATION_MAX_FRAME of the flow, frames 1 to 14 move the films
+    const int KMovieFrames = 15;
+    const int KSlides = 10;
+    const QSize KWindowSize(360, 640);
+}
+
+class tst_FilmstripFlow : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void movie_data();
+    void movie();
+
+private:
+    QImage thumbnail(const QSize& size, int i);
+};
+
+/*!
+ * A page like thumbnail, smooth scaling it down costs about what a real
+ * page costs
+ */
+QImage tst_FilmstripFlow::thumbnail(const QSize& size, int i)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(0xffffffff);
+    QPainter painter(&image);
+    painter.setPen(QColor::fromHsv(i * 36 % 360, 200, 160));
+    for (int y = 0; y < size.height(); y += 12)
+        painter.drawText(8, y + 10, QString("Window %1, line %2 of some page text").arg(i).arg(y / 12));
+    return image;
+}
+
+void tst_FilmstripFlow::movie_data()
+{
+    QTest::addColumn<QSize>("thumbnailSize");
+
+    QTest::newRow("window size thumbnails") << KWindowSize;
+    QTest::newRow("double size thumbnails") << KWindowSize * 2;
+}
+
+/*!
+ * Paints the frames of a move to the next slide, as the movie timer would.
+ * The widget is shown without reaching the screen so that each frame goes
+ * through paintEvent(); the event loop does not run, so the timer started
+ * by showNext() never gets to play the movie itself.
+ */
+void tst_FilmstripFlow::movie()
+{
+    QFETCH(QSize, thumbnailSize);
+
+    FilmstripFlow flow;
+    flow.setAttribute(Qt::WA_DontShowOnScreen);
+    flow.resize(KWindowSize);
+    flow.init();
+    for (int i = 0; i < KSlides; i++)
+        flow.addSlide(thumbnail(thumbnailSize, i), QString("Window %1").arg(i));
+    flow.show();
+    QTest::qWaitForWindowShown(&flow);
+    flow.setCenterIndex(KSlides / 2);
+    flow.showNext();
+
+    QBENCHMARK {
+        for (int frame = 1; frame < KMovieFrames; frame++)
+            QMetaObject::invokeMethod(&flow, "playMovie", Qt::DirectConnection, Q_ARG(int, frame));
+    }
+    QCOMPARE(flow.centerIndex(), KSlides / 2);
+}
+
+QTEST_MAIN(tst_FilmstripFlow)
+#include "tst_filmstripflow.moc"
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include "geolocationManager.h"
+
+Q_DECLARE_METATYPE(QWebPage::PermissionPolicy)
+
+class tst_Geolocation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void deleteDomain();
+    void clearAll();
+    void addAfterDelete();
+
+private:
+    void reload();
+    static bool isCached(const QString& domain);
+    static QWebPage::PermissionPolicy permission(const QString& domain);
+
+private:
+    QString m_savedDir;
+    QString m_dir;
+};
+
+void tst_Geolocation::initTestCase()
+{
+    // the database is opened in the current directory
+    m_savedDir = QDir::currentPath();
+    m_dir = QDir::temp().filePath("tst_geolocation");
+    QDir().mkpath(m_dir);
+    QDir::setCurrent(m_dir);
+}
+
+void tst_Geolocation::cleanupTestCase()
+{
+    delete GeolocationManager::getSingleton();
+    QFile::remove(m_dir + "/" GEOLOCATION_DB_FILE);
+    QDir::setCurrent(m_savedDir);
+    QDir().rmdir(m_dir);
+}
+
+void tst_Geolocation::init()
+{
+    QCOMPARE(GeolocationManager::getSingleton()->clearAllGeodata(), int(GeolocationManager::SUCCESS));
+    reload();
+}
+
+/*!
+ * Deletes the manager, which waits for its writer, and reads the table
+ * into a new one
+ */
+void tst_Geolocation::reload()
+{
+    delete GeolocationManager::getSingleton();
+    QVERIFY(GeolocationManager::getSingleton());
+}
+
+bool tst_Geolocation::isCached(const QString& domain)
+{
+    return !GeolocationManager::getSingleton()->findGeodomain(domain).isEmpty();
+}
+
+QWebPage::PermissionPolicy tst_Geolocation::permission(const QString& domain)
+{
+    QList<QVariant> found = GeolocationManager::getSingleton()->findGeodomain(domain);
+    return found.isEmpty() ? QWebPage::PermissionUnknown : found.first().value<QWebPage::PermissionPolicy>();
+}
+
+void tst_Geolocation::deleteDomain()
+{
+    GeolocationManager* manager = GeolocationManager::getSingleton();
+    QCOMPARE(manager->addGeodomain("a.example.com", QWebPage::PermissionGranted), int(GeolocationManager::SUCCESS));
+    QCOMPARE(manager->addGeodomain("b.example.com", QWebPage::PermissionDenied), int(GeolocationManager::SUCCESS));
+    QCOMPARE(manager->deleteGeodomain("a.example.com"), int(GeolocationManager::SUCCESS));
+
+    QVERIFY(!isCached("a.example.com"));
+    QCOMPARE(permission("b.example.com"), QWebPage::PermissionDenied);
+
+    reload();
+    QVERIFY(!isCached("a.example.com"));
+    QCOMPARE(permission("b.example.com"), QWebPage::PermissionDenied);
+}
+
+void tst_Geolocation::clearAll()
+{
+    GeolocationManager* manager = GeolocationManager::getSingleton();
+    manager->addGeodomain("a.example.com", QWebPage::PermissionGranted);
+    manager->addGeodomain("b.example.com", QWebPage::PermissionDenied);
+    QCOMPARE(manager->clearAllGeodata(), int(GeolocationManager::SUCCESS));
+    manager->addGeodomain("c.example.com", QWebPage::PermissionGranted);
+
+    QVERIFY(!isCached("a.example.com"));
+    QVERIFY(!isCached("b.example.com"));
+    QCOMPARE(permission("c.example.com"), QWebPage::PermissionGranted);
+
+    reload();
+    QVERIFY(!isCached("a.example.com"));
+    QVERIFY(!isCached("b.example.com"));
+    QCOMPARE(permission("c.example.com"), QWebPage::PermissionGranted);
+}
+
+/*!
+ * A domain keeps its first permission until it is deleted; the writes
+ * reach the database in the order they were made
+ */
+void tst_Geolocation::addAfterDelete()
+{
+    GeolocationManager* manager = GeolocationManager::getSingleton();
+    manager->addGeodomain("a.example.com", QWebPage::PermissionGranted);
+    manager->addGeodomain("a.example.com", QWebPage::PermissionDenied);
+    QCOMPARE(permission("a.example.com"), QWebPage::PermissionGranted);
+
+    manager->deleteGeodomain("a.example.com");
+    manager->addGeodomain("a.example.com", QWebPage::PermissionDenied);
+    QCOMPARE(permission("a.example.com"), QWebPage::PermissionDenied);
+
+    reload();
+    QCOMPARE(permission("a.example.com"), QWebPage::PermissionDenied);
+}
+
+QTEST_MAIN(tst_Geolocation)
+#include "tst_geolocation.moc"
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include "qstmeventpool.h"
+#include "qstmstatemachine.h"
+#include "qstmstateengine.h"
+#include "qstmuievent.h"
+
+using namespace qstmUiEventEngine;
+
+namespace {
+    const int KDragEvents = 10000;
+    const int KWarmUpEvents = 1000;
+
+    struct Probe
+    {
+        double a;
+        double b;
+    };
+}
+
+class tst_GesturePool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void exhaustionFallsBackToHeap();
+    void oversizedRequestGoesToHeap();
+    void releasedSlotIsReused();
+    void longDragDoesNotAllocate();
+
+private:
+    void send(QStm_StateMachine& machine, QStm_PlatformPointerEvent::PEType type,
+              const QPoint& pos, const QTime& time);
+};
+
+void tst_GesturePool::exhaustionFallsBackToHeap()
+{
+    QStm_EventPool pool(sizeof(Probe), 4);
+    QList<void*> objects;
+    for (int i = 0; i < 4; i++)
+        objects.append(pool.alloc(sizeof(Probe)));
+    QCOMPARE(pool.inUse(), 4);
+    QCOMPARE(pool.overflowCount(), 0);
+
+    // The fifth object no longer fits and comes from the heap
+    objects.append(pool.alloc(sizeof(Probe)));
+    QVERIFY(objects.last() != 0);
+    QCOMPARE(pool.inUse(), 4);
+    QCOMPARE(pool.overflowCount(), 1);
+    QCOMPARE(pool.highWaterMark(), 4);
+
+    foreach (void* p, objects)
+        pool.release(p);
+    QCOMPARE(pool.inUse(), 0);
+    QCOMPARE(pool.highWaterMark(), 4);
+
+    pool.resetCounters();
+    QCOMPARE(pool.overflowCount(), 0);
+    QCOMPARE(pool.highWaterMark(), 0);
+}
+
+void tst_GesturePool::oversizedRequestGoesToHeap()
+{
+    QStm_EventPool pool(sizeof(Probe), 4);
+    void* p = pool.alloc(sizeof(Probe) * 2);
+    QVERIFY(p != 0);
+    QCOMPARE(pool.inUse(), 0);
+    QCOMPARE(pool.overflowCount(), 1);
+    pool.release(p);
+    QCOMPARE(pool.inUse(), 0);
+}
+
+void tst_GesturePool::releasedSlotIsReused()
+{
+    QStm_EventPool pool(sizeof(Probe), 4);
+    void* first = pool.alloc(sizeof(Probe));
+    void* second = pool.alloc(sizeof(Probe));
+    pool.release(second);
+    QCOMPARE(pool.alloc(sizeof(Probe)), second);
+    pool.release(first);
+    QCOMPARE(pool.alloc(sizeof(Probe)), first);
+    QCOMPARE(pool.inUse(), 2);
+    QCOMPARE(pool.overflowCount(), 0);
+}
+
+void tst_GesturePool::send(QStm_StateMachine& machine, QStm_PlatformPointerEvent::PEType type,
+                           const QPoint& pos, const QTime& time)
+{
+    QStm_PlatformPointerEvent event;
+    event.m_type = type;
+    event.m_modifiers = 0;
+    event.m_position = pos;
+    event.m_pointerNumber = 0;
+    event.m_target = 0;
+    event.m_time = time;
+    machine.handleStateEvent(event);
+}
+
+void tst_GesturePool::longDragDoesNotAllocate()
+{
+    QStm_StateMachine machine;
+    machine.enableLogging(false);
+
+    const int hwBaseline = QStm_HwEvent::pool().inUse();
+    const int uiBaseline = QStm_UiEvent::pool().inUse();
+    QTime time = QTime::currentTime();
+    QPoint pos(100, 300);
+
+    send(machine, QStm_PlatformPointerEvent::EButton1Down, pos, time);
+
+    int hwOverflow = 0;
+    int uiOverflow = 0;
+    int step = 4;
+    for (int i = 0; i < KDragEvents; i++) {
+        if (i == KWarmUpEvents) {
+            hwOverflow = QStm_HwEvent::pool().overflowCount();
+            uiOverflow = QStm_UiEvent::pool().overflowCount();
+        }
+        // Pan back and forth across the screen, one event per 10 ms
+        if (pos.x() + step > 600 || pos.x() + step < 100)
+            step = -step;
+        pos.rx() += step;
+        time = time.addMSecs(10);
+        send(machine, QStm_PlatformPointerEvent::EDrag, pos, time);
+    }
+
+    QCOMPARE(QStm_HwEvent::pool().overflowCount(), hwOverflow);
+    QCOMPARE(QStm_UiEvent::pool().overflowCount(), uiOverflow);
+    QVERIFY(QStm_HwEvent::pool().highWaterMark() <= QStm_HwEvent::pool().capacity());
+    QVERIFY(QStm_UiEvent::pool().highWaterMark() <= QStm_UiEvent::pool().capacity());
+
+    send(machine, QStm_PlatformPointerEvent::EButton1Up, pos, time.addMSecs(10));
+    QCOMPARE(QStm_HwEvent::pool().inUse(), hwBaseline);
+    QCOMPARE(QStm_UiEvent::pool().inUse(), uiBaseline);
+}
+
+QTEST_MAIN(tst_GesturePool)
+#include "tst_gesturepool.moc"
@@ -0,0 +1,34 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#   Replays gesture recordings through the state machine and the gesture
+#   engine and reports the latency percentiles and the gesture sequence.
+#   Replay a recording made on a device with
+#   QSTM_RECORDING=<file> ./GestureReplay_Benchmark
+#
+
+TARGET = GestureReplay_Benchmark
+QT += core gui
+
+include(../tests.pri)
+
+INCLUDEPATH += $$ROOT_DIR/qstmgesturelib
+INCLUDEPATH += $$ROOT_DIR/qstmgesturelib/qstmfilelogger
+LIBS += -lqstmgesturelib
+
+SOURCES += tst_gesturereplay.cpp
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QWidget>
+#include "qstmgestureapi.h"
+#include "qstmgesture_if.h"
+#include "qstmstatemachine.h"
+#include "qstmgesturerecorder.h"
+
+using namespace qstmUiEventEngine;
+
+Q_DECLARE_METATYPE(QList<QStm_RecordedPointerEvent>)
+Q_DECLARE_METATYPE(QList<int>)
+
+namespace {
+    // Long enough for the gestures decided by a timer after the last event,
+    // e.g. a tap once no second tap came
+    const int KSettleTime = 1000;
+
+    QStm_RecordedPointerEvent pointerEvent(int offset, QStm_PlatformPointerEvent::PEType type,
+                                           int x, int y)
+    {
+        QStm_RecordedPointerEvent event;
+        event.m_offset = offset;
+        event.m_type = type;
+        event.m_pointerNumber = 0;
+        event.m_modifiers = 0;
+        event.m_position = QPoint(x, y);
+        return event;
+    }
+
+    QList<QStm_RecordedPointerEvent> tap()
+    {
+        QList<QStm_RecordedPointerEvent> events;
+        events << pointerEvent(0, QStm_PlatformPointerEvent::EButton1Down, 200, 300)
+               << pointerEvent(80, QStm_PlatformPointerEvent::EButton1Up, 200, 300);
+        return events;
+    }
+
+    // Slow drag downwards, 8 px every 16 ms, then a pause before lifting
+    QList<QStm_RecordedPointerEvent> pan()
+    {
+        QList<QStm_RecordedPointerEvent> events;
+        events << pointerEvent(0, QStm_PlatformPointerEvent::EButton1Down, 200, 100);
+        int t = 0;
+        for (int y = 108; y <= 500; y += 8)
+            events << pointerEvent(t += 16, QStm_PlatformPointerEvent::EDrag, 200, y);
+        events << pointerEvent(t + 300, QStm_PlatformPointerEvent::EButton1Up, 200, 500);
+        return events;
+    }
+
+    // Fast swipe to the left
+    QList<QStm_RecordedPointerEvent> flick()
+    {
+        QList<QStm_RecordedPointerEvent> events;
+        events << pointerEvent(0, QStm_PlatformPointerEvent::EButton1Down, 400, 300);
+        int t = 0;
+        for (int x = 360; x >= 40; x -= 40)
+            events << pointerEvent(t += 10, QStm_PlatformPointerEvent::EDrag, x, 300);
+        events << pointerEvent(t + 10, QStm_PlatformPointerEvent::EButton1Up, 40, 300);
+        return events;
+    }
+
+    // Press without moving past the hold timeout
+    QList<QStm_RecordedPointerEvent> hold()
+    {
+        QList<QStm_RecordedPointerEvent> events;
+        events << pointerEvent(0, QStm_PlatformPointerEvent::EButton1Down, 200, 300);
+        for (int t = 100; t <= 1500; t += 100)
+            events << pointerEvent(t, QStm_PlatformPointerEvent::EDrag, 200 + (t / 100) % 2, 300);
+        events << pointerEvent(1600, QStm_PlatformPointerEvent::EButton1Up, 201, 300);
+        return events;
+    }
+}
+
+class tst_GestureReplay : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void recordingRoundTrip();
+    void replay_data();
+    void replay();
+
+private:
+    QWidget*               m_target;
+    QStm_GestureEngineApi* m_engine;
+    QStm_GestureContext*   m_context;
+    QStm_GestureReplay*    m_replay;
+};
+
+void tst_GestureReplay::initTestCase()
+{
+    m_target = new QWidget;
+    m_target->resize(480, 640);
+    m_engine = new QStm_GestureEngineApi();
+    m_context = m_engine->createContext(qptrdiff(m_target));
+    QStm_GestureParameters& param = m_context->config();
+    param.setEnabled(qstmGesture::EGestureUidTap, true);
+    param.setEnabled(qstmGesture::EGestureUidPan, true);
+    param.setEnabled(qstmGesture::EGestureUidFlick, true);
+    param.setEnabled(qstmGesture::EGestureUidLongPress, true);
+    param.setEnabled(qstmGesture::EGestureUidRelease, true);
+    param.setEnabled(qstmGesture::EGestureUidTouch, true);
+    m_context->setLogging(0);
+
+    m_replay = new QStm_GestureReplay;
+    m_context->addListener(m_replay);
+    m_context->activate(m_target);
+}
+
+void tst_GestureReplay::cleanupTestCase()
+{
+    m_context->removeListener(m_replay);
+    delete m_replay;
+    delete m_context;
+    delete m_engine;
+    delete m_target;
+}
+
+void tst_GestureReplay::recordingRoundTrip()
+{
+    QString fileName = QDir::temp().filePath("tst_gesturereplay.qsgr");
+    QStm_GestureRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+
+    QStm_StateMachine* machine = m_engine->getStateMachine();
+    machine->setRecorder(&recorder);
+    QTime base = QTime::currentTime();
+    const QList<QStm_RecordedPointerEvent> input = pan();
+    foreach (const QStm_RecordedPointerEvent& recorded, input) {
+        QStm_PlatformPointerEvent event;
+        event.m_type = recorded.m_type;
+        event.m_modifiers = recorded.m_modifiers;
+        event.m_position = recorded.m_position;
+        event.m_pointerNumber = recorded.m_pointerNumber;
+        event.m_target = m_target;
+        event.m_time = base.addMSecs(recorded.m_offset);
+        machine->handleStateEvent(event);
+    }
+    machine->setRecorder(0);
+    recorder.close();
+
+    QList<QStm_RecordedPointerEvent> output;
+    QVERIFY(QStm_GestureRecorder::load(fileName, output));
+    QFile::remove(fileName);
+    QCOMPARE(output.count(), input.count());
+    for (int i = 0; i < input.count(); i++) {
+        QCOMPARE(output[i].m_offset, input[i].m_offset);
+        QCOMPARE(int(output[i].m_type), int(input[i].m_type));
+        QCOMPARE(output[i].m_position, input[i].m_position);
+    }
+}
+
+void tst_GestureReplay::replay_data()
+{
+    using namespace qstmGesture;
+
+    QTest::addColumn<QList<QStm_RecordedPointerEvent> >("events");
+    QTest::addColumn<qreal>("speed");
+    // gestures that must come out in this order, touch, release and the like
+    // may come in between; and gestures that must not come out at all
+    QTest::addColumn<QList<int> >("expected");
+    QTest::addColumn<QList<int> >("unexpected");
+
+    QList<int> tapExpected = QList<int>() << EGestureUidTap;
+    QList<int> tapUnexpected = QList<int>() << EGestureUidPan << EGestureUidFlick << EGestureUidLongPress;
+    QList<int> panExpected = QList<int>() << EGestureUidPan;
+    QList<int> panUnexpected = QList<int>() << EGestureUidTap << EGestureUidLongPress;
+    QList<int> flickExpected = QList<int>() << EGestureUidFlick;
+    QList<int> flickUnexpected = QList<int>() << EGestureUidTap << EGestureUidLongPress;
+    QList<int> holdExpected = QList<int>() << EGestureUidLongPress;
+    QList<int> holdUnexpected = QList<int>() << EGestureUidTap << EGestureUidPan << EGestureUidFlick;
+
+    QTest::newRow("tap x1") << tap() << qreal(1.0) << tapExpected << tapUnexpected;
+    QTest::newRow("pan x1") << pan() << qreal(1.0) << panExpected << panUnexpected;
+    QTest::newRow("pan x4") << pan() << qreal(4.0) << panExpected << panUnexpected;
+    QTest::newRow("flick x1") << flick() << qreal(1.0) << flickExpected << flickUnexpected;
+    QTest::newRow("hold x1") << hold() << qreal(1.0) << holdExpected << holdUnexpected;
+    // Back to back, no timers: the engines' own cost
+    QTest::newRow("pan x0") << pan() << qreal(0) << panExpected << panUnexpected;
+    QTest::newRow("flick x0") << flick() << qreal(0) << flickExpected << flickUnexpected;
+
+    QString recording = qgetenv("QSTM_RECORDING");
+    if (!recording.isEmpty()) {
+        QList<QStm_RecordedPointerEvent> events;
+        if (QStm_GestureRecorder::load(recording, events)) {
+            QTest::newRow("recording x1") << events << qreal(1.0) << QList<int>() << QList<int>();
+            QTest::newRow("recording x0") << events << qreal(0) << QList<int>() << QList<int>();
+        }
+        else {
+            qWarning("cannot load %s", qPrintable(recording));
+        }
+    }
+}
+
+void tst_GestureReplay::replay()
+{
+    QFETCH(QList<QStm_RecordedPointerEvent>, events);
+    QFETCH(qreal, speed);
+    QFETCH(QList<int>, expected);
+    QFETCH(QList<int>, unexpected);
+
+    m_replay->setEvents(events);
+    if (speed > 0) {
+        // Real time replays take as long as the recording, run them once
+        QBENCHMARK_ONCE {
+            m_replay->run(m_engine->getStateMachine(), m_target, speed);
+        }
+    }
+    else {
+        QBENCHMARK {
+            m_replay->run(m_engine->getStateMachine(), m_target, speed);
+        }
+    }
+
+    QCOMPARE(m_replay->latencies().count(), events.count());
+    QTest::qWait(KSettleTime);
+    QVERIFY(!m_replay->gestures().isEmpty());
+    QString report = m_replay->report();
+    qDebug("%s", qPrintable(report));
+
+    QList<int> uids;
+    foreach (const QStm_GestureReplay::GestureRecord& gesture, m_replay->gestures()) {
+        if (!gesture.m_exit)
+            uids.append(gesture.m_uid);
+    }
+    int matched = 0;
+    foreach (int uid, uids) {
+        if (matched < expected.count() && uid == expected.at(matched))
+            matched++;
+    }
+    QVERIFY2(matched == expected.count(), qPrintable(report));
+    foreach (int uid, unexpected)
+        QVERIFY2(!uids.contains(uid), qPrintable(report));
+}
+
+QTEST_MAIN(tst_GestureReplay)
+#include "tst_gesturereplay.moc"
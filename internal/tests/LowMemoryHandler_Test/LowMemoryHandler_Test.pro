@@ -0,0 +1,34 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#   Linux backend of the low memory handler, run against fake /proc and
+#   /sys trees written to a temporary directory. Each pressure level must
+#   be signalled once per episode.
+#
+
+TARGET = LowMemoryHandler_Test
+QT += core
+
+include(../tests.pri)
+
+INCLUDEPATH += $$ROOT_DIR/browsercore/appfw/Api/Managers
+
+HEADERS += $$ROOT_DIR/browsercore/appfw/Api/Managers/lowmemoryhandler.h
+SOURCES += $$ROOT_DIR/browsercore/appfw/Api/Managers/lowmemoryhandler.cpp \
+           $$ROOT_DIR/browsercore/appfw/Api/Managers/lowmemoryhandler_p.cpp \
+           tst_lowmemoryhandler.cpp
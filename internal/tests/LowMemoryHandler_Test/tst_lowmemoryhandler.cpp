@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include "lowmemoryhandler.h"
+#include <unistd.h>
+
+namespace {
+    // physical memory of the fake /proc/meminfo, in kB
+    const int KMemTotal = 1024 * 1024;
+    const char KNoStall[] = "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"
+                            "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+}
+
+class tst_LowMemoryHandler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void psiLevels();
+    void psiSystemWide();
+    void cgroupLevels();
+    void cgroupEvents();
+
+private:
+    void writeFile(const QString& path, const QByteArray& data);
+    void setResident(int percent);
+    void setStall(double some, double full);
+    void check();
+    void removeTree(const QString& path);
+
+private:
+    QString m_root;
+    LowMemoryHandler* m_handler;
+    QSignalSpy* m_moderate;
+    QSignalSpy* m_low;
+    QSignalSpy* m_outOfMemory;
+    QSignalSpy* m_recovered;
+};
+
+void tst_LowMemoryHandler::init()
+{
+    m_root = QDir::temp().filePath("tst_lowmemoryhandler");
+    removeTree(m_root);
+    writeFile("proc/meminfo", QString("MemTotal:       %1 kB\nMemFree:          1024 kB\n").arg(KMemTotal).toLatin1());
+    setResident(10);
+
+    m_handler = new LowMemoryHandler;
+    m_moderate = new QSignalSpy(m_handler, SIGNAL(moderateMemory()));
+    m_low = new QSignalSpy(m_handler, SIGNAL(lowMemory()));
+    m_outOfMemory = new QSignalSpy(m_handler, SIGNAL(outOfMemory()));
+    m_recovered = new QSignalSpy(m_handler, SIGNAL(memoryRecovered()));
+}
+
+void tst_LowMemoryHandler::cleanup()
+{
+    delete m_moderate;
+    delete m_low;
+    delete m_outOfMemory;
+    delete m_recovered;
+    delete m_handler;
+    removeTree(m_root);
+}
+
+/*!
+ * Writes \a data to \a path under the fake root, in place so that a
+ * descriptor the handler keeps open sees the new contents
+ */
+void tst_LowMemoryHandler::writeFile(const QString& path, const QByteArray& data)
+{
+    QString fileName = m_root + "/" + path;
+    QDir().mkpath(QFileInfo(fileName).path());
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data);
+}
+
+void tst_LowMemoryHandler::setResident(int percent)
+{
+    qint64 pages = qint64(KMemTotal) * 1024 / sysconf(_SC_PAGESIZE) * percent / 100;
+    writeFile("proc/self/statm", QString("%1 %2 100 10 0 %1 0\n").arg(pages * 2).arg(pages).toLatin1());
+}
+
+void tst_LowMemoryHandler::setStall(double some, double full)
+{
+    writeFile("proc/pressure/memory",
+              QString("some avg10=%1 avg60=0.00 avg300=0.00 total=0\n"
+                      "full avg10=%2 avg60=0.00 avg300=0.00 total=0\n")
+              .arg(some, 0, 'f', 2).arg(full, 0, 'f', 2).toLatin1());
+}
+
+// What the poll timer and the kernel notifications do
+void tst_LowMemoryHandler::check()
+{
+    QVERIFY(QMetaObject::invokeMethod(m_handler, "_q_checkMemory"));
+}
+
+void tst_LowMemoryHandler::removeTree(const QString& path)
+{
+    QDir dir(path);
+    foreach (const QFileInfo& entry, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System)) {
+        if (entry.isDir())
+            removeTree(entry.filePath());
+        else
+            dir.remove(entry.fileName());
+    }
+    QDir().rmdir(path);
+}
+
+/*!
+ * Stalls of the process's own memory, the resident size is significant so
+ * system wide PSI is trusted
+ */
+void tst_LowMemoryHandler::psiLevels()
+{
+    setResident(55);
+    writeFile("proc/pressure/memory", KNoStall);
+    m_handler->setFileSystemRoot(m_root);
+    m_handler->start();
+    QCOMPARE(m_moderate->count() + m_low->count() + m_outOfMemory->count(), 0);
+
+    setStall(15, 0);
+    check();
+    check();
+    QCOMPARE(m_moderate->count(), 1);
+
+    setStall(15, 10);
+    check();
+    check();
+    QCOMPARE(m_low->count(), 1);
+
+    setStall(40, 30);
+    check();
+    setStall(15, 10);
+    check();
+    QCOMPARE(m_outOfMemory->count(), 1);
+    QCOMPARE(m_recovered->count(), 0);
+
+    setStall(0, 0);
+    check();
+    check();
+    QCOMPARE(m_recovered->count(), 1);
+
+    // straight to the top in a new episode, the lower levels are skipped
+    setStall(40, 30);
+    check();
+    QCOMPARE(m_moderate->count(), 1);
+    QCOMPARE(m_low->count(), 1);
+    QCOMPARE(m_outOfMemory->count(), 2);
+}
+
+/*!
+ * System wide stalls with a small resident size are someone else's,
+ * they never go past moderate
+ */
+void tst_LowMemoryHandler::psiSystemWide()
+{
+    setResident(10);
+    writeFile("proc/pressure/memory", KNoStall);
+    m_handler->setFileSystemRoot(m_root);
+    m_handler->start();
+
+    setStall(40, 30);
+    check();
+    QCOMPARE(m_moderate->count(), 1);
+    QCOMPARE(m_low->count(), 0);
+    QCOMPARE(m_outOfMemory->count(), 0);
+
+    setResident(70);
+    check();
+    QCOMPARE(m_outOfMemory->count(), 1);
+}
+
+/*!
+ * Usage of a cgroup v2 memory limit, without PSI
+ */
+void tst_LowMemoryHandler::cgroupLevels()
+{
+    writeFile("proc/self/cgroup", "0::/browser\n");
+    writeFile("sys/fs/cgroup/browser/memory.max", "1000\n");
+    writeFile("sys/fs/cgroup/browser/memory.high", "max\n");
+    writeFile("sys/fs/cgroup/browser/memory.events", "low 0\nhigh 0\nmax 0\noom 0\noom_kill 0\n");
+    writeFile("sys/fs/cgroup/browser/memory.current", "500\n");
+    m_handler->setFileSystemRoot(m_root);
+    m_handler->start();
+    QCOMPARE(m_moderate->count() + m_low->count() + m_outOfMemory->count(), 0);
+
+    writeFile("sys/fs/cgroup/browser/memory.current", "850\n");
+    check();
+    check();
+    QCOMPARE(m_moderate->count(), 1);
+
+    writeFile("sys/fs/cgroup/browser/memory.current", "920\n");
+    check();
+    check();
+    QCOMPARE(m_low->count(), 1);
+
+    writeFile("sys/fs/cgroup/browser/memory.current", "980\n");
+    check();
+    check();
+    QCOMPARE(m_outOfMemory->count(), 1);
+
+    writeFile("sys/fs/cgroup/browser/memory.current", "100\n");
+    check();
+    check();
+    QCOMPARE(m_recovered->count(), 1);
+    QCOMPARE(m_moderate->count(), 1);
+    QCOMPARE(m_low->count(), 1);
+    QCOMPARE(m_outOfMemory->count(), 1);
+}
+
+/*!
+ * Counters of memory.events going up raise the level for one check
+ */
+void tst_LowMemoryHandler::cgroupEvents()
+{
+    writeFile("proc/self/cgroup", "0::/browser\n");
+    writeFile("sys/fs/cgroup/browser/memory.max", "1000\n");
+    writeFile("sys/fs/cgroup/browser/memory.events", "low 0\nhigh 0\nmax 0\noom 0\noom_kill 0\n");
+    writeFile("sys/fs/cgroup/browser/memory.current", "100\n");
+    m_handler->setFileSystemRoot(m_root);
+    m_handler->start();
+
+    writeFile("sys/fs/cgroup/browser/memory.events", "low 0\nhigh 3\nmax 0\noom 0\noom_kill 0\n");
+    check();
+    QCOMPARE(m_moderate->count(), 1);
+    check();
+    QCOMPARE(m_recovered->count(), 1);
+
+    writeFile("sys/fs/cgroup/browser/memory.events", "low 0\nhigh 3\nmax 1\noom 1\noom_kill 1\n");
+    check();
+    QCOMPARE(m_outOfMemory->count(), 1);
+    QCOMPARE(m_low->count(), 0);
+    check();
+    QCOMPARE(m_recovered->count(), 2);
+}
+
+QTEST_MAIN(tst_LowMemoryHandler)
+#include "tst_lowmemoryhandler.moc"
@@ -0,0 +1,42 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#   Loads a corpus of pages from a local HTTP server into a browser window,
+#   through the window's network access manager, the shared transport, its
+#   disk cache and cookie jar, with no view and no network. Each run is
+#   done with an empty and with a filled disk cache, over a local link and
+#   over a slow one (latency and bandwidth shaped by the server). Reports
+#   first paint, load finished, requests, bytes and cache hits per page.
+#   Load a recorded corpus, a directory of files laid out by url path with
+#   the pages at its top, with
+#   PAGELOAD_CORPUS=<directory> ./PageLoad_Benchmark
+#   otherwise a generated corpus is used.
+#
+
+TARGET = PageLoad_Benchmark
+QT += network webkit
+
+include(../tests.pri)
+
+include($$ROOT_DIR/browsercore/appfw/appfw-includepath.pri)
+INCLUDEPATH += $$ROOT_DIR/browsercore/core
+INCLUDEPATH += $$ROOT_DIR/browsercore/core/network
+INCLUDEPATH += $$ROOT_DIR/bedrockProvisioning
+LIBS += -lBrowserCore -lBedrockProvisioning
+
+SOURCES += tst_pageload.cpp
@@ -0,0 +1,467 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QtNetwork>
+#include <QPainter>
+#include <QWebFrame>
+#include "bedrockprovisioning.h"
+#include "webpagecontroller.h"
+#include "wrtbrowsercontainer.h"
+#include "webnetworkaccessmanager.h"
+#include "webnetworkrecorder.h"
+
+using namespace WRT;
+
+namespace {
+    const QSize KViewportSize(360, 640);
+    const int KLoadTimeout = 30000;
+    // the server sends the shaped responses in slices of this period
+    const int KTickMs = 10;
+    const int KGeneratedPages = 5;
+    const int KImagesPerPage = 6;
+}
+
+/*!
+ * HTTP/1.1 server of the files of a corpus directory. Every response is
+ * held back by the latency and then sent at most at the bandwidth, in
+ * bytes per second, 0 meaning as fast as the socket takes it. Responses
+ * are fresh for an hour, so a filled cache serves them.
+ */
+class CorpusServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    CorpusServer() : m_latency(0), m_bandwidth(0), m_requests(0), m_bytes(0)
+    {
+        connect(&m_ticker, SIGNAL(timeout()), this, SLOT(tick()));
+        m_clock.start();
+    }
+
+    void setCorpus(const QString& directory) { m_corpus = directory; }
+    void setShaping(int latency, int bandwidth) { m_latency = latency; m_bandwidth = bandwidth; }
+    int requests() const { return m_requests; }
+    qint64 bytes() const { return m_bytes; }
+    void reset() { m_requests = 0; m_bytes = 0; }
+
+protected:
+    void incomingConnection(int socketDescriptor)
+    {
+        QTcpSocket* socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(socketDescriptor);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    }
+
+private slots:
+    void readRequest()
+    {
+        QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+            QByteArray path = buffer.left(buffer.indexOf("\r\n")).split(' ').value(1);
+            buffer.remove(0, end + 4);
+            m_requests++;
+            Response response;
+            response.m_socket = socket;
+            response.m_due = m_clock.elapsed() + m_latency;
+            response.m_data = respond(QUrl::fromEncoded(path).path());
+            m_bytes += response.m_data.size();
+            m_responses.append(response);
+        }
+        tick();
+    }
+
+    // sends what is due, within the bandwidth of one tick per connection
+    void tick()
+    {
+        qint64 now = m_clock.elapsed();
+        qint64 slice = m_bandwidth > 0 ? qint64(m_bandwidth) * KTickMs / 1000 : -1;
+        QHash<QTcpSocket*, qint64> budget;
+        // a connection's responses go out in order, one not yet sent in
+        // full holds back the ones after it
+        QSet<QTcpSocket*> blocked;
+        for (int i = 0; i < m_responses.count(); ) {
+            Response& response = m_responses[i];
+            QTcpSocket* socket = response.m_socket;
+            if (blocked.contains(socket) || response.m_due > now) {
+                blocked.insert(socket);
+                i++;
+                continue;
+            }
+            qint64 size = response.m_data.size();
+            if (slice >= 0) {
+                qint64 left = budget.contains(socket) ? budget.value(socket) : slice;
+                size = qMin(size, left);
+                budget.insert(socket, left - size);
+            }
+            socket->write(response.m_data.left(size));
+            response.m_data.remove(0, size);
+            if (response.m_data.isEmpty()) {
+                m_responses.removeAt(i);
+            } else {
+                blocked.insert(socket);
+                i++;
+            }
+        }
+        if (m_responses.isEmpty())
+            m_ticker.stop();
+        else if (!m_ticker.isActive())
+            m_ticker.start(KTickMs);
+    }
+
+    void onDisconnected()
+    {
+        QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+        m_buffers.remove(socket);
+        for (int i = m_responses.count() - 1; i >= 0; i--) {
+            if (m_responses.at(i).m_socket == socket)
+                m_responses.removeAt(i);
+        }
+        socket->deleteLater();
+    }
+
+private:
+    QByteArray respond(const QString& path)
+    {
+        QFile file(m_corpus + path);
+        if (path.contains("..") || !file.open(QIODevice::ReadOnly)) {
+            return "HTTP/1.1 404 Not Found\r\n"
+                   "Content-Length: 0\r\n"
+                   "Connection: keep-alive\r\n"
+                   "\r\n";
+        }
+        QByteArray body = file.readAll();
+        QByteArray type = "application/octet-stream";
+        if (path.endsWith(".html"))
+            type = "text/html";
+        else if (path.endsWith(".css"))
+            type = "text/css";
+        else if (path.endsWith(".js"))
+            type = "application/javascript";
+        else if (path.endsWith(".png"))
+            type = "image/png";
+        else if (path.endsWith(".jpg"))
+            type = "image/jpeg";
+        QByteArray header = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: " + type + "\r\n"
+                            "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                            "Cache-Control: max-age=3600\r\n"
+                            "Connection: keep-alive\r\n";
+        if (path.endsWith(".html"))
+            header += "Set-Cookie: visited=" + QFileInfo(path).baseName().toLatin1() + "; path=/\r\n";
+        return header + "\r\n" + body;
+    }
+
+private:
+    struct Response
+    {
+        QTcpSocket* m_socket;
+        qint64 m_due;
+        QByteArray m_data;
+    };
+
+    QString m_corpus;
+    int m_latency;
+    int m_bandwidth;
+    int m_requests;
+    qint64 m_bytes;
+    QElapsedTimer m_clock;
+    QTimer m_ticker;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QList<Response> m_responses;
+};
+
+/*!
+ * What one page load took
+ */
+struct PageLoad
+{
+    bool m_ok;
+    qint64 m_firstPaint;
+    qint64 m_finished;
+    int m_requests;
+    int m_cacheHits;
+    qint64 m_bytes;
+};
+
+/*!
+ * Times the first repaint and the end of a load of a page without a view
+ */
+class LoadWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    LoadWatcher(QWebPage* page) : m_firstPaint(-1), m_finished(-1), m_ok(false)
+    {
+        connect(page, SIGNAL(repaintRequested(const QRect&)), this, SLOT(onRepaintRequested()));
+        connect(page, SIGNAL(loadFinished(bool)), this, SLOT(onLoadFinished(bool)));
+    }
+
+    void start() { m_firstPaint = -1; m_finished = -1; m_ok = false; m_clock.start(); }
+
+    qint64 m_firstPaint;
+    qint64 m_finished;
+    bool m_ok;
+
+signals:
+    void finished();
+
+private slots:
+    void onRepaintRequested()
+    {
+        if (m_firstPaint < 0 && m_clock.isValid())
+            m_firstPaint = m_clock.elapsed();
+    }
+
+    void onLoadFinished(bool ok)
+    {
+        m_finished = m_clock.elapsed();
+        m_ok = ok;
+        emit finished();
+    }
+
+private:
+    QElapsedTimer m_clock;
+};
+
+class tst_PageLoad : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void corpus_data();
+    void corpus();
+
+private:
+    void generateCorpus(const QString& directory);
+    void clearCache();
+    QList<PageLoad> loadCorpus();
+
+private:
+    CorpusServer m_server;
+    QString m_dir;
+    QString m_corpus;
+    QStringList m_pages;
+};
+
+void tst_PageLoad::initTestCase()
+{
+    m_dir = QDir::temp().filePath("tst_pageload");
+    QDir().mkpath(m_dir + "/cache");
+
+    m_corpus = QString::fromLocal8Bit(qgetenv("PAGELOAD_CORPUS"));
+    if (m_corpus.isEmpty()) {
+        m_corpus = m_dir + "/corpus";
+        generateCorpus(m_corpus);
+    }
+    m_pages = QDir(m_corpus).entryList(QStringList() << "*.html" << "*.htm", QDir::Files, QDir::Name);
+    QVERIFY(!m_pages.isEmpty());
+    m_server.setCorpus(m_corpus);
+    QVERIFY(m_server.listen(QHostAddress::LocalHost));
+
+    // The settings of the test are kept apart from the browser's: no
+    // restored windows; the disk cache and the cookies in the test's directory
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir);
+    BEDROCK_PROVISIONING::BedrockProvisioning* settings =
+        BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning();
+    settings->setValue("SaveSession", 0);
+    settings->setValue("DataBaseDirectory", m_dir + "/");
+    settings->setValue("DiskCacheEnabled", 1);
+    settings->setValue("DiskCacheDirectoryPath", m_dir + "/cache");
+    settings->setValue("DiskCacheMaxSize", 20 * 1024 * 1024);
+}
+
+void tst_PageLoad::cleanupTestCase()
+{
+    QString settingsFile = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->fileName();
+    QFile::remove(settingsFile);
+    QDir().rmdir(QFileInfo(settingsFile).path());
+}
+
+/*!
+ * Pages sharing a style sheet, a script and some images, each with images
+ * of its own, about the weight of a mobile news page
+ */
+void tst_PageLoad::generateCorpus(const QString& directory)
+{
+    QDir().mkpath(directory + "/static");
+
+    QFile css(directory + "/static/style.css");
+    if (css.open(QIODevice::WriteOnly)) {
+        for (int i = 0; i < 200; i++)
+            css.write(QString(".rule%1 { margin: %1px; color: #%2; }\n").arg(i).arg(i * 1234 % 0xffffff, 6, 16, QChar('0')).toLatin1());
+        css.close();
+    }
+    QFile js(directory + "/static/script.js");
+    if (js.open(QIODevice::WriteOnly)) {
+        for (int i = 0; i < 100; i++)
+            js.write(QString("function f%1(x) { return x * %1 + document.title.length; }\n").arg(i).toLatin1());
+        js.write("document.addEventListener('DOMContentLoaded', function() { f1(2); }, false);\n");
+        js.close();
+    }
+
+    for (int i = 0; i < KGeneratedPages * KImagesPerPage; i++) {
+        QImage image(160, 120, QImage::Format_RGB32);
+        image.fill(QColor::fromHsv(i * 37 % 360, 160, 200).rgb());
+        QPainter painter(&image);
+        for (int y = 0; y < image.height(); y += 6)
+            painter.drawLine(0, y, image.width(), (y * 7 + i) % image.height());
+        painter.end();
+        image.save(QString("%1/static/image%2.png").arg(directory).arg(i), "PNG");
+    }
+
+    for (int page = 0; page < KGeneratedPages; page++) {
+        QFile html(QString("%1/page%2.html").arg(directory).arg(page));
+        if (!html.open(QIODevice::WriteOnly))
+            continue;
+        html.write(QString("<html><head><title>Page %1</title>"
+                           "<link rel=\"stylesheet\" type=\"text/css\" href=\"/static/style.css\"/>"
+                           "<script type=\"text/javascript\" src=\"/static/script.js\"></script></head><body>")
+                   .arg(page).toLatin1());
+        for (int i = 0; i < KImagesPerPage; i++) {
+            // the first half are shared by all the pages
+            int image = i < KImagesPerPage / 2 ? i : page * KImagesPerPage + i;
+            html.write(QString("<p class=\"rule%1\"><img src=\"/static/image%2.png\"/>Paragraph %1 of page %3, "
+                               "some text to lay out around the image.</p>").arg(i).arg(image).arg(page).toLatin1());
+        }
+        html.write("</body></html>");
+        html.close();
+    }
+}
+
+void tst_PageLoad::clearCache()
+{
+    QDir cache(m_dir + "/cache");
+    QDirIterator it(cache.path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        QFile::remove(it.next());
+}
+
+/*!
+ * Loads the pages of the corpus one after the other in a new window, as
+ * a user following links would
+ */
+QList<PageLoad> tst_PageLoad::loadCorpus()
+{
+    QList<PageLoad> loads;
+    WebPageController controller;
+    WrtBrowserContainer* page = controller.openPage();
+    page->setViewportSize(KViewportSize);
+    WebNetworkAccessManager* manager = qobject_cast<WebNetworkAccessManager*>(page->networkAccessManager());
+    if (!manager)
+        return loads;
+    LoadWatcher watcher(page);
+
+    foreach (const QString& name, m_pages) {
+        QEventLoop loop;
+        connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        QTimer::singleShot(KLoadTimeout, &loop, SLOT(quit()));
+        watcher.start();
+        page->mainFrame()->load(QUrl(QString("http://127.0.0.1:%1/%2").arg(m_server.serverPort()).arg(name)));
+        if (watcher.m_finished < 0)
+            loop.exec();
+
+        PageLoad load;
+        load.m_ok = watcher.m_ok;
+        load.m_firstPaint = watcher.m_firstPaint;
+        load.m_finished = watcher.m_finished;
+        load.m_requests = 0;
+        load.m_cacheHits = 0;
+        load.m_bytes = 0;
+        foreach (const WebNetworkRecorder::Entry& entry, manager->recorder()->entries()) {
+            load.m_requests++;
+            load.m_bytes += entry.m_bytes;
+            if (entry.m_fromCache)
+                load.m_cacheHits++;
+        }
+        loads << load;
+    }
+    return loads;
+}
+
+void tst_PageLoad::corpus_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("bandwidth");
+    QTest::addColumn<bool>("warm");
+
+    QTest::newRow("local link, cold cache") << 0 << 0 << false;
+    QTest::newRow("local link, warm cache") << 0 << 0 << true;
+    // about a 3G link: 150 ms round trip, 1 Mbit/s down
+    QTest::newRow("slow link, cold cache") << 150 << 128 * 1024 << false;
+    QTest::newRow("slow link, warm cache") << 150 << 128 * 1024 << true;
+}
+
+/*!
+ * Time to load the whole corpus. A warm run fills the cache with a first,
+ * untimed, run in another window set, so the transport and its cache are
+ * built again from the disk as at a browser start.
+ */
+void tst_PageLoad::corpus()
+{
+    QFETCH(int, latency);
+    QFETCH(int, bandwidth);
+    QFETCH(bool, warm);
+
+    m_server.setShaping(latency, bandwidth);
+    clearCache();
+    if (warm)
+        QCOMPARE(loadCorpus().count(), m_pages.count());
+
+    m_server.reset();
+    QList<PageLoad> loads;
+    QBENCHMARK_ONCE {
+        loads = loadCorpus();
+    }
+    QCOMPARE(loads.count(), m_pages.count());
+
+    int requests = 0;
+    int cacheHits = 0;
+    qint64 bytes = 0;
+    for (int i = 0; i < loads.count(); i++) {
+        const PageLoad& load = loads.at(i);
+        QVERIFY2(load.m_ok, qPrintable(m_pages.at(i)));
+        qDebug() << m_pages.at(i) << "first paint" << load.m_firstPaint << "ms, load finished" << load.m_finished
+                 << "ms," << load.m_requests << "requests," << load.m_bytes << "bytes,"
+                 << load.m_cacheHits << "from cache";
+        requests += load.m_requests;
+        cacheHits += load.m_cacheHits;
+        bytes += load.m_bytes;
+    }
+    qDebug() << "total" << requests << "requests," << bytes << "bytes, cache hit rate"
+             << (requests ? cacheHits * 100 / requests : 0) << "%," << m_server.requests()
+             << "requests and" << m_server.bytes() << "bytes served";
+
+    // the filled cache answers for the server
+    if (warm) {
+        QVERIFY(cacheHits > 0);
+        QVERIFY(m_server.requests() < requests);
+    }
+}
+
+QTEST_MAIN(tst_PageLoad)
+#include "tst_pageload.moc"
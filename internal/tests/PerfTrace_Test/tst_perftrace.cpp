@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QThread>
+#include "wrtperftracer.h"
+
+namespace {
+    // the ring size of a thread
+    const int KRingCapacity = 16384;
+    const int KEvents = KRingCapacity * 4;
+}
+
+/*!
+ * Records KEvents counter events, numbered from 0
+ */
+class TraceWriter : public QThread
+{
+protected:
+    void run()
+    {
+        for (int i = 0; i < KEvents; i++)
+            WrtPerfTracer::tracer()->counter(WrtPerfTracer::Cache, "sequence", i);
+    }
+};
+
+class tst_PerfTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void exportWhileWrapping();
+
+private:
+    QList<int> sequence();
+
+private:
+    int m_savedCategories;
+};
+
+void tst_PerfTrace::initTestCase()
+{
+    m_savedCategories = WrtPerfTracer::categories();
+    WrtPerfTracer::setCategories(WrtPerfTracer::Cache);
+}
+
+void tst_PerfTrace::cleanupTestCase()
+{
+    WrtPerfTracer::setCategories(m_savedCategories);
+}
+
+/*!
+ * The values of the exported "sequence" counter events
+ */
+QList<int> tst_PerfTrace::sequence()
+{
+    QList<int> values;
+    QRegExp value("\"args\":\\{\"value\":(\\d+)\\}");
+    QString json = QString::fromUtf8(WrtPerfTracer::tracer()->toTraceJson());
+    foreach (const QString& item, json.split(",\n")) {
+        if (item.contains("\"name\":\"sequence\"") && value.indexIn(item) >= 0)
+            values << value.cap(1).toInt();
+    }
+    return values;
+}
+
+/*!
+ * An export during the writes may miss the events being overwritten, but
+ * never shows one out of order; once the writer is done the ring holds
+ * the last KRingCapacity events
+ */
+void tst_PerfTrace::exportWhileWrapping()
+{
+    TraceWriter writer;
+    writer.setObjectName("writer");
+    writer.start();
+    while (!writer.isFinished()) {
+        QList<int> values = sequence();
+        QVERIFY(values.count() <= KRingCapacity);
+        for (int i = 1; i < values.count(); i++)
+            QVERIFY(values.at(i) > values.at(i - 1));
+    }
+    writer.wait();
+
+    QList<int> values = sequence();
+    QCOMPARE(values.count(), KRingCapacity);
+    for (int i = 0; i < values.count(); i++)
+        QCOMPARE(values.at(i), KEvents - KRingCapacity + i);
+}
+
+QTEST_MAIN(tst_PerfTrace)
+#include "tst_perftrace.moc"
@@ -0,0 +1,32 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#
+
+TARGET = ServiceIpcSharedRing_Test
+QT += core network
+
+include(../tests.pri)
+
+INCLUDEPATH += $$ROOT_DIR/utilities/serviceipcclient \
+               $$ROOT_DIR/utilities/serviceipcserver
+
+HEADERS += $$ROOT_DIR/utilities/serviceipcclient/serviceipcsharedring_p.h
+SOURCES += tst_serviceipcsharedring.cpp \
+           $$ROOT_DIR/utilities/serviceipcclient/serviceipcsharedring.cpp
+LIBS += -lbrserviceipcclient -lbrserviceipcserver -lrt
@@ -0,0 +1,284 @@
+/**
+   This file is part of CWRT package **
+
+   Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies). **
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU (Lesser) General Public License as
+   published by the Free Software Foundation, version 2.1 of the License.
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   (Lesser) General Public License for more details. You should have
+   received a copy of the GNU (Lesser) General Public License along
+   with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtTest/QtTest>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "serviceipcsharedring_p.h"
+#include "serviceipc.h"
+#include "serviceipcserver.h"
+#include "serviceipcobserver.h"
+#include "serviceipcrequest.h"
+
+using namespace WRT;
+
+namespace {
+    const int KCapacity = 4096;
+
+    // Offsets of the fields in the shared segment header
+    const int KCapacityOffset = 4;
+    const int KHeadOffset = 8;
+
+    QString ringName(const char* aTag)
+    {
+        return QString("/wrtipc_test_%1_%2").arg(QCoreApplication::applicationPid())
+                                            .arg(aTag);
+    }
+
+    // Overwrite a header field the way a misbehaving peer could
+    void pokeHeader(const QString& aName, int aOffset, quint32 aValue)
+    {
+        int fd = shm_open(QFile::encodeName(aName).constData(), O_RDWR, 0);
+        QVERIFY(fd != -1);
+        void* addr = mmap(NULL, aOffset + 4, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        QVERIFY(addr != MAP_FAILED);
+        *reinterpret_cast<volatile quint32*>(static_cast<char*>(addr) + aOffset) = aValue;
+        munmap(addr, aOffset + 4);
+    }
+
+    // Replies to every request with its own data
+    class EchoObserver : public MServiceIPCObserver
+    {
+    public:
+        bool handleRequest(ServiceIPCRequest* aRequest)
+        {
+            aRequest->write(aRequest->getData());
+            return aRequest->completeRequest();
+        }
+        void handleCancelRequest(ServiceIPCRequest*) {}
+        void handleClientConnect(ClientInfo*) {}
+        void handleClientDisconnect(ClientInfo*) {}
+    };
+
+    // Runs an echo server in its own event loop so that the client's
+    // synchronous calls can block in the test thread
+    class EchoServerThread : public QThread
+    {
+    public:
+        EchoServerThread(const QString& aServerName)
+            : m_serverName(aServerName)
+            , m_ready(false)
+            , m_listening(false)
+        {
+        }
+
+        bool waitForListening()
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_ready) {
+                m_readyCondition.wait(&m_mutex);
+            }
+            return m_listening;
+        }
+
+    protected:
+        void run()
+        {
+            EchoObserver observer;
+            ServiceFwIPCServer server(&observer, NULL, ELocalSocket);
+            bool listening = server.listen(m_serverName);
+            m_mutex.lock();
+            m_listening = listening;
+            m_ready = true;
+            m_readyCondition.wakeAll();
+            m_mutex.unlock();
+            if (listening) {
+                exec();
+            }
+            server.disconnect();
+        }
+
+    private:
+        QString m_serverName;
+        QMutex m_mutex;
+        QWaitCondition m_readyCondition;
+        bool m_ready;
+        bool m_listening;
+    };
+}
+
+class tst_ServiceIpcSharedRing : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void writeReadWrapAround();
+    void fullRingWritesPartially();
+    void corruptedCountIsRejected();
+    void attachRejectsBadCapacity();
+    void spaceNotification();
+    void loopback_data();
+    void loopback();
+};
+
+void tst_ServiceIpcSharedRing::writeReadWrapAround()
+{
+    ServiceIPCSharedRing writer;
+    ServiceIPCSharedRing reader;
+    QString name = ringName("wrap");
+    QVERIFY(writer.create(name, KCapacity));
+    QVERIFY(reader.attach(name));
+    writer.unlink();
+
+    // Several passes so the indices wrap inside the chunk
+    QByteArray chunk(KCapacity / 3, 'x');
+    for (int i = 0; i < 10; ++i) {
+        chunk.fill('a' + i);
+        QCOMPARE(writer.write(chunk.constData(), chunk.length()), chunk.length());
+        QCOMPARE(reader.bytesAvailable(), chunk.length());
+        QByteArray data;
+        QCOMPARE(reader.read(data), chunk.length());
+        QCOMPARE(data, chunk);
+    }
+    QCOMPARE(reader.bytesAvailable(), 0);
+    QCOMPARE(writer.freeSpace(), KCapacity);
+}
+
+void tst_ServiceIpcSharedRing::fullRingWritesPartially()
+{
+    ServiceIPCSharedRing writer;
+    ServiceIPCSharedRing reader;
+    QString name = ringName("full");
+    QVERIFY(writer.create(name, KCapacity));
+    QVERIFY(reader.attach(name));
+    writer.unlink();
+
+    QByteArray data(KCapacity + 100, 'f');
+    QCOMPARE(writer.write(data.constData(), data.length()), KCapacity);
+    QCOMPARE(writer.freeSpace(), 0);
+    QCOMPARE(writer.write(data.constData(), data.length()), 0);
+    QVERIFY(!writer.waitForSpace(0));
+
+    QByteArray received;
+    QCOMPARE(reader.read(received), KCapacity);
+    QVERIFY(writer.waitForSpace(0));
+}
+
+void tst_ServiceIpcSharedRing::corruptedCountIsRejected()
+{
+    ServiceIPCSharedRing writer;
+    ServiceIPCSharedRing reader;
+    QString name = ringName("corrupt");
+    QVERIFY(writer.create(name, KCapacity));
+    QVERIFY(reader.attach(name));
+
+    // A head more than the capacity ahead of the tail must not be read
+    pokeHeader(name, KHeadOffset, KCapacity * 4);
+    writer.unlink();
+
+    QByteArray data;
+    QCOMPARE(reader.bytesAvailable(), -1);
+    QCOMPARE(reader.read(data), -1);
+    QVERIFY(data.isEmpty());
+    QCOMPARE(writer.write("x", 1), -1);
+    QCOMPARE(writer.freeSpace(), -1);
+    QVERIFY(!writer.waitForSpace(0));
+
+    // A capacity changed after attaching is ignored
+    ServiceIPCSharedRing writer2;
+    ServiceIPCSharedRing reader2;
+    QString name2 = ringName("capacity");
+    QVERIFY(writer2.create(name2, KCapacity));
+    QVERIFY(reader2.attach(name2));
+    pokeHeader(name2, KCapacityOffset, 0x7FFFFFFF);
+    writer2.unlink();
+    QByteArray big(KCapacity * 2, 'b');
+    QCOMPARE(writer2.write(big.constData(), big.length()), KCapacity);
+    QCOMPARE(reader2.read(data), KCapacity);
+}
+
+void tst_ServiceIpcSharedRing::attachRejectsBadCapacity()
+{
+    ServiceIPCSharedRing writer;
+    ServiceIPCSharedRing reader;
+    QString name = ringName("attach");
+    QVERIFY(!writer.create(name, 3000));
+    QVERIFY(writer.create(name, KCapacity));
+    pokeHeader(name, KCapacityOffset, KCapacity * 2);
+    QVERIFY(!reader.attach(name));
+    QVERIFY(!reader.isAttached());
+}
+
+void tst_ServiceIpcSharedRing::spaceNotification()
+{
+    ServiceIPCSharedRing writer;
+    ServiceIPCSharedRing reader;
+    QString name = ringName("notify");
+    QVERIFY(writer.create(name, KCapacity));
+    QVERIFY(reader.attach(name));
+    writer.unlink();
+
+    QVERIFY(reader.wakeWriter());
+    writer.requestSpaceNotification();
+    // Only the first read after the request notifies
+    QVERIFY(!reader.wakeWriter());
+    QVERIFY(reader.wakeWriter());
+}
+
+void tst_ServiceIpcSharedRing::loopback_data()
+{
+    QTest::addColumn<bool>("sharedMemory");
+    QTest::addColumn<int>("messageSize");
+
+    QTest::newRow("socket 1KB") << false << 1024;
+    QTest::newRow("ring 1KB") << true << 1024;
+    QTest::newRow("socket 64KB") << false << 65536;
+    QTest::newRow("ring 64KB") << true << 65536;
+    QTest::newRow("socket 1MB") << false << 1024 * 1024;
+    QTest::newRow("ring 1MB") << true << 1024 * 1024;
+}
+
+/*!
+ Send a message to an echo server running in another thread and read it
+ back, through a client backend made by the IPC factory. The server is
+ the same for both rows, the shared memory client negotiates its rings
+ on connecting.
+ */
+void tst_ServiceIpcSharedRing::loopback()
+{
+    QFETCH(bool, sharedMemory);
+    QFETCH(int, messageSize);
+
+    EchoServerThread serverThread(ringName("loopback"));
+    serverThread.start();
+    QVERIFY(serverThread.waitForListening());
+
+    const QByteArray message(messageSize, 'm');
+    QByteArray received;
+    {
+        ServiceFwIPC client(NULL, sharedMemory ? ESharedMemory : ELocalSocket);
+        if (client.connect(ringName("loopback"))) {
+            QBENCHMARK {
+                if (!client.sendSync("echo", message)) {
+                    received.clear();
+                    break;
+                }
+                received = client.readAll();
+            }
+            client.disconnect();
+        }
+    }
+    serverThread.quit();
+    serverThread.wait();
+    QCOMPARE(received.length(), messageSize);
+    QVERIFY(received == message);
+}
+
+QTEST_MAIN(tst_ServiceIpcSharedRing)
+#include "tst_serviceipcsharedring.moc"
@@ -0,0 +1,302 @@
+/**
+   This file is part of CWRT package **
+
+   Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies). **
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU (Lesser) General Public License as
+   published by the Free Software Foundation, version 2.1 of the License.
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   (Lesser) General Public License for more details. You should have
+   received a copy of the GNU (Lesser) General Public License along
+   with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtTest/QtTest>
+#include <QtNetwork>
+#include "serviceipcframe.h"
+#include "serviceipc.h"
+#include "serviceipcserver.h"
+#include "serviceipcobserver.h"
+#include "serviceipcrequest.h"
+
+using namespace WRT;
+
+namespace {
+    QString serverName(const char* aTag)
+    {
+        return QString("wrtipc_test_%1_%2").arg(QCoreApplication::applicationPid())
+                                           .arg(aTag);
+    }
+
+    QList<QByteArray> requestFields(const QByteArray& aType, const QByteArray& aData)
+    {
+        QList<QByteArray> fields;
+        fields.append(aType);
+        fields.append(aData);
+        return fields;
+    }
+
+    // Replies to every request with its own data
+    class EchoObserver : public MServiceIPCObserver
+    {
+    public:
+        bool handleRequest(ServiceIPCRequest* aRequest)
+        {
+            aRequest->write(aRequest->getData());
+            return aRequest->completeRequest();
+        }
+        void handleCancelRequest(ServiceIPCRequest*) {}
+        void handleClientConnect(ClientInfo*) {}
+        void handleClientDisconnect(ClientInfo*) {}
+    };
+
+    // Runs an echo server in its own event loop so that the client's
+    // synchronous calls can block in the test thread
+    class EchoServerThread : public QThread
+    {
+    public:
+        EchoServerThread(const QString& aServerName)
+            : m_serverName(aServerName)
+            , m_ready(false)
+            , m_listening(false)
+        {
+        }
+
+        bool waitForListening()
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_ready) {
+                m_readyCondition.wait(&m_mutex);
+            }
+            return m_listening;
+        }
+
+    protected:
+        void run()
+        {
+            EchoObserver observer;
+            ServiceFwIPCServer server(&observer, NULL, ELocalSocket);
+            bool listening = server.listen(m_serverName);
+            m_mutex.lock();
+            m_listening = listening;
+            m_ready = true;
+            m_readyCondition.wakeAll();
+            m_mutex.unlock();
+            if (listening) {
+                exec();
+            }
+            server.disconnect();
+        }
+
+    private:
+        QString m_serverName;
+        QMutex m_mutex;
+        QWaitCondition m_readyCondition;
+        bool m_ready;
+        bool m_listening;
+    };
+
+    // Connect once to a server that never answers, as a server built before
+    // the binary protocol leaves the negotiation request to its observer.
+    // The client then speaks the text protocol to any server of that name.
+    bool pinTextProtocol(const QString& aServerName)
+    {
+        QLocalServer::removeServer(aServerName);
+        QLocalServer silentServer;
+        if (!silentServer.listen(aServerName)) {
+            return false;
+        }
+        ServiceFwIPC client(NULL, ELocalSocket);
+        bool connected = client.connect(aServerName);
+        client.disconnect();
+        silentServer.close();
+        return connected;
+    }
+}
+
+class tst_ServiceIpcFrame : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void severalFramesInOneRead();
+    void frameSplitAcrossReads();
+    void malformedField();
+    void textServerFallback();
+    void throughput_data();
+    void throughput();
+};
+
+void tst_ServiceIpcFrame::roundTrip()
+{
+    QByteArray data("attribute;dump;with;delimiters");
+    QByteArray encoded = ServiceIPCFrame::encode(ServiceIPCFrame::ERequest, 42,
+                                                 requestFields("getattr", data));
+    QCOMPARE(encoded.length(), ServiceIPCFrame::KHeaderLength
+             + 2 * ServiceIPCFrame::KFieldHeaderLength + 7 + data.length());
+
+    ServiceIPCFrameReader reader;
+    reader.append(encoded);
+    ServiceIPCFrame frame;
+    QVERIFY(reader.next(frame));
+    QCOMPARE(frame.m_Opcode, quint16(ServiceIPCFrame::ERequest));
+    QCOMPARE(frame.m_RequestId, quint32(42));
+    QCOMPARE(frame.m_Fields.count(), 2);
+    QCOMPARE(frame.m_Fields[0], QByteArray("getattr"));
+    QCOMPARE(frame.m_Fields[1], data);
+    QVERIFY(!reader.hasPendingData());
+    QVERIFY(!reader.next(frame));
+}
+
+void tst_ServiceIpcFrame::severalFramesInOneRead()
+{
+    // A single readyRead can carry several replies, all must come out
+    QByteArray data;
+    for (int i = 1; i <= 3; ++i) {
+        data.append(ServiceIPCFrame::encode(ServiceIPCFrame::EReply, i,
+                    QList<QByteArray>() << QByteArray::number(i)));
+    }
+
+    ServiceIPCFrameReader reader;
+    reader.append(data);
+    ServiceIPCFrame frame;
+    for (int i = 1; i <= 3; ++i) {
+        QVERIFY(reader.next(frame));
+        QCOMPARE(frame.m_RequestId, quint32(i));
+        QCOMPARE(frame.m_Fields.value(0), QByteArray::number(i));
+    }
+    QVERIFY(!reader.next(frame));
+    QVERIFY(!reader.hasPendingData());
+}
+
+void tst_ServiceIpcFrame::frameSplitAcrossReads()
+{
+    QByteArray encoded = ServiceIPCFrame::encode(ServiceIPCFrame::EReply, 7,
+                         QList<QByteArray>() << QByteArray(1000, 'x'));
+
+    ServiceIPCFrameReader reader;
+    ServiceIPCFrame frame;
+    // Header split first, then the payload in uneven chunks
+    reader.append(encoded.left(5));
+    QVERIFY(!reader.next(frame));
+    reader.append(encoded.mid(5, 300));
+    QVERIFY(!reader.next(frame));
+    reader.append(encoded.mid(305));
+    QVERIFY(reader.next(frame));
+    QCOMPARE(frame.m_RequestId, quint32(7));
+    QCOMPARE(frame.m_Fields.value(0), QByteArray(1000, 'x'));
+}
+
+void tst_ServiceIpcFrame::malformedField()
+{
+    QByteArray encoded = ServiceIPCFrame::encode(ServiceIPCFrame::ERequest, 1,
+                                                 requestFields("op", "data"));
+    // Claim a second field longer than the payload
+    uchar* p = reinterpret_cast<uchar*>(encoded.data()) + ServiceIPCFrame::KHeaderLength
+               + ServiceIPCFrame::KFieldHeaderLength + 2;
+    qToBigEndian<quint32>(0xFFFF, p);
+    encoded.append(ServiceIPCFrame::encode(ServiceIPCFrame::ERequest, 2,
+                                           requestFields("op", "next")));
+
+    ServiceIPCFrameReader reader;
+    reader.append(encoded);
+    ServiceIPCFrame frame;
+    // The broken field is dropped but the stream stays in sync
+    QVERIFY(reader.next(frame));
+    QCOMPARE(frame.m_RequestId, quint32(1));
+    QCOMPARE(frame.m_Fields.count(), 1);
+    QVERIFY(reader.next(frame));
+    QCOMPARE(frame.m_RequestId, quint32(2));
+    QCOMPARE(frame.m_Fields.value(1), QByteArray("next"));
+}
+
+/*!
+ A server that does not answer the negotiation is spoken to with the text
+ protocol on a new connection, the unanswered request stays on the old one
+ */
+void tst_ServiceIpcFrame::textServerFallback()
+{
+    QString name = serverName("fallback");
+    QLocalServer::removeServer(name);
+    QLocalServer silentServer;
+    QVERIFY(silentServer.listen(name));
+
+    ServiceFwIPC client(NULL, ELocalSocket);
+    QVERIFY(client.connect(name));
+
+    QVERIFY(silentServer.waitForNewConnection(1000));
+    QLocalSocket* negotiated = silentServer.nextPendingConnection();
+    QVERIFY(silentServer.waitForNewConnection(1000));
+    QLocalSocket* reconnected = silentServer.nextPendingConnection();
+    QVERIFY(negotiated && reconnected);
+    if (negotiated->state() == QLocalSocket::ConnectedState) {
+        negotiated->waitForDisconnected(1000);
+    }
+    QVERIFY(negotiated->readAll().contains(NEGOTIATEPROTOCOL));
+    QCOMPARE(negotiated->state(), QLocalSocket::UnconnectedState);
+    QTest::qWait(100);
+    QCOMPARE(reconnected->bytesAvailable(), qint64(0));
+    client.disconnect();
+}
+
+void tst_ServiceIpcFrame::throughput_data()
+{
+    QTest::addColumn<bool>("binary");
+    QTest::addColumn<int>("payloadSize");
+
+    QTest::newRow("text 64B") << false << 64;
+    QTest::newRow("binary 64B") << true << 64;
+    QTest::newRow("text 4KB") << false << 4096;
+    QTest::newRow("binary 4KB") << true << 4096;
+    QTest::newRow("text 64KB") << false << 65536;
+    QTest::newRow("binary 64KB") << true << 65536;
+}
+
+/*!
+ Send requests to an echo server in another thread and read the replies,
+ through ServiceFwIPC and ServiceFwIPCServer over a local socket. The
+ binary rows negotiate the framing, the text rows are made to fall back
+ the way they would with an older server.
+ */
+void tst_ServiceIpcFrame::throughput()
+{
+    QFETCH(bool, binary);
+    QFETCH(int, payloadSize);
+
+    QString name = serverName(binary ? "binary" : "text");
+    if (!binary) {
+        QVERIFY(pinTextProtocol(name));
+    }
+    EchoServerThread serverThread(name);
+    serverThread.start();
+    QVERIFY(serverThread.waitForListening());
+
+    const QString type("getdownloadattribute");
+    const QByteArray payload(payloadSize, 'a');
+    const int KRequests = 100;
+    int echoed(0);
+    {
+        ServiceFwIPC client(NULL, ELocalSocket);
+        if (client.connect(name)) {
+            QBENCHMARK {
+                for (int i = 0; i < KRequests; ++i) {
+                    if (client.sendSync(type, payload) && client.readAll() == payload) {
+                        ++echoed;
+                    }
+                }
+            }
+            client.disconnect();
+        }
+    }
+    serverThread.quit();
+    serverThread.wait();
+    QVERIFY(echoed >= KRequests);
+}
+
+QTEST_MAIN(tst_ServiceIpcFrame)
+#include "tst_serviceipcframe.moc"
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QWebPage>
+#include <QWebFrame>
+#include <QWebHistory>
+#include "bedrockprovisioning.h"
+#include "sessionjournal.h"
+#include "webpagecontroller.h"
+#include "wrtbrowsercontainer.h"
+
+using namespace WRT;
+
+namespace {
+    // the journal only uses pages as keys, these are never dereferenced
+    WrtBrowserContainer* fakePage(int i)
+    {
+        return reinterpret_cast<WrtBrowserContainer*>(quintptr(0x1000 + 0x10 * i));
+    }
+}
+
+class tst_SessionJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void tornTail();
+    void appendDuringCompaction();
+    void crashDuringCompaction();
+    void legacyMigration();
+
+private:
+    QList<SessionJournal::Window> windows(int count, int thumbnailSize = 0);
+    QByteArray history(const QString& title);
+
+private:
+    QString m_dir;
+    QString m_fileName;
+};
+
+void tst_SessionJournal::initTestCase()
+{
+    m_dir = QDir::temp().filePath("tst_sessionjournal");
+    QDir().mkpath(m_dir);
+    m_fileName = m_dir + "/session.journal";
+
+    // The settings of the test are kept apart from the browser's
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir);
+    BEDROCK_PROVISIONING::BedrockProvisioning* settings =
+        BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning();
+    settings->setValue("DataBaseDirectory", m_dir);
+    settings->setValue("SaveSession", 1);
+}
+
+void tst_SessionJournal::cleanupTestCase()
+{
+    QString settingsFile = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->fileName();
+    QFile::remove(settingsFile);
+    QDir().rmdir(QFileInfo(settingsFile).path());
+    QDir().rmdir(m_dir);
+}
+
+void tst_SessionJournal::cleanup()
+{
+    QDir dir(m_dir);
+    foreach (const QString& file, dir.entryList(QDir::Files))
+        dir.remove(file);
+}
+
+QList<SessionJournal::Window> tst_SessionJournal::windows(int count, int thumbnailSize)
+{
+    QList<SessionJournal::Window> windows;
+    for (int i = 0; i < count; i++) {
+        SessionJournal::Window window;
+        window.m_url = QString("http://example.com/%1").arg(i);
+        window.m_title = QString("Window %1").arg(i);
+        window.m_thumbnail = QByteArray(thumbnailSize, char(i));
+        windows.append(window);
+    }
+    return windows;
+}
+
+/*!
+ * Returns the history of a page that loaded a document titled \a title,
+ * serialised as the browser did before the journal
+ */
+QByteArray tst_SessionJournal::history(const QString& title)
+{
+    QWebPage page;
+    QSignalSpy loaded(&page, SIGNAL(loadFinished(bool)));
+    page.mainFrame()->setUrl(QUrl(QString("data:text/html,<title>%1</title>").arg(title)));
+    for (int i = 0; i < 50 && loaded.isEmpty(); i++)
+        QTest::qWait(100);
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << *(page.history());
+    return data;
+}
+
+/*!
+ * A record cut short by a crash is dropped, the records before it are kept
+ */
+void tst_SessionJournal::tornTail()
+{
+    {
+        SessionJournal journal(m_fileName);
+        QList<WrtBrowserContainer*> pages;
+        pages << fakePage(0) << fakePage(1);
+        QVERIFY(journal.compact(pages, windows(2), 0));
+        journal.waitForCompaction();
+        journal.windowNavigated(fakePage(1), 1, "http://example.com/kept", "Kept");
+        journal.windowActivated(fakePage(1));
+    }
+
+    // half of a navigation record
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out << quint32(64) << quint16(0) << quint8(4) << quint32(1);
+    file.write(record);
+    file.close();
+
+    SessionJournal journal(m_fileName);
+    QList<SessionJournal::Window> loaded;
+    int activeIndex = -1;
+    QVERIFY(journal.load(loaded, activeIndex));
+    QCOMPARE(loaded.count(), 2);
+    QCOMPARE(activeIndex, 1);
+    QCOMPARE(loaded.at(0).m_url, QString("http://example.com/0"));
+    QCOMPARE(loaded.at(1).m_url, QString("http://example.com/kept"));
+}
+
+/*!
+ * Records appended while the snapshot is written end up after it
+ */
+void tst_SessionJournal::appendDuringCompaction()
+{
+    {
+        SessionJournal journal(m_fileName);
+        QList<WrtBrowserContainer*> pages;
+        for (int i = 0; i < 4; i++)
+            pages << fakePage(i);
+        // big thumbnails keep the writer busy
+        QVERIFY(journal.compact(pages, windows(4, 1024 * 1024), 0));
+        QVERIFY(journal.isOpen());
+        journal.windowClosed(fakePage(0));
+        journal.windowNavigated(fakePage(2), 1, "http://example.com/during", "During");
+        journal.windowNavigated(fakePage(4), 3, "http://example.com/new", "New");
+        journal.windowActivated(fakePage(4));
+        journal.waitForCompaction();
+        QVERIFY(!QFile::exists(m_fileName + ".new"));
+    }
+
+    SessionJournal journal(m_fileName);
+    QList<SessionJournal::Window> loaded;
+    int activeIndex = -1;
+    QVERIFY(journal.load(loaded, activeIndex));
+    QCOMPARE(loaded.count(), 4);
+    QCOMPARE(activeIndex, 3);
+    QCOMPARE(loaded.at(0).m_url, QString("http://example.com/1"));
+    QCOMPARE(loaded.at(1).m_url, QString("http://example.com/during"));
+    QCOMPARE(loaded.at(2).m_url, QString("http://example.com/3"));
+    QCOMPARE(loaded.at(2).m_thumbnail.size(), 1024 * 1024);
+    QCOMPARE(loaded.at(3).m_url, QString("http://example.com/new"));
+}
+
+/*!
+ * A crash before the snapshot replaces the journal leaves the old session,
+ * the records appended meanwhile do not apply to its windows
+ */
+void tst_SessionJournal::crashDuringCompaction()
+{
+    QString crashedFileName = m_dir + "/crashed.journal";
+    {
+        SessionJournal journal(m_fileName);
+        QList<WrtBrowserContainer*> pages;
+        for (int i = 0; i < 4; i++)
+            pages << fakePage(i);
+        QVERIFY(journal.compact(pages, windows(4), 0));
+        journal.waitForCompaction();
+        journal.windowClosed(fakePage(0));
+
+        // the snapshot numbers the three windows left from 1 again
+        pages.removeFirst();
+        QVERIFY(journal.compact(pages, windows(3, 1024 * 1024), 0));
+        journal.windowNavigated(fakePage(1), 0, "http://example.com/during", "During");
+        journal.windowClosed(fakePage(2));
+        journal.windowActivated(fakePage(3));
+
+        // what is on disk if the process dies now
+        QVERIFY(QFile::copy(m_fileName, crashedFileName));
+        journal.waitForCompaction();
+    }
+
+    SessionJournal journal(crashedFileName);
+    QList<SessionJournal::Window> loaded;
+    int activeIndex = -1;
+    QVERIFY(journal.load(loaded, activeIndex));
+    QCOMPARE(loaded.count(), 3);
+    QCOMPARE(activeIndex, 0);
+    QCOMPARE(loaded.at(0).m_url, QString("http://example.com/1"));
+    QCOMPARE(loaded.at(1).m_url, QString("http://example.com/2"));
+    QCOMPARE(loaded.at(2).m_url, QString("http://example.com/3"));
+}
+
+/*!
+ * A session saved in the old files is moved into the journal, once
+ */
+void tst_SessionJournal::legacyMigration()
+{
+    QStringList titles;
+    titles << "First" << "Second" << "Third";
+    for (int i = 0; i < titles.count(); i++) {
+        QFile file(m_dir + QString("/history%1.history").arg(i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(history(titles.at(i)));
+    }
+    QFile numWindow(m_dir + "/numwindow.dat");
+    QVERIFY(numWindow.open(QIODevice::WriteOnly));
+    QTextStream(&numWindow) << titles.count();
+    numWindow.close();
+    QFile activeWindow(m_dir + "/activewindow.dat");
+    QVERIFY(activeWindow.open(QIODevice::WriteOnly));
+    QTextStream(&activeWindow) << 1;
+    activeWindow.close();
+
+    {
+        WebPageController controller;
+        controller.openPage();
+        controller.loadFromHistory();
+        QCOMPARE(controller.pageCount(), titles.count());
+        QCOMPARE(controller.allPages()->indexOf(controller.currentPage()), 1);
+        QCOMPARE(controller.currentPage()->history()->currentItem().title(), QString("Second"));
+    }
+
+    QVERIFY(QFile::exists(m_fileName));
+    QVERIFY(!QFile::exists(m_dir + "/numwindow.dat"));
+    QVERIFY(!QFile::exists(m_dir + "/activewindow.dat"));
+    for (int i = 0; i < titles.count(); i++)
+        QVERIFY(!QFile::exists(m_dir + QString("/history%1.history").arg(i)));
+
+    SessionJournal journal(m_fileName);
+    QList<SessionJournal::Window> loaded;
+    int activeIndex = -1;
+    QVERIFY(journal.load(loaded, activeIndex));
+    QCOMPARE(loaded.count(), titles.count());
+    QCOMPARE(activeIndex, 1);
+    for (int i = 0; i < titles.count(); i++)
+        QCOMPARE(loaded.at(i).m_title, titles.at(i));
+}
+
+QTEST_MAIN(tst_SessionJournal)
+#include "tst_sessionjournal.moc"
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QImage>
+#include "bedrockprovisioning.h"
+#include "sessionjournal.h"
+#include "webpagecontroller.h"
+#include "wrtbrowsercontainer.h"
+
+using namespace WRT;
+
+namespace {
+    // MAX_NUM_WINDOWS of the controller, windows past it are not restored
+    const int KMaxWindows = 5;
+}
+
+class tst_SessionRestore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void restore_data();
+    void restore();
+
+private:
+    QByteArray writeSession(int windowCount, int activeIndex);
+    void removeSessionDir(const QString& dir);
+
+private:
+    QString m_dir;
+    QByteArray m_thumbnail;
+};
+
+void tst_SessionRestore::initTestCase()
+{
+    m_dir = QDir::temp().filePath("tst_sessionrestore");
+    QDir().mkpath(m_dir);
+
+    // The settings of the test are kept apart from the browser's
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir);
+    BEDROCK_PROVISIONING::BedrockProvisioning* settings =
+        BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning();
+    settings->setValue("SaveSession", 1);
+
+    // About the size of the window switcher captures
+    QImage image(180, 280, QImage::Format_RGB32);
+    image.fill(0xff336699);
+    QBuffer buffer(&m_thumbnail);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+}
+
+void tst_SessionRestore::cleanupTestCase()
+{
+    QString settingsFile = BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->fileName();
+    QFile::remove(settingsFile);
+    QDir().rmdir(QFileInfo(settingsFile).path());
+    QDir().rmdir(m_dir);
+}
+
+/*!
+ * Returns a session journal as saved at exit, with \a windowCount windows
+ */
+QByteArray tst_SessionRestore::writeSession(int windowCount, int activeIndex)
+{
+    QString fileName = m_dir + "/session.journal";
+    SessionJournal journal(fileName);
+    QList<WrtBrowserContainer*> pages;
+    QList<SessionJournal::Window> windows;
+    for (int i = 0; i < windowCount; i++) {
+        SessionJournal::Window window;
+        window.m_url = "about:blank";
+        window.m_title = QString("Window %1").arg(i);
+        window.m_thumbnail = m_thumbnail;
+        pages.append(0);
+        windows.append(window);
+    }
+    journal.compact(pages, windows, activeIndex);
+    journal.waitForCompaction();
+
+    QFile file(fileName);
+    file.open(QIODevice::ReadOnly);
+    QByteArray session = file.readAll();
+    file.close();
+    journal.remove();
+    return session;
+}
+
+void tst_SessionRestore::removeSessionDir(const QString& dir)
+{
+    QDir sessionDir(dir);
+    foreach (const QString& file, sessionDir.entryList(QDir::Files))
+        sessionDir.remove(file);
+    QDir().rmdir(dir);
+}
+
+void tst_SessionRestore::restore_data()
+{
+    QTest::addColumn<int>("windowCount");
+
+    QTest::newRow("1 window") << 1;
+    QTest::newRow("10 windows") << 10;
+    QTest::newRow("50 windows") << 50;
+}
+
+void tst_SessionRestore::restore()
+{
+    QFETCH(int, windowCount);
+    QByteArray session = writeSession(windowCount, windowCount / 2);
+    QVERIFY(!session.isEmpty());
+
+    // A controller rewrites the journal with the windows it kept once it has
+    // restored them, and again when it is deleted, so they are only deleted
+    // once the measurement is over. Each one restores a copy of the session
+    // in a directory of its own.
+    BEDROCK_PROVISIONING::BedrockProvisioning* settings =
+        BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning();
+    QList<WebPageController*> controllers;
+    QList<int> savedCounts;
+    QBENCHMARK {
+        QString dir = m_dir + QString("/%1").arg(controllers.count());
+        QDir().mkpath(dir);
+        QFile file(dir + "/session.journal");
+        file.open(QIODevice::WriteOnly);
+        file.write(session);
+        file.close();
+        settings->setValue("DataBaseDirectory", dir);
+
+        WebPageController* controller = new WebPageController;
+        controllers.append(controller);
+        controller->openPage();
+        // read by openPage() already
+        savedCounts.append(controller->historyWindowCount());
+        controller->loadFromHistory();
+    }
+
+    // Every iteration restored the whole session
+    foreach (int count, savedCounts)
+        QCOMPARE(count, windowCount);
+
+    // Only the active window has a page
+    foreach (WebPageController* controller, controllers) {
+        QCOMPARE(controller->pageCount(), qMin(windowCount, KMaxWindows));
+        QCOMPARE(controller->allPages()->count() - controller->allPages()->count(0), 1);
+        QCOMPARE(controller->allPages()->indexOf(controller->currentPage()),
+                 qMin(windowCount / 2, KMaxWindows - 1));
+    }
+    for (int i = 0; i < controllers.count(); i++) {
+        delete controllers.at(i);
+        removeSessionDir(m_dir + QString("/%1").arg(i));
+    }
+}
+
+QTEST_MAIN(tst_SessionRestore)
+#include "tst_sessionrestore.moc"
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <QtNetwork>
+#include "bedrockprovisioning.h"
+#include "webpagecontroller.h"
+#include "wrtbrowsercontainer.h"
+
+using namespace WRT;
+
+/*!
+ * Minimal HTTP/1.1 server that keeps connections alive and counts them
+ */
+class KeepAliveServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    KeepAliveServer() : m_connections(0), m_requests(0) {}
+
+    int connections() const { return m_connections; }
+    int requests() const { return m_requests; }
+    void reset() { m_connections = 0; m_requests = 0; }
+
+protected:
+    void incomingConnection(int socketDescriptor)
+    {
+        QTcpSocket* socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(socketDescriptor);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        m_connections++;
+    }
+
+private slots:
+    void readRequest()
+    {
+        QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+            buffer.remove(0, end + 4);
+            m_requests++;
+            socket->write("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/html\r\n"
+                          "Content-Length: 28\r\n"
+                          "Cache-Control: no-store\r\n"
+                          "Connection: keep-alive\r\n"
+                          "\r\n"
+                          "<html><body>ok</body></html>");
+        }
+    }
+
+private:
+    int m_connections;
+    int m_requests;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+};
+
+class tst_SharedTransport : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void connections_data();
+    void connections();
+
+private:
+    bool load(QNetworkAccessManager* manager, int window);
+
+private:
+    KeepAliveServer m_server;
+    QVariant m_savedSaveSession;
+};
+
+void tst_SharedTransport::initTestCase()
+{
+    QVERIFY(m_server.listen(QHostAddress::LocalHost));
+
+    // no restored windows, they would block the network while restoring
+    BEDROCK_PROVISIONING::BedrockProvisioning* settings =
+        BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning();
+    m_savedSaveSession = settings->value("SaveSession");
+    settings->setValue("SaveSession", 0);
+}
+
+void tst_SharedTransport::cleanupTestCase()
+{
+    BEDROCK_PROVISIONING::BedrockProvisioning::createBedrockProvisioning()->setValue("SaveSession", m_savedSaveSession);
+}
+
+/*!
+ * Gets a page of the server's origin through \a manager and waits for it
+ */
+bool tst_SharedTransport::load(QNetworkAccessManager* manager, int window)
+{
+    QUrl url(QString("http://127.0.0.1:%1/window%2.html").arg(m_server.serverPort()).arg(window));
+    QNetworkReply* reply = manager->get(QNetworkRequest(url));
+    QEventLoop loop;
+    connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+    QTimer::singleShot(5000, &loop, SLOT(quit()));
+    if (!reply->isFinished())
+        loop.exec();
+    bool loaded = reply->isFinished() && reply->error() == QNetworkReply::NoError;
+    reply->deleteLater();
+    return loaded;
+}
+
+void tst_SharedTransport::connections_data()
+{
+    QTest::addColumn<int>("windowCount");
+    QTest::addColumn<bool>("shared");
+
+    QTest::newRow("2 windows, shared transport") << 2 << true;
+    QTest::newRow("2 windows, manager per window") << 2 << false;
+    QTest::newRow("5 windows, shared transport") << 5 << true;
+    QTest::newRow("5 windows, manager per window") << 5 << false;
+}
+
+/*!
+ * Opens the origin in every window, one after the other, and checks how
+ * many connections the server saw
+ */
+void tst_SharedTransport::connections()
+{
+    QFETCH(int, windowCount);
+    QFETCH(bool, shared);
+
+    WebPageController controller;
+    QList<QNetworkAccessManager*> managers;
+    for (int i = 0; i < windowCount; i++) {
+        if (shared)
+            managers.append(controller.openPage()->networkAccessManager());
+        else
+            managers.append(new QNetworkAccessManager(&controller));
+    }
+
+    m_server.reset();
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < windowCount; i++)
+            QVERIFY(load(managers.at(i), i));
+    }
+
+    qDebug() << windowCount << "windows," << m_server.requests() << "requests,"
+             << m_server.connections() << "connections";
+    QCOMPARE(m_server.requests(), windowCount);
+    QCOMPARE(m_server.connections(), shared ? 1 : windowCount);
+}
+
+QTEST_MAIN(tst_SharedTransport)
+#include "tst_sharedtransport.moc"
@@ -0,0 +1,43 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#
+
+TEMPLATE = lib
+TARGET = brperftrace
+QT += core webkit
+
+ROOT_DIR = $$PWD/../../..
+include($$ROOT_DIR/browserui.pri)
+
+#This is used to toggle behaviour of BRPERFTRACE_EXPORT
+#between Q_DECL_EXPORT and Q_DECL_IMPORT
+DEFINES += BUILDING_BRPERFTRACE
+
+CONFIG += dll
+
+HEADERS += $$PWD/wrtperftracer.h
+SOURCES += $$PWD/wrtperftracer.cpp
+
+symbian: {
+    TARGET.EPOCALLOWDLLDATA=1
+    TARGET.CAPABILITY = All -TCB -DRM
+    TARGET.VID = VID_DEFAULT
+}
+
+symbian:MMP_RULES += SMPSAFE
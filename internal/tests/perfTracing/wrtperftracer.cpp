@@ -0,0 +1,366 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QStringList>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+#include <QWebPage>
+
+#include "wrtperftracer.h"
+
+struct WrtPerfTraceEvent
+{
+    const char* m_name;
+    qint64 m_timestamp;
+    qint64 m_value;         // duration of complete events, value of counters
+    char m_phase;           // trace-event phase: B, E, X, C or i
+    quint8 m_category;
+};
+
+/*
+ * Events of one thread. Only that thread appends, so it needs no lock.
+ * Each slot has a sequence number, odd while the slot is written and
+ * 2 * n + 2 once it holds the n-th event. The exporter copies a slot and
+ * keeps the copy only if the sequence was that of the event it wanted both
+ * before and after, so a slot overwritten during the copy is skipped.
+ */
+class WrtPerfTraceRing
+{
+public:
+    static const int KCapacity = 16384;
+
+    WrtPerfTraceRing(int tid, const QString& threadName)
+        : m_tid(tid), m_threadName(threadName), m_slots(KCapacity), m_count(0)
+    {
+    }
+
+    void append(const WrtPerfTraceEvent& event)
+    {
+        uint count = uint(int(m_count));
+        Slot& slot = m_slots[count % KCapacity];
+        slot.m_sequence.fetchAndStoreOrdered(int(2 * count + 1));
+        slot.m_event = event;
+        slot.m_sequence.fetchAndStoreRelease(int(2 * count + 2));
+        m_count.fetchAndStoreRelease(int(count + 1));
+    }
+
+    // oldest first
+    QVector<WrtPerfTraceEvent> events() const
+    {
+        uint count = uint(m_count.fetchAndAddAcquire(0));
+        uint size = qMin(count, uint(KCapacity));
+        QVector<WrtPerfTraceEvent> result;
+        result.reserve(size);
+        for (uint i = count - size; i != count; i++) {
+            const Slot& slot = m_slots.at(i % KCapacity);
+            int sequence = int(2 * i + 2);
+            if (slot.m_sequence.fetchAndAddAcquire(0) != sequence)
+                continue;
+            WrtPerfTraceEvent event = slot.m_event;
+            if (slot.m_sequence.fetchAndAddOrdered(0) != sequence)
+                continue;
+            result.append(event);
+        }
+        return result;
+    }
+
+    int m_tid;
+    QString m_threadName;
+
+private:
+    struct Slot
+    {
+        Slot() : m_sequence(0) {}
+        WrtPerfTraceEvent m_event;
+        mutable QAtomicInt m_sequence;
+    };
+
+    QVector<Slot> m_slots;
+    mutable QAtomicInt m_count;
+};
+
+// QThreadStorage deletes its data when the thread ends, the ring itself
+// stays with the tracer so the events of finished threads are exported too
+struct WrtPerfTraceRingRef
+{
+    WrtPerfTraceRing* m_ring;
+};
+
+static const struct {
+    WrtPerfTracer::Category m_category;
+    const char* m_name;
+} KCategoryNames[] = {
+    { WrtPerfTracer::Load, "load" },
+    { WrtPerfTracer::Tiling, "tiling" },
+    { WrtPerfTracer::Gesture, "gesture" },
+    { WrtPerfTracer::Cache, "cache" },
+    { WrtPerfTracer::Ipc, "ipc" },
+    { WrtPerfTracer::Paint, "paint" },
+    { WrtPerfTracer::Chrome, "chrome" },
+    { WrtPerfTracer::Debug, "debug" }
+};
+static const int KCategoryCount = sizeof(KCategoryNames) / sizeof(KCategoryNames[0]);
+
+static int categoriesFromEnvironment()
+{
+    QString value = QString::fromLatin1(qgetenv("BR_PERF_TRACE")).toLower();
+    if (value == "all")
+        return WrtPerfTracer::AllCategories;
+
+    int categories = 0;
+    foreach (const QString& name, value.split(',', QString::SkipEmptyParts)) {
+        for (int i = 0; i < KCategoryCount; i++) {
+            if (name.trimmed() == KCategoryNames[i].m_name)
+                categories |= KCategoryNames[i].m_category;
+        }
+    }
+    return categories;
+}
+
+static const char* categoryName(int category)
+{
+    for (int i = 0; i < KCategoryCount; i++) {
+        if (KCategoryNames[i].m_category == category)
+            return KCategoryNames[i].m_name;
+    }
+    return "unknown";
+}
+
+static QString traceFileName(const char* suffix)
+{
+    QString fileName = QString::fromLocal8Bit(qgetenv("BR_PERF_TRACE_FILE"));
+    if (fileName.isEmpty())
+        fileName = QDir::tempPath() + "/brperftrace.json";
+    if (qstrcmp(suffix, ".json"))
+        fileName = fileName.section('.', 0, -2) + suffix;
+    return fileName;
+}
+
+static QString jsonString(const char* str)
+{
+    QString result("\"");
+    for (const char* c = str; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            result += '\\';
+        result += QLatin1Char(*c);
+    }
+    return result + '"';
+}
+
+QAtomicInt WrtPerfTracer::s_categories(categoriesFromEnvironment());
+
+static QAtomicPointer<WrtPerfTracer> s_tracer;
+static QMutex s_tracerLock;
+static QThreadStorage<WrtPerfTraceRingRef*> s_threadRing;
+
+WrtPerfTracer* WrtPerfTracer::tracer()
+{
+    WrtPerfTracer* tracer = s_tracer;
+    if (!tracer) {
+        QMutexLocker locker(&s_tracerLock);
+        tracer = s_tracer;
+        if (!tracer) {
+            tracer = new WrtPerfTracer();
+            // the page load slots run on the main thread
+            if (QCoreApplication::instance())
+                tracer->moveToThread(QCoreApplication::instance()->thread());
+            s_tracer.fetchAndStoreOrdered(tracer);
+        }
+    }
+    return tracer;
+}
+
+WrtPerfTracer::WrtPerfTracer() : QObject()
+{
+    m_clock.start();
+}
+
+qint64 WrtPerfTracer::now() const
+{
+#if QT_VERSION >= 0x040800
+    return m_clock.nsecsElapsed() / 1000;
+#else
+    return m_clock.elapsed() * 1000;
+#endif
+}
+
+WrtPerfTraceRing* WrtPerfTracer::ring()
+{
+    if (!s_threadRing.hasLocalData()) {
+        QMutexLocker locker(&m_ringsLock);
+        QThread* thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            name = "main";
+        else if (name.isEmpty())
+            name = QString("thread %1").arg(m_rings.count() + 1);
+        WrtPerfTraceRingRef* ref = new WrtPerfTraceRingRef;
+        ref->m_ring = new WrtPerfTraceRing(m_rings.count() + 1, name);
+        m_rings.append(ref->m_ring);
+        s_threadRing.setLocalData(ref);
+    }
+    return s_threadRing.localData()->m_ring;
+}
+
+void WrtPerfTracer::record(Category category, char phase, const char* name, qint64 timestamp, qint64 value)
+{
+    if (!isEnabled(category))
+        return;
+    WrtPerfTraceEvent event;
+    event.m_name = name;
+    event.m_timestamp = timestamp;
+    event.m_value = value;
+    event.m_phase = phase;
+    event.m_category = category;
+    ring()->append(event);
+}
+
+void WrtPerfTracer::begin(Category category, const char* name)
+{
+    record(category, 'B', name, now(), 0);
+}
+
+void WrtPerfTracer::end(Category category, const char* name)
+{
+    record(category, 'E', name, now(), 0);
+}
+
+void WrtPerfTracer::complete(Category category, const char* name, qint64 start, qint64 duration)
+{
+    record(category, 'X', name, start, duration);
+}
+
+void WrtPerfTracer::counter(Category category, const char* name, qint64 value)
+{
+    record(category, 'C', name, now(), value);
+}
+
+void WrtPerfTracer::instant(Category category, const char* name)
+{
+    record(category, 'i', name, now(), 0);
+}
+
+QByteArray WrtPerfTracer::toTraceJson() const
+{
+    QList<WrtPerfTraceRing*> rings;
+    {
+        QMutexLocker locker(&m_ringsLock);
+        rings = m_rings;
+    }
+
+    QStringList items;
+    foreach (WrtPerfTraceRing* ring, rings) {
+        items << QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}")
+                 .arg(ring->m_tid).arg(ring->m_threadName);
+        foreach (const WrtPerfTraceEvent& event, ring->events()) {
+            QString item = QString("{\"name\":%1,\"cat\":\"%2\",\"ph\":\"%3\",\"ts\":%4,\"pid\":1,\"tid\":%5")
+                           .arg(jsonString(event.m_name))
+                           .arg(categoryName(event.m_category))
+                           .arg(QLatin1Char(event.m_phase))
+                           .arg(event.m_timestamp)
+                           .arg(ring->m_tid);
+            if (event.m_phase == 'X')
+                item += QString(",\"dur\":%1").arg(event.m_value);
+            else if (event.m_phase == 'C')
+                item += QString(",\"args\":{\"value\":%1}").arg(event.m_value);
+            else if (event.m_phase == 'i')
+                item += ",\"s\":\"t\"";
+            items << item + '}';
+        }
+    }
+    return QString("{\"traceEvents\":[%1],\"displayTimeUnit\":\"ms\"}").arg(items.join(",\n")).toUtf8();
+}
+
+bool WrtPerfTracer::writeTrace(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(toTraceJson()) >= 0;
+}
+
+void WrtPerfTracer::initPage(QWebPage* page)
+{
+    // the category may be switched on later, the slots test it
+    connect(page, SIGNAL(loadStarted()), this, SLOT(onLoadStarted()));
+    connect(page, SIGNAL(loadFinished(bool)), this, SLOT(onLoadFinished(bool)));
+    connect(page, SIGNAL(destroyed(QObject*)), this, SLOT(onPageDestroyed(QObject*)));
+}
+
+void WrtPerfTracer::onLoadStarted()
+{
+    if (isEnabled(Load))
+        m_loads.insert(sender(), now());
+}
+
+void WrtPerfTracer::onLoadFinished(bool ok)
+{
+    if (!m_loads.contains(sender()))
+        return;
+    qint64 start = m_loads.take(sender());
+    if (!isEnabled(Load))
+        return;
+    complete(Load, ok ? "page load" : "page load (failed)", start, now() - start);
+}
+
+void WrtPerfTracer::onPageDestroyed(QObject* page)
+{
+    m_loads.remove(page);
+}
+
+unsigned int WrtPerfTracer::startTimer()
+{
+    return m_clock.elapsed();
+}
+
+unsigned int WrtPerfTracer::elapsedTime(unsigned int start)
+{
+    return m_clock.elapsed() - start;
+}
+
+QTextStream& WrtPerfTracer::out()
+{
+    if (!m_outFile.isOpen()) {
+        m_outFile.setFileName(traceFileName(".txt"));
+        m_outFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+        m_out.setDevice(&m_outFile);
+    }
+    return m_out;
+}
+
+void WrtPerfTracer::close()
+{
+    bool recorded;
+    {
+        QMutexLocker locker(&m_ringsLock);
+        recorded = !m_rings.isEmpty();
+    }
+    if (recorded)
+        writeTrace(traceFileName(".json"));
+    if (m_outFile.isOpen()) {
+        m_out.flush();
+        m_out.setDevice(0);
+        m_outFile.close();
+    }
+}
@@ -0,0 +1,176 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef __WRTPERFTRACER_H__
+#define __WRTPERFTRACER_H__
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QTextStream>
+#include <QFile>
+
+#ifndef BRPERFTRACE_EXPORT
+  #if defined (BUILDING_BRPERFTRACE)
+    #define BRPERFTRACE_EXPORT Q_DECL_EXPORT
+  #else
+    #define BRPERFTRACE_EXPORT Q_DECL_IMPORT
+  #endif
+#endif
+
+class QWebPage;
+class WrtPerfTraceRing;
+
+/*!
+ * Performance tracing shared by all the browser subsystems.
+ *
+ * Events go to a ring buffer owned by the thread that records them, so
+ * recording takes no lock; only a thread's first event registers its ring.
+ * Each category is switched on or off at runtime with setCategories() or,
+ * at startup, with the BR_PERF_TRACE environment variable ("load,tiling",
+ * "all"). A disabled category costs one test of an integer at the call site.
+ *
+ * Names must be string literals, only the pointer is recorded. close()
+ * writes the rings to BR_PERF_TRACE_FILE (brperftrace.json in the temp
+ * directory by default) as Chrome trace-event JSON, which chrome://tracing
+ * shows as one timeline per thread.
+ */
+class BRPERFTRACE_EXPORT WrtPerfTracer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Category {
+        Load    = 0x01,
+        Tiling  = 0x02,
+        Gesture = 0x04,
+        Cache   = 0x08,
+        Ipc     = 0x10,
+        Paint   = 0x20,
+        Chrome  = 0x40,
+        Debug   = 0x80,     // PERF_DEBUG() text output
+        AllCategories = 0xff
+    };
+
+    static WrtPerfTracer* tracer();
+
+    static bool isEnabled(int category) { return (int(s_categories) & category) != 0; }
+    static void setCategories(int categories) { s_categories = categories; }
+    static int categories() { return s_categories; }
+
+    // time since the tracer was created, in microseconds
+    qint64 now() const;
+
+    void begin(Category category, const char* name);
+    void end(Category category, const char* name);
+    void complete(Category category, const char* name, qint64 start, qint64 duration);
+    void counter(Category category, const char* name, qint64 value);
+    void instant(Category category, const char* name);
+
+    QByteArray toTraceJson() const;
+    bool writeTrace(const QString& fileName) const;
+
+    // traces the page loads of \a page while the Load category is enabled
+    void initPage(QWebPage* page);
+
+    // milliseconds based timers of the original tracer
+    unsigned int startTimer();
+    unsigned int elapsedTime(unsigned int start);
+
+    QTextStream& out();
+    void close();
+
+private slots:
+    void onLoadStarted();
+    void onLoadFinished(bool ok);
+    void onPageDestroyed(QObject* page);
+
+private:
+    WrtPerfTracer();
+
+    void record(Category category, char phase, const char* name, qint64 timestamp, qint64 value);
+    WrtPerfTraceRing* ring();
+
+private:
+    static QAtomicInt s_categories;
+
+    QElapsedTimer m_clock;
+    mutable QMutex m_ringsLock;     // registration and export only
+    QList<WrtPerfTraceRing*> m_rings;
+    QHash<QObject*, qint64> m_loads;
+    QFile m_outFile;
+    QTextStream m_out;
+};
+
+/*!
+ * Records the time from its construction to the end of the scope as one
+ * event, when the category is enabled at construction.
+ */
+class WrtPerfScope
+{
+public:
+    WrtPerfScope(WrtPerfTracer::Category category, const char* name)
+        : m_category(category), m_name(name), m_start(-1)
+    {
+        if (WrtPerfTracer::isEnabled(category))
+            m_start = WrtPerfTracer::tracer()->now();
+    }
+    ~WrtPerfScope()
+    {
+        if (m_start >= 0) {
+            WrtPerfTracer* tracer = WrtPerfTracer::tracer();
+            tracer->complete(m_category, m_name, m_start, tracer->now() - m_start);
+        }
+    }
+
+private:
+    WrtPerfTracer::Category m_category;
+    const char* m_name;
+    qint64 m_start;
+};
+
+#define PERF_TRACE_CONCAT2(a, b) a##b
+#define PERF_TRACE_CONCAT(a, b) PERF_TRACE_CONCAT2(a, b)
+
+#define PERF_TRACE_SCOPE(category, name) \
+    WrtPerfScope PERF_TRACE_CONCAT(perfScope, __LINE__)(WrtPerfTracer::category, name)
+
+#define PERF_TRACE_COUNTER(category, name, value) \
+    do { \
+        if (WrtPerfTracer::isEnabled(WrtPerfTracer::category)) \
+            WrtPerfTracer::tracer()->counter(WrtPerfTracer::category, name, value); \
+    } while (0)
+
+#define PERF_TRACE_INSTANT(category, name) \
+    do { \
+        if (WrtPerfTracer::isEnabled(WrtPerfTracer::category)) \
+            WrtPerfTracer::tracer()->instant(WrtPerfTracer::category, name); \
+    } while (0)
+
+#define PERF_TRACE_OUT() WrtPerfTracer::tracer()->out()
+
+#define PERF_DEBUG() \
+    if (!WrtPerfTracer::isEnabled(WrtPerfTracer::Debug)) ; else PERF_TRACE_OUT()
+
+#endif // __WRTPERFTRACER_H__
@@ -0,0 +1,49 @@
+#
+# Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies). 
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, version 2.1 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, 
+# see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+#
+# Description:
+#
+
+# Unit tests and benchmarks, built with: qmake "what=tests"
+# Each test is a QTestLib executable, run it without arguments or with
+# the usual QTestLib options (-xml, -iterations N, ...).
+
+TEMPLATE = subdirs
+
+SUBDIRS += ServiceIpc_Test \
+           Allocator_Benchmark \
+           GesturePool_Test \
+           GestureReplay_Benchmark \
+           SessionRestore_Benchmark \
+           SessionJournal_Test \
+           FilmstripFlow_Benchmark \
+           SharedTransport_Benchmark \
+           ChromeRepaint_Benchmark \
+           ChromeConstruction_Benchmark \
+           ChromeSnapshot_Benchmark \
+           PerfTrace_Test \
+           PageLoad_Benchmark
+
+# POSIX shared memory and futexes
+linux-*: SUBDIRS += ServiceIpcSharedRing_Test
+
+# the procfs and cgroup backend of the low memory handler
+linux-*: SUBDIRS += LowMemoryHandler_Test
+
+# the geolocation manager is only built with geolocation support
+include(../../browserui.pri)
+contains(br_geolocation, yes): SUBDIRS += Geolocation_Test
@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#include "qstmeventpool.h"
+
+using namespace qstmUiEventEngine ;
+
+QStm_EventPool::QStm_EventPool(int objectSize, int capacity) :
+    m_free(NULL), m_capacity(capacity), m_inUse(0), m_highWaterMark(0), m_overflowCount(0)
+{
+    // keep the slots aligned for any member type
+    const int align = sizeof(double) > sizeof(void*) ? sizeof(double) : sizeof(void*) ;
+    m_slotSize = (qMax<int>(objectSize, sizeof(void*)) + align - 1) & ~(align - 1) ;
+    m_storage = static_cast<char*>(qMalloc(m_slotSize * m_capacity)) ;
+    if (!m_storage)
+    {
+        m_capacity = 0 ;
+    }
+    for (int i = m_capacity - 1; i >= 0; --i)
+    {
+        void* slot = m_storage + i * m_slotSize ;
+        *static_cast<void**>(slot) = m_free ;
+        m_free = slot ;
+    }
+}
+
+QStm_EventPool::~QStm_EventPool()
+{
+    qFree(m_storage) ;
+}
+
+void* QStm_EventPool::alloc(size_t size)
+{
+    void* p ;
+    if (m_free && size <= size_t(m_slotSize))
+    {
+        p = m_free ;
+        m_free = *static_cast<void**>(p) ;
+        if (++m_inUse > m_highWaterMark) m_highWaterMark = m_inUse ;
+    }
+    else
+    {
+        ++m_overflowCount ;
+        p = ::operator new(size) ;
+    }
+    return p ;
+}
+
+void QStm_EventPool::release(void* p)
+{
+    if (!p) return ;
+    if (owns(p))
+    {
+        *static_cast<void**>(p) = m_free ;
+        m_free = p ;
+        --m_inUse ;
+    }
+    else
+    {
+        ::operator delete(p) ;
+    }
+}
+
+void QStm_EventPool::resetCounters()
+{
+    m_highWaterMark = m_inUse ;
+    m_overflowCount = 0 ;
+}
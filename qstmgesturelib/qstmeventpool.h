@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, 
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef QSTMEVENTPOOL_H_
+#define QSTMEVENTPOOL_H_
+
+#include <QtCore>
+#include "qstmgesturedefs.h"
+
+namespace qstmUiEventEngine
+{
+
+/*!
+ * Fixed capacity free list for the small objects the state engine creates for
+ * every pointer event (QStm_UiEvent, QStm_HwEvent).  The slots are allocated
+ * once, when the pool is created, and reused in LIFO order.
+ *
+ * The capacity is not a limit: when every slot is in use, or the object is
+ * bigger than a slot, alloc() falls back to operator new and counts an
+ * overflow; release() recognises heap objects by address and deletes them.
+ * The pool never grows, overflowCount() and highWaterMark() tell whether
+ * the capacity fits the load.
+ * Not thread safe, the gesture library runs on the GUI thread.
+ */
+class QSTMGESTURELIB_EXPORT QStm_EventPool
+{
+public:
+    QStm_EventPool(int objectSize, int capacity) ;
+    ~QStm_EventPool() ;
+
+    void* alloc(size_t size) ;
+    void release(void* p) ;
+
+    int capacity() const { return m_capacity ; }
+    int inUse() const { return m_inUse ; }
+    int highWaterMark() const { return m_highWaterMark ; }
+    int overflowCount() const { return m_overflowCount ; }
+    void resetCounters() ;
+
+private:
+    Q_DISABLE_COPY(QStm_EventPool)
+
+    inline bool owns(void* p) const
+    {
+        return (char*)p >= m_storage && (char*)p < m_storage + m_capacity * m_slotSize ;
+    }
+
+    char*  m_storage ;
+    void*  m_free ;             // free list threaded through the unused slots
+    int    m_slotSize ;
+    int    m_capacity ;
+    int    m_inUse ;            // slots currently handed out
+    int    m_highWaterMark ;    // most slots in use at the same time
+    int    m_overflowCount ;    // allocations that went to the heap
+};
+
+}
+
+#endif /* QSTMEVENTPOOL_H_ */
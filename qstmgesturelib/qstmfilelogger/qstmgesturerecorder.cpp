@@ -0,0 +1,268 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+#include <QElapsedTimer>
+#include <QStringList>
+#include "qstmgesturerecorder.h"
+#include "qstmstatemachine.h"
+#include "qstmfilelogger.h"
+#if QT_VERSION < 0x040800 && defined(Q_OS_UNIX)
+#include <time.h>
+#endif
+
+using namespace qstmUiEventEngine;
+
+const int KMsecsPerDay = 24 * 3600 * 1000;
+
+/*!
+ * Monotonic time in microseconds. QElapsedTimer has no sub-millisecond
+ * resolution before Qt 4.8, and most events take less than a millisecond.
+ */
+static qint64 monotonicUsecs()
+{
+#if QT_VERSION < 0x040800 && defined(Q_OS_UNIX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+#if QT_VERSION >= 0x040800
+    return clock.nsecsElapsed() / 1000;
+#else
+    return clock.elapsed() * 1000;  // no better clock on this platform
+#endif
+#endif
+}
+
+QStm_GestureRecorder::QStm_GestureRecorder() : m_firstEvent(true)
+{
+}
+
+QStm_GestureRecorder::~QStm_GestureRecorder()
+{
+    close();
+}
+
+bool QStm_GestureRecorder::open(const QString& fileName)
+{
+    close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOGARG("QStm_GestureRecorder: cannot open %s", fileName.toLatin1().constData());
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(QDataStream::Qt_4_6);
+    m_stream << KMagic << KVersion;
+    m_firstEvent = true;
+    return true;
+}
+
+void QStm_GestureRecorder::close()
+{
+    if (m_file.isOpen()) {
+        m_stream.setDevice(0);
+        m_file.close();
+    }
+}
+
+void QStm_GestureRecorder::record(const QStm_PlatformPointerEvent& event)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    if (m_firstEvent) {
+        m_firstEventTime = event.m_time;
+        m_firstEvent = false;
+    }
+    int offset = m_firstEventTime.msecsTo(event.m_time);
+    if (offset < 0) {
+        offset += KMsecsPerDay; // recording went over midnight
+    }
+    m_stream << qint32(offset) << quint8(event.m_type) << quint8(event.m_pointerNumber)
+             << quint32(event.m_modifiers) << qint32(event.m_position.x()) << qint32(event.m_position.y());
+}
+
+bool QStm_GestureRecorder::load(const QString& fileName, QList<QStm_RecordedPointerEvent>& events)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic;
+    quint16 version;
+    stream >> magic >> version;
+    if (magic != KMagic || version != KVersion) {
+        return false;
+    }
+
+    events.clear();
+    while (!stream.atEnd()) {
+        qint32 offset, x, y;
+        quint8 type, pointerNumber;
+        quint32 modifiers;
+        stream >> offset >> type >> pointerNumber >> modifiers >> x >> y;
+        if (stream.status() != QDataStream::Ok) {
+            return false;   // truncated record
+        }
+        if (pointerNumber >= KMaxNumberOfPointers || type > QStm_PlatformPointerEvent::EMove) {
+            continue;       // the state machine cannot take these
+        }
+        QStm_RecordedPointerEvent event;
+        event.m_offset = offset;
+        event.m_type = QStm_PlatformPointerEvent::PEType(type);
+        event.m_pointerNumber = pointerNumber;
+        event.m_modifiers = modifiers;
+        event.m_position = QPoint(x, y);
+        events.append(event);
+    }
+    return true;
+}
+
+
+QStm_GestureReplay::QStm_GestureReplay() : QObject(),
+    m_stateMachine(0), m_target(0), m_speed(1.0), m_next(0)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(feedNext()));
+}
+
+QStm_GestureReplay::~QStm_GestureReplay()
+{
+}
+
+bool QStm_GestureReplay::load(const QString& fileName)
+{
+    return QStm_GestureRecorder::load(fileName, m_events);
+}
+
+void QStm_GestureReplay::run(QStm_StateMachine* stateMachine, void* target, qreal speed)
+{
+    m_stateMachine = stateMachine;
+    m_target = target;
+    m_speed = speed;
+    m_next = 0;
+    m_latencies.clear();
+    m_latencies.reserve(m_events.count());
+    m_gestures.clear();
+    if (!m_stateMachine || m_events.isEmpty()) {
+        return;
+    }
+
+    // Set back as they were afterwards, scaling back would round again
+    unsigned int touchTimeout = m_stateMachine->getTouchTimeout();
+    unsigned int holdTimeout = m_stateMachine->getHoldTimeout();
+    unsigned int touchSuppressTimeout = m_stateMachine->getTouchSuppressTimeout();
+    unsigned int moveSuppressTimeout = m_stateMachine->getMoveSuppressTimeout();
+    if (m_speed > 0) {
+        scaleTimeouts(1.0 / m_speed);
+    }
+    m_baseTime = QTime::currentTime();
+    m_timer.start(0);
+    m_loop.exec();
+    m_stateMachine->setTouchTimeout(touchTimeout);
+    m_stateMachine->setHoldTimeout(holdTimeout);
+    m_stateMachine->setTouchSuppressTimeout(touchSuppressTimeout);
+    m_stateMachine->setMoveSuppressTimeout(moveSuppressTimeout);
+}
+
+void QStm_GestureReplay::feedNext()
+{
+    const QStm_RecordedPointerEvent& recorded = m_events[m_next];
+    QStm_PlatformPointerEvent event;
+    event.m_type = recorded.m_type;
+    event.m_modifiers = recorded.m_modifiers;
+    event.m_position = recorded.m_position;
+    event.m_pointerNumber = recorded.m_pointerNumber;
+    event.m_target = m_target;
+    event.m_time = m_baseTime.addMSecs(recorded.m_offset);
+
+    qint64 start = monotonicUsecs();
+    m_stateMachine->handleStateEvent(event);
+    m_latencies.append(monotonicUsecs() - start);
+
+    if (++m_next == m_events.count()) {
+        m_loop.quit();
+        return;
+    }
+    int delay = 0;
+    if (m_speed > 0) {
+        delay = qRound((m_events[m_next].m_offset - recorded.m_offset) / m_speed);
+    }
+    m_timer.start(qMax(delay, 0));
+}
+
+void QStm_GestureReplay::scaleTimeouts(qreal factor)
+{
+    m_stateMachine->setTouchTimeout(qRound(m_stateMachine->getTouchTimeout() * factor));
+    m_stateMachine->setHoldTimeout(qRound(m_stateMachine->getHoldTimeout() * factor));
+    m_stateMachine->setTouchSuppressTimeout(qRound(m_stateMachine->getTouchSuppressTimeout() * factor));
+    m_stateMachine->setMoveSuppressTimeout(qRound(m_stateMachine->getMoveSuppressTimeout() * factor));
+}
+
+qint64 QStm_GestureReplay::latencyPercentile(int percent) const
+{
+    if (m_latencies.isEmpty()) {
+        return 0;
+    }
+    QVector<qint64> sorted = m_latencies;
+    qSort(sorted);
+    int index = (qBound(0, percent, 100) * (sorted.count() - 1) + 50) / 100;
+    return sorted[index];
+}
+
+QString QStm_GestureReplay::report() const
+{
+    QStringList lines;
+    lines << QString("events %1, latency us: p50 %2 p90 %3 p99 %4 max %5")
+             .arg(m_latencies.count())
+             .arg(latencyPercentile(50))
+             .arg(latencyPercentile(90))
+             .arg(latencyPercentile(99))
+             .arg(latencyPercentile(100));
+
+    QStringList sequence;
+    foreach (const GestureRecord& gesture, m_gestures) {
+        sequence << (gesture.m_exit ? QString("%1/exit").arg(gesture.m_uid)
+                                    : QString("%1/%2").arg(gesture.m_uid).arg(gesture.m_type));
+    }
+    lines << QString("gestures: ") + sequence.join(" ");
+
+    QString text = lines.join("\n");
+    LOGTXT(text.toLatin1().constData());
+    return text;
+}
+
+QStm_GestureListenerApiIf::QStm_ProcessingResult QStm_GestureReplay::handleGestureEvent(
+        qstmGesture::QStm_GestureUid uid, qstmGesture::QStm_GestureIf* gesture)
+{
+    GestureRecord record;
+    record.m_uid = uid;
+    record.m_type = gesture ? gesture->getType() : 0;
+    record.m_exit = (gesture == NULL);
+    m_gestures.append(record);
+    return EContinue;
+}
@@ -0,0 +1,142 @@
+/*
+* Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+* All rights reserved.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, version 2.1 of the License.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not,
+* see "http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html/".
+*
+* Description:
+*
+*/
+
+#ifndef QSTMGESTURERECORDER_H_
+#define QSTMGESTURERECORDER_H_
+
+#include <qstmgesturedefs.h>
+#include <qstmuievent_if.h>
+#include <qstmgestureapi.h>
+#include <QFile>
+#include <QDataStream>
+#include <QEventLoop>
+#include <QTimer>
+#include <QVector>
+
+namespace qstmUiEventEngine
+{
+    class QStm_StateMachine;
+}
+
+/*!
+ * Binary recording of raw pointer events, as passed to
+ * QStm_StateMachine::handleStateEvent().
+ *
+ * The file starts with KMagic and KVersion, followed by one record per event:
+ * offset in ms from the first event, pointer event type, pointer number,
+ * modifiers and position, all written with QDataStream.
+ */
+struct QStm_RecordedPointerEvent
+{
+    int                                               m_offset;  // ms from the first event
+    qstmUiEventEngine::QStm_PlatformPointerEvent::PEType m_type;
+    int                                               m_pointerNumber;
+    unsigned int                                      m_modifiers;
+    QPoint                                            m_position;
+};
+
+class QSTMGESTURELIB_EXPORT QStm_GestureRecorder
+{
+public:
+    static const quint32 KMagic = 0x51534752; // "QSGR"
+    static const quint16 KVersion = 1;
+
+    QStm_GestureRecorder();
+    ~QStm_GestureRecorder();
+
+    bool open(const QString& fileName);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    void record(const qstmUiEventEngine::QStm_PlatformPointerEvent& event);
+
+    static bool load(const QString& fileName, QList<QStm_RecordedPointerEvent>& events);
+
+private:
+    QFile       m_file;
+    QDataStream m_stream;
+    QTime       m_firstEventTime;
+    bool        m_firstEvent;
+};
+
+/*!
+ * Feeds a recording through a state machine, and so through the gesture engine
+ * listening to it, and collects the processing latency of every pointer event
+ * and the gestures that came out.
+ *
+ * Add the replay as a listener of the gesture context under test so that it
+ * sees the gestures; \a target given to run() is the widget the events are
+ * addressed to, it should be the owner of that context.
+ *
+ * \a speed scales the delays between the events, and the state machine's
+ * touch, hold and suppress timeouts with them; the timestamps of the pointer
+ * events keep the recorded spacing. A speed of 0 feeds the events back to
+ * back, then no timer driven UI event (e.g. EHold) is produced.
+ */
+class QSTMGESTURELIB_EXPORT QStm_GestureReplay : public QObject, public QStm_GestureListenerApiIf
+{
+    Q_OBJECT
+public:
+    struct GestureRecord
+    {
+        qstmGesture::QStm_GestureUid m_uid;
+        int                          m_type;
+        bool                         m_exit;
+    };
+
+    QStm_GestureReplay();
+    ~QStm_GestureReplay();
+
+    bool load(const QString& fileName);
+    void setEvents(const QList<QStm_RecordedPointerEvent>& events) { m_events = events; }
+
+    void run(qstmUiEventEngine::QStm_StateMachine* stateMachine, void* target, qreal speed = 1.0);
+
+    /*!
+     * Processing time of the pointer events of the last run, in microseconds
+     */
+    const QVector<qint64>& latencies() const { return m_latencies; }
+    qint64 latencyPercentile(int percent) const;
+    const QList<GestureRecord>& gestures() const { return m_gestures; }
+    QString report() const;
+
+    // from QStm_GestureListenerApiIf
+    QStm_ProcessingResult handleGestureEvent(qstmGesture::QStm_GestureUid uid, qstmGesture::QStm_GestureIf* gesture);
+
+private slots:
+    void feedNext();
+
+private:
+    void scaleTimeouts(qreal factor);
+
+private:
+    QList<QStm_RecordedPointerEvent>       m_events;
+    QVector<qint64>                        m_latencies;
+    QList<GestureRecord>                   m_gestures;
+    qstmUiEventEngine::QStm_StateMachine*  m_stateMachine;
+    void*                                  m_target;
+    qreal                                  m_speed;
+    int                                    m_next;
+    QTime                                  m_baseTime;
+    QTimer                                 m_timer;
+    QEventLoop                             m_loop;
+};
+
+#endif /* QSTMGESTURERECORDER_H_ */
@@ -32,6 +32,8 @@ QStm_GestureEngine::QStm_GestureEngine()
     m_numOfActiveStreams = 0 ;
     m_currentGestureOwner = -1 ;
     m_currentLockedGesture = -1 ;
+    m_dispatchTableDirty = true ;
+    m_currentEventCode = qstmUiEventEngine::ENull ;
     for (int i = 0; i < qstmUiEventEngine::KMaxNumberOfPointers; i++) {
         m_uiEventStream[i] = NULL ;
     }
@@ -48,6 +50,7 @@ bool QStm_GestureEngine::addGesture(const QStm_GestureRecogniserIf* newGesture)
 	if (newGesture) {
 		QStm_GestureRecogniserIf* p = const_cast<QStm_GestureRecogniserIf*>(newGesture);
 		m_gestures.append(p);
+		m_dispatchTableDirty = true ;
 	}
     return true;
 }
@@ -56,6 +59,7 @@ bool QStm_GestureEngine::insertGesture(const QStm_GestureRecogniserIf* newGestur
 {
 	QStm_GestureRecogniserIf* p = const_cast<QStm_GestureRecogniserIf*>(newGesture);
     m_gestures.insert(startPos, p);
+    m_dispatchTableDirty = true ;
     return true;
 }
 
@@ -118,6 +122,7 @@ bool QStm_GestureEngine::removeGesture(const QStm_GestureRecogniserIf* oldGestur
     bool found = (ix != -1);
     if (found) {
         m_gestures.removeAt(ix) ;
+        m_dispatchTableDirty = true ;
     }
     return found ;
 }
@@ -155,6 +160,7 @@ const qstmUiEventEngine::QStm_UiEventIf* QStm_GestureEngine::getUiEvents(int ind
 void QStm_GestureEngine::handleUiEvent(const qstmUiEventEngine::QStm_UiEventIf& event )
 {
     // process one incoming UI event
+    m_currentEventCode = event.code() ;
     storeUiEvent(event) ;  // store the event to the "stream" based on the index of pointer
     walkTroughGestures() ;  // and walk trough the gestures to process the UI event
     updateUiEvents() ;
@@ -190,7 +196,29 @@ void QStm_GestureEngine::storeUiEvent(const qstmUiEventEngine::QStm_UiEventIf& e
 }
 
 /*!
- *  Call each gesture handler in turn until one claims to be in control of the gesture.
+ * Sort the recognisers by the UI events and stream counts they are interested in.
+ */
+void QStm_GestureEngine::buildDispatchTable()
+{
+    for (int code = 0; code <= qstmUiEventEngine::ENull; code++) {
+        for (int streams = 0; streams <= qstmUiEventEngine::KMaxNumberOfPointers; streams++) {
+            QList<int>& candidates = m_dispatchTable[code][streams] ;
+            candidates.clear() ;
+            for (int i = 0; i < m_gestures.count(); i++) {
+                QStm_GestureRecogniserIf* pgrif = m_gestures[i] ;
+                if (pgrif != NULL &&
+                    (pgrif->interestedEvents() & QSTM_UIEVENT_BIT(code)) &&
+                    (pgrif->interestedStreamCounts() & (1 << streams))) {
+                    candidates.append(i) ;
+                }
+            }
+        }
+    }
+    m_dispatchTableDirty = false ;
+}
+
+/*!
+ *  Call each interested gesture handler in turn until one claims to be in control of the gesture.
  */
 void QStm_GestureEngine::walkTroughGestures()
 {
@@ -203,6 +231,10 @@ void QStm_GestureEngine::walkTroughGestures()
         uknownGestureEnabled = uknownGesture->isEnabled();
     }
 
+    if (m_dispatchTableDirty) {
+        buildDispatchTable() ;
+    }
+
     int newowner = -1 ;
     int newlocker =  -1; //m_currentLockedGesture ;
     // check if someone has locked the gesture
@@ -256,8 +288,13 @@ void QStm_GestureEngine::walkTroughGestures()
         if (m_loggingEnabled) {
             LOGARG("walk trough recognizers active streams %d", m_numOfActiveStreams);
         }
-        // No locking gesture, walk trough the list until someone handles this
+        // No locking gesture, walk trough the interested recognisers until someone handles this
         int gcount = m_gestures.count();
+        const QList<int>& candidates = m_dispatchTable[m_currentEventCode][m_numOfActiveStreams] ;
+        int ccount = candidates.count() ;
+        int c = 0 ;
+        // The owner sees every event, it must be able to give the gesture up
+        int pendingOwner = m_currentGestureOwner ;
         if (m_currentGestureOwner > -1) {
             QStm_GestureRecogniserIf* gestureOwner = m_gestures[m_currentGestureOwner] ;
             currentState = gestureOwner->state();
@@ -266,10 +303,30 @@ void QStm_GestureEngine::walkTroughGestures()
             currentState = ENotMyGesture;
         }
         
-        for (int i = 0; i < gcount; i++) {
+        for (;;) {
+            int i ;
+            if (pendingOwner != -1 && (c == ccount || pendingOwner <= candidates[c])) {
+                i = pendingOwner ;
+                pendingOwner = -1 ;
+                if (c < ccount && candidates[c] == i) c++ ;
+            }
+            else if (c < ccount) {
+                i = candidates[c++] ;
+            }
+            else {
+                break ;
+            }
+            // The lock holder already gave this event up above
+            if (i == m_currentLockedGesture) {
+                continue ;
+            }
+
             bool controlObtained = false;
             QStm_GestureRecogniserIf* pgrif = m_gestures[i];
-            
+            // Disabled recognisers would just return ENotMyGesture
+            if (pgrif != NULL && i != m_currentGestureOwner && !pgrif->isEnabled()) {
+                continue ;
+            }
             
             if (pgrif != NULL) {
                 switch (pgrif->recognise(m_numOfActiveStreams, this)) {
@@ -38,6 +38,8 @@ namespace qstmGesture
  * previously, its release method is called. Gesture recogniser can also lock the gesture
  * by returning ELockToThisGesture. Then only that gesture recogniser will be called
  * until release is detected or the recogniser returns something else than ELockToThisGesture.
+ * Each UI event is only offered to the recognisers whose interestedEvents() and
+ * interestedStreamCounts() match it, looked up from a table rebuilt when the list changes.
  */
 class QStm_GestureEngine : public QStm_GestureEngineIf, 
                            public qstmUiEventEngine::QStm_UiEventObserverIf
@@ -104,11 +106,19 @@ private:
 
     void storeUiEvent(const qstmUiEventEngine::QStm_UiEventIf& event) ;
     void walkTroughGestures() ;
+    void buildDispatchTable() ;
     void updateUiEvents() ;
     int m_numOfActiveStreams ;
     int m_currentGestureOwner ;
     int m_currentLockedGesture ;
     bool m_loggingEnabled ;
+    /*!
+     * Indexes to m_gestures of the recognisers interested in each UI event code
+     * and number of active streams, in list order.
+     */
+    QList<int> m_dispatchTable[qstmUiEventEngine::ENull + 1][qstmUiEventEngine::KMaxNumberOfPointers + 1] ;
+    bool m_dispatchTableDirty ;
+    qstmUiEventEngine::QStm_UiEventCode m_currentEventCode ;
 };
 
 }
@@ -24,11 +24,7 @@
 
 #include "qstmgesturelistener_if.h"
 #include "qstmgesture_if.h"
-
-namespace qstmUiEventEngine
-{
-    class QStm_UiEventIf ;
-}
+#include "qstmuievent_if.h"
 
 namespace qstmGesture
 {
@@ -135,6 +131,15 @@ enum QStm_GestureRecognitionState
     ENotMyGesture       /*! < not this gesture, try the next one in the list  */
 };
 
+/*!
+ * Interest masks returned by QStm_GestureRecogniserIf::interestedEvents() and
+ * interestedStreamCounts(); bit N stands for UI event code N or N active streams.
+ */
+#define QSTM_UIEVENT_BIT(code) (1 << (code))
+const int KAllUiEvents = ~0;
+const int KAnyStreamCount = ~0;
+const int KSingleStream = 1 << 1;
+
 /*!
  * The types of gesture recognisers. TODO to implement rule based gesture engine
  * where the recognisers can be added in any order, and the rules define the order of them.
@@ -215,6 +220,20 @@ public:
     virtual void setOwner(void* owner) = 0;
     
     virtual QStm_GestureRecognitionState state() = 0;
+
+    /*!
+     * The UI event codes this recogniser reacts to, as QSTM_UIEVENT_BIT() flags.
+     * The gesture engine offers a UI event only to the recognisers interested in
+     * its code; the current gesture owner always gets the event regardless, so that
+     * it can give the gesture up. The value must not change after the recogniser
+     * has been added to the engine.
+     */
+    virtual int interestedEvents() const { return KAllUiEvents; }
+    /*!
+     * The numbers of active streams this recogniser reacts to, bit N set for N streams.
+     * Same rules as interestedEvents().
+     */
+    virtual int interestedStreamCounts() const { return KAnyStreamCount; }
 };
 
 class QStm_GestureRecogniser : public QObject, public QStm_GestureRecogniserIf
@@ -56,11 +56,13 @@ HEADERS += qstmgestureevent.h \
     qstmcallbacktimer.h \
     qstmstatemachine.h \
     qstmuievent.h \
+    qstmeventpool.h \
     qstmstatemachine_v2.h \
     qstmtimerinterface.h \
     qstmstateengineconfig.h \
     qstmstateengine.h \
     qstmfilelogger/qstmfilelogger.h \
+    qstmfilelogger/qstmgesturerecorder.h \
     uitimer.h
     
 SOURCES += recognisers/qstmtouchgesturerecogniser.cpp \
@@ -85,8 +87,10 @@ SOURCES += recognisers/qstmtouchgesturerecogniser.cpp \
     qstmstateengineconfig.cpp \
     qstmstatemachine.cpp \
     qstmuievent.cpp \
+    qstmeventpool.cpp \
     qstmuieventsender.cpp \
     qstmfilelogger/qstmfilelogger.cpp \
+    qstmfilelogger/qstmgesturerecorder.cpp \
     qstmgestureevent.cpp
 
 
@@ -112,6 +116,9 @@ symbian: {
 
 }
 
+# clock_gettime() for the gesture replay timing
+linux-*: LIBS += -lrt
+
 
 
 symbian:MMP_RULES += SMPSAFE
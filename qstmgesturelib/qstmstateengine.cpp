@@ -473,9 +473,7 @@ QStm_StateEngine::QStm_StateEngine(QStm_StateEngineConfiguration* config, QStm_T
 
 QStm_StateEngine::~QStm_StateEngine()
 {
-    m_touchPoints.clear() ;
-    qDeleteAll(m_dragPoints.begin(), m_dragPoints.end());
-    m_dragPoints.clear() ;
+    releasePoints() ;
 }
 
 void QStm_StateEngine::consumeEvent()
@@ -749,14 +747,14 @@ void QStm_StateEngine::renameToDrag()
 
 void QStm_StateEngine::prepareTouchTimeArea()
 {
-    if (m_touchPoints.count()>0) m_touchPoints.clear() ;
+    m_touchPoints.erase(m_touchPoints.begin(), m_touchPoints.end()) ;
     m_touchRect = toleranceRect(m_hwe.m_position, m_config->m_touchTimeTolerance) ;
 }
 
 
 void QStm_StateEngine::prepareTouchArea()
 {
-    if (m_touchPoints.count()>0) m_touchPoints.clear() ;
+    m_touchPoints.erase(m_touchPoints.begin(), m_touchPoints.end()) ;
     m_touchRect = toleranceRect(m_hwe.m_position, m_config->m_touchTolerance) ;
 }
 
@@ -791,9 +789,18 @@ void QStm_StateEngine::setGestureStart()
     m_gestureStartXY = m_hwe.m_position ;
     m_previousXY = m_hwe.m_position ;
     m_gestureTarget = m_hwe.m_target ;
+    releasePoints() ;
+}
+
+/*!
+ * Give the drag and touch points back to the event pool.
+ * erase() keeps the list storage for the next gesture, clear() would free it
+ */
+void QStm_StateEngine::releasePoints()
+{
     qDeleteAll(m_dragPoints.begin(), m_dragPoints.end());
-    m_dragPoints.clear() ;
-    m_touchPoints.clear() ;
+    m_dragPoints.erase(m_dragPoints.begin(), m_dragPoints.end()) ;
+    m_touchPoints.erase(m_touchPoints.begin(), m_touchPoints.end()) ;
 }
 
 
@@ -816,6 +823,34 @@ void QStm_StateEngine::addDraggingPos()
     m_dragPoints.append(new QStm_HwEvent(m_hwe.m_type, m_hwe.m_position, m_hwe.m_time, m_hwe.m_target, m_index)) ;
 }
 
+// Drag points are trimmed by isNewHoldingPoint() on every drag event, so only
+// the points inside the hold area are kept; touch points are only collected
+// during the touch time.  64 covers a slow drag inside the hold area.  Events
+// beyond that come from the heap (QStm_EventPool::overflowCount()), nothing fails.
+static const int KHwEventPoolCapacity = 64 ;
+
+static QStm_EventPool& hwEventPool()
+{
+    // never deleted: events may still be released during static destruction
+    static QStm_EventPool* pool = new QStm_EventPool(sizeof(QStm_HwEvent), KHwEventPoolCapacity) ;
+    return *pool ;
+}
+
+void* QStm_HwEvent::operator new(size_t size)
+{
+    return hwEventPool().alloc(size) ;
+}
+
+void QStm_HwEvent::operator delete(void* p)
+{
+    hwEventPool().release(p) ;
+}
+
+const QStm_EventPool& QStm_HwEvent::pool()
+{
+    return hwEventPool() ;
+}
+
 
 bool QStm_StateEngine::handleStateEvent()
 {
@@ -42,7 +42,7 @@ class QStm_UiEvent;
  * sees the timers as messages.  This hopefully makes it easier to keep the core state machine as
  * OS agnostic as possible.
  */
-class QStm_HwEvent
+class QSTMGESTURELIB_EXPORT QStm_HwEvent
 {
 public:
     QStm_HwEvent() {} ;
@@ -53,6 +53,14 @@ public:
         m_type(code), m_position(pos),
         m_time(time), m_target(target), m_pointerNumber(pointerNr) {}
 
+    /*!
+     * Drag and touch points are stored for every pointer event, they are
+     * taken from a fixed size pool instead of the heap
+     */
+    static void* operator new(size_t size) ;
+    static void operator delete(void* p) ;
+    static const QStm_EventPool& pool() ;
+
     QStm_StateMachineEvent m_type ;
     QPoint  m_position ;
     QTime   m_time ;
@@ -131,6 +139,7 @@ private:
     QStm_HwEvent m_hwe ;
 
     bool isNewHoldingPoint() ;
+    void releasePoints() ;
     QList<QStm_HwEvent*>  m_dragPoints;        // LATER: change this into std::vector
     QStm_TimerInterfaceIf*  m_timerif ;                //
 
@@ -25,6 +25,7 @@
 #include "qstmstateengineconfig.h"
 
 #include "qstmfilelogger.h"
+#include "qstmgesturerecorder.h"
 #include "qstmutils.h"
 #include <QtGui>
 
@@ -76,6 +77,7 @@ QStm_StateMachine::QStm_StateMachine()
     m_dblClickEnabled = false;
     m_currentNativeWin = NULL;
     m_widget = 0;
+    m_recorder = NULL;
     //m_pointBuffer = NULL;
     init();
 }
@@ -127,6 +129,10 @@ void QStm_StateMachine::init()
 
 bool QStm_StateMachine::handleStateEvent(const QStm_PlatformPointerEvent& platPointerEvent)
 {
+    if (m_recorder)
+    {
+        m_recorder->record(platPointerEvent) ;
+    }
     int index = pointerIndex(platPointerEvent);
     QStm_StateEngine* engine = m_impl[index];
     createHwEvent(engine->initEvent(), platPointerEvent, platPointerEvent.m_target, platPointerEvent.m_time) ;
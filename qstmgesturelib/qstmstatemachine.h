@@ -32,6 +32,7 @@
 #include <qwindowdefs.h>
 
 class QSymbianEvent;
+class QStm_GestureRecorder;
 
 #if !defined(Q_WS_X11)
 #define XEvent void
@@ -93,6 +94,10 @@ public:
     bool handleWinPlatformEvent(const void* platEvent);
 
     bool handleStateEvent(const QStm_PlatformPointerEvent& platPointerEvent) ;
+    /*!
+     * Write every pointer event handled from now on to \a recorder, NULL stops recording.
+     */
+    void setRecorder(QStm_GestureRecorder* recorder) { m_recorder = recorder; }
     /*!
      * Setting the Y adjustment useful in capacitive touch
      * Note that there are problems with the adjustment if done at this level,
@@ -159,6 +164,7 @@ private:
     bool m_adjustYposition ;
     void* m_currentNativeWin;
     QWidget* m_widget;
+    QStm_GestureRecorder* m_recorder;
     // Use same naming scheme with the timers, and variables and methods
     // using macro expansion tricks (with multitouch support starts to look quite ugly):
 #define DECLARE_TIMER(x) \
@@ -40,6 +40,33 @@ const char* qstmUiEventEngine::event_name(qstmUiEventEngine::QStm_UiEventCode co
     return eventNames[code];
 }
 
+// A pointer keeps only a few events chained, see QStm_UiEventSender::compressStack,
+// so 32 covers all pointers with room to spare.  Events beyond that come from the
+// heap (QStm_EventPool::overflowCount()), nothing fails.
+static const int KUiEventPoolCapacity = 32 ;
+
+static QStm_EventPool& uiEventPool()
+{
+    // never deleted: events may still be released during static destruction
+    static QStm_EventPool* pool = new QStm_EventPool(sizeof(QStm_UiEvent), KUiEventPoolCapacity) ;
+    return *pool ;
+}
+
+void* QStm_UiEvent::operator new(size_t size)
+{
+    return uiEventPool().alloc(size) ;
+}
+
+void QStm_UiEvent::operator delete(void* p)
+{
+    uiEventPool().release(p) ;
+}
+
+const QStm_EventPool& QStm_UiEvent::pool()
+{
+    return uiEventPool() ;
+}
+
 QStm_UiEvent::QStm_UiEvent(
     QStm_UiEventCode code,
     const QPoint& start, const QPoint& xy, const QPoint& previousXY,
@@ -23,12 +23,13 @@
 #define QSTMUIEVENT_H_
 
 #include "qstmuievent_if.h"
+#include "qstmeventpool.h"
 
 
 namespace qstmUiEventEngine
 {
 
-class QStm_UiEvent : public QStm_UiEventIf
+class QSTMGESTURELIB_EXPORT QStm_UiEvent : public QStm_UiEventIf
 {
 public:
     virtual const QPoint& startPos() const ;
@@ -66,6 +67,14 @@ public:
      * in UI sender
      */
     virtual void setPrevious(QStm_UiEvent* aEvent) ;
+
+    /*!
+     * UI events are created for every pointer event, they are taken from
+     * a fixed size pool instead of the heap
+     */
+    static void* operator new(size_t size) ;
+    static void operator delete(void* p) ;
+    static const QStm_EventPool& pool() ;
 private:
 
     QStm_UiEventCode m_code ;
@@ -49,6 +49,8 @@ public:
     virtual void setOwner(void* owner) ;
 
     virtual QStm_GestureUid gestureUid() const { return KUid; }
+    virtual int interestedEvents() const { return QSTM_UIEVENT_BIT(qstmUiEventEngine::EHold); }
+    virtual int interestedStreamCounts() const { return KSingleStream; }
 
     void setArea(const QRect& theArea)  ;
 
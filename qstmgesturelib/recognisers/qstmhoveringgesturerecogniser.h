@@ -43,6 +43,9 @@ public:
     virtual void release(QStm_GestureEngineIf* ge) ;
 
     virtual QStm_GestureUid gestureUid() const { return KUid; }
+    virtual int interestedEvents() const { return QSTM_UIEVENT_BIT(qstmUiEventEngine::EMove) |
+                                                   QSTM_UIEVENT_BIT(qstmUiEventEngine::ERelease); }
+    virtual int interestedStreamCounts() const { return KSingleStream; }
 
     void setHoveringSpeed(float aSpeed) /*__SOFTFP */;
 
@@ -39,6 +39,8 @@ public:
     virtual void release(QStm_GestureEngineIf* ge) ;
 
     virtual QStm_GestureUid gestureUid() const { return KUid; }
+    virtual int interestedEvents() const { return QSTM_UIEVENT_BIT(qstmUiEventEngine::EMove); }
+    virtual int interestedStreamCounts() const { return KSingleStream; }
     QStm_LeftrightGestureRecogniser(QStm_GestureListenerIf* listener) ;
     void setAxisLockThreshold(qreal axisLock) { m_axisLock = axisLock; }
 
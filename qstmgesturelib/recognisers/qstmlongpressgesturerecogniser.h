@@ -44,6 +44,8 @@ public:
     virtual void release(QStm_GestureEngineIf* ge) ;
 
     virtual QStm_GestureUid gestureUid() const { return KUid; }
+    virtual int interestedEvents() const { return QSTM_UIEVENT_BIT(qstmUiEventEngine::EHold); }
+    virtual int interestedStreamCounts() const { return KSingleStream; }
 
     void setArea(const QRect& theArea) ;
 
@@ -40,6 +40,8 @@ public:
     virtual void release(QStm_GestureEngineIf* ge) ;
 
     virtual QStm_GestureUid gestureUid() const { return KUid; }
+    virtual int interestedEvents() const { return QSTM_UIEVENT_BIT(qstmUiEventEngine::EMove); }
+    virtual int interestedStreamCounts() const { return KSingleStream; }
     virtual void setPanningSpeedLow(float aSpeed) /*__SOFTFP*/ ;
     virtual void setPanningSpeedHigh(float aSpeed)/* __SOFTFP*/ ;
 
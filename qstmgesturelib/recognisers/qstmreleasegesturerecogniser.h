@@ -48,6 +48,8 @@ public:
     virtual void release(QStm_GestureEngineIf* ge) ;
 
     virtual QStm_GestureUid gestureUid() const  { return KUid; }
+    virtual int interestedEvents() const { return QSTM_UIEVENT_BIT(qstmUiEventEngine::ERelease); }
+    virtual int interestedStreamCounts() const { return KSingleStream; }
     void setArea(const QRect& theArea) ;
 
     QStm_ReleaseGestureRecogniser(QStm_GestureListenerIf* listener) ;
@@ -37,6 +37,11 @@
 #endif
 
 // DownloadManagerClient definitions
+// The client subscribes to events on a second channel and also polls with
+// GetEvents every EVENTS_REQUEST_INTERVAL ms. Polling stops once the server
+// has pushed the first batch on the event channel, so servers that do not
+// push keep working. Within a batch the client only posts the last Progress
+// event of each download.
 #define EVENTS_REQUEST_INTERVAL 50
 
 // enum for progressive download operations supported
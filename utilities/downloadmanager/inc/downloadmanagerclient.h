@@ -60,6 +60,10 @@ private:
     bool initServer();
     // connect to download manager server
     bool connectToServer();
+    // connect the event channel on which the server pushes events
+    bool connectEventChannel();
+    // ask the server for the next batch of pushed events
+    void subscribeEvents();
     // process Download and DownloadManager events
     void processEvents(QString eventMsg);
     // encodes the strings (client name, url, etc) so that it does not contain
@@ -69,6 +73,8 @@ private:
 private slots:
     // poll server for events
     void getEvents();
+    // handle events pushed by the server
+    void handleEvents();
     // set server IPC error
     void setServerError(int );
 };
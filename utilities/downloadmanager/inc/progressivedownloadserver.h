@@ -25,9 +25,15 @@ typedef QAbstractSocket::SocketError ProgressiveDlServerError;
 
 // forward declarations
 class ProgressiveDownloadServerPrivate;
+class ProgressiveReader;
 class Download;
+class QTcpSocket;
 
 // class declaration 
+// Besides the control protocol (ProgressiveOperation / ProgressiveResponse)
+// the server answers HTTP GET and HEAD requests with Range support, so that
+// any number of local players can read the file while it is downloaded.
+// A read beyond the downloaded part is held until the data has arrived.
 class ProgressiveDownloadServer : public QObject {
     Q_OBJECT
     DM_DECLARE_PRIVATE(ProgressiveDownloadServer);
@@ -56,6 +62,17 @@ signals:
 private slots:
     void handleConnection(void);
     void handleRequest(void);
+    void handleDisconnected(void);
+    void handleBytesWritten(void);
+    void handleReaderWritable(int socket);
+
+private:
+    void handleControlRequest(QTcpSocket* client);
+    void handleHttpRequest(ProgressiveReader* reader);
+    void sendToControlClients(quint16 response);
+    void serveReader(ProgressiveReader* reader);
+    void serveReaders(void);
+    void closeReader(ProgressiveReader* reader);
 
 };
 
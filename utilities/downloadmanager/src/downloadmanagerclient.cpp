@@ -31,6 +31,9 @@ public:
     bool m_isConnected;
     int m_error;
     WRT::ServiceFwIPC* m_session;
+    WRT::ServiceFwIPC* m_eventSession;
+    // true once the server has pushed events on the event channel
+    bool m_eventsPushed;
     DownloadManager* m_downloadManager;
     QTimer* m_timer;
 };
@@ -41,6 +44,8 @@ DownloadManagerClientPrivate::DownloadManagerClientPrivate()
     m_isConnected = false;
     m_error = 0;
     m_session = 0;
+    m_eventSession = 0;
+    m_eventsPushed = false;
     m_downloadManager = 0;
     m_timer = 0;
 }
@@ -54,6 +59,12 @@ DownloadManagerClientPrivate::~DownloadManagerClientPrivate()
         m_timer = 0;
     }
 
+    if (m_eventSession) {
+        m_eventSession->disconnect();
+        delete m_eventSession;
+        m_eventSession = 0;
+    }
+
     if (m_session) {
         m_session->disconnect();
         delete m_session;
@@ -92,7 +103,10 @@ bool DownloadManagerClient::initServer()
         // and attach to downloads
         setStartupInfo();
 
-        // start timer to get events from server
+        // subscribe to pushed events, but keep polling until the server
+        // has shown that it pushes them
+        priv->m_eventsPushed = false;
+        connectEventChannel();
         priv->m_timer->start(EVENTS_REQUEST_INTERVAL);
         priv->m_downloadManager->postEvent(ConnectedToServer, NULL);
     }
@@ -130,6 +144,41 @@ bool DownloadManagerClient::connectToServer()
     return priv->m_isConnected;
 }
 
+bool DownloadManagerClient::connectEventChannel()
+{
+    DM_PRIVATE(DownloadManagerClient);
+    // the event channel shares the session id of the request channel so that
+    // the server can route the events of this client to it
+    int sessionId(0);
+    if (!priv->m_session->getSessionId(sessionId))
+        return false;
+
+    if (!priv->m_eventSession) {
+        priv->m_eventSession = new WRT::ServiceFwIPC(this);
+        connect(priv->m_eventSession, SIGNAL(readyRead()), this, SLOT(handleEvents()));
+        connect(priv->m_eventSession, SIGNAL(error(int)), this, SLOT(setServerError(int)));
+    }
+    else {
+        priv->m_eventSession->disconnect();
+    }
+
+    if (priv->m_eventSession->connect(DMSERVER)) {
+        if (priv->m_eventSession->setSessionId(sessionId)) {
+            subscribeEvents();
+            return true;
+        }
+        priv->m_eventSession->disconnect();
+    }
+    return false;
+}
+
+void DownloadManagerClient::subscribeEvents()
+{
+    DM_PRIVATE(DownloadManagerClient);
+    // the server completes this request as soon as an event is available
+    priv->m_eventSession->sendAsync(SUBSCRIBEBROADCASTMSG, encodeString(priv->m_clientName).toAscii());
+}
+
 void DownloadManagerClient::setStartupInfo()
 {
     DM_PRIVATE(DownloadManagerClient);
@@ -650,33 +699,72 @@ void DownloadManagerClient::getEvents()
             processEvents(eventMsg);
 
         // start timer for getting next set of events
-        priv->m_timer->start(EVENTS_REQUEST_INTERVAL);
+        if (!priv->m_eventsPushed)
+            priv->m_timer->start(EVENTS_REQUEST_INTERVAL);
     }
     else {
         setServerError(WRT::ServiceFwIPC::EIPCError);
     }
 }
 
+// handle events pushed by the server
+void DownloadManagerClient::handleEvents()
+{
+    DM_PRIVATE(DownloadManagerClient);
+    QString eventMsg = priv->m_eventSession->readAll();
+    // nothing complete yet, the subscription is still outstanding
+    if (eventMsg.isEmpty())
+        return;
+
+    // the server pushes events, polling is no longer needed
+    if (!priv->m_eventsPushed) {
+        priv->m_eventsPushed = true;
+        priv->m_timer->stop();
+    }
+    processEvents(eventMsg);
+
+    // wait for the next set of events
+    if (priv->m_isConnected)
+        subscribeEvents();
+}
+
 // process Download and DownloadManager events
 void DownloadManagerClient::processEvents(QString eventMsg)
 {
     DM_PRIVATE(DownloadManagerClient);
 
-    // Separate out the fields of an event
-    QStringList list = eventMsg.split(DM_FIELD_DELIMITER);
-    if (list.count() >= 2) {
-        QString eventName = list[0];
-        // // check type of event
+    // Separate out the events; a batch may carry several of them
+    QStringList events = eventMsg.split(DM_MSG_DELIMITER, QString::SkipEmptyParts);
+
+    // only the last Progress event of each download in a batch is posted
+    QHash<int, int> lastProgress;
+    QList<QStringList> eventFields;
+    for (int i = 0; i < events.count(); i++) {
+        QStringList list = events[i].split(DM_FIELD_DELIMITER);
+        if (list.count() >= 3 && list[0] == QString::number(EventDownload)
+            && list[2].toInt() == Progress)
+            lastProgress[list[1].toInt()] = i;
+        eventFields.append(list);
+    }
+
+    for (int i = 0; i < eventFields.count(); i++) {
+        // Separate out the fields of an event
+        const QStringList& list = eventFields[i];
+        if (list.count() < 2)
+            continue;
+        // check type of event
         if (list[0] == QString::number(EventDownloadManager)) {
             // Download Manager event
             DEventType type = (DEventType)list[1].toInt();
             // post event
             priv->m_downloadManager->postEvent(type, NULL);
         }
-        else if (list[0] == QString::number(EventDownload)) {
+        else if (list[0] == QString::number(EventDownload) && list.count() >= 3) {
             // Download event
             int dlId = list[1].toInt();
             DEventType type = (DEventType)list[2].toInt();
+            if (type == Progress && lastProgress.value(dlId) != i)
+                continue;
             BackgroundDownload* dl = dynamic_cast<BackgroundDownload*>(priv->m_downloadManager->findDownload(dlId));
             // post event
             if (dl)
@@ -709,6 +797,8 @@ void DownloadManagerClient::setServerError(int error)
     priv->m_isConnected = false;
     if (priv->m_timer->isActive())
         priv->m_timer->stop();
+    if (priv->m_eventSession)
+        priv->m_eventSession->disconnect();
     priv->m_downloadManager->postEvent(DisconnectedFromServer, NULL);
     priv->m_downloadManager->postEvent(ServerError, NULL);
 }
@@ -120,6 +120,9 @@ int FileStorage::write(const QByteArray& data,bool lastChunk)
     DM_PRIVATE(FileStorage);
     // write the data chunk
     int value = priv->m_file->write(data);
+    // hand the chunk to the file system, the progressive download server
+    // serves it from the file as soon as the progress is reported
+    priv->m_file->flush();
     if(lastChunk)
     {
         close();
@@ -16,12 +16,62 @@
 
 #include "progressivedownloadserver.h"
 #include "download.h"
+#include "downloadmanager.h"
+#include "storageutility.h"
 #include "dmcommon.h"
 #include "dmcommoninternal.h"
 #include <QTcpSocket>
 #include <QHostAddress>
+#include <QSocketNotifier>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegExp>
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <sys/sendfile.h>
+#endif
 
 #define SERVER_WAIT_INTERVAL 1000
+// largest block of the file handed to a socket at once
+#define SERVE_CHUNK_SIZE (64 * 1024)
+// a range request with a longer header is rejected
+#define MAX_REQUEST_HEADER_SIZE 8192
+
+// one http connection reading the download
+class ProgressiveReader
+{
+public:
+    ProgressiveReader(QTcpSocket* socket);
+    ~ProgressiveReader();
+    QTcpSocket* m_socket;
+    QSocketNotifier* m_writeNotifier;   // enabled while sendfile would block
+    QByteArray m_request;               // request header until it is complete
+    QFile m_file;
+    qint64 m_offset;                    // next byte of the file to send
+    qint64 m_end;                       // last byte of the file to send
+    bool m_headOnly;
+    bool m_serving;                     // response header is written
+    bool m_closed;
+};
+
+ProgressiveReader::ProgressiveReader(QTcpSocket* socket)
+{
+    m_socket = socket;
+    m_writeNotifier = 0;
+    m_offset = 0;
+    m_end = -1;
+    m_headOnly = false;
+    m_serving = false;
+    m_closed = false;
+}
+
+ProgressiveReader::~ProgressiveReader()
+{
+    // may be deleted from within its own activated() signal
+    if (m_writeNotifier)
+        m_writeNotifier->deleteLater();
+}
 
 // private implementation
 class ProgressiveDownloadServerPrivate
@@ -30,28 +80,56 @@ class ProgressiveDownloadServerPrivate
 public:
     ProgressiveDownloadServerPrivate();
     ~ProgressiveDownloadServerPrivate();
+    QString filePath();
+    bool isFinished();
     QTcpServer* m_serverSocket;
-    QTcpSocket* m_clientConnection;
+    QList<QTcpSocket*> m_controlClients;
+    QHash<QTcpSocket*, ProgressiveReader*> m_readers;
     Download* m_download;
     DownloadState m_previousDlState;
+    bool m_receivingEvents;
 };
 
 ProgressiveDownloadServerPrivate::ProgressiveDownloadServerPrivate()
 {
     m_serverSocket = 0;
-    m_clientConnection = 0;
     m_download = 0;
     m_previousDlState = DlNone;
+    m_receivingEvents = false;
 }
 
 ProgressiveDownloadServerPrivate::~ProgressiveDownloadServerPrivate()
 {
+    qDeleteAll(m_readers);
+    m_readers.clear();
     if (m_serverSocket) {
         delete m_serverSocket;
         m_serverSocket = 0;
     }
 }
 
+// the file the download is stored in, see FileStorage
+QString ProgressiveDownloadServerPrivate::filePath()
+{
+    QString fileName = m_download->getAttribute(DlFileName).toString();
+    QString path;
+    if (isFinished()) {
+        // moved to the destination path on completion
+        path = m_download->getAttribute(DlDestPath).toString();
+    } else {
+        QString clientName = m_download->downloadManager()->getAttribute(DlMgrClientName).toString();
+        path = StorageUtility::createTemporaryPath(clientName);
+    }
+    return QFileInfo(QDir(path), fileName).filePath();
+}
+
+// no more data will be written to the file
+bool ProgressiveDownloadServerPrivate::isFinished()
+{
+    DownloadState state = (DownloadState)m_download->getAttribute(DlDownloadState).toInt();
+    return (state == DlCompleted || state == DlFailed || state == DlCancelled);
+}
+
 Q_DECL_EXPORT ProgressiveDownloadServer::ProgressiveDownloadServer(Download* download)
 {
     DM_INITIALIZE(ProgressiveDownloadServer);
@@ -84,29 +162,36 @@ Q_DECL_EXPORT int ProgressiveDownloadServer::startServer(void)
 Q_DECL_EXPORT int ProgressiveDownloadServer::stopServer(void)
 {
     DM_PRIVATE(ProgressiveDownloadServer);
+    int result = 0;
     // unregister the event listener
     priv->m_download->unregisterEventReceiver(this);
+    priv->m_receivingEvents = false;
 
     // send the server down signal
-    if ((priv->m_clientConnection) && (priv->m_clientConnection->state() == QAbstractSocket::ConnectedState)) {
+    foreach (QTcpSocket* client, priv->m_controlClients) {
+        if (client->state() != QAbstractSocket::ConnectedState)
+            continue;
         QByteArray block;
         QDataStream out(&block, QIODevice::WriteOnly);
         out.setVersion(QDataStream::Qt_4_0);
         out << (quint16)ProgressiveDlServerDown;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        client->write(block);
+        client->flush();
 
         // wait till the data is written
-        if (priv->m_clientConnection->waitForBytesWritten(SERVER_WAIT_INTERVAL))
-            return 0;
-        else
-            return -1;
+        if (!client->waitForBytesWritten(SERVER_WAIT_INTERVAL))
+            result = -1;
     }
 
+    // readers are cut off, handleDisconnected() releases them
+    QList<QTcpSocket*> readers = priv->m_readers.keys();
+    foreach (QTcpSocket* client, readers)
+        client->abort();
+
     if (priv->m_serverSocket->isListening())
         priv->m_serverSocket->close();
 
-    return 0;
+    return result;
 }
 
 Q_DECL_EXPORT quint16 ProgressiveDownloadServer::serverPort(void)
@@ -135,24 +220,58 @@ Q_DECL_EXPORT QString ProgressiveDownloadServer::lastErrorString(void)
 void ProgressiveDownloadServer::handleConnection(void)
 {
     DM_PRIVATE(ProgressiveDownloadServer);
-    priv->m_clientConnection = priv->m_serverSocket->nextPendingConnection();
-    connect(priv->m_clientConnection, SIGNAL(readyRead()),
-            this, SLOT(handleRequest()));
-    priv->m_download->registerEventReceiver(this);
+    // the server keeps listening, any number of clients may connect
+    while (priv->m_serverSocket->hasPendingConnections()) {
+        QTcpSocket* client = priv->m_serverSocket->nextPendingConnection();
+        connect(client, SIGNAL(readyRead()), this, SLOT(handleRequest()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(handleDisconnected()));
+        connect(client, SIGNAL(bytesWritten(qint64)), this, SLOT(handleBytesWritten()));
+    }
 
-    // right now only one client is supported
-    priv->m_serverSocket->close();
+    if (!priv->m_receivingEvents) {
+        priv->m_download->registerEventReceiver(this);
+        priv->m_receivingEvents = true;
+    }
 }
 
 void ProgressiveDownloadServer::handleRequest(void)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if (!client)
+        return;
+
+    if (priv->m_readers.contains(client)) {
+        handleHttpRequest(priv->m_readers.value(client));
+        return;
+    }
+
+    if (!priv->m_controlClients.contains(client)) {
+        // control requests start with a small big endian quint16,
+        // http requests with the method name
+        char first;
+        if (client->peek(&first, 1) != 1)
+            return;
+        if (first != 0) {
+            ProgressiveReader* reader = new ProgressiveReader(client);
+            priv->m_readers.insert(client, reader);
+            handleHttpRequest(reader);
+            return;
+        }
+        priv->m_controlClients.append(client);
+    }
+    handleControlRequest(client);
+}
+
+void ProgressiveDownloadServer::handleControlRequest(QTcpSocket* client)
 {
     // handles the request from client
     DM_PRIVATE(ProgressiveDownloadServer);
     quint16 requestCode;
-    QDataStream in(priv->m_clientConnection);
+    QDataStream in(client);
     in.setVersion(QDataStream::Qt_4_0);
 
-    if (priv->m_clientConnection->bytesAvailable() < (int)sizeof(quint16))
+    if (client->bytesAvailable() < (int)sizeof(quint16))
         return;
 
     in >> requestCode;
@@ -174,18 +293,257 @@ void ProgressiveDownloadServer::handleRequest(void)
         out.setVersion(QDataStream::Qt_4_0);
         out << (quint16)ProgressiveDlGetAttribute;
         out << value;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        client->write(block);
+        client->flush();
     }
 }
 
-bool ProgressiveDownloadServer::event(QEvent *event)
+// writes a response without body and closes the connection
+static void writeHttpStatus(QTcpSocket* client, const QByteArray& status, const QByteArray& headers = QByteArray())
+{
+    client->write("HTTP/1.1 " + status + "\r\n"
+                  "Content-Length: 0\r\n"
+                  "Connection: close\r\n" + headers + "\r\n");
+}
+
+void ProgressiveDownloadServer::handleHttpRequest(ProgressiveReader* reader)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    QTcpSocket* client = reader->m_socket;
+    if (reader->m_serving || reader->m_closed) {
+        // one request per connection
+        client->readAll();
+        return;
+    }
+
+    reader->m_request.append(client->readAll());
+    int headerEnd = reader->m_request.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (reader->m_request.size() > MAX_REQUEST_HEADER_SIZE) {
+            writeHttpStatus(client, "400 Bad Request");
+            closeReader(reader);
+        }
+        return;
+    }
+
+    QList<QByteArray> lines = reader->m_request.left(headerEnd).split('\n');
+    QByteArray method = lines.first().trimmed().split(' ').first();
+    if (method != "GET" && method != "HEAD") {
+        writeHttpStatus(client, "501 Not Implemented");
+        closeReader(reader);
+        return;
+    }
+    reader->m_headOnly = (method == "HEAD");
+
+    QByteArray range;
+    for (int i = 1; i < lines.count(); i++) {
+        int colon = lines[i].indexOf(':');
+        if (colon > 0 && lines[i].left(colon).trimmed().toLower() == "range")
+            range = lines[i].mid(colon + 1).trimmed();
+    }
+
+    // the size is known once the response headers of the download have arrived,
+    // until then the request is held and retried from serveReaders()
+    qint64 total = priv->m_download->getAttribute(DlTotalSize).toLongLong();
+    if (total <= 0) {
+        if (!priv->isFinished())
+            return;
+        total = QFileInfo(priv->filePath()).size();
+    }
+
+    // a single byte range is supported, anything else is answered with the whole file
+    qint64 start = 0;
+    qint64 end = total - 1;
+    bool partial = false;
+    QRegExp rangeExp("bytes\\s*=\\s*(\\d*)\\s*-\\s*(\\d*)");
+    if (rangeExp.exactMatch(QString::fromLatin1(range))
+        && !(rangeExp.cap(1).isEmpty() && rangeExp.cap(2).isEmpty())) {
+        if (rangeExp.cap(1).isEmpty()) {
+            // suffix range, the last n bytes
+            start = qMax<qint64>(0, total - rangeExp.cap(2).toLongLong());
+        } else {
+            start = rangeExp.cap(1).toLongLong();
+            if (!rangeExp.cap(2).isEmpty())
+                end = qMin(end, rangeExp.cap(2).toLongLong());
+        }
+        if (start >= total || end < start) {
+            writeHttpStatus(client, "416 Requested Range Not Satisfiable",
+                            "Content-Range: bytes */" + QByteArray::number(total) + "\r\n");
+            closeReader(reader);
+            return;
+        }
+        partial = true;
+    }
+
+    QByteArray header = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+    QByteArray contentType = priv->m_download->getAttribute(DlContentType).toString().toLatin1();
+    if (!contentType.isEmpty())
+        header += "Content-Type: " + contentType + "\r\n";
+    header += "Content-Length: " + QByteArray::number(end - start + 1) + "\r\n";
+    if (partial)
+        header += "Content-Range: bytes " + QByteArray::number(start) + "-"
+                  + QByteArray::number(end) + "/" + QByteArray::number(total) + "\r\n";
+    header += "Accept-Ranges: bytes\r\n"
+              "Connection: close\r\n\r\n";
+    client->write(header);
+    reader->m_request.clear();
+    reader->m_offset = start;
+    reader->m_end = end;
+    reader->m_serving = true;
+
+    if (reader->m_headOnly)
+        closeReader(reader);
+    else
+        serveReader(reader);
+}
+
+// sends as much of the requested range as has been downloaded
+void ProgressiveDownloadServer::serveReader(ProgressiveReader* reader)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    if (!reader->m_serving || reader->m_closed)
+        return;
+
+    QTcpSocket* client = reader->m_socket;
+    if (!reader->m_file.isOpen()) {
+        reader->m_file.setFileName(priv->filePath());
+        if (!reader->m_file.open(QIODevice::ReadOnly)) {
+            // the store is created with the first chunk of data
+            if (priv->isFinished())
+                closeReader(reader);
+            return;
+        }
+    }
+
+    while (reader->m_offset <= reader->m_end) {
+        qint64 available = reader->m_file.size();
+        if (reader->m_offset >= available) {
+            // the client blocks in its read until the next Progress event
+            if (priv->isFinished())
+                closeReader(reader);
+            return;
+        }
+        qint64 count = qMin<qint64>(qMin(reader->m_end + 1, available) - reader->m_offset,
+                                    SERVE_CHUNK_SIZE);
+#ifdef Q_OS_LINUX
+        // the response header has to leave the socket buffer before the file data,
+        // continued from handleBytesWritten() otherwise
+        if (client->bytesToWrite() > 0) {
+            client->flush();
+            if (client->bytesToWrite() > 0)
+                return;
+        }
+        // copied from the page cache to the socket without passing through user space,
+        // the file stays valid when it is moved to the destination path on completion
+        off_t offset = reader->m_offset;
+        ssize_t sent = ::sendfile(client->socketDescriptor(), reader->m_file.handle(), &offset, count);
+        if (sent < 0 && (errno == EAGAIN || errno == EINTR)) {
+            if (!reader->m_writeNotifier) {
+                reader->m_writeNotifier = new QSocketNotifier(client->socketDescriptor(),
+                                                              QSocketNotifier::Write);
+                connect(reader->m_writeNotifier, SIGNAL(activated(int)),
+                        this, SLOT(handleReaderWritable(int)));
+            }
+            reader->m_writeNotifier->setEnabled(true);
+            return;
+        }
+#else
+        // keep at most one chunk queued in the socket, continued from handleBytesWritten()
+        if (client->bytesToWrite() >= SERVE_CHUNK_SIZE)
+            return;
+        qint64 sent = -1;
+        if (reader->m_file.seek(reader->m_offset)) {
+            QByteArray data = reader->m_file.read(count);
+            if (!data.isEmpty())
+                sent = client->write(data);
+        }
+#endif
+        if (sent <= 0) {
+            closeReader(reader);
+            return;
+        }
+        reader->m_offset += sent;
+    }
+
+    // whole range is sent
+    closeReader(reader);
+}
+
+void ProgressiveDownloadServer::serveReaders(void)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    // a reader may be released while the others are served
+    QList<QTcpSocket*> clients = priv->m_readers.keys();
+    foreach (QTcpSocket* client, clients) {
+        ProgressiveReader* reader = priv->m_readers.value(client);
+        if (!reader)
+            continue;
+        if (reader->m_serving)
+            serveReader(reader);
+        else if (!reader->m_request.isEmpty())
+            handleHttpRequest(reader);
+    }
+}
+
+// closes the connection once the written data is sent, the reader
+// is released in handleDisconnected() and must not be used after this
+void ProgressiveDownloadServer::closeReader(ProgressiveReader* reader)
+{
+    reader->m_closed = true;
+    if (reader->m_writeNotifier)
+        reader->m_writeNotifier->setEnabled(false);
+    reader->m_socket->disconnectFromHost();
+}
+
+void ProgressiveDownloadServer::handleBytesWritten(void)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    ProgressiveReader* reader = priv->m_readers.value(client);
+    if (reader)
+        serveReader(reader);
+}
+
+void ProgressiveDownloadServer::handleReaderWritable(int socket)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    foreach (ProgressiveReader* reader, priv->m_readers) {
+        if (reader->m_writeNotifier && reader->m_writeNotifier->socket() == socket) {
+            reader->m_writeNotifier->setEnabled(false);
+            serveReader(reader);
+            return;
+        }
+    }
+}
+
+void ProgressiveDownloadServer::handleDisconnected(void)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if (!client)
+        return;
+    priv->m_controlClients.removeAll(client);
+    delete priv->m_readers.take(client);
+    client->deleteLater();
+}
+
+void ProgressiveDownloadServer::sendToControlClients(quint16 response)
 {
     DM_PRIVATE(ProgressiveDownloadServer);
-    DEventType type = (DEventType)event->type();
     QByteArray block;
     QDataStream out(&block, QIODevice::WriteOnly);
     out.setVersion(QDataStream::Qt_4_0);
+    out << response;
+    foreach (QTcpSocket* client, priv->m_controlClients) {
+        client->write(block);
+        client->flush();
+    }
+}
+
+bool ProgressiveDownloadServer::event(QEvent *event)
+{
+    DM_PRIVATE(ProgressiveDownloadServer);
+    DEventType type = (DEventType)event->type();
 
     // handle the events from the download and send the response to the client
     switch(type) {
@@ -194,40 +552,33 @@ bool ProgressiveDownloadServer::event(QEvent *event)
         // to avoid continueously writing to the response buffer and increasing the ipc overhead 
         if (priv->m_previousDlState != DlInprogress) {
             priv->m_previousDlState = DlInprogress;
-            out << (quint16)ProgressiveDlInprogress;
-            priv->m_clientConnection->write(block);
-            priv->m_clientConnection->flush();
+            sendToControlClients(ProgressiveDlInprogress);
         }
+        // more of the file is available to held readers
+        serveReaders();
         break;
     case Paused:
         priv->m_previousDlState = DlPaused;
-        out << (quint16)ProgressiveDlPaused;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        sendToControlClients(ProgressiveDlPaused);
         break;
     case Completed:
         priv->m_previousDlState = DlCompleted;
-        out << (quint16)ProgressiveDlCompleted;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        sendToControlClients(ProgressiveDlCompleted);
+        serveReaders();
         break;
     case Failed:
         priv->m_previousDlState = DlFailed;
-        out << (quint16)ProgressiveDlFailed;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        sendToControlClients(ProgressiveDlFailed);
+        serveReaders();
         break;
     case Cancelled:
         priv->m_previousDlState = DlCancelled;
-        out << (quint16)ProgressiveDlCancelled;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        sendToControlClients(ProgressiveDlCancelled);
+        serveReaders();
         break;
     case NetworkLoss:
         priv->m_previousDlState = DlPaused;
-        out << (quint16)ProgressiveDlPaused;
-        priv->m_clientConnection->write(block);
-        priv->m_clientConnection->flush();
+        sendToControlClients(ProgressiveDlPaused);
         break;
     default:
         break;
@@ -235,5 +586,3 @@ bool ProgressiveDownloadServer::event(QEvent *event)
     // event is consumed in any case.
     return true;
 }
-       
-
@@ -17,6 +17,9 @@
 
 #include <QByteArray>
 #include "serviceipclocalsocket_p.h"
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
 
 namespace WRT
 {
@@ -24,6 +27,12 @@ namespace WRT
 const char* REQUEST_COMPLETE_TOKEN = ";ROK";
 const int REQUEST_COMPLETE_TOKEN_LENGTH = 4;
 const char REQUEST_DELIMITER_TOKEN = ';';
+// How long to wait for the protocol negotiation reply, in milliseconds.
+// A server that speaks the binary protocol answers right away; only text
+// servers run into the timeout, and only on the first connect to them.
+const int NEGOTIATE_TIMEOUT = 200;
+// How long a synchronous read waits for more data, in milliseconds
+const int SYNC_READ_TIMEOUT = 30000;
 /*!
  \class ServiceLocalSocketIPC
  QLocalSocket based IPC client-side backend
@@ -32,7 +41,11 @@ const char REQUEST_DELIMITER_TOKEN = ';';
 /*!
  Constructor
  */
-ServiceLocalSocketIPC::ServiceLocalSocketIPC() : m_BufferType( ENoBuffer )
+ServiceLocalSocketIPC::ServiceLocalSocketIPC() 
+    : m_BufferType( ENoBuffer )
+    , m_ProtocolVersion( KIPCTextProtocol )
+    , m_NextRequestId( 0 )
+    , m_SyncRequestId( 0 )
 {
     m_Socket = new QLocalSocket();
     QObject::connect(m_Socket, SIGNAL( error( QLocalSocket::LocalSocketError ) ),
@@ -58,9 +71,85 @@ bool ServiceLocalSocketIPC::connect(const QString& aServerName)
     bool rtn;
     m_Socket->connectToServer(aServerName);
     rtn = m_Socket->waitForConnected();
+    if (rtn) {
+        rtn = negotiateProtocol(aServerName);
+    }
     return rtn;
 }
 
+/*!
+ Negotiate the wire protocol with the server.\n
+ The request is sent with the text protocol; if the server answers with
+ a binary protocol version both sides switch to binary framing. Servers
+ that do not answer in time are spoken to with the text protocol, and are
+ remembered so that later connections from this process do not wait again.
+ Such a server may still be holding the unanswered request, and would take
+ the next request as more of its data, so the connection is made again.
+ @param aServerName name of the server connected to
+ @return true if connected, false if connecting again failed
+ */
+bool ServiceLocalSocketIPC::negotiateProtocol(const QString& aServerName)
+{
+    static QSet<QString> textServers;
+
+    m_ProtocolVersion = KIPCTextProtocol;
+    m_FrameReader.clear();
+    m_Replies.clear();
+    m_AbandonedRequests.clear();
+    if (textServers.contains(aServerName)) {
+        return true;
+    }
+
+    QByteArray version;
+    version.setNum(KIPCBinaryProtocol);
+    if (!sendSync(NEGOTIATEPROTOCOL, version)) {
+        return m_Socket->state() == QLocalSocket::ConnectedState;
+    }
+
+    QByteArray reply;
+    while (!reply.endsWith(REQUEST_COMPLETE_TOKEN)) {
+        if (!m_Socket->waitForReadyRead(NEGOTIATE_TIMEOUT)) {
+            m_BufferType = ENoBuffer;
+            textServers.insert(aServerName);
+            m_Socket->abort();
+            m_Socket->connectToServer(aServerName);
+            return m_Socket->waitForConnected();
+        }
+        reply.append(m_Socket->readAll());
+    }
+    reply.chop(REQUEST_COMPLETE_TOKEN_LENGTH);
+    m_BufferType = ENoBuffer;
+    m_ProtocolVersion = qMin(reply.toInt(), KIPCBinaryProtocol);
+    return true;
+}
+
+/*!
+ Serialise a request in the negotiated protocol
+ @param aRequestType type of request, toAscii() will be called to serialize the data
+ @param aData data to send to the server
+ @return the request ready to be written to the socket
+ */
+QByteArray ServiceLocalSocketIPC::encodeRequest(const QString& aRequestType,
+                                                const QByteArray& aData)
+{
+    QByteArray data;
+    if (m_ProtocolVersion == KIPCBinaryProtocol) {
+        QList<QByteArray> fields;
+        fields.append(aRequestType.toAscii());
+        fields.append(aData);
+        data = ServiceIPCFrame::encode(ServiceIPCFrame::ERequest,
+                                       ++m_NextRequestId, fields);
+    }
+    else {
+        data.setNum(aData.length());
+        data.append(REQUEST_DELIMITER_TOKEN);
+        data.append(aRequestType.toAscii());
+        data.append(REQUEST_DELIMITER_TOKEN);
+        data.append(aData);
+    }
+    return data;
+}
+
 /*!
  Disconnect from the server
  */
@@ -143,18 +232,117 @@ bool ServiceLocalSocketIPC::startServer(const QString& aServerName,
 bool ServiceLocalSocketIPC::sendSync(const QString& aRequestType,
                                      const QByteArray& aData)
 {
-    QByteArray data;
-    data.setNum(aData.length());
-    data.append(REQUEST_DELIMITER_TOKEN);
-    data.append(aRequestType.toAscii());
-    data.append(REQUEST_DELIMITER_TOKEN);
-    data.append(aData);
-    int count = m_Socket->write(data);
-    m_Socket->flush();
+    qint64 count = writeRequest(encodeRequest(aRequestType, aData));
+    m_SyncRequestId = m_NextRequestId;
     m_BufferType = ESyncBuffer;
     return (count > 0);
 }
 
+/*!
+ Send a synchronous request without waiting for its reply.\n
+ With the binary protocol several requests can be in flight on the
+ connection, each reply is matched to its request by the request id.
+ The text protocol cannot match replies, so the request completes
+ before this returns.
+ @param aRequestType type of request, toAscii() will be called to serialize the data
+ @param aData data to send to the server
+ @return id to pass to readReply(), -1 on error
+ */
+int ServiceLocalSocketIPC::sendPipelined(const QString& aRequestType,
+                                         const QByteArray& aData)
+{
+    if (m_ProtocolVersion != KIPCBinaryProtocol) {
+        return ServiceFwIPCPrivate::sendPipelined(aRequestType, aData);
+    }
+    qint64 count = writeRequest(encodeRequest(aRequestType, aData));
+    return (count > 0) ? (int) m_NextRequestId : -1;
+}
+
+/*!
+ Wait for and read the reply to a pipelined request
+ @param aRequestId id returned by sendPipelined()
+ @return the reply data
+ */
+QByteArray ServiceLocalSocketIPC::readReply(int aRequestId)
+{
+    if (m_ProtocolVersion != KIPCBinaryProtocol) {
+        return ServiceFwIPCPrivate::readReply(aRequestId);
+    }
+    return waitForReply(aRequestId);
+}
+
+/*!
+ Block until the reply frame of a request has been received.\n
+ Replies to other requests that arrive first are kept until asked for.
+ If the server does not answer in time ETimedOut is reported via error()
+ and the request is abandoned, its reply is dropped if it comes later.
+ @param aRequestId id of the request
+ @return the reply data, empty if the connection failed or timed out
+ */
+QByteArray ServiceLocalSocketIPC::waitForReply(quint32 aRequestId)
+{
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Ipc, "ServiceLocalSocketIPC::waitForReply");
+#endif
+    ServiceIPCFrame frame;
+    forever {
+        if (m_Replies.contains(aRequestId)) {
+            return m_Replies.take(aRequestId);
+        }
+        if (m_FrameReader.next(frame)) {
+            if (frame.m_Opcode == ServiceIPCFrame::EReply
+                && !m_AbandonedRequests.remove(frame.m_RequestId)) {
+                m_Replies.insert(frame.m_RequestId, frame.m_Fields.value(0));
+            }
+            continue;
+        }
+        // Sleep until the server sends more, socket errors are reported
+        // via handleError()
+        if (!readFrames(SYNC_READ_TIMEOUT)) {
+            if (m_Socket->state() == QLocalSocket::ConnectedState) {
+                m_AbandonedRequests.insert(aRequestId);
+                emitError(ServiceFwIPC::ETimedOut);
+            }
+            return QByteArray();
+        }
+    }
+}
+
+/*!
+ Write a serialised request to the socket
+ @param aData request to write
+ @return number of bytes written, -1 on error
+ */
+qint64 ServiceLocalSocketIPC::writeRequest(const QByteArray& aData)
+{
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Ipc, "ServiceLocalSocketIPC::writeRequest");
+    PERF_TRACE_COUNTER(Ipc, "ipc request bytes", aData.length());
+#endif
+    qint64 count = m_Socket->write(aData);
+    m_Socket->flush();
+    return count;
+}
+
+/*!
+ Move data received on the socket into the frame reader
+ @param aTimeout how long to wait if nothing has been received, in milliseconds
+ @return true if data was added
+ */
+bool ServiceLocalSocketIPC::readFrames(int aTimeout)
+{
+    if (m_Socket->bytesAvailable() == 0
+        && (aTimeout == 0 || !m_Socket->waitForReadyRead(aTimeout))) {
+        return false;
+    }
+    QByteArray data = m_Socket->readAll();
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_COUNTER(Ipc, "ipc reply bytes", data.length());
+#endif
+    m_FrameReader.append(data);
+    return true;
+}
+
 /*!
  Send a request asynchronously
  @param aRequestType type of request, toAscii() will be called to serialize the data
@@ -163,19 +351,19 @@ bool ServiceLocalSocketIPC::sendSync(const QString& aRequestType,
 void ServiceLocalSocketIPC::sendAsync(const QString& aRequestType,
                                       const QByteArray& aData)
 {
-    QByteArray data;
-    data.setNum(aData.length());
-    data.append(REQUEST_DELIMITER_TOKEN);
-    data.append(aRequestType.toAscii());
-    data.append(REQUEST_DELIMITER_TOKEN);
-    data.append(aData);
-    m_Socket->write(data);
+    writeRequest(encodeRequest(aRequestType, aData));
 
     // Connect the signal and reset aync data buffer
     m_AsyncData.clear();
     QObject::connect(m_Socket, SIGNAL( readyRead() ),
-    this, SLOT( handleReadyRead() ) );
+    this, SLOT( handleReadyRead() ), Qt::UniqueConnection );
     m_BufferType = EAsyncBuffer;
+
+    // Frames received together with an earlier reply are already buffered,
+    // no readyRead() will come for them
+    if (m_ProtocolVersion == KIPCBinaryProtocol && m_FrameReader.hasPendingData()) {
+        QMetaObject::invokeMethod(this, "handleReadyRead", Qt::QueuedConnection);
+    }
 }
 
 /*!
@@ -188,19 +376,33 @@ QByteArray ServiceLocalSocketIPC::readAll()
 
     // If asynchronous read all data from the socket 
     //
-    if ( m_BufferType == ESyncBuffer ) {
-        // Wait for all data to be completed before returning
+    if ( m_BufferType == ESyncBuffer && m_ProtocolVersion == KIPCBinaryProtocol ) {
+        // Wait for the reply frame to be complete before returning
         //
-        bool done = false;
-        do {
+        result = waitForReply(m_SyncRequestId);
+    }
+    else if ( m_BufferType == ESyncBuffer ) {
+        // Wait for all data to be completed before returning, only the
+        // tail of the buffer needs to be checked for the end token
+        //
+        result.append(m_Socket->readAll());
+        while (!result.endsWith(REQUEST_COMPLETE_TOKEN)) {
+            if (!m_Socket->waitForReadyRead(SYNC_READ_TIMEOUT)) {
+                break;
+            }
             result.append(m_Socket->readAll());
-            if (result.right(REQUEST_COMPLETE_TOKEN_LENGTH)
-                            == REQUEST_COMPLETE_TOKEN) {
-                // Chop the end token
-                result.chop(REQUEST_COMPLETE_TOKEN_LENGTH);
-                done = true;
+        }
+        if (result.endsWith(REQUEST_COMPLETE_TOKEN)) {
+            // Chop the end token
+            result.chop(REQUEST_COMPLETE_TOKEN_LENGTH);
+        }
+        else {
+            // Incomplete reply, socket errors are reported via handleError()
+            if (m_Socket->state() == QLocalSocket::ConnectedState) {
+                emitError(ServiceFwIPC::ETimedOut);
             }
-        } while (done == false);
+            result.clear();
+        }
     }
     // If async, return the internal databuffer
     else if( m_BufferType == EAsyncBuffer ){
@@ -220,7 +422,14 @@ QByteArray ServiceLocalSocketIPC::readAll()
  */
 bool ServiceLocalSocketIPC::waitForRead()
 {
-    return m_Socket->waitForReadyRead();
+    if (m_ProtocolVersion == KIPCBinaryProtocol) {
+        // Replies may already have been buffered while reading another one
+        if (m_FrameReader.hasPendingData() || !m_Replies.isEmpty()) {
+            return true;
+        }
+        return readFrames(SYNC_READ_TIMEOUT);
+    }
+    return m_Socket->waitForReadyRead(SYNC_READ_TIMEOUT);
 }
 
 /*!
@@ -238,9 +447,23 @@ void ServiceLocalSocketIPC::handleError(QLocalSocket::LocalSocketError aSocketEr
  */
 void ServiceLocalSocketIPC::handleReadyRead()
 {
+    if (m_ProtocolVersion == KIPCBinaryProtocol) {
+        readFrames(0);
+        // One read can carry several frames, deliver all of them as long
+        // as the client is still waiting for asynchronous data
+        ServiceIPCFrame frame;
+        while (m_BufferType == EAsyncBuffer && m_FrameReader.next(frame)) {
+            if (m_AbandonedRequests.remove(frame.m_RequestId)) {
+                continue;
+            }
+            m_AsyncData = frame.m_Fields.value(0);
+            emitReadyRead();
+        }
+        return;
+    }
+
     m_AsyncData.append(m_Socket->readAll());
-    if (m_AsyncData.right(REQUEST_COMPLETE_TOKEN_LENGTH)
-                    == REQUEST_COMPLETE_TOKEN) {
+    if (m_AsyncData.endsWith(REQUEST_COMPLETE_TOKEN)) {
         // Chop the end token
         m_AsyncData.chop(REQUEST_COMPLETE_TOKEN_LENGTH);
 
@@ -21,6 +21,7 @@
 #include <QtCore>
 #include <QtNetwork>
 #include "serviceipc_p.h"
+#include "serviceipcframe.h"
 
 namespace WRT {
 
@@ -47,6 +48,10 @@ namespace WRT {
         QByteArray readAll();
     
         bool waitForRead();
+
+        int sendPipelined(const QString& aRequestType, const QByteArray& aData);
+
+        QByteArray readReply(int aRequestId);
     
     private slots:
     
@@ -54,20 +59,49 @@ namespace WRT {
     
         void handleReadyRead();
     
+    protected:
+        /**
+         * Write a serialised request to the server
+         * @param aData request to write
+         * @return number of bytes written, -1 on error
+         */
+        virtual qint64 writeRequest(const QByteArray& aData);
+
+        /**
+         * Move received binary data into the frame reader
+         * @param aTimeout how long to wait if nothing has been received, in milliseconds
+         * @return true if data was added
+         */
+        virtual bool readFrames(int aTimeout);
+
     private:
         int doMapErrors( int aError );
+
+        bool negotiateProtocol(const QString& aServerName);
+
+        QByteArray encodeRequest(const QString& aRequestType, const QByteArray& aData);
+
+        QByteArray waitForReply(quint32 aRequestId);
     
-    private:
+    protected:
         enum TBufferType {
             ENoBuffer,
             ESyncBuffer,
             EAsyncBuffer
         };
     // Member Variables
-    private:
+    protected:
         QLocalSocket* m_Socket;
         QByteArray m_AsyncData;
         TBufferType m_BufferType;
+        int m_ProtocolVersion;
+        quint32 m_NextRequestId;
+        quint32 m_SyncRequestId;
+        ServiceIPCFrameReader m_FrameReader;
+        // Replies received ahead of the one being waited for
+        QHash<quint32, QByteArray> m_Replies;
+        // Requests that timed out, their late replies are dropped
+        QSet<quint32> m_AbandonedRequests;
     };
 
 }
@@ -117,6 +117,33 @@ void ServiceFwIPC::sendAsync(const QString& aRequestType,
     m_AsyncRequestPending = true;
 }
 
+/*!
+ Send a synchronous request without waiting for its reply.\n
+ Several requests may be in flight at once; read each reply with
+ readReply(). Backends that cannot pipeline complete the request here.
+ @param aRequestType name of the request
+ @param aData data to send
+ @return id of the request, -1 if it could not be sent
+ */
+int ServiceFwIPC::sendPipelined(const QString& aRequestType,
+                                const QByteArray& aData)
+{
+#ifdef _DEBUG
+    Q_ASSERT_X( aRequestType.contains(";") == false, "", "aRequestType cannot contain semicolons!" );
+#endif // _DEBUG
+    return d->sendPipelined(aRequestType, aData);
+}
+
+/*!
+ Wait for and read the reply of a request sent with sendPipelined()
+ @param aRequestId id returned by sendPipelined()
+ @return QByteArray of results, empty on error
+ */
+QByteArray ServiceFwIPC::readReply(int aRequestId)
+{
+    return d->readReply(aRequestId);
+}
+
 /*!
  Reads all data pending in the buffer.\n
  For Sync version this will wait until all of the data is available.\n
@@ -176,6 +203,28 @@ bool ServiceFwIPC::setSessionId(int aSessionId)
     return ret;
 }
 
+/*!
+ Default pipelining: complete the request synchronously and keep its reply
+ */
+int ServiceFwIPCPrivate::sendPipelined(const QString& aRequestType,
+                                       const QByteArray& aData)
+{
+    int id(-1);
+    if (sendSync(aRequestType, aData) && waitForRead()) {
+        id = ++m_LastPipelinedId;
+        m_PipelinedReplies.insert(id, readAll());
+    }
+    return id;
+}
+
+/*!
+ Default pipelining: return the reply kept by sendPipelined()
+ */
+QByteArray ServiceFwIPCPrivate::readReply(int aRequestId)
+{
+    return m_PipelinedReplies.take(aRequestId);
+}
+
 } // end of namespace
 
 /*!
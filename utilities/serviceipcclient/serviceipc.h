@@ -40,7 +40,8 @@ namespace WRT {
             EConnectionClosed,                      /*!< IPC Connection is closed */
             EServerNotFound,                        /*!< Can not find server */
             EIPCError,                              /*!< Known IPC error defined by SDK */
-            EUnknownError                           /*!< Unknown IPC error */
+            EUnknownError,                          /*!< Unknown IPC error */
+            ETimedOut                               /*!< No reply from the server in time */
             };
 
     public:
@@ -58,6 +59,10 @@ namespace WRT {
         bool sendSync(const QString& aRequestType, const QByteArray& aData);
     
         void sendAsync(const QString& aRequestType, const QByteArray& aData);
+
+        int sendPipelined(const QString& aRequestType, const QByteArray& aData);
+
+        QByteArray readReply(int aRequestId);
     
         QByteArray readAll();
     
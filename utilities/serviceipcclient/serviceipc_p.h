@@ -31,6 +31,8 @@ namespace WRT {
     class ServiceFwIPCPrivate
     {
     public:
+        ServiceFwIPCPrivate() : m_LastPipelinedId(0) {};
+
         /**
          * Virtual destructor
          */
@@ -84,6 +86,21 @@ namespace WRT {
          */
         virtual bool waitForRead() = 0;
 
+        /**
+         * Send a synchronous request without waiting for the reply.
+         * The default implementation completes the request before returning,
+         * backends that can match replies to requests override this.
+         * @note: refer to public API ServiceFwIPC
+         */
+        virtual int sendPipelined(const QString& aRequestType,
+                                  const QByteArray& aData);
+
+        /**
+         * Read the reply of a pipelined request
+         * @note: refer to public API ServiceFwIPC
+         */
+        virtual QByteArray readReply(int aRequestId);
+
         /**
          * Retrieves the session id synchronously
          * @note: refer to public API ServiceFwIPC
@@ -118,6 +135,9 @@ namespace WRT {
     private:
         friend class ServiceFwIPC;
         ServiceFwIPC* q;  // not owned
+        // Replies of completed pipelined requests not read yet
+        QHash<int, QByteArray> m_PipelinedReplies;
+        int m_LastPipelinedId;
     };
 
 }
@@ -144,6 +144,28 @@ void ServiceIPCClient::sendAsync(const QString& aRequestType,
     m_asyncIPC->sendAsync(aRequestType, aData);
 }
 
+/*!
+ Send a synchronous request without waiting for its reply
+ @param aRequestType name of the request
+ @param aData data to send
+ @return id of the request to pass to readReply(), -1 on error
+ */
+int ServiceIPCClient::sendPipelined(const QString& aRequestType,
+                                    const QByteArray& aData)
+{
+    return m_syncIPC->sendPipelined(aRequestType, aData);
+}
+
+/*!
+ Wait for and read the reply of a pipelined request
+ @param aRequestId id returned by sendPipelined()
+ @return QByteArray of results
+ */
+QByteArray ServiceIPCClient::readReply(int aRequestId)
+{
+    return m_syncIPC->readReply(aRequestId);
+}
+
 /*!
  Reads all data pending in the buffer.\n
  For Sync version this will wait until all of the data is available.\n
@@ -43,6 +43,10 @@ namespace WRT {
         bool sendSync(const QString& aRequestType, const QByteArray& aData);
     
         void sendAsync(const QString& aRequestType, const QByteArray& aData);
+
+        int sendPipelined(const QString& aRequestType, const QByteArray& aData);
+
+        QByteArray readReply(int aRequestId);
     
         QByteArray readAll();
     
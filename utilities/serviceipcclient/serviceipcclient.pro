@@ -27,11 +27,10 @@ HEADERS += serviceipcdefs.h \
            serviceipc_p.h \
            serviceipc.h \ 
            serviceipcfactory.h \
-           serviceipcsharedmem_p.h \
+           serviceipcframe.h \
            serviceipcclient.h
 SOURCES += serviceipc.cpp \ 
            serviceipcfactory.cpp \
-           serviceipcsharedmem.cpp \
            serviceipcclient.cpp
 
 DEFINES += QT_MAKE_IPC_DLL
@@ -70,6 +69,21 @@ else {
     HEADERS += ./platform/qt/serviceipclocalsocket_p.h
     SOURCES += ./platform/qt/serviceipclocalsocket.cpp
     INCLUDEPATH += $$PWD/platform/qt
+
+    # Shared memory transport, POSIX shm and futex based
+    linux-* {
+        HEADERS += serviceipcsharedmem_p.h \
+                   serviceipcsharedring_p.h
+        SOURCES += serviceipcsharedmem.cpp \
+                   serviceipcsharedring.cpp
+        LIBS += -lrt
+    }
+
+    # Ipc category of the browser's tracer, qmake DEFINES+=ENABLE_PERF_TRACE
+    contains(DEFINES, ENABLE_PERF_TRACE) {
+        LIBS += -lbrperftrace
+        INCLUDEPATH += $$ROOT_DIR/internal/tests/perfTracing
+    }
     
     # Export headers on non-symbian systems
 ###    EXPORT_DIR = $$CWRT_INCLUDE
@@ -33,5 +33,7 @@ namespace WRT {
     #define GETSESSIONID   "GetSessionId"
     #define SETSESSIONINFO   "SetSessionInfo"
     #define SUBSCRIBEBROADCASTMSG "SubscribeBroadcastMsg"
+    #define NEGOTIATEPROTOCOL "NegotiateProtocol"
+    #define SETUPSHAREDMEM "SetupSharedMem"
 }
 #endif // serviceipcdefs_h
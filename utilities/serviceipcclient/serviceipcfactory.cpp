@@ -20,7 +20,9 @@
 #ifndef __SYMBIAN32__
 #include "serviceipclocalsocket_p.h"
 #endif // Q_OS_WIN32
+#ifdef Q_OS_LINUX
 #include "serviceipcsharedmem_p.h"
+#endif // Q_OS_LINUX
 
 #ifdef __SYMBIAN32__
 #include "serviceipcsymbian_p.h"
@@ -65,6 +67,10 @@ bool ServiceFwIPCFactory::isIPCTypeSupported(TServiceIPCBackends aIPCType)
     if (aIPCType == ESymbianServer) {
         supported = true;
     }
+#elif defined(Q_OS_LINUX)
+    if (aIPCType == ELocalSocket || aIPCType == ESharedMemory) {
+        supported = true;
+    }
 #else
     //avoid compile warning
     aIPCType = EDefaultIPC;
@@ -89,6 +95,13 @@ ServiceFwIPCPrivate* ServiceFwIPCFactory::createBackend(TServiceIPCBackends aBac
     {
         backend = new ServiceLocalSocketIPC();
     }
+#ifdef Q_OS_LINUX
+    // Shared memory rings for bulk payloads, set up over a local socket
+    else if( aBackend == ESharedMemory )
+    {
+        backend = new ServiceSharedMemIPC();
+    }
+#endif // Q_OS_LINUX
 #else
     // Symbian server is default
     if (aBackend == ESymbianServer || aBackend == EDefaultIPC) {
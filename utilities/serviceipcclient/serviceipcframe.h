@@ -0,0 +1,180 @@
+/**
+   This file is part of CWRT package **
+
+   Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies). **
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU (Lesser) General Public License as
+   published by the Free Software Foundation, version 2.1 of the License.
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   (Lesser) General Public License for more details. You should have
+   received a copy of the GNU (Lesser) General Public License along
+   with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef serviceipcframe_h
+#define serviceipcframe_h
+
+#include <QtCore>
+#include <QtEndian>
+
+namespace WRT {
+
+    // Protocol versions, negotiated with NEGOTIATEPROTOCOL at connect time
+    const int KIPCTextProtocol = 0;
+    const int KIPCBinaryProtocol = 1;
+
+    /**
+     * One frame of the binary IPC protocol.
+     *
+     * Layout, all integers are big endian:
+     *   quint32 payload length
+     *   quint16 opcode (TFrameOpcode)
+     *   quint16 protocol version
+     *   quint32 request id, a reply carries the id of its request
+     *   payload, a list of fields each a quint32 length followed by the data
+     *
+     * A request carries two fields, the request type and the request data.
+     * A reply carries one field, the data written by the server.
+     */
+    class ServiceIPCFrame
+    {
+    public:
+        enum TFrameOpcode
+            {
+            ERequest = 1,
+            EReply
+            };
+
+        enum { KHeaderLength = 12, KFieldHeaderLength = 4 };
+
+        ServiceIPCFrame() : m_Opcode(0), m_RequestId(0) {}
+
+        /**
+         * Serialise a frame
+         * @param aOpcode frame opcode
+         * @param aRequestId id of the request this frame belongs to
+         * @param aFields payload fields
+         * @return the encoded frame
+         */
+        static QByteArray encode(quint16 aOpcode, quint32 aRequestId,
+                                 const QList<QByteArray>& aFields)
+        {
+            int payloadLength(0);
+            for (int i = 0; i < aFields.count(); ++i) {
+                payloadLength += KFieldHeaderLength + aFields[i].length();
+            }
+
+            QByteArray frame;
+            frame.resize(KHeaderLength + payloadLength);
+            uchar* p = reinterpret_cast<uchar*>(frame.data());
+            qToBigEndian<quint32>(payloadLength, p);
+            qToBigEndian<quint16>(aOpcode, p + 4);
+            qToBigEndian<quint16>(KIPCBinaryProtocol, p + 6);
+            qToBigEndian<quint32>(aRequestId, p + 8);
+            p += KHeaderLength;
+            for (int i = 0; i < aFields.count(); ++i) {
+                const QByteArray& field = aFields[i];
+                qToBigEndian<quint32>(field.length(), p);
+                p += KFieldHeaderLength;
+                memcpy(p, field.constData(), field.length());
+                p += field.length();
+            }
+            return frame;
+        }
+
+    public:
+        quint16 m_Opcode;
+        quint32 m_RequestId;
+        QList<QByteArray> m_Fields;
+    };
+
+    /**
+     * Incremental parser for binary frames.
+     * Bytes are appended as they arrive from the transport, complete frames
+     * are taken out with next() without re-scanning already parsed data.
+     */
+    class ServiceIPCFrameReader
+    {
+    public:
+        ServiceIPCFrameReader() : m_Offset(0) {}
+
+        inline void append(const QByteArray& aData)
+        {
+            // Drop consumed bytes before growing the buffer
+            if (m_Offset > 0 && m_Offset == m_Buffer.length()) {
+                m_Buffer.clear();
+                m_Offset = 0;
+            }
+            m_Buffer.append(aData);
+        }
+
+        inline bool hasPendingData() const
+        {
+            return m_Offset < m_Buffer.length();
+        }
+
+        inline void clear()
+        {
+            m_Buffer.clear();
+            m_Offset = 0;
+        }
+
+        /**
+         * Take the next complete frame out of the buffer
+         * @param aFrame receives the frame
+         * @return true if a complete frame was available
+         */
+        bool next(ServiceIPCFrame& aFrame)
+        {
+            int available = m_Buffer.length() - m_Offset;
+            if (available < ServiceIPCFrame::KHeaderLength) {
+                return false;
+            }
+            const uchar* p = reinterpret_cast<const uchar*>(m_Buffer.constData()) + m_Offset;
+            quint32 payloadLength = qFromBigEndian<quint32>(p);
+            if (available - ServiceIPCFrame::KHeaderLength < (qint64) payloadLength) {
+                return false;
+            }
+
+            aFrame.m_Opcode = qFromBigEndian<quint16>(p + 4);
+            aFrame.m_RequestId = qFromBigEndian<quint32>(p + 8);
+            aFrame.m_Fields.clear();
+
+            int pos = m_Offset + ServiceIPCFrame::KHeaderLength;
+            int end = pos + payloadLength;
+            while (pos + ServiceIPCFrame::KFieldHeaderLength <= end) {
+                quint32 fieldLength = qFromBigEndian<quint32>(
+                    reinterpret_cast<const uchar*>(m_Buffer.constData()) + pos);
+                pos += ServiceIPCFrame::KFieldHeaderLength;
+                if ((qint64) fieldLength > end - pos) {
+                    // Malformed field, discard the rest of the frame
+                    break;
+                }
+                aFrame.m_Fields.append(m_Buffer.mid(pos, fieldLength));
+                pos += fieldLength;
+            }
+            m_Offset = end;
+
+            // Compact once the consumed prefix dominates the buffer
+            if (m_Offset == m_Buffer.length()) {
+                m_Buffer.clear();
+                m_Offset = 0;
+            }
+            else if (m_Offset > m_Buffer.length() / 2) {
+                m_Buffer.remove(0, m_Offset);
+                m_Offset = 0;
+            }
+            return true;
+        }
+
+    private:
+        QByteArray m_Buffer;
+        int m_Offset;
+    };
+
+}
+#endif // serviceipcframe_h
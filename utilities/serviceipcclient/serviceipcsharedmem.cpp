@@ -17,21 +17,35 @@
 
 #include <QByteArray>
 #include "serviceipcsharedmem_p.h"
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
 
 namespace WRT
 {
+// CONSTANTS
+// How long a blocked read or write waits for the peer, in milliseconds
+const int SHAREDMEM_TIMEOUT = 30000;
+// Interval in which a blocked read checks that the server is still there
+const int SHAREDMEM_POLL_SLICE = 100;
 
 /*!
  \class ServiceSharedMemIPC
 
- Shared memory backend for the service IPC
- @note: THIS CLASS IS NOT FINISHED
+ Shared memory backend for the service IPC.\n
+ The connection is set up like a local socket connection, then each
+ direction gets a ring buffer in POSIX shared memory that carries the
+ binary frames. The socket is only used to wake a peer that waits in its
+ event loop; a peer blocked in a synchronous read is woken with a futex.
+ If the server does not support shared memory the local socket transport
+ is used unchanged.
  */
 
 /*!
  Constructor
  */
 ServiceSharedMemIPC::ServiceSharedMemIPC()
+    : m_SharedMemActive(false)
 {
 }
 
@@ -43,11 +57,18 @@ ServiceSharedMemIPC::~ServiceSharedMemIPC()
 }
 
 /*!
- Connect to the server
+ Connect to the server and set up the shared memory rings
+ @param aServerName name of the server to connect to
+ @return true if connected, false otherwise
  */
-bool ServiceSharedMemIPC::connect(const QString& /*aServerName*/)
+bool ServiceSharedMemIPC::connect(const QString& aServerName)
 {
-    return false;
+    m_SharedMemActive = false;
+    bool rtn = ServiceLocalSocketIPC::connect(aServerName);
+    if (rtn && m_ProtocolVersion == KIPCBinaryProtocol) {
+        m_SharedMemActive = setupSharedMemory();
+    }
+    return rtn;
 }
 
 /*!
@@ -55,48 +76,162 @@ bool ServiceSharedMemIPC::connect(const QString& /*aServerName*/)
  */
 void ServiceSharedMemIPC::disconnect()
 {
+    ServiceLocalSocketIPC::disconnect();
+    m_SharedMemActive = false;
+    m_RequestRing.close();
+    m_ReplyRing.close();
 }
 
 /*!
- Start the server
+ Create the rings and ask the server to attach to them
+ @return true if the server is attached
  */
-bool ServiceSharedMemIPC::startServer(const QString& /*aServerName*/,
-                                      const QString& /*aExeName*/)
+bool ServiceSharedMemIPC::setupSharedMemory()
 {
-    return false;
+    static QAtomicInt connectionCount;
+    QString name = QString("/wrtipc_%1_%2").arg(QCoreApplication::applicationPid())
+                                           .arg(connectionCount.fetchAndAddRelaxed(1));
+
+    bool attached(false);
+    if (m_RequestRing.create(name + KIPCSharedRingRequestSuffix, KIPCSharedRingCapacity)
+        && m_ReplyRing.create(name + KIPCSharedRingReplySuffix, KIPCSharedRingCapacity)
+        && sendSync(SETUPSHAREDMEM, name.toAscii()) && waitForRead()) {
+        attached = (readAll() == "1");
+    }
+
+    // Both sides hold a mapping now, the names are not needed any more
+    m_RequestRing.unlink();
+    m_ReplyRing.unlink();
+    if (!attached) {
+        m_RequestRing.close();
+        m_ReplyRing.close();
+    }
+    return attached;
 }
 
 /*!
- Send data synchronously
+ Write a serialised request into the request ring
+ @param aData request to write
+ @return number of bytes written, -1 on error
  */
-bool ServiceSharedMemIPC::sendSync(const QString& /*aRequestType*/,
-                                   const QByteArray& /*aData*/)
+qint64 ServiceSharedMemIPC::writeRequest(const QByteArray& aData)
 {
-    return false;
+    if (!m_SharedMemActive) {
+        return ServiceLocalSocketIPC::writeRequest(aData);
+    }
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Ipc, "ServiceSharedMemIPC::writeRequest");
+    PERF_TRACE_COUNTER(Ipc, "ipc request bytes", aData.length());
+#endif
+
+    const char* data = aData.constData();
+    int remaining = aData.length();
+    while (remaining > 0) {
+        int written = m_RequestRing.write(data, remaining);
+        if (written < 0) {
+            ringCorrupted();
+            return -1;
+        }
+        data += written;
+        remaining -= written;
+        if (written > 0) {
+            ringDoorbell();
+        }
+        // Larger requests are streamed while the server drains the ring
+        if (remaining > 0 && !m_RequestRing.waitForSpace(SHAREDMEM_TIMEOUT)) {
+            return -1;
+        }
+    }
+    return aData.length();
 }
 
 /*!
- Send data asynchronously
+ Move data from the reply ring into the frame reader
+ @param aTimeout how long to wait if nothing has been received, in milliseconds
+ @return true if data was added
  */
-void ServiceSharedMemIPC::sendAsync(const QString& /*aRequestType*/,
-                                    const QByteArray& /*aData*/)
+bool ServiceSharedMemIPC::readFrames(int aTimeout)
 {
+    if (!m_SharedMemActive) {
+        return ServiceLocalSocketIPC::readFrames(aTimeout);
+    }
+
+    // Doorbells only wake the event loop, the data is in the ring
+    m_Socket->readAll();
+
+    QByteArray data;
+    int count = m_ReplyRing.read(data);
+    if (count == 0) {
+        if (aTimeout == 0 || !waitForReplyData(aTimeout)) {
+            return false;
+        }
+        count = m_ReplyRing.read(data);
+    }
+    if (count < 0) {
+        ringCorrupted();
+        return false;
+    }
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_COUNTER(Ipc, "ipc reply bytes", count);
+#endif
+    // The server does not block on a full ring, it waits for a doorbell
+    if (!m_ReplyRing.wakeWriter()) {
+        m_Socket->write(&KIPCSharedRingDoorbell, 1);
+        m_Socket->flush();
+    }
+    m_FrameReader.append(data);
+    return true;
 }
 
 /*!
- Read all data from the buffer
+ Block on the reply ring, checking in between that the server is alive
+ @param aTimeout timeout in milliseconds, -1 to wait forever
+ @return true if reply data is available
  */
-QByteArray ServiceSharedMemIPC::readAll()
+bool ServiceSharedMemIPC::waitForReplyData(int aTimeout)
 {
-    return QByteArray();
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Ipc, "ServiceSharedMemIPC::waitForReplyData");
+#endif
+    QTime timer;
+    timer.start();
+    forever {
+        int slice = SHAREDMEM_POLL_SLICE;
+        if (aTimeout >= 0) {
+            slice = qMin(slice, aTimeout - timer.elapsed());
+            if (slice <= 0) {
+                return false;
+            }
+        }
+        if (m_ReplyRing.waitForData(slice)) {
+            return true;
+        }
+        // Lets the socket notice a server that went away
+        m_Socket->waitForReadyRead(0);
+        if (m_Socket->state() != QLocalSocket::ConnectedState) {
+            return false;
+        }
+    }
 }
 
 /*!
- Wait for data to be available in the buffer
+ Drop the connection after the server broke the ring protocol
  */
-bool ServiceSharedMemIPC::waitForRead()
+void ServiceSharedMemIPC::ringCorrupted()
 {
-    return false;
+    emitError(ServiceFwIPC::EIPCError);
+    disconnect();
+}
+
+/*!
+ Wake the server after writing to the request ring
+ */
+void ServiceSharedMemIPC::ringDoorbell()
+{
+    if (!m_RequestRing.wakeReader()) {
+        m_Socket->write(&KIPCSharedRingDoorbell, 1);
+        m_Socket->flush();
+    }
 }
 }
 // END OF FILE
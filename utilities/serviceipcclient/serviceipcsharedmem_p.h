@@ -19,11 +19,12 @@
 #define serviceipcsharedmem_p_h
 
 #include <QtCore>
-#include "serviceipc_p.h"
+#include "serviceipclocalsocket_p.h"
+#include "serviceipcsharedring_p.h"
 
 namespace WRT {
 
-    class ServiceSharedMemIPC : public ServiceFwIPCPrivate
+    class ServiceSharedMemIPC : public ServiceLocalSocketIPC
     {
     public:
         ServiceSharedMemIPC();
@@ -35,16 +36,27 @@ namespace WRT {
         bool connect(const QString& aServerName);
     
         void disconnect();
-    
-        bool startServer(const QString& aServerName, const QString& aExeName);
-    
-        bool sendSync(const QString& aRequestType, const QByteArray& aData);
-    
-        void sendAsync(const QString& aRequestType, const QByteArray& aData);
-    
-        QByteArray readAll();
-    
-        bool waitForRead();
+
+    protected:
+
+        qint64 writeRequest(const QByteArray& aData);
+
+        bool readFrames(int aTimeout);
+
+    private:
+
+        bool setupSharedMemory();
+
+        bool waitForReplyData(int aTimeout);
+
+        void ringDoorbell();
+
+        void ringCorrupted();
+
+    private:
+        ServiceIPCSharedRing m_RequestRing;
+        ServiceIPCSharedRing m_ReplyRing;
+        bool m_SharedMemActive;
     };
 
 }
@@ -0,0 +1,366 @@
+/**
+   This file is part of CWRT package **
+
+   Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies). **
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU (Lesser) General Public License as
+   published by the Free Software Foundation, version 2.1 of the License.
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   (Lesser) General Public License for more details. You should have
+   received a copy of the GNU (Lesser) General Public License along
+   with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "serviceipcsharedring_p.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
+
+namespace WRT
+{
+// CONSTANTS
+const quint32 KRingMagic = 0x57524952; // "WRIR"
+
+/*!
+ Layout of the shared segment header.\n
+ head and tail count bytes written and read and wrap around; the
+ capacity is a power of two so they index the ring with a mask.
+ The segment is writable by the peer, so nothing read from it is trusted:
+ the capacity is kept locally and head - tail is checked against it.
+ */
+struct ServiceIPCSharedRing::RingHeader
+{
+    quint32 magic;
+    quint32 capacity;
+    volatile quint32 head;
+    volatile quint32 tail;
+    volatile int dataSeq;       // futex word, bumped when data is written
+    volatile int spaceSeq;      // futex word, bumped when data is read
+    volatile int dataWaiters;
+    volatile int spaceWaiters;
+    volatile int spaceWanted;   // writer asked for a socket notification
+};
+
+static void futexWait(volatile int* aWord, int aExpected, int aTimeout)
+{
+    struct timespec timeout;
+    timeout.tv_sec = aTimeout / 1000;
+    timeout.tv_nsec = (aTimeout % 1000) * 1000000;
+    syscall(SYS_futex, aWord, FUTEX_WAIT, aExpected,
+            aTimeout < 0 ? NULL : &timeout, NULL, 0);
+}
+
+static void futexWake(volatile int* aWord)
+{
+    syscall(SYS_futex, aWord, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/*!
+ \class ServiceIPCSharedRing
+ Byte ring buffer shared between a client and a server process
+ */
+
+/*!
+ Constructor
+ */
+ServiceIPCSharedRing::ServiceIPCSharedRing()
+    : m_Header(NULL)
+    , m_Data(NULL)
+    , m_MappedSize(0)
+    , m_Capacity(0)
+    , m_Owner(false)
+{
+}
+
+/*!
+ Destructor
+ */
+ServiceIPCSharedRing::~ServiceIPCSharedRing()
+{
+    close();
+}
+
+/*!
+ Create a new shared ring
+ @param aName name of the shared memory object, unique per connection
+ @param aCapacity capacity in bytes, must be a power of two
+ @return true if created
+ */
+bool ServiceIPCSharedRing::create(const QString& aName, int aCapacity)
+{
+    close();
+    if (aCapacity <= 0 || (aCapacity & (aCapacity - 1)) != 0) {
+        return false;
+    }
+
+    m_Name = QFile::encodeName(aName);
+    int fd = shm_open(m_Name.constData(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        return false;
+    }
+    int size = sizeof(RingHeader) + aCapacity;
+    bool mapped = (ftruncate(fd, size) == 0) && map(fd, size);
+    ::close(fd);
+    if (!mapped) {
+        shm_unlink(m_Name.constData());
+        return false;
+    }
+
+    m_Owner = true;
+    m_Capacity = aCapacity;
+    memset(m_Header, 0, sizeof(RingHeader));
+    m_Header->capacity = aCapacity;
+    m_Header->magic = KRingMagic;
+    return true;
+}
+
+/*!
+ Attach to a ring created by the peer
+ @param aName name of the shared memory object
+ @return true if attached
+ */
+bool ServiceIPCSharedRing::attach(const QString& aName)
+{
+    close();
+    m_Name = QFile::encodeName(aName);
+    int fd = shm_open(m_Name.constData(), O_RDWR, 0);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat info;
+    bool mapped = (fstat(fd, &info) == 0)
+                  && info.st_size > (off_t) sizeof(RingHeader)
+                  && map(fd, info.st_size);
+    ::close(fd);
+    if (mapped) {
+        quint32 capacity = m_Header->capacity;
+        if (m_Header->magic != KRingMagic || capacity == 0
+            || (capacity & (capacity - 1)) != 0
+            || sizeof(RingHeader) + capacity != (quint32) m_MappedSize) {
+            close();
+            return false;
+        }
+        m_Capacity = capacity;
+    }
+    return mapped;
+}
+
+/*!
+ Remove the name of the ring; existing mappings stay valid.
+ Done by the creator once the peer has attached.
+ */
+void ServiceIPCSharedRing::unlink()
+{
+    if (m_Owner && !m_Name.isEmpty()) {
+        shm_unlink(m_Name.constData());
+        m_Owner = false;
+    }
+}
+
+/*!
+ Unmap the ring
+ */
+void ServiceIPCSharedRing::close()
+{
+    unlink();
+    if (m_Header) {
+        munmap(m_Header, m_MappedSize);
+        m_Header = NULL;
+        m_Data = NULL;
+        m_MappedSize = 0;
+        m_Capacity = 0;
+    }
+    m_Name.clear();
+}
+
+bool ServiceIPCSharedRing::map(int aFd, int aSize)
+{
+    void* addr = mmap(NULL, aSize, PROT_READ | PROT_WRITE, MAP_SHARED, aFd, 0);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    m_Header = static_cast<RingHeader*>(addr);
+    m_Data = static_cast<char*>(addr) + sizeof(RingHeader);
+    m_MappedSize = aSize;
+    return true;
+}
+
+/*!
+ Write as much of the data as fits, does not block
+ @param aData data to write
+ @param aLength length of the data
+ @return number of bytes written, -1 if the peer corrupted the ring
+ */
+int ServiceIPCSharedRing::write(const char* aData, int aLength)
+{
+    quint32 capacity = m_Capacity;
+    quint32 head = m_Header->head;
+    quint32 tail = __sync_fetch_and_add(&m_Header->tail, 0);
+    if (head - tail > capacity) {
+        return -1;
+    }
+    quint32 count = qMin<quint32>(capacity - (head - tail), aLength);
+    if (count == 0) {
+        return 0;
+    }
+
+    quint32 offset = head & (capacity - 1);
+    quint32 first = qMin(count, capacity - offset);
+    memcpy(m_Data + offset, aData, first);
+    memcpy(m_Data, aData + first, count - first);
+
+    // Publish the data before moving the head
+    __sync_synchronize();
+    m_Header->head = head + count;
+    __sync_fetch_and_add(&m_Header->dataSeq, 1);
+    return count;
+}
+
+/*!
+ Append all available data to a buffer, does not block
+ @param aBuffer buffer to append to
+ @return number of bytes read, -1 if the peer corrupted the ring
+ */
+int ServiceIPCSharedRing::read(QByteArray& aBuffer)
+{
+    quint32 capacity = m_Capacity;
+    quint32 tail = m_Header->tail;
+    quint32 head = __sync_fetch_and_add(&m_Header->head, 0);
+    quint32 count = head - tail;
+    if (count > capacity) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    quint32 offset = tail & (capacity - 1);
+    quint32 first = qMin(count, capacity - offset);
+    aBuffer.append(m_Data + offset, first);
+    aBuffer.append(m_Data, count - first);
+
+    // Finish copying before handing the space back
+    __sync_synchronize();
+    m_Header->tail = tail + count;
+    __sync_fetch_and_add(&m_Header->spaceSeq, 1);
+    return count;
+}
+
+/*!
+ Number of bytes that can be read
+ @return the byte count, -1 if the peer corrupted the ring
+ */
+int ServiceIPCSharedRing::bytesAvailable() const
+{
+    quint32 count = __sync_fetch_and_add(&m_Header->head, 0) - m_Header->tail;
+    return (count > m_Capacity) ? -1 : (int) count;
+}
+
+/*!
+ Number of bytes that can be written
+ @return the byte count, -1 if the peer corrupted the ring
+ */
+int ServiceIPCSharedRing::freeSpace() const
+{
+    int count = bytesAvailable();
+    return (count < 0) ? -1 : (int) m_Capacity - count;
+}
+
+/*!
+ Block until data can be read
+ @param aTimeout timeout in milliseconds, -1 to wait forever
+ @return true if data is available
+ */
+bool ServiceIPCSharedRing::waitForData(int aTimeout)
+{
+    int seq = __sync_fetch_and_add(&m_Header->dataSeq, 0);
+    if (bytesAvailable() != 0) {
+        return true;
+    }
+    __sync_fetch_and_add(&m_Header->dataWaiters, 1);
+    if (bytesAvailable() == 0) {
+#ifdef ENABLE_PERF_TRACE
+        PERF_TRACE_SCOPE(Ipc, "ServiceIPCSharedRing::waitForData");
+#endif
+        futexWait(&m_Header->dataSeq, seq, aTimeout);
+    }
+    __sync_fetch_and_sub(&m_Header->dataWaiters, 1);
+    // A corrupted ring reports data, read() then fails
+    return bytesAvailable() != 0;
+}
+
+/*!
+ Block until data can be written
+ @param aTimeout timeout in milliseconds, -1 to wait forever
+ @return true if there is free space
+ */
+bool ServiceIPCSharedRing::waitForSpace(int aTimeout)
+{
+    int seq = __sync_fetch_and_add(&m_Header->spaceSeq, 0);
+    int space = freeSpace();
+    if (space != 0) {
+        return space > 0;
+    }
+    __sync_fetch_and_add(&m_Header->spaceWaiters, 1);
+    if (freeSpace() == 0) {
+#ifdef ENABLE_PERF_TRACE
+        PERF_TRACE_SCOPE(Ipc, "ServiceIPCSharedRing::waitForSpace");
+#endif
+        futexWait(&m_Header->spaceSeq, seq, aTimeout);
+    }
+    __sync_fetch_and_sub(&m_Header->spaceWaiters, 1);
+    return freeSpace() > 0;
+}
+
+/*!
+ Wake a reader blocked in waitForData()
+ @return true if a reader was waiting, false if the peer has to be
+ notified some other way
+ */
+bool ServiceIPCSharedRing::wakeReader()
+{
+    if (__sync_fetch_and_add(&m_Header->dataWaiters, 0) > 0) {
+        futexWake(&m_Header->dataSeq);
+        return true;
+    }
+    return false;
+}
+
+/*!
+ Ask the reader to notify this side through the socket when it frees
+ space, for a writer that must not block in waitForSpace().\n
+ Check freeSpace() again afterwards, the reader may have drained the
+ ring before it saw the request.
+ */
+void ServiceIPCSharedRing::requestSpaceNotification()
+{
+    __sync_lock_test_and_set(&m_Header->spaceWanted, 1);
+}
+
+/*!
+ Wake a writer blocked in waitForSpace()
+ @return true if the writer was woken or is not waiting, false if it
+ asked with requestSpaceNotification() to be notified some other way
+ */
+bool ServiceIPCSharedRing::wakeWriter()
+{
+    if (__sync_fetch_and_add(&m_Header->spaceWaiters, 0) > 0) {
+        futexWake(&m_Header->spaceSeq);
+    }
+    return __sync_lock_test_and_set(&m_Header->spaceWanted, 0) == 0;
+}
+
+}
+// END OF FILE
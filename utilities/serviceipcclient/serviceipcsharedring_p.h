@@ -0,0 +1,92 @@
+/**
+   This file is part of CWRT package **
+
+   Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies). **
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU (Lesser) General Public License as
+   published by the Free Software Foundation, version 2.1 of the License.
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   (Lesser) General Public License for more details. You should have
+   received a copy of the GNU (Lesser) General Public License along
+   with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef serviceipcsharedring_p_h
+#define serviceipcsharedring_p_h
+
+#include <QtCore>
+
+namespace WRT {
+
+    // Capacity of each direction of a shared memory connection, power of two
+    const int KIPCSharedRingCapacity = 256 * 1024;
+
+    // Suffixes appended to the connection's segment name for each direction
+    static const char KIPCSharedRingRequestSuffix[] = "_req";
+    static const char KIPCSharedRingReplySuffix[] = "_rep";
+
+    // Written to the socket to wake a peer that waits in its event loop
+    const char KIPCSharedRingDoorbell = '!';
+
+    /**
+     *  Single producer, single consumer byte ring in POSIX shared memory.
+     *  Waiting is done on futexes inside the shared segment, so a blocked
+     *  reader or writer in the peer process is woken without a syscall
+     *  on the socket.
+     */
+    class ServiceIPCSharedRing
+    {
+    public:
+        ServiceIPCSharedRing();
+
+        virtual ~ServiceIPCSharedRing();
+
+    public:
+
+        bool create(const QString& aName, int aCapacity);
+
+        bool attach(const QString& aName);
+
+        void unlink();
+
+        void close();
+
+        inline bool isAttached() const { return m_Header != NULL; }
+
+        int write(const char* aData, int aLength);
+
+        int read(QByteArray& aBuffer);
+
+        int bytesAvailable() const;
+
+        int freeSpace() const;
+
+        bool waitForData(int aTimeout);
+
+        bool waitForSpace(int aTimeout);
+
+        bool wakeReader();
+
+        void requestSpaceNotification();
+
+        bool wakeWriter();
+
+    private:
+        bool map(int aFd, int aSize);
+
+    private:
+        struct RingHeader;
+        RingHeader* m_Header;   // mapped, start of the segment
+        char* m_Data;           // mapped, ring storage after the header
+        int m_MappedSize;
+        quint32 m_Capacity;     // local copy, the mapped one is not trusted
+        QByteArray m_Name;
+        bool m_Owner;
+    };
+
+}
+#endif // serviceipcsharedring_p_h
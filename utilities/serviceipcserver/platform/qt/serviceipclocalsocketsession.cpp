@@ -20,6 +20,9 @@
 #include "serviceipcrequest.h"
 #include <QtNetwork>
 #include <clientinfo.h>
+#ifdef ENABLE_PERF_TRACE
+#include "wrtperftracer.h"
+#endif
 
 namespace WRT
 {
@@ -38,6 +41,10 @@ LocalSocketSession::~LocalSocketSession()
 {
     delete m_curRequest;
     m_curRequest = NULL;
+#ifdef Q_OS_LINUX
+    delete m_requestRing;
+    delete m_replyRing;
+#endif // Q_OS_LINUX
     if (m_clientInfo) {
         delete m_clientInfo;
         m_clientInfo = NULL;
@@ -53,6 +60,13 @@ LocalSocketSession::LocalSocketSession(QLocalSocket* aNewSocket,
                                        MServiceIPCObserver* aObserver) 
     : ServiceIPCSession(aObserver)
     , m_socket(aNewSocket)
+    , m_protocolVersion(KIPCTextProtocol)
+    , m_curRequestId(0)
+#ifdef Q_OS_LINUX
+    , m_requestRing(NULL)
+    , m_replyRing(NULL)
+    , m_sharedMemActive(false)
+#endif // Q_OS_LINUX
 {
     // Take ownership of the socket
     m_socket->setParent(this);
@@ -68,8 +82,65 @@ LocalSocketSession::LocalSocketSession(QLocalSocket* aNewSocket,
  */
 void LocalSocketSession::handleRequest()
 {
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Ipc, "LocalSocketSession::handleRequest");
+#endif
     // Process data
     QByteArray data = m_socket->readAll();
+#ifdef Q_OS_LINUX
+    if (m_sharedMemActive) {
+        // The socket only carries doorbells, requests are in the ring
+        // and a doorbell may also mean the client made room for replies
+        data.clear();
+        if (m_requestRing->read(data) < 0 || !flushReply()) {
+            // The client broke the ring protocol
+            close();
+            return;
+        }
+        m_requestRing->wakeWriter();
+    }
+#endif // Q_OS_LINUX
+    if (m_protocolVersion == KIPCBinaryProtocol) {
+        m_frameReader.append(data);
+        dispatchFrames();
+    }
+    else {
+        handleTextRequest(data);
+    }
+}
+
+/*!
+ Dispatch the buffered binary request frames.\n
+ Requests are handled one at a time; frames that arrive while a request
+ is outstanding stay buffered until it completes.
+ */
+void LocalSocketSession::dispatchFrames()
+{
+    ServiceIPCFrame frame;
+    while (!m_curRequest && m_frameReader.next(frame)) {
+        if (frame.m_Opcode != ServiceIPCFrame::ERequest || frame.m_Fields.count() != 2) {
+            continue;
+        }
+        const QByteArray& requestData = frame.m_Fields[1];
+        m_curRequestId = frame.m_RequestId;
+        m_replyData.clear();
+        m_curRequest = new ServiceIPCRequest(this, requestData.length(),
+                                             QString::fromAscii(frame.m_Fields[0]));
+        m_curRequest->addRequestdata(requestData);
+
+        ClientInfo *client = new ClientInfo();
+        client->setSessionId(m_clientInfo->sessionId());
+        m_curRequest->setClientInfo(client); // ownership passed
+        handleReq();
+    }
+}
+
+/*!
+ Handle request data of the text protocol
+ @param data data read from the socket
+ */
+void LocalSocketSession::handleTextRequest(const QByteArray& data)
+{
     // TODO: Get Client info
     ClientInfo *client = new ClientInfo();
 
@@ -128,6 +199,11 @@ void LocalSocketSession::handleRequest()
  */
 bool LocalSocketSession::write(const QByteArray& aData)
 {
+    // Binary replies are sent as one frame on completion
+    if (m_protocolVersion == KIPCBinaryProtocol) {
+        m_replyData.append(aData);
+        return true;
+    }
     int written = m_socket->write(aData);
     return (written != -1);
 }
@@ -137,14 +213,118 @@ bool LocalSocketSession::write(const QByteArray& aData)
  */
 bool LocalSocketSession::completeRequest()
 {
-    // Write a request complete token and wait until all data has been written to the socket
-    m_socket->write(REQUEST_COMPLETE_TOKEN);
+#ifdef ENABLE_PERF_TRACE
+    PERF_TRACE_SCOPE(Ipc, "LocalSocketSession::completeRequest");
+#endif
+    if (m_protocolVersion == KIPCBinaryProtocol) {
+        QList<QByteArray> fields;
+        fields.append(m_replyData);
+        writeReply(ServiceIPCFrame::encode(ServiceIPCFrame::EReply,
+                                           m_curRequestId, fields));
+        m_replyData.clear();
+    }
+    else {
+        // Write a request complete token
+        m_socket->write(REQUEST_COMPLETE_TOKEN);
+    }
+    // Wait until all data has been written to the socket
     bool done = m_socket->waitForBytesWritten(-1);
     delete m_curRequest;
     m_curRequest = NULL;
+
+    // Pick up requests that were pipelined behind the completed one
+    if (m_frameReader.hasPendingData()) {
+        QMetaObject::invokeMethod(this, "dispatchFrames", Qt::QueuedConnection);
+    }
     return done;
 }
 
+/*!
+ Send a binary reply frame to the client
+ @param aFrame encoded frame
+ @return true if the whole frame was written
+ */
+bool LocalSocketSession::writeReply(const QByteArray& aFrame)
+{
+#ifdef Q_OS_LINUX
+    if (m_sharedMemActive) {
+        // Queued behind any reply still waiting for ring space
+        m_pendingReply.append(aFrame);
+        return flushReply();
+    }
+#endif // Q_OS_LINUX
+    return (m_socket->write(aFrame) != -1);
+}
+
+#ifdef Q_OS_LINUX
+/*!
+ Write as much of the pending reply data as fits into the reply ring.\n
+ Never blocks: when the ring is full the client is asked for a doorbell
+ once it has read, and the rest is written from handleRequest().
+ @return false if the client corrupted the ring
+ */
+bool LocalSocketSession::flushReply()
+{
+    while (!m_pendingReply.isEmpty()) {
+        int written = m_replyRing->write(m_pendingReply.constData(),
+                                         m_pendingReply.length());
+        if (written < 0) {
+            return false;
+        }
+        if (written > 0) {
+            m_pendingReply.remove(0, written);
+            // Futex for a client blocked in a sync read, else a doorbell
+            if (!m_replyRing->wakeReader()) {
+                m_socket->write(&KIPCSharedRingDoorbell, 1);
+                m_socket->flush();
+            }
+            continue;
+        }
+        // Ring full, the client may have drained it before it saw the request
+        m_replyRing->requestSpaceNotification();
+        if (m_replyRing->freeSpace() == 0) {
+            break;
+        }
+    }
+    return true;
+}
+#endif // Q_OS_LINUX
+
+#ifdef Q_OS_LINUX
+/*!
+ Attach to the shared memory rings created by the client
+ @param aName base name of the rings
+ @return true if attached
+ */
+bool LocalSocketSession::attachSharedMemory(const QString& aName)
+{
+    // Frames are required to delimit data in the rings
+    if (m_protocolVersion != KIPCBinaryProtocol) {
+        return false;
+    }
+    if (!m_requestRing) {
+        m_requestRing = new ServiceIPCSharedRing();
+        m_replyRing = new ServiceIPCSharedRing();
+    }
+    return m_requestRing->attach(aName + KIPCSharedRingRequestSuffix)
+           && m_replyRing->attach(aName + KIPCSharedRingReplySuffix);
+}
+
+/*!
+ Start exchanging frames through the shared memory rings
+ @param aEnabled true if the rings were attached
+ */
+void LocalSocketSession::setSharedMemoryEnabled(bool aEnabled)
+{
+    m_sharedMemActive = aEnabled;
+    m_pendingReply.clear();
+    if (!aEnabled && m_requestRing) {
+        m_requestRing->close();
+        m_replyRing->close();
+    }
+}
+#endif // Q_OS_LINUX
+
 /*!
  Handles when a client disconnect
  This slot function is connected to the underlying QLocalSocket
@@ -20,6 +20,10 @@
 
 #include "serviceipcserversession.h"
 #include "serviceipcserverlocalsocket_p.h"
+#include "serviceipcframe.h"
+#ifdef Q_OS_LINUX
+#include "serviceipcsharedring_p.h"
+#endif // Q_OS_LINUX
 
 class MServiceIPCObserver;
 class QLocalSocket;
@@ -55,6 +59,22 @@ namespace WRT {
         {
             ((ServiceFwIPCServerLocalSocket*) parent())->appendBroadcastList(aSessionId, aSession);
         }; 
+
+        inline int maxProtocolVersion() const
+        {
+            return KIPCBinaryProtocol;
+        };
+
+        inline void setProtocolVersion(int aVersion)
+        {
+            m_protocolVersion = aVersion;
+        };
+
+#ifdef Q_OS_LINUX
+        bool attachSharedMemory(const QString& aName);
+
+        void setSharedMemoryEnabled(bool aEnabled);
+#endif // Q_OS_LINUX
     
     public slots:
     
@@ -63,8 +83,18 @@ namespace WRT {
     private slots:
     
         void handleDisconnect();
+
+        void dispatchFrames();
     
     private:
+
+        void handleTextRequest(const QByteArray& data);
+
+        bool writeReply(const QByteArray& aFrame);
+
+#ifdef Q_OS_LINUX
+        bool flushReply();
+#endif // Q_OS_LINUX
     
         void doCancelRequest();
     
@@ -74,6 +104,19 @@ namespace WRT {
     
     private:
         QLocalSocket* m_socket;
+        int m_protocolVersion;
+        // Binary protocol state
+        ServiceIPCFrameReader m_frameReader;
+        QByteArray m_replyData;
+        quint32 m_curRequestId;
+#ifdef Q_OS_LINUX
+        // Shared memory transport, owned
+        ServiceIPCSharedRing* m_requestRing;
+        ServiceIPCSharedRing* m_replyRing;
+        bool m_sharedMemActive;
+        // Reply data that did not fit into the reply ring yet
+        QByteArray m_pendingReply;
+#endif // Q_OS_LINUX
     };
 
 }
@@ -124,17 +124,9 @@ void ServiceFwIPCServer::configIpcServerLifetime(bool aKeepServer)
 void ServiceFwIPCServer::broadcast( const QByteArray& aMessage )
 {
     QHash<int, ServiceIPCSession*> sessions = d->getBroadcastSessions(); 
-    for (int i = 0; i < sessions.count(); ++i) {
-        ServiceIPCSession* session = sessions[i];
-        if ((session->getReadyToSend()) && (session->messageListIsEmpty())) {
-            session->write(aMessage);
-            session->completeRequest();
-            session->setReadyToSend(false);
-        }
-        else {
-            //queue the aMessage to be sent
-            session->appendMessageList(aMessage);
-        }
+    QHash<int, ServiceIPCSession*>::const_iterator it = sessions.constBegin();
+    for (; it != sessions.constEnd(); ++it) {
+        deliverMessage(it.value(), aMessage, QByteArray());
     }
 }
  
@@ -144,19 +136,49 @@ void ServiceFwIPCServer::broadcast( const QByteArray& aMessage )
  * @param aMessage the contents of the message
  */ 
 void ServiceFwIPCServer::sendMessage( qint32 aSessionId, QByteArray& aMessage )
+{
+    sendMessage(aSessionId, aMessage, QByteArray());
+}
+
+/*!
+ * Push a message to a particular client connected to this server.\n
+ * The message is written immediately if the client is waiting for one,
+ * otherwise it is queued; a queued message with the same coalesce key
+ * is replaced rather than appended.
+ * @param aSessionId, id of a session to send to
+ * @param aMessage the contents of the message
+ * @param aCoalesceKey key identifying replaceable messages, may be empty
+ */ 
+void ServiceFwIPCServer::sendMessage( qint32 aSessionId,
+                                      const QByteArray& aMessage,
+                                      const QByteArray& aCoalesceKey )
 {
     QHash<int, ServiceIPCSession*> sessions = d->getBroadcastSessions(); 
     ServiceIPCSession* session = sessions.value(aSessionId);
     if (session != NULL) {
-        if ((session->getReadyToSend()) && (session->messageListIsEmpty())) { 
-            session->write(aMessage);
-            session->completeRequest();
-            session->setReadyToSend(false);
-        }
-        else {
-            //queue the aMessage to be sent
-            session->appendMessageList(aMessage);
-        }
+        deliverMessage(session, aMessage, aCoalesceKey);
+    }
+}
+
+/*!
+ * Write a message to a subscribed session or queue it until the session
+ * subscribes again
+ * @param aSession session to deliver to
+ * @param aMessage the contents of the message
+ * @param aCoalesceKey key identifying replaceable messages, may be empty
+ */ 
+void ServiceFwIPCServer::deliverMessage( ServiceIPCSession* aSession,
+                                         const QByteArray& aMessage,
+                                         const QByteArray& aCoalesceKey )
+{
+    if ((aSession->getReadyToSend()) && (aSession->messageListIsEmpty())) {
+        aSession->write(aMessage);
+        aSession->completeRequest();
+        aSession->setReadyToSend(false);
+    }
+    else {
+        //queue the aMessage to be sent
+        aSession->appendMessageList(aMessage, aCoalesceKey);
     }
 }
                                 
@@ -26,6 +26,7 @@ namespace WRT {
     // Forward Declarations
     class ServiceFwIPCServerPrivate;
     class MServiceIPCObserver;
+    class ServiceIPCSession;
     
     class SFWIPCSRV_EXPORT ServiceFwIPCServer : public QObject
     {
@@ -59,12 +60,26 @@ namespace WRT {
         * @param aMessage the contents of the message
         */ 
         void sendMessage( qint32 aSessionId, QByteArray& aMessage );
+
+        /**
+        * Push a message to a particular client connected to this server,
+        * coalescing it with a still queued message of the same key
+        * @param aSessionId, id of a session to send to
+        * @param aMessage the contents of the message
+        * @param aCoalesceKey key identifying replaceable messages, may be empty
+        */ 
+        void sendMessage( qint32 aSessionId, const QByteArray& aMessage,
+                          const QByteArray& aCoalesceKey );
                              
              
     signals:
         void handleExit();
         
     private:
+        void deliverMessage( ServiceIPCSession* aSession,
+                             const QByteArray& aMessage,
+                             const QByteArray& aCoalesceKey );
+
         void startTimer();
         
         void stopTimer();
@@ -83,7 +83,20 @@ else {
     SOURCES += ./platform/qt/serviceipcserverlocalsocket.cpp \
                ./platform/qt/serviceipclocalsocketsession.cpp
     
-    INCLUDEPATH += $$PWD/platform/qt
+    INCLUDEPATH += $$PWD/platform/qt $$PWD/../serviceipcclient
+
+    # Shared memory transport, POSIX shm and futex based
+    linux-* {
+        HEADERS += ../serviceipcclient/serviceipcsharedring_p.h
+        SOURCES += ../serviceipcclient/serviceipcsharedring.cpp
+        LIBS += -lrt
+    }
+
+    # Ipc category of the browser's tracer, qmake DEFINES+=ENABLE_PERF_TRACE
+    contains(DEFINES, ENABLE_PERF_TRACE) {
+        LIBS += -lbrperftrace
+        INCLUDEPATH += $$ROOT_DIR/internal/tests/perfTracing
+    }
 }
 
 ###include($$WRT_DIR/cwrt-export.pri)
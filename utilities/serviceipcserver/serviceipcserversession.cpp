@@ -48,6 +48,41 @@ ServiceIPCSession::ServiceIPCSession(MServiceIPCObserver* aObserver)
 ServiceIPCSession::~ServiceIPCSession()
 {
     m_messageList.clear();
+    m_messageKeys.clear();
+}
+
+/*!
+ Queue a message until the client is ready to receive it.\n
+ If a message with the same non-empty coalesce key is still queued it is
+ replaced in place, so a burst of e.g. progress updates for the same item
+ is delivered as a single, most recent message.
+ @param aMessage message to queue
+ @param aCoalesceKey key identifying replaceable messages, may be empty
+ */
+void ServiceIPCSession::appendMessageList(const QByteArray& aMessage,
+                                         const QByteArray& aCoalesceKey)
+{
+    if (!aCoalesceKey.isEmpty()) {
+        int index = m_messageKeys.indexOf(aCoalesceKey);
+        if (index != -1) {
+            m_messageList[index] = aMessage;
+            return;
+        }
+    }
+    m_messageList.append(aMessage);
+    m_messageKeys.append(aCoalesceKey);
+}
+
+/*!
+ Remove and return the oldest queued message
+ @return the message, or an empty QByteArray if none is queued
+ */
+QByteArray ServiceIPCSession::takeFirstMessage()
+{
+    if (m_messageList.isEmpty())
+        return QByteArray();
+    m_messageKeys.removeFirst();
+    return m_messageList.takeFirst();
 }
 
 
@@ -71,6 +106,24 @@ void ServiceIPCSession::handleReq()
         m_curRequest->completeRequest();
         m_observer->handleClientConnect(m_clientInfo);
     }
+    else if (m_curRequest->getOperation() == NEGOTIATEPROTOCOL) {
+        // Reply in the protocol the request came in, then switch
+        int version = qMin(m_curRequest->getData().toInt(), maxProtocolVersion());
+        QByteArray reply;
+        reply.setNum(version);
+        m_curRequest->write(reply);
+
+        m_curRequest->completeRequest();
+        setProtocolVersion(version);
+    }
+    else if (m_curRequest->getOperation() == SETUPSHAREDMEM) {
+        // Reply on the socket, then move to the rings
+        bool attached = attachSharedMemory(QString::fromAscii(m_curRequest->getData()));
+        m_curRequest->write(attached ? "1" : "0");
+
+        m_curRequest->completeRequest();
+        setSharedMemoryEnabled(attached);
+    }
     else if (m_curRequest->getOperation() == SUBSCRIBEBROADCASTMSG) {
         m_readyToSend = true;
         if (!m_appendToBList) {
@@ -79,7 +132,7 @@ void ServiceIPCSession::handleReq()
             m_appendToBList = true;
         }
         if (!m_messageList.isEmpty()) {
-            write(m_messageList.takeFirst());
+            write(takeFirstMessage());
             completeRequest();
             m_readyToSend = false;
         }
@@ -44,6 +44,29 @@ namespace WRT {
         virtual void releaseSessionId(int aSessionId) = 0;
         
         virtual void appendBroadcastList(int aSessionId, ServiceIPCSession * aSession) = 0; 
+
+        /**
+         * Highest wire protocol version this session can speak,
+         * the text protocol (0) unless overridden by the backend
+         */
+        virtual int maxProtocolVersion() const { return 0; }
+
+        /**
+         * Switch the session to the negotiated protocol version
+         */
+        virtual void setProtocolVersion(int /*aVersion*/) {}
+
+        /**
+         * Attach to the shared memory rings created by the client
+         * @param aName base name of the rings
+         * @return true if attached, unsupported by default
+         */
+        virtual bool attachSharedMemory(const QString& /*aName*/) { return false; }
+
+        /**
+         * Start exchanging frames through the attached shared memory rings
+         */
+        virtual void setSharedMemoryEnabled(bool /*aEnabled*/) {}
     
         inline void setClientInfo(ClientInfo* aClientInfo) 
         {
@@ -59,8 +82,11 @@ namespace WRT {
         };       
         inline void appendMessageList(const QByteArray& aMessage) 
         {
-            m_messageList.append(aMessage);
+            appendMessageList(aMessage, QByteArray());
         };       
+        void appendMessageList(const QByteArray& aMessage,
+                               const QByteArray& aCoalesceKey);
+        QByteArray takeFirstMessage();
         inline bool messageListIsEmpty() const
         {
             return m_messageList.isEmpty();
@@ -76,6 +102,8 @@ namespace WRT {
         bool m_appendToBList;
     private:
         QList<QByteArray> m_messageList;
+        // coalesce key of each queued message, empty if not coalescable
+        QList<QByteArray> m_messageKeys;
         bool m_readyToSend;
     };
 
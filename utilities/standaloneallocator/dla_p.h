@@ -36,7 +36,12 @@
 #define NO_MALLINFO 0
 #define HAVE_GETPAGESIZE
 
+#ifdef __SYMBIAN32__
 #define LACKS_SYS_TYPES_H
+#else
+/* malloc() has to return memory aligned for any type */
+#define MALLOC_ALIGNMENT ((size_t)(2 * sizeof(void*)))
+#endif
 #ifndef LACKS_SYS_TYPES_H
 #include <sys/types.h>  /* For size_t */
 #else
@@ -359,8 +364,7 @@ struct mallinfo {
 #define CHUNK_ALIGN_MASK    (MALLOC_ALIGNMENT - SIZE_T_ONE)
 
 /* True if address a has acceptable alignment */
-//#define is_aligned(A)       (((size_t)((A)) & (CHUNK_ALIGN_MASK)) == 0)
-#define is_aligned(A)       (((unsigned int)((A)) & (CHUNK_ALIGN_MASK)) == 0)
+#define is_aligned(A)       (((size_t)((A)) & (CHUNK_ALIGN_MASK)) == 0)
 
 /* the number of bytes to offset an address to align it */
 #define align_offset(A)\
@@ -975,7 +979,7 @@ struct malloc_params {
     #define pagesize        (1<<pageshift)
     #define slabshift       10
     #define slabsize        (1 << slabshift)
-    #define cellalign       8
+    #define cellalign       (2 * sizeof(void*))
     const unsigned slabfull = 0;
     const TInt  slabsperpage    =   (int)(pagesize/slabsize);
     #define hibit(bits) (((unsigned)bits & 0xc) ? 2 + ((unsigned)bits>>3) : ((unsigned) bits>>1))
@@ -983,7 +987,7 @@ struct malloc_params {
     #define lowbit(bits)    (((unsigned) bits&3) ? 1 - ((unsigned)bits&1) : 3 - (((unsigned)bits>>2)&1))
     #define maxslabsize 60
     #define minpagepower    pageshift+2
-    #define cellalign   8
+    #define cellalign       (2 * sizeof(void*))
     class slabhdr
     {
     public:
@@ -1004,15 +1008,15 @@ struct malloc_params {
     const unsigned firstpos = sizeof(slabhdr)>>2;
     #define checktree(x) (void)0
     template <class T> inline T floor(const T addr, unsigned aln)
-        {return T((unsigned(addr))&~(aln-1));}
+        {return T((TLinAddr(addr))&~TLinAddr(aln-1));}
     template <class T> inline T ceiling(T addr, unsigned aln)
-        {return T((unsigned(addr)+(aln-1))&~(aln-1));}
+        {return T((TLinAddr(addr)+(aln-1))&~TLinAddr(aln-1));}
     template <class T> inline unsigned lowbits(T addr, unsigned aln)
-        {return unsigned(addr)&(aln-1);}
+        {return unsigned(TLinAddr(addr)&(aln-1));}
     template <class T1, class T2> inline int ptrdiff(const T1* a1, const T2* a2)
         {return reinterpret_cast<const unsigned char*>(a1) - reinterpret_cast<const unsigned char*>(a2);}
     template <class T> inline T offset(T addr, signed ofs)
-        {return T(unsigned(addr)+ofs);}
+        {return T(TLinAddr(addr)+ofs);}
     class slabset
     {
     public:
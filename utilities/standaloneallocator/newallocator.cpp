@@ -33,6 +33,7 @@
  ***************************************************************************/
 
 
+#ifdef __SYMBIAN32__
 #include <e32std.h>
 #include <e32cmn.h>
 #include <hal.h>
@@ -65,6 +66,9 @@ struct SStdEpocThreadCreateInfo : public SThreadCreateInfo
 #include <u32std.h>
 #endif
 #include <e32svr.h>
+#else
+#include "newallocator_linux_p.h"
+#endif
 
 //Named local chunks require support from the kernel, which depends on Symbian^3
 #define NO_NAMED_LOCAL_CHUNKS
@@ -105,7 +109,7 @@ struct SStdEpocThreadCreateInfo : public SThreadCreateInfo
 #endif
 
 
-#ifndef __WINS__
+#if defined(__SYMBIAN32__) && !defined(__WINS__)
 #pragma push
 #pragma arm
 #endif
@@ -360,6 +364,7 @@ inline void RNewAllocator::TraceCallStack()
 #endif
 }
 
+#ifdef __SYMBIAN32__
 size_t getpagesize()
 {
     TInt size;
@@ -368,6 +373,7 @@ size_t getpagesize()
         return (size_t)0x1000;
     return (size_t)size;
 }
+#endif
 
 #define gm  (&iGlobalMallocState)
 
@@ -407,7 +413,11 @@ RNewAllocator::RNewAllocator(TInt aChunkHandle, TInt aOffset, TInt aMinLength, T
     if (aMinLength == aMaxLength)
         Init(0, 0, 0);
     else
+#ifdef __SYMBIAN32__
         Init(0x3fff, 15, 0x10000);  // all slabs, page {32KB}, trim {64KB} // Andrew: Adopting Webkit config?
+#else
+        Init(0x88a, 15, 0x10000);   // slabs {48, 32, 16, 8} keep malloc alignment, page {32KB}, trim {64KB}
+#endif
         //Init(0xabe, 16, iPageSize*4); // slabs {48, 40, 32, 24, 20, 16, 12, 8}, page {64KB}, trim {16KB}
 #ifdef TRACING_HEAPS
     RChunk chunk;
@@ -426,7 +436,7 @@ RNewAllocator::RNewAllocator(TInt aChunkHandle, TInt aOffset, TInt aMinLength, T
 
     }
 
-TAny* RNewAllocator::operator new(TUint aSize, TAny* aBase) __NO_THROW
+TAny* RNewAllocator::operator new(size_t aSize, TAny* aBase) __NO_THROW
     {
     __ASSERT_ALWAYS(aSize>=sizeof(RNewAllocator), HEAP_PANIC(ETHeapNewBadSize));
     RNewAllocator* h = (RNewAllocator*)aBase;
@@ -2450,7 +2460,7 @@ void* RNewAllocator::slab_allocate(slabset& ss)
             return p;
         }
         unsigned h2 = h + ((h&0x3C000)<<6);
-        if (h2 < 0xfc00000)
+        if (h2 < (maxuse << 20))      // used bytes still within the slab payload
         {
             ASSERT((header_usedm4(h2)+4)%header_size(h2) == 0);
             s->header = h2;
@@ -2825,6 +2835,7 @@ The heap cannot be extended.
     return h;
     }
 
+#ifdef __SYMBIAN32__
 RNewAllocator* RNewAllocator::ChunkHeap(const TDesC* aName, TInt aMinLength, TInt aMaxLength, TInt aGrowBy, TInt aAlign, TBool aSingleThread)
 /**
 Creates a heap in a local or global chunk.
@@ -2893,6 +2904,8 @@ Note that the size of the heap cannot be adjusted by more than aMaxLength.
     return h;
     }
 
+#endif // __SYMBIAN32__
+
 RNewAllocator* RNewAllocator::ChunkHeap(RChunk aChunk, TInt aMinLength, TInt aGrowBy, TInt aMaxLength, TInt aAlign, TBool aSingleThread, TUint32 aMode)
 /**
 Creates a heap in an existing chunk.
@@ -3210,6 +3223,7 @@ void RNewAllocator::dump_heap_logs(size_t fail_size)
 /* Only for debugging purpose - end*/
 
 
+#ifdef __SYMBIAN32__
 #define UserTestDebugMaskBit(bit) (TBool)(UserSvr::DebugMask(bit>>5) & (1<<(bit&31)))
 
 #ifndef NO_NAMED_LOCAL_CHUNKS
@@ -3306,6 +3320,151 @@ TInt _symbian_SetupThreadHeap(TBool /*aNotFirst*/, SStdEpocThreadCreateInfo& aIn
     return r;
     }
 
-#ifndef __WINS__
+#else // __SYMBIAN32__
+
+RNewAllocator* RNewAllocator::CreateProcessHeap(TInt aMaxLength)
+/**
+Creates a process wide heap for the Linux build.
+
+The heap lives in a disconnected chunk reserved for twice aMaxLength, the
+slab and page allocators take the lower half and Doug Lea's allocator grows
+upwards from the middle, as in CreateThreadHeap().
+
+@param aMaxLength    The maximum length of each half of the heap.
+
+@return A pointer to the new heap or NULL if the heap could not be created.
+*/
+    {
+    TInt page_size = malloc_getpagesize;
+    TInt maxLength = _ALIGN_UP(Max(aMaxLength, KMinHeapSize), page_size);
+    RChunk c;
+    TInt r = c.CreateDisconnectedLocal(0, 0, maxLength * 2);
+    if (r!=KErrNone)
+        return NULL;
+    RNewAllocator* h = ChunkHeap(c, 0, page_size, maxLength, 0, EFalse, 0);
+    c.Close();
+    return h;
+    }
+
+TInt RNewAllocator::SlabAllocBatch(TInt aSize, TAny** aCells, TInt aCount)
+/**
+Allocates up to aCount cells of one slab size class under a single lock.
+
+@param aSize         The cell size, must be below the slab threshold.
+@param aCells        Receives the cells.
+@param aCount        The number of cells wanted.
+
+@return The number of cells allocated.
+*/
+    {
+    __ASSERT_ALWAYS(aSize >= 0 && aSize < slab_threshold, HEAP_PANIC(ETHeapBadAllocatedCellSize));
+    Lock();
+    slabset& ss = slaballoc[sizemap[(aSize+3)>>2]];
+    TInt n = 0;
+    for (; n < aCount; ++n)
+        {
+        TAny* p = slab_allocate(ss);
+        if (!p)
+            break;
+        aCells[n] = p;
+        }
+    iCellCount += n;
+    iTotalAllocSize += n * ss.size;
+    Unlock();
+    return n;
+    }
+
+void RNewAllocator::SlabFreeBatch(TAny** aCells, TInt aCount)
+/**
+Frees cells returned by SlabAllocBatch() under a single lock.
+*/
+    {
+    Lock();
+    for (TInt i = 0; i < aCount; ++i)
+        slab_free(aCells[i]);
+    iCellCount -= aCount;
+    Unlock();
+    }
+
+TAny* RNewAllocator::AlignedAlloc(TInt aAlign, TInt aSize)
+/**
+Allocates a cell aligned on aAlign bytes from Doug Lea's allocator.
+Cells from the slab and page allocators are only aligned on cellalign.
+
+@param aAlign        The alignment, a power of two.
+@param aSize         The size of the cell.
+
+@return The cell or NULL if there is not enough memory.
+*/
+    {
+    __ASSERT_ALWAYS((TUint)aSize<(KMaxTInt/2),HEAP_PANIC(ETHeapBadAllocatedCellSize));
+    Lock();
+    TAny* addr = dlmemalign(aAlign, aSize);
+    if (addr)
+        iCellCount++;
+    Unlock();
+    return addr;
+    }
+
+void* RNewAllocator::dlmemalign(size_t alignment, size_t bytes)
+//
+// internal_memalign() of dlmalloc 2.8.x: over-allocate, then give back the
+// misaligned leader and any spare trailer
+//
+{
+    if (alignment <= MALLOC_ALIGNMENT)
+        return dlmalloc(bytes);
+    if (alignment < MIN_CHUNK_SIZE)
+        alignment = MIN_CHUNK_SIZE;
+    if ((alignment & (alignment-SIZE_T_ONE)) != 0) {
+        size_t a = MALLOC_ALIGNMENT << 1;
+        while (a < alignment) a <<= 1;
+        alignment = a;
+    }
+    if (bytes >= MAX_REQUEST - alignment)
+        return 0;
+
+    size_t nb = request2size(bytes);
+    size_t req = nb + alignment + MIN_CHUNK_SIZE - CHUNK_OVERHEAD;
+    TUint8* mem = (TUint8*)dlmalloc(req);
+    if (mem == 0)
+        return 0;
+
+    void* leader = 0;
+    void* trailer = 0;
+    mchunkptr p = mem2chunk(mem);
+    if ((((size_t)(mem)) % alignment) != 0) {
+        TUint8* br = (TUint8*)mem2chunk((size_t)(((size_t)(mem + alignment - SIZE_T_ONE)) & -alignment));
+        TUint8* pos = ((size_t)(br - (TUint8*)(p)) >= MIN_CHUNK_SIZE)? br : br+alignment;
+        mchunkptr newp = (mchunkptr)pos;
+        size_t leadsize = pos - (TUint8*)(p);
+        size_t newsize = chunksize(p) - leadsize;
+        set_inuse(gm, newp, newsize);
+        set_inuse(gm, p, leadsize);
+        leader = chunk2mem(p);
+        p = newp;
+    }
+
+    size_t size = chunksize(p);
+    if (size > nb + MIN_CHUNK_SIZE) {
+        size_t remainder_size = size - nb;
+        mchunkptr remainder = chunk_plus_offset(p, nb);
+        set_inuse(gm, p, nb);
+        set_inuse(gm, remainder, remainder_size);
+        trailer = chunk2mem(remainder);
+    }
+
+    ASSERT(chunksize(p) >= nb);
+    ASSERT((((size_t)(chunk2mem(p))) % alignment) == 0);
+    if (leader != 0)
+        dlfree(leader);
+    if (trailer != 0)
+        dlfree(trailer);
+    return chunk2mem(p);
+}
+
+#endif // __SYMBIAN32__
+
+#if defined(__SYMBIAN32__) && !defined(__WINS__)
 #pragma pop
 #endif
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "newallocator_linux_p.h"
+#include <sys/mman.h>
+
+/*
+ * \internal
+ *
+ * State of a disconnected chunk. Chunks are never freed, the allocator
+ * creates one per heap and heaps live as long as the process.
+ */
+struct TLinuxChunk
+    {
+    TUint8* iBase;
+    TInt iMaxSize;
+    TInt iSize;             // committed bytes
+    TInt iPages;
+    TInt iFreeHint;         // no free page below this index
+    TUint32* iCommitted;    // one bit per page
+    TUint32* iRetained;     // decommitted, not yet given back to the kernel
+    TInt iRetainedSize;     // bytes in iRetained
+    TInt iRetainedLow;      // page range holding all retained pages
+    TInt iRetainedHigh;
+    };
+
+/*
+ * Decommitted pages are kept mapped until this many bytes have
+ * accumulated, then all of them go back to the kernel in one pass.
+ * The heap frees and reallocates the same pages constantly while a page
+ * loads, a madvise() on every decommit would fault them in again each
+ * time. Scaled with the committed size so a large heap trims less often.
+ */
+const TInt KMinRetainedSize = 4 << 20;
+const TInt KRetainedShift = 2;      // a quarter of the committed size
+
+const TInt KMaxLinuxChunks = 4;
+static TLinuxChunk TheChunks[KMaxLinuxChunks];
+static TInt TheChunkCount = 0;
+static pthread_mutex_t TheChunkLock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline TInt PageShift()
+    {
+    static TInt shift = 0;
+    if (!shift)
+        {
+        TInt size = sysconf(_SC_PAGESIZE);
+        while ((1 << shift) < size)
+            ++shift;
+        }
+    return shift;
+    }
+
+static inline TLinuxChunk* Chunk(TInt aHandle)
+    {
+    return (aHandle > 0 && aHandle <= TheChunkCount) ? &TheChunks[aHandle - 1] : NULL;
+    }
+
+static inline TBool IsCommitted(const TLinuxChunk* aChunk, TInt aPage)
+    {
+    return (aChunk->iCommitted[aPage >> 5] >> (aPage & 31)) & 1;
+    }
+
+static inline TBool IsRetained(const TLinuxChunk* aChunk, TInt aPage)
+    {
+    return (aChunk->iRetained[aPage >> 5] >> (aPage & 31)) & 1;
+    }
+
+/*
+ * Give every retained page back to the kernel, one madvise() per run
+ */
+static void Trim(TLinuxChunk* aChunk)
+    {
+    TInt shift = PageShift();
+    TInt runStart = -1;
+    for (TInt page = aChunk->iRetainedLow; page <= aChunk->iRetainedHigh; ++page)
+        {
+        if (!(page & 31) && !aChunk->iRetained[page >> 5] && runStart < 0)
+            {
+            page += 31;
+            continue;
+            }
+        if (IsRetained(aChunk, page))
+            {
+            aChunk->iRetained[page >> 5] &= ~(1u << (page & 31));
+            if (runStart < 0)
+                runStart = page;
+            }
+        else if (runStart >= 0)
+            {
+            madvise(aChunk->iBase + (runStart << shift), (page - runStart) << shift, MADV_DONTNEED);
+            runStart = -1;
+            }
+        }
+    if (runStart >= 0)
+        madvise(aChunk->iBase + (runStart << shift),
+                (aChunk->iRetainedHigh + 1 - runStart) << shift, MADV_DONTNEED);
+    aChunk->iRetainedSize = 0;
+    aChunk->iRetainedLow = aChunk->iPages;
+    aChunk->iRetainedHigh = -1;
+    }
+
+TInt HAL::Get(HALData::TAttribute aAttribute, TInt& aValue)
+    {
+    if (aAttribute != HALData::EMemoryPageSize)
+        return KErrNotSupported;
+    aValue = 1 << PageShift();
+    return KErrNone;
+    }
+
+TInt RChunk::CreateDisconnectedLocal(TInt aInitialBottom, TInt aInitialTop, TInt aMaxSize, TOwnerType /*aType*/)
+    {
+    TInt pageSize = 1 << PageShift();
+    if (aMaxSize <= 0 || aInitialBottom < 0 || aInitialTop < aInitialBottom)
+        return KErrArgument;
+    aMaxSize = _ALIGN_UP(aMaxSize, pageSize);
+
+    pthread_mutex_lock(&TheChunkLock);
+    if (TheChunkCount == KMaxLinuxChunks)
+        {
+        pthread_mutex_unlock(&TheChunkLock);
+        return KErrNoMemory;
+        }
+    TLinuxChunk& c = TheChunks[TheChunkCount];
+
+    // Reserve the address space only, pages are backed on first touch
+    void* base = mmap(NULL, aMaxSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    TInt pages = aMaxSize >> PageShift();
+    TInt bitmapSize = _ALIGN_UP(((pages + 31) >> 5) * (TInt)sizeof(TUint32), pageSize);
+    // Committed bitmap followed by the retained one
+    void* bitmap = mmap(NULL, 2 * bitmapSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED || bitmap == MAP_FAILED)
+        {
+        if (base != MAP_FAILED)
+            munmap(base, aMaxSize);
+        if (bitmap != MAP_FAILED)
+            munmap(bitmap, 2 * bitmapSize);
+        pthread_mutex_unlock(&TheChunkLock);
+        return KErrNoMemory;
+        }
+
+    c.iBase = static_cast<TUint8*>(base);
+    c.iMaxSize = aMaxSize;
+    c.iSize = 0;
+    c.iPages = pages;
+    c.iFreeHint = 0;
+    c.iCommitted = static_cast<TUint32*>(bitmap);
+    c.iRetained = c.iCommitted + bitmapSize / sizeof(TUint32);
+    c.iRetainedSize = 0;
+    c.iRetainedLow = pages;
+    c.iRetainedHigh = -1;
+    iHandle = ++TheChunkCount;
+    pthread_mutex_unlock(&TheChunkLock);
+
+    if (aInitialTop > aInitialBottom)
+        return Commit(aInitialBottom, aInitialTop - aInitialBottom);
+    return KErrNone;
+    }
+
+TInt RChunk::Commit(TInt aOffset, TInt aSize)
+    {
+    TLinuxChunk* c = Chunk(iHandle);
+    TInt mask = (1 << PageShift()) - 1;
+    if (!c || aOffset < 0 || aSize < 0 || aOffset > c->iMaxSize - aSize
+        || (aOffset & mask) || (aSize & mask))
+        return KErrArgument;
+
+    TInt first = aOffset >> PageShift();
+    TInt last = first + (aSize >> PageShift());
+    for (TInt page = first; page < last; ++page)
+        {
+        if (IsCommitted(c, page))
+            return KErrAlreadyExists;
+        }
+    for (TInt page = first; page < last; ++page)
+        {
+        c->iCommitted[page >> 5] |= 1u << (page & 31);
+        // Reused as is, the memory is still there
+        if (IsRetained(c, page))
+            {
+            c->iRetained[page >> 5] &= ~(1u << (page & 31));
+            c->iRetainedSize -= 1 << PageShift();
+            }
+        }
+    c->iSize += aSize;
+    return KErrNone;
+    }
+
+TInt RChunk::Decommit(TInt aOffset, TInt aSize)
+    {
+    TLinuxChunk* c = Chunk(iHandle);
+    TInt mask = (1 << PageShift()) - 1;
+    if (!c || aOffset < 0 || aSize < 0 || aOffset > c->iMaxSize - aSize
+        || (aOffset & mask) || (aSize & mask))
+        return KErrArgument;
+
+    // Pages not committed are ignored, as on Symbian
+    TInt first = aOffset >> PageShift();
+    TInt last = first + (aSize >> PageShift());
+    for (TInt page = first; page < last; ++page)
+        {
+        if (IsCommitted(c, page))
+            {
+            c->iCommitted[page >> 5] &= ~(1u << (page & 31));
+            c->iRetained[page >> 5] |= 1u << (page & 31);
+            c->iSize -= 1 << PageShift();
+            c->iRetainedSize += 1 << PageShift();
+            }
+        }
+    if (first < c->iFreeHint)
+        c->iFreeHint = first;
+    c->iRetainedLow = Min(c->iRetainedLow, first);
+    c->iRetainedHigh = Max(c->iRetainedHigh, last - 1);
+    if (c->iRetainedSize > Max(KMinRetainedSize, c->iSize >> KRetainedShift))
+        Trim(c);
+    return KErrNone;
+    }
+
+TInt RChunk::Allocate(TInt aSize)
+    {
+    TLinuxChunk* c = Chunk(iHandle);
+    TInt mask = (1 << PageShift()) - 1;
+    if (!c || aSize <= 0)
+        return KErrArgument;
+    TInt count = (aSize + mask) >> PageShift();
+
+    // Lowest run of free pages, whole words of committed pages are skipped
+    TInt run = 0;
+    TInt page = c->iFreeHint;
+    TBool belowHint = ETrue;
+    while (page < c->iPages)
+        {
+        if (!(page & 31) && c->iCommitted[page >> 5] == KMaxTUint)
+            {
+            run = 0;
+            page += 32;
+            continue;
+            }
+        if (IsCommitted(c, page))
+            {
+            run = 0;
+            }
+        else
+            {
+            if (belowHint)
+                {
+                c->iFreeHint = page;
+                belowHint = EFalse;
+                }
+            if (++run == count)
+                {
+                TInt offset = (page + 1 - count) << PageShift();
+                Commit(offset, count << PageShift());
+                return offset;
+                }
+            }
+        ++page;
+        }
+    return KErrNoMemory;
+    }
+
+TUint8* RChunk::Base() const
+    {
+    TLinuxChunk* c = Chunk(iHandle);
+    return c ? c->iBase : NULL;
+    }
+
+TInt RChunk::Size() const
+    {
+    TLinuxChunk* c = Chunk(iHandle);
+    return c ? c->iSize : 0;
+    }
+
+TInt RChunk::MaxSize() const
+    {
+    TLinuxChunk* c = Chunk(iHandle);
+    return c ? c->iMaxSize : 0;
+    }
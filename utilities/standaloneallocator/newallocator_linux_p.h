@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+/****************************************************************************
+ *
+ * The subset of the Symbian user library used by RNewAllocator, for the
+ * Linux build of the allocator.
+ *
+ * A disconnected chunk is emulated by one anonymous mapping reserved at
+ * creation time. Committing pages only updates the chunk's page bitmap,
+ * the kernel provides the memory on first touch; decommitted pages are
+ * retained up to a limit and then handed back together with
+ * madvise(MADV_DONTNEED). This keeps the reservation in a single mapping
+ * however the allocator interleaves commits.
+ *
+ ***************************************************************************/
+
+
+#ifndef NEWALLOCATOR_LINUX_H
+#define NEWALLOCATOR_LINUX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+typedef void TAny;
+typedef int TInt;
+typedef unsigned int TUint;
+typedef signed char TInt8;
+typedef unsigned char TUint8;
+typedef short TInt16;
+typedef unsigned short TUint16;
+typedef int TInt32;
+typedef unsigned int TUint32;
+typedef int TBool;
+typedef uintptr_t TLinAddr;
+
+const TBool ETrue = 1;
+const TBool EFalse = 0;
+
+const TInt KErrNone = 0;
+const TInt KErrNotFound = -1;
+const TInt KErrGeneral = -2;
+const TInt KErrNoMemory = -4;
+const TInt KErrNotSupported = -5;
+const TInt KErrArgument = -6;
+const TInt KErrAlreadyExists = -11;
+
+const TInt KMaxTInt = 0x7fffffff;
+const TUint KMaxTUint = 0xffffffffu;
+const TInt KMinHeapSize = 0x100;
+const TInt KMinHeapGrowBy = 0x1000;
+
+#define LOCAL_C static
+#define __NO_THROW throw()
+#define _ALIGN_UP(x, a) (((x) + ((a) - 1)) & ~((a) - 1))
+#define _LIT(name, s) static const char* const name = s
+#define _L(s) s
+
+#define __ASSERT_ALWAYS(c, p) ((void)((c) || (p, 0)))
+#ifdef _DEBUG
+#define __ASSERT_DEBUG(c, p) __ASSERT_ALWAYS(c, p)
+#define ASSERT(x) ((void)((x) || (abort(), 0)))
+#else
+#define __ASSERT_DEBUG(c, p) ((void)0)
+#define ASSERT(x) ((void)0)
+#endif
+
+template <class T> inline T Max(T aLeft, T aRight)
+    {return aLeft < aRight ? aRight : aLeft;}
+template <class T> inline T Min(T aLeft, T aRight)
+    {return aLeft < aRight ? aLeft : aRight;}
+
+enum TOwnerType {EOwnerProcess, EOwnerThread};
+
+// Panic codes of the heap, as in e32panic.h
+enum TCdtPanic
+    {
+    ETHeapMaxLengthNegative = 56,
+    ETHeapMinLengthNegative = 55,
+    ETHeapCreateMaxLessThanMin = 41,
+    ETHeapNewBadAlignment = 42,
+    ETHeapBadCellAddress = 42,
+    ETHeapBadAllocatedCellSize = 47,
+    ETHeapNewBadSize = 48,
+    ETHeapNewBadOffset = 212
+    };
+
+class RAllocator;
+
+class User
+    {
+public:
+    // There is no thread heap to switch, the malloc shim owns the process heap
+    static RAllocator* SwitchHeap(RAllocator* /*aA*/)
+        {return NULL;}
+    static void Panic(const char* /*aCategory*/, TInt /*aReason*/)
+        {abort();}
+    static void Invariant()
+        {abort();}
+    };
+
+class HALData
+    {
+public:
+    enum TAttribute {EMemoryPageSize};
+    };
+
+class HAL
+    {
+public:
+    static TInt Get(HALData::TAttribute aAttribute, TInt& aValue);
+    };
+
+class RThread
+    {
+    };
+
+class RHandleBase
+    {
+public:
+    inline RHandleBase() : iHandle(0) {}
+    inline TInt Handle() const {return iHandle;}
+    inline void SetHandle(TInt aHandle) {iHandle = aHandle;}
+    inline TInt Duplicate(const RThread& /*aSrc*/, TOwnerType /*aType*/ = EOwnerProcess)
+        {return KErrNone;}
+    inline void Close() {}
+protected:
+    TInt iHandle;
+    };
+
+class RFastLock : public RHandleBase
+    {
+public:
+    inline TInt CreateLocal(TOwnerType /*aType*/ = EOwnerProcess)
+        {return pthread_mutex_init(&iMutex, NULL) == 0 ? KErrNone : KErrGeneral;}
+    inline void Wait() {pthread_mutex_lock(&iMutex);}
+    inline void Signal() {pthread_mutex_unlock(&iMutex);}
+private:
+    pthread_mutex_t iMutex;
+    };
+
+/**
+Disconnected chunk over a reserved anonymous mapping. The handle indexes
+a process wide table of chunks.
+*/
+class RChunk : public RHandleBase
+    {
+public:
+    TInt CreateDisconnectedLocal(TInt aInitialBottom, TInt aInitialTop, TInt aMaxSize,
+                                 TOwnerType aType = EOwnerProcess);
+    TInt Commit(TInt aOffset, TInt aSize);
+    TInt Decommit(TInt aOffset, TInt aSize);
+    TInt Allocate(TInt aSize);
+    TUint8* Base() const;
+    TInt Size() const;
+    TInt MaxSize() const;
+    };
+
+class UserHeap
+    {
+public:
+    enum TChunkHeapCreateMode {EChunkHeapSwitchTo = 1, EChunkHeapDuplicate = 2};
+    };
+
+class RAllocator
+    {
+public:
+    enum TAllocFail {ERandom, ETrueRandom, EDeterministic, ENone, EFailNext, EReset};
+    enum TAllocDebugOp {ECount, EMarkStart, EMarkEnd, ECheck, ESetFail, ECopyDebugInfo};
+    enum TReAllocMode {ENeverMove = 1, EAllowMoveOnShrink = 2};
+    enum TFlags {ESingleThreaded = 1, EFixedSize = 2, ETraceAllocs = 4};
+public:
+    inline RAllocator()
+        : iAccessCount(1), iHandleCount(0), iHandles(0), iFlags(0), iCellCount(0), iTotalAllocSize(0)
+        {}
+    virtual TAny* Alloc(TInt aSize) = 0;
+    virtual void Free(TAny* aPtr) = 0;
+    virtual TAny* ReAlloc(TAny* aPtr, TInt aSize, TInt aMode = 0) = 0;
+    virtual TInt AllocLen(const TAny* aCell) const = 0;
+    virtual TInt Compress() = 0;
+    virtual void Reset() = 0;
+    virtual TInt AllocSize(TInt& aTotalAllocSize) const = 0;
+    virtual TInt Available(TInt& aBiggestBlock) const = 0;
+    virtual TInt DebugFunction(TInt aFunc, TAny* a1 = NULL, TAny* a2 = NULL) = 0;
+protected:
+    virtual TInt Extension_(TUint aExtensionId, TAny*& a0, TAny* a1) = 0;
+protected:
+    TInt iAccessCount;
+    TInt iHandleCount;
+    TInt* iHandles;
+    TUint32 iFlags;
+    TInt iCellCount;
+    TInt iTotalAllocSize;
+    };
+
+#endif // NEWALLOCATOR_LINUX_H
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ *
+ * This file is part of Qt Web Runtime.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/****************************************************************************
+ *
+ * malloc() and friends on top of RNewAllocator, for use with LD_PRELOAD.
+ *
+ * The process has a single heap, created on the first allocation. Slab
+ * sized requests are served from a small per-thread cache of cells of each
+ * slab class, refilled and drained in batches so that the heap lock is
+ * taken once per batch rather than once per call. The cache of a thread is
+ * given back to the heap when the thread exits.
+ *
+ * Not <malloc.h>: dla_p.h has its own struct mallinfo.
+ *
+ ***************************************************************************/
+
+#include "newallocator_linux_p.h"
+#include "dla_p.h"
+#include "newallocator_p.h"
+#include <errno.h>
+
+// Largest heap, the chunk reserves twice this; NEWALLOCATOR_MAX_HEAP overrides it.
+// 32-bit processes cannot spare 2GB of address space for the reservation.
+const TInt KDefaultMaxHeap = sizeof(TAny*) > 4 ? 0x3FFF0000 : 0x0FFF0000;
+
+// Slab classes used by the heap on Linux, see RNewAllocator::RNewAllocator()
+const TInt KSlabClasses = 4;
+static const TInt KSlabClassSize[KSlabClasses] = {8, 16, 32, 48};
+
+// Cells kept per class and thread, and moved to or from the heap at once
+const TInt KCacheDepth = 32;
+const TInt KCacheBatch = KCacheDepth / 2;
+
+// Alignment of every cell larger than the smallest slab class
+const TInt KMallocAlign = 16;
+
+struct TThreadCache
+    {
+    TInt iCount[KSlabClasses];
+    TAny* iCells[KSlabClasses][KCacheDepth];
+    TBool iRegistered;
+    TBool iDead;            // flushed on exit, later frees bypass the cache
+    };
+
+static RNewAllocator* volatile TheHeap = NULL;
+static pthread_mutex_t TheHeapLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t TheCacheKey;
+static __thread TThreadCache TheCache __attribute__((tls_model("initial-exec")));
+
+static inline TInt SlabClass(size_t aSize)
+    {
+    return aSize <= 8 ? 0 : aSize <= 16 ? 1 : aSize <= 32 ? 2 : 3;
+    }
+
+static void FlushCache(TAny* aCache)
+    {
+    TThreadCache* cache = static_cast<TThreadCache*>(aCache);
+    for (TInt i = 0; i < KSlabClasses; ++i)
+        {
+        if (cache->iCount[i])
+            TheHeap->SlabFreeBatch(cache->iCells[i], cache->iCount[i]);
+        cache->iCount[i] = 0;
+        }
+    cache->iDead = ETrue;
+    }
+
+static void PrepareFork()
+    {
+    pthread_mutex_lock(&TheHeapLock);
+    if (TheHeap)
+        TheHeap->Lock();
+    }
+
+static void FinishFork()
+    {
+    if (TheHeap)
+        TheHeap->Unlock();
+    pthread_mutex_unlock(&TheHeapLock);
+    }
+
+static RNewAllocator* CreateHeap()
+    {
+    pthread_mutex_lock(&TheHeapLock);
+    if (!TheHeap)
+        {
+        TInt maxHeap = KDefaultMaxHeap;
+        const char* env = getenv("NEWALLOCATOR_MAX_HEAP");
+        if (env)
+            {
+            long value = strtol(env, NULL, 0);
+            if (value > 0 && value <= KDefaultMaxHeap)
+                maxHeap = value;
+            }
+        RNewAllocator* heap = RNewAllocator::CreateProcessHeap(maxHeap);
+        if (heap)
+            {
+            pthread_key_create(&TheCacheKey, FlushCache);
+            pthread_atfork(PrepareFork, FinishFork, FinishFork);
+            __sync_synchronize();
+            TheHeap = heap;
+            }
+        }
+    pthread_mutex_unlock(&TheHeapLock);
+    return TheHeap;
+    }
+
+static inline RNewAllocator* Heap()
+    {
+    RNewAllocator* heap = TheHeap;
+    return heap ? heap : CreateHeap();
+    }
+
+static inline TThreadCache* Cache()
+    {
+    TThreadCache* cache = &TheCache;
+    if (!cache->iRegistered)
+        {
+        // Set first, pthread_setspecific() may allocate
+        cache->iRegistered = ETrue;
+        pthread_setspecific(TheCacheKey, cache);
+        }
+    return cache->iDead ? NULL : cache;
+    }
+
+static void* Allocate(size_t aSize)
+    {
+    RNewAllocator* heap = Heap();
+    if (!heap || aSize >= size_t(KMaxTInt / 2))
+        {
+        errno = ENOMEM;
+        return NULL;
+        }
+
+    TAny* p = NULL;
+    TThreadCache* cache;
+    if (TInt(aSize) < heap->SlabThreshold() && (cache = Cache()) != NULL)
+        {
+        TInt c = SlabClass(aSize);
+        if (!cache->iCount[c])
+            cache->iCount[c] = heap->SlabAllocBatch(KSlabClassSize[c], cache->iCells[c], KCacheBatch);
+        if (cache->iCount[c])
+            p = cache->iCells[c][--cache->iCount[c]];
+        }
+    else
+        {
+        // Sizes above the smallest class are rounded to keep 16 byte alignment
+        p = heap->Alloc(aSize <= 8 ? aSize : _ALIGN_UP(aSize, KMallocAlign));
+        }
+    if (!p)
+        errno = ENOMEM;
+    return p;
+    }
+
+static void Release(void* aPtr)
+    {
+    RNewAllocator* heap = TheHeap;
+    if (!aPtr || !heap || !heap->Owns(aPtr))
+        return;     // not ours, allocated before the heap was set up
+
+    TThreadCache* cache;
+    if (heap->IsSlabCell(aPtr) && (cache = Cache()) != NULL)
+        {
+        // The size bits of a slab header do not change while it has live cells
+        TInt c = SlabClass(heap->AllocLen(aPtr));
+        if (cache->iCount[c] == KCacheDepth)
+            {
+            heap->SlabFreeBatch(&cache->iCells[c][KCacheDepth - KCacheBatch], KCacheBatch);
+            cache->iCount[c] -= KCacheBatch;
+            }
+        cache->iCells[c][cache->iCount[c]++] = aPtr;
+        return;
+        }
+    heap->Free(aPtr);
+    }
+
+static void* AlignedAllocate(size_t aAlign, size_t aSize)
+    {
+    if (aAlign <= size_t(KMallocAlign))
+        return Allocate(aSize <= 8 && aAlign > 8 ? 16 : aSize);
+
+    RNewAllocator* heap = Heap();
+    if (!heap || aSize >= size_t(KMaxTInt / 2) || aAlign >= size_t(KMaxTInt / 2))
+        {
+        errno = ENOMEM;
+        return NULL;
+        }
+    TAny* p = heap->AlignedAlloc(aAlign, aSize);
+    if (!p)
+        errno = ENOMEM;
+    return p;
+    }
+
+extern "C" {
+
+void* malloc(size_t aSize)
+    {
+    return Allocate(aSize);
+    }
+
+void free(void* aPtr)
+    {
+    Release(aPtr);
+    }
+
+void cfree(void* aPtr)
+    {
+    Release(aPtr);
+    }
+
+void* calloc(size_t aCount, size_t aSize)
+    {
+    if (aSize && aCount > size_t(-1) / aSize)
+        {
+        errno = ENOMEM;
+        return NULL;
+        }
+    void* p = Allocate(aCount * aSize);
+    if (p)
+        memset(p, 0, aCount * aSize);
+    return p;
+    }
+
+void* realloc(void* aPtr, size_t aSize)
+    {
+    if (!aPtr)
+        return Allocate(aSize);
+    if (!aSize)
+        {
+        Release(aPtr);
+        return NULL;
+        }
+
+    RNewAllocator* heap = TheHeap;
+    if (!heap || !heap->Owns(aPtr) || aSize >= size_t(KMaxTInt / 2))
+        {
+        errno = ENOMEM;
+        return NULL;
+        }
+    // Slab cells go through the thread cache, the others can grow in place
+    TInt oldSize = heap->AllocLen(aPtr);
+    if (heap->IsSlabCell(aPtr))
+        {
+        if (aSize <= size_t(oldSize))
+            return aPtr;
+        void* p = Allocate(aSize);
+        if (p)
+            {
+            memcpy(p, aPtr, oldSize);
+            Release(aPtr);
+            }
+        return p;
+        }
+    void* p = heap->ReAlloc(aPtr, aSize <= 8 ? aSize : _ALIGN_UP(aSize, KMallocAlign));
+    if (!p)
+        errno = ENOMEM;
+    return p;
+    }
+
+void* memalign(size_t aAlign, size_t aSize)
+    {
+    if (aAlign & (aAlign - 1))
+        {
+        errno = EINVAL;
+        return NULL;
+        }
+    return AlignedAllocate(aAlign, aSize);
+    }
+
+void* aligned_alloc(size_t aAlign, size_t aSize)
+    {
+    return memalign(aAlign, aSize);
+    }
+
+int posix_memalign(void** aPtr, size_t aAlign, size_t aSize)
+    {
+    if (aAlign < sizeof(void*) || (aAlign & (aAlign - 1)))
+        return EINVAL;
+    void* p = AlignedAllocate(aAlign, aSize);
+    if (!p)
+        return ENOMEM;
+    *aPtr = p;
+    return 0;
+    }
+
+void* valloc(size_t aSize)
+    {
+    return AlignedAllocate(sysconf(_SC_PAGESIZE), aSize);
+    }
+
+void* pvalloc(size_t aSize)
+    {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    return AlignedAllocate(pageSize, _ALIGN_UP(aSize, pageSize));
+    }
+
+size_t malloc_usable_size(void* aPtr)
+    {
+    RNewAllocator* heap = TheHeap;
+    if (!aPtr || !heap || !heap->Owns(aPtr))
+        return 0;
+    return heap->AllocLen(aPtr);
+    }
+
+}
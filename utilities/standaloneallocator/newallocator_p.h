@@ -107,7 +107,7 @@ public:
     RNewAllocator(TInt aChunkHandle, TInt aOffset, TInt aMinLength, TInt aMaxLength, TInt aGrowBy, TInt aAlign=0, TBool aSingleThread=EFalse);
     inline RNewAllocator();
 
-    TAny* operator new(TUint aSize, TAny* aBase) __NO_THROW;
+    TAny* operator new(size_t aSize, TAny* aBase) __NO_THROW;
     inline void operator delete(TAny*, TAny*);
 
 protected:
@@ -191,7 +191,9 @@ private:
     inline  mchunkptr mmap_resize(mstate m, mchunkptr oldp, size_t nb);
 
         /****************************Code Added For DL heap**********************/
+#ifdef __SYMBIAN32__
     friend TInt _symbian_SetupThreadHeap(TBool aNotFirst, SStdEpocThreadCreateInfo& aInfo);
+#endif
 private:
     unsigned short slab_threshold;
     unsigned short page_threshold;      // 2^n is smallest cell size allocated in paged allocator
@@ -274,12 +276,29 @@ private:
     //TInt iHighWaterMark;
 
 
+#ifndef __SYMBIAN32__
+public:
+    static RNewAllocator* CreateProcessHeap(TInt aMaxLength);
+    TInt SlabAllocBatch(TInt aSize, TAny** aCells, TInt aCount);
+    void SlabFreeBatch(TAny** aCells, TInt aCount);
+    TAny* AlignedAlloc(TInt aAlign, TInt aSize);
+    inline TBool Owns(const TAny* aPtr) const;
+    inline TBool IsSlabCell(const TAny* aPtr) const;
+    inline TInt SlabThreshold() const {return slab_threshold;}
+private:
+    void* dlmemalign(size_t alignment, size_t bytes);
+#endif
+
 private:
     static RNewAllocator* FixedHeap(TAny* aBase, TInt aMaxLength, TInt aAlign, TBool aSingleThread);
+#ifdef __SYMBIAN32__
     static RNewAllocator* ChunkHeap(const TDesC* aName, TInt aMinLength, TInt aMaxLength, TInt aGrowBy, TInt aAlign, TBool aSingleThread);
+#endif
     static RNewAllocator* ChunkHeap(RChunk aChunk, TInt aMinLength, TInt aGrowBy, TInt aMaxLength, TInt aAlign, TBool aSingleThread, TUint32 aMode);
     static RNewAllocator* OffsetChunkHeap(RChunk aChunk, TInt aMinLength, TInt aOffset, TInt aGrowBy, TInt aMaxLength, TInt aAlign, TBool aSingleThread, TUint32 aMode);
+#ifdef __SYMBIAN32__
     static TInt CreateThreadHeap(SStdEpocThreadCreateInfo& aInfo, RNewAllocator*& aHeap, TInt aAlign = 0, TBool aSingleThread = EFalse);
+#endif
 
 
 private:
@@ -366,4 +385,25 @@ inline TInt RNewAllocator::ChunkHandle() const
     return iChunkHandle;
     }
 
+#ifndef __SYMBIAN32__
+inline TBool RNewAllocator::Owns(const TAny* aPtr) const
+/**
+@return ETrue if aPtr lies in the chunk of this heap.
+@internalComponent
+*/
+    {
+    TLinAddr base = TLinAddr(this) - iOffset;
+    return TLinAddr(aPtr) - base < TLinAddr(iOffset) + iMaxLength;
+    }
+
+inline TBool RNewAllocator::IsSlabCell(const TAny* aPtr) const
+/**
+@return ETrue if aPtr, a cell of this heap, was allocated from a slab.
+@internalComponent
+*/
+    {
+    return TLinAddr(aPtr) < TLinAddr(this) && lowbits(aPtr, pagesize) > cellalign;
+    }
+#endif
+
 #endif // NEWALLOCATOR_H
@@ -17,7 +17,7 @@
 #
 #
 
-# Custom memory allocator lib for Symbian only
+# Custom memory allocator lib for Symbian, and a malloc replacement on Linux
 TEMPLATE = lib
 TARGET   = standaloneallocator
 # We might want to change this later to project-specific output area
@@ -39,6 +39,13 @@ symbian {
     
     # This seems not to work, some hard coded libs are still added as dependency
     LIBS =
+} else:linux-* {
+    # Shared library interposing malloc() and friends, for LD_PRELOAD
+    CONFIG  -= staticlib
+    CONFIG  += shared plugin
+    SOURCES  =  newallocator.cpp newallocator_linux.cpp newallocator_malloc.cpp
+    HEADERS  =  dla_p.h newallocator_p.h newallocator_linux_p.h
+    LIBS    += -lpthread
 } else {
-    error("$$_FILE_ is intended only for Symbian!")
+    error("$$_FILE_ is intended only for Symbian and Linux!")
 }
@@ -32,6 +32,12 @@ symbian {
     SUBDIRS += standaloneallocator
 }
 
+# Opt-in on Linux, qmake CONFIG+=newallocator builds the allocator as a
+# malloc replacement to load with LD_PRELOAD
+linux-*:newallocator {
+    SUBDIRS += standaloneallocator
+}
+
 SUBDIRS += serviceipcserver
 SUBDIRS += serviceipcclient
 SUBDIRS += downloadmanager